@@ -247,6 +247,41 @@ def envoy_cc_test_library(name,
         linkstatic = 1,
     )
 
+# Envoy C++ benchmark binaries (using google/benchmark) should be specified with this function.
+def envoy_cc_benchmark_binary(name,
+                              srcs = [],
+                              data = [],
+                              external_deps = [],
+                              deps = [],
+                              repository = ""):
+    native.cc_binary(
+        name = name,
+        srcs = srcs,
+        data = data,
+        copts = envoy_copts(repository, test = True),
+        linkopts = envoy_test_linkopts(),
+        testonly = 1,
+        linkstatic = 1,
+        malloc = tcmalloc_external_dep(repository),
+        deps = deps + [envoy_external_dep_path(dep) for dep in external_deps] + [
+            envoy_external_dep_path('benchmark'),
+            repository + "//test/benchmark:main",
+        ],
+    )
+
+# Runs an Envoy benchmark binary as a test, with each benchmark doing a single iteration. This
+# checks that the benchmarks keep building and working, without timing anything.
+def envoy_benchmark_test(name,
+                         benchmark_binary,
+                         tags = []):
+    native.sh_test(
+        name = name,
+        srcs = ["//bazel:sh_test_wrapper.sh"],
+        data = [":" + benchmark_binary],
+        args = ["./" + benchmark_binary, "--benchmark_min_time=0"],
+        tags = tags,
+    )
+
 # Envoy Python test binaries should be specified with this function.
 def envoy_py_test_binary(name,
                          external_deps = [],
@@ -4,6 +4,7 @@
 TARGET_RECIPES = {
     "ares": "cares",
     "backward": "backward",
+    "benchmark": "benchmark",
     "event": "libevent",
     "event_pthreads": "libevent",
     "fmtlib": "fmtlib",
@@ -18,6 +19,7 @@ TARGET_RECIPES = {
     "protobuf": "protobuf",
     "protoc": "protobuf",
     "rapidjson": "rapidjson",
+    "re2": "re2",
     "spdlog": "spdlog",
     "ssl": "boringssl",
     "tclap": "tclap",
@@ -18,6 +18,52 @@ struct RawSlice {
   size_t len_;
 };
 
+/**
+ * A wrapper class to facilitate passing in externally owned data to a buffer via
+ * addBufferFragment(). When the buffer no longer needs the data passed in through a fragment, it
+ * calls done() on it.
+ */
+class BufferFragment {
+public:
+  virtual ~BufferFragment() {}
+
+  /**
+   * @return a pointer to the referenced data.
+   */
+  virtual const void* data() const PURE;
+
+  /**
+   * @return the size of the referenced data.
+   */
+  virtual size_t size() const PURE;
+
+  /**
+   * Called by a buffer when the referenced data is no longer needed.
+   */
+  virtual void done() PURE;
+};
+
+/**
+ * An account that buffers charge the memory they hold to, e.g. one per connection covering all of
+ * the buffers that hold data for that connection.
+ */
+class MemoryAccount {
+public:
+  virtual ~MemoryAccount() {}
+
+  /**
+   * @param bytes supplies the number of bytes added to a buffer charged to this account.
+   */
+  virtual void charge(uint64_t bytes) PURE;
+
+  /**
+   * @param bytes supplies the number of bytes removed from a buffer charged to this account.
+   */
+  virtual void credit(uint64_t bytes) PURE;
+};
+
+typedef std::shared_ptr<MemoryAccount> MemoryAccountSharedPtr;
+
 /**
  * A basic buffer abstraction.
  */
@@ -32,6 +78,14 @@ public:
    */
   virtual void add(const void* data, uint64_t size) PURE;
 
+  /**
+   * Add externally owned data into the buffer. No copying is done. The fragment is not owned by the
+   * buffer and must stay valid, along with the data it references, until the buffer calls done()
+   * on it. Data added this way is read only: it is never written to by the buffer.
+   * @param fragment the externally owned data to add to the buffer.
+   */
+  virtual void addBufferFragment(BufferFragment& fragment) PURE;
+
   /**
    * Copy a string into the buffer.
    * @param data supplies the string to copy.
@@ -44,6 +98,19 @@ public:
    */
   virtual void add(const Instance& data) PURE;
 
+  /**
+   * Prepend a string to the buffer, copying it.
+   * @param data supplies the string to copy.
+   */
+  virtual void prepend(const std::string& data) PURE;
+
+  /**
+   * Prepend data from another buffer to this buffer. The contents of the other buffer are moved
+   * with as little copying as possible, and the other buffer is left empty.
+   * @param data supplies the buffer whose contents are moved to the front of this buffer.
+   */
+  virtual void prepend(Instance& data) PURE;
+
   /**
    * Commit a set of slices originally obtained from reserve(). The number of slices can be
    * different from the number obtained from reserve(). The size of each slice can also be altered.
@@ -65,13 +132,13 @@ public:
    * @return the actual number of slices needed, which may be greater than out_size. Passing
    *         nullptr for out and 0 for out_size will just return the size of the array needed
    *         to capture all of the slice data.
-   * TODO(mattklein123): WARNING: The underlying implementation of this function currently uses
-   * libevent's evbuffer. It has the infuriating property where calling getRawSlices(nullptr, 0)
+   * TODO(mattklein123): WARNING: The libevent implementation of this function (see
+   * OwnedImpl::useOldImpl()) has the infuriating property where calling getRawSlices(nullptr, 0)
    * will return the slices that include all of the buffer data, but not any empty slices at the
    * end. However, calling getRawSlices(iovec, SOME_CONST), WILL return potentially empty slices
    * beyond the end of the buffer. Code that is trying to avoid stack overflow by limiting the
-   * number of returned slices needs to deal with this. When we get rid of evbuffer we can rework
-   * all of this.
+   * number of returned slices needs to deal with this. The native implementation never returns
+   * empty slices. When we get rid of evbuffer we can rework all of this.
    */
   virtual uint64_t getRawSlices(RawSlice* out, uint64_t out_size) const PURE;
 
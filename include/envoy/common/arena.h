@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+
+/**
+ * Memory that is released all at once when the arena is destroyed, rather than object by object.
+ * Allocating from an arena is usually a pointer bump, so objects that share a lifetime, such as
+ * everything that belongs to one HTTP stream, can be created without a heap allocation each.
+ */
+class Arena {
+public:
+  virtual ~Arena() {}
+
+  /**
+   * Allocate memory that stays valid until the arena is destroyed. It can't be freed on its own.
+   * @param size supplies the number of bytes to allocate.
+   * @param alignment supplies the alignment of the memory. It must be a power of two.
+   * @return void* the memory.
+   */
+  virtual void* allocate(size_t size, size_t alignment) PURE;
+
+  /**
+   * Create an object in the arena, with its reference count in the same allocation. The object is
+   * destroyed as usual when its last reference goes away, which must happen before the arena is
+   * destroyed.
+   * @param args supplies the constructor arguments.
+   * @return std::shared_ptr<T> the object.
+   */
+  template <class T, class... Args> std::shared_ptr<T> makeShared(Args&&... args);
+};
+
+/**
+ * A standard library allocator over an arena, for containers and std::allocate_shared().
+ * deallocate() does nothing, the memory comes back when the arena is destroyed.
+ */
+template <class T> class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  ArenaAllocator(Arena& arena) : arena_(&arena) {}
+  template <class U> ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+  T* allocate(size_t n) { return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T))); }
+  void deallocate(T*, size_t) {}
+
+  template <class U> bool operator==(const ArenaAllocator<U>& rhs) const {
+    return arena_ == rhs.arena_;
+  }
+  template <class U> bool operator!=(const ArenaAllocator<U>& rhs) const {
+    return arena_ != rhs.arena_;
+  }
+
+private:
+  template <class U> friend class ArenaAllocator;
+
+  Arena* arena_;
+};
+
+template <class T, class... Args> std::shared_ptr<T> Arena::makeShared(Args&&... args) {
+  return std::allocate_shared<T>(ArenaAllocator<T>(*this), std::forward<Args>(args)...);
+}
+
+} // namespace Envoy
@@ -92,7 +92,11 @@ enum class StreamResetReason {
   // If the stream was locally reset due to connection termination.
   ConnectionTermination,
   // The stream was reset because of a resource overflow.
-  Overflow
+  Overflow,
+  // If the stream was locally reset due to connection termination while it was pipelined behind
+  // another request on an HTTP/1.1 connection and its method is not idempotent. The upstream may
+  // have processed it, so it must not be retried.
+  PipelinedConnectionTermination
 };
 
 /**
@@ -181,6 +185,8 @@ struct Http1Settings {
   // Enable codec to parse absolute uris. This enables forward/explicit proxy support for non TLS
   // traffic
   bool allow_absolute_url_{false};
+  // Parse requests with the line based Http1::FastParser instead of http_parser.
+  bool fast_parser_{false};
 };
 
 /**
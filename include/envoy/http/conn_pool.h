@@ -35,6 +35,17 @@ enum class PoolFailureReason {
   ConnectionFailure
 };
 
+/**
+ * How far ahead of demand a pool opens connections. The default opens connections only on demand.
+ */
+struct PreconnectPolicy {
+  // Connections to keep open beyond those needed by the requests in flight.
+  uint32_t min_idle_connections_{};
+  // Connections to keep open per request in flight, so that the pool grows ahead of a rising
+  // request rate.
+  double ratio_{1.0};
+};
+
 /**
  * Pool callbacks invoked in the context of a newStream() call, either synchronously or
  * asynchronously.
@@ -95,6 +106,12 @@ public:
    *                      should be done by resetting the stream.
    */
   virtual Cancellable* newStream(Http::StreamDecoder& response_decoder, Callbacks& callbacks) PURE;
+
+  /**
+   * Open connections ahead of demand as allowed by the pool's preconnect policy. This is used to
+   * warm up a pool before its first request. Pools also preconnect as new streams are created.
+   */
+  virtual void preconnect() PURE;
 };
 
 typedef std::unique_ptr<Instance> InstancePtr;
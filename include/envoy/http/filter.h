@@ -5,6 +5,7 @@
 #include <memory>
 #include <string>
 
+#include "envoy/common/arena.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/http/access_log.h"
 #include "envoy/http/codec.h"
@@ -462,6 +463,13 @@ public:
    * @param handler supplies the handler to add.
    */
   virtual void addAccessLogHandler(Http::AccessLog::InstanceSharedPtr handler) PURE;
+
+  /**
+   * @return Arena& memory that lives as long as the stream. Filters that are created in it with
+   *         Arena::makeShared() avoid a heap allocation each, but must not be referenced once the
+   *         stream is destroyed.
+   */
+  virtual Arena& arena() PURE;
 };
 
 /**
@@ -79,6 +79,18 @@ public:
     Stats::Gauge& write_current_;
     // Counter* as this is an optional counter.  Bind errors will not be tracked if this is nullptr.
     Stats::Counter* bind_errors_;
+    // Counter* as this is an optional counter. Counts the socket reads that returned data, so that
+    // the average number of bytes per read can be derived from read_total_. Not tracked if this is
+    // nullptr.
+    Stats::Counter* read_syscalls_;
+  };
+
+  struct ZeroCopySendStats {
+    // Writes sent with MSG_ZEROCOPY.
+    Stats::Counter& sends_;
+    // Zero copy writes that were copied after all, either by the kernel or because the socket ran
+    // out of memory for pinned pages.
+    Stats::Counter& fallbacks_;
   };
 
   virtual ~Connection() {}
@@ -181,7 +193,8 @@ public:
   /**
    * Set a soft limit on the size of buffers for the connection.
    * For the read buffer, this limits the bytes read prior to flushing to further stages in the
-   * processing pipeline.
+   * processing pipeline. It also bounds the amount of data requested from the socket by a single
+   * read.
    * For the write buffer, it sets watermarks.  When enough data is buffered it triggers a call to
    * onAboveWriteBufferHighWatermark, which allows subscribers to enforce flow control by disabling
    * reads on the socket funneling data to the write buffer.  When enough data is drained from the
@@ -195,6 +208,45 @@ public:
    */
   virtual uint32_t bufferLimit() const PURE;
 
+  /**
+   * Opt in to zero copy sends (MSG_ZEROCOPY) for large writes. Sent data is then transmitted by the
+   * kernel straight from the write buffer memory, which is held until the kernel reports completion.
+   * This is only worthwhile for connections that write large payloads. It is not available on all
+   * platforms, and not for TLS connections.
+   * @param stats supplies the counters to update. They must outlive the connection.
+   * @return bool whether zero copy sends were enabled.
+   */
+  virtual bool enableZeroCopySend(const ZeroCopySendStats& stats) PURE;
+
+  /**
+   * Move data read from this connection straight to the socket of another connection with
+   * splice(2), so that it is never copied into user space. The read filters of this connection and
+   * the write filters of the other connection are bypassed, so this is only allowed if this
+   * connection has at most one read filter (the caller) and the other connection has no write
+   * filters. Neither connection may use TLS and this connection must not have buffered read data.
+   * Data already buffered for writing on the other connection is written before spliced data.
+   * Flow control between the two connections is then applied by the kernel pipe in between rather
+   * than by write buffer watermarks.
+   * @param connection supplies the connection to send data to. It must outlive this connection or
+   *        be closed first.
+   * @return bool whether splicing was enabled. If not, data keeps flowing through the read filters.
+   */
+  virtual bool spliceTo(Connection& connection) PURE;
+
+  /**
+   * Publish the buffer memory held for this connection to a gauge of its owner, e.g. its listener
+   * or cluster. Does nothing if buffer memory is not tracked for the connection.
+   * @param gauge supplies the gauge. It must stay valid until the connection is closed.
+   */
+  virtual void setBufferMemoryGauge(Stats::Gauge& gauge) PURE;
+
+  /**
+   * @return Buffer::MemoryAccountSharedPtr the account that buffers holding data for this
+   *         connection, such as HTTP stream buffers, should charge. nullptr if buffer memory is not
+   *         tracked for the connection.
+   */
+  virtual Buffer::MemoryAccountSharedPtr bufferMemoryAccount() PURE;
+
   /**
    * @return boolean telling if the connection's local address is an original destination address,
    * rather than the listener's address.
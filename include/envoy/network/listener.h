@@ -25,6 +25,8 @@ struct ListenerOptions {
   bool use_original_dst_;
   // Soft limit on size of the listener's new connection read and write buffers.
   uint32_t per_connection_buffer_limit_bytes_;
+  // Whether the listener's new connections send large writes with zero copy sends.
+  bool zero_copy_send_;
 
   /**
    * Factory for ListenerOptions with bind_to_port_ set.
@@ -34,7 +36,8 @@ struct ListenerOptions {
     return {.bind_to_port_ = true,
             .use_proxy_proto_ = false,
             .use_original_dst_ = false,
-            .per_connection_buffer_limit_bytes_ = 0};
+            .per_connection_buffer_limit_bytes_ = 0,
+            .zero_copy_send_ = false};
   }
 };
 
@@ -100,6 +100,13 @@ public:
    */
   virtual uint32_t perConnectionBufferLimitBytes() PURE;
 
+  /**
+   * @return bool whether the listener's new connections should use zero copy sends for large
+   *         writes. It is fixed for the lifetime of the listener.
+   *         @see Network::Connection::enableZeroCopySend().
+   */
+  virtual bool zeroCopySend() PURE;
+
   /**
    * @return Stats::Scope& the stats scope to use for all listener specific stats.
    */
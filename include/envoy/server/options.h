@@ -120,6 +120,13 @@ public:
    * @return const std::string& the server's zone.
    */
   virtual const std::string& serviceZone() PURE;
+
+  /**
+   * @return uint64_t the maximum number of bytes held in connection and HTTP stream buffers across
+   *         all workers before reads are disabled on the connections holding the most, or 0 for no
+   *         limit.
+   */
+  virtual uint64_t maxBufferMemoryBytes() PURE;
 };
 
 } // namespace Server
@@ -186,11 +186,15 @@ public:
   COUNTER(lb_zone_routing_cross_zone)                                                              \
   COUNTER(upstream_cx_total)                                                                       \
   GAUGE  (upstream_cx_active)                                                                      \
+  GAUGE  (upstream_cx_buffer_memory_bytes)                                                          \
   COUNTER(upstream_cx_http1_total)                                                                 \
   COUNTER(upstream_cx_http2_total)                                                                 \
   COUNTER(upstream_cx_connect_fail)                                                                \
   COUNTER(upstream_cx_connect_timeout)                                                             \
   COUNTER(upstream_cx_overflow)                                                                    \
+  COUNTER(upstream_cx_preconnect)                                                                  \
+  COUNTER(upstream_cx_preconnect_used)                                                             \
+  COUNTER(upstream_cx_preconnect_wasted)                                                           \
   TIMER  (upstream_cx_connect_ms)                                                                  \
   TIMER  (upstream_cx_length_ms)                                                                   \
   COUNTER(upstream_cx_destroy)                                                                     \
@@ -202,6 +206,7 @@ public:
   COUNTER(upstream_cx_close_notify)                                                                \
   COUNTER(upstream_cx_rx_bytes_total)                                                              \
   GAUGE  (upstream_cx_rx_bytes_buffered)                                                           \
+  COUNTER(upstream_cx_rx_syscalls_total)                                                           \
   COUNTER(upstream_cx_tx_bytes_total)                                                              \
   GAUGE  (upstream_cx_tx_bytes_buffered)                                                           \
   COUNTER(upstream_cx_protocol_error)                                                              \
@@ -214,6 +219,7 @@ public:
   COUNTER(upstream_rq_pending_failure_eject)                                                       \
   GAUGE  (upstream_rq_pending_active)                                                              \
   COUNTER(upstream_rq_cancelled)                                                                   \
+  COUNTER(upstream_rq_pipelined)                                                                   \
   COUNTER(upstream_rq_maintenance_mode)                                                            \
   COUNTER(upstream_rq_timeout)                                                                     \
   COUNTER(upstream_rq_per_try_timeout)                                                             \
@@ -1,5 +1,8 @@
 #include "common/buffer/buffer_impl.h"
 
+#include <sys/uio.h>
+
+#include <climits>
 #include <cstdint>
 #include <string>
 
@@ -10,21 +13,70 @@
 namespace Envoy {
 namespace Buffer {
 
-// RawSlice is the same structure as evbuffer_iovec. This was put into place to avoid leaking
-// libevent into most code since we will likely replace evbuffer with our own implementation at
-// some point. However, we can avoid a bunch of copies since the structure is the same.
+// RawSlice is the same structure as evbuffer_iovec and struct iovec. This was put into place to
+// avoid leaking libevent into most code. However, we can avoid a bunch of copies since the
+// structure is the same.
 static_assert(sizeof(RawSlice) == sizeof(evbuffer_iovec), "RawSlice != evbuffer_iovec");
 static_assert(offsetof(RawSlice, mem_) == offsetof(evbuffer_iovec, iov_base),
               "RawSlice != evbuffer_iovec");
 static_assert(offsetof(RawSlice, len_) == offsetof(evbuffer_iovec, iov_len),
               "RawSlice != evbuffer_iovec");
+static_assert(sizeof(RawSlice) == sizeof(iovec), "RawSlice != iovec");
+static_assert(offsetof(RawSlice, mem_) == offsetof(iovec, iov_base), "RawSlice != iovec");
+static_assert(offsetof(RawSlice, len_) == offsetof(iovec, iov_len), "RawSlice != iovec");
+
+bool OwnedImpl::use_old_impl_ = false;
+
+void OwnedImpl::useOldImpl(bool use_old_impl) { use_old_impl_ = use_old_impl; }
 
-void OwnedImpl::add(const void* data, uint64_t size) { evbuffer_add(buffer_.get(), data, size); }
+bool OwnedImpl::isSameBufferImpl(const Instance& rhs) const {
+  const OwnedImpl* other = dynamic_cast<const OwnedImpl*>(&rhs);
+  if (other == nullptr) {
+    return false;
+  }
+  return usesOldImpl() == other->usesOldImpl();
+}
 
-void OwnedImpl::add(const std::string& data) {
-  evbuffer_add(buffer_.get(), data.c_str(), data.size());
+Event::Libevent::BufferPtr& OwnedImpl::buffer() {
+  ASSERT(old_impl_);
+  return buffer_;
 }
 
+void OwnedImpl::add(const void* data, uint64_t size) {
+  if (old_impl_) {
+    evbuffer_add(buffer_.get(), data, size);
+    return;
+  }
+
+  const uint8_t* src = static_cast<const uint8_t*>(data);
+  bool new_slice_needed = slices_.empty();
+  while (size != 0) {
+    if (new_slice_needed) {
+      slices_.emplace_back(OwnedSlice::create(size));
+    }
+    const uint64_t copy_size = slices_.back()->append(src, size);
+    src += copy_size;
+    size -= copy_size;
+    length_ += copy_size;
+    new_slice_needed = true;
+  }
+}
+
+void OwnedImpl::addBufferFragment(BufferFragment& fragment) {
+  if (old_impl_) {
+    evbuffer_add_reference(
+        buffer_.get(), fragment.data(), fragment.size(),
+        [](const void*, size_t, void* arg) { static_cast<BufferFragment*>(arg)->done(); },
+        &fragment);
+    return;
+  }
+
+  length_ += fragment.size();
+  slices_.emplace_back(SlicePtr(new UnownedSlice(fragment)));
+}
+
+void OwnedImpl::add(const std::string& data) { add(data.c_str(), data.size()); }
+
 void OwnedImpl::add(const Instance& data) {
   uint64_t num_slices = data.getRawSlices(nullptr, 0);
   RawSlice slices[num_slices];
@@ -34,77 +86,422 @@ void OwnedImpl::add(const Instance& data) {
   }
 }
 
+void OwnedImpl::prepend(const std::string& data) {
+  if (old_impl_) {
+    evbuffer_prepend(buffer_.get(), data.c_str(), data.size());
+    return;
+  }
+
+  uint64_t size = data.size();
+  bool new_slice_needed = slices_.empty();
+  while (size != 0) {
+    if (new_slice_needed) {
+      slices_.emplace_front(OwnedSlice::create(size));
+    }
+    // Slice::prepend() copies the tail of the data, so the remaining data is always a prefix.
+    const uint64_t copy_size = slices_.front()->prepend(data.c_str(), size);
+    size -= copy_size;
+    length_ += copy_size;
+    new_slice_needed = true;
+  }
+}
+
+void OwnedImpl::prepend(Instance& data) {
+  ASSERT(&data != this);
+  ASSERT(isSameBufferImpl(data));
+  // See move() below for why we do the static cast.
+  OwnedImpl& other = static_cast<OwnedImpl&>(data);
+  if (old_impl_) {
+    int rc = evbuffer_prepend_buffer(buffer_.get(), other.buffer().get());
+    ASSERT(rc == 0);
+    UNREFERENCED_PARAMETER(rc);
+  } else {
+    while (!other.slices_.empty()) {
+      const uint64_t slice_size = other.slices_.back()->dataSize();
+      length_ += slice_size;
+      other.length_ -= slice_size;
+      slices_.emplace_front(std::move(other.slices_.back()));
+      other.slices_.pop_back();
+    }
+  }
+  other.postProcess();
+}
+
 void OwnedImpl::commit(RawSlice* iovecs, uint64_t num_iovecs) {
-  int rc =
-      evbuffer_commit_space(buffer_.get(), reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(rc == 0);
-  UNREFERENCED_PARAMETER(rc);
+  if (old_impl_) {
+    int rc =
+        evbuffer_commit_space(buffer_.get(), reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
+    ASSERT(rc == 0);
+    UNREFERENCED_PARAMETER(rc);
+    return;
+  }
+
+  if (num_iovecs == 0 || slices_.empty()) {
+    return;
+  }
+
+  // Reservations are made from the end of the buffer and out of order commits are not supported,
+  // so scan backward to the last slice containing any content. Slices in front of it cannot match
+  // any of the iovecs being committed.
+  size_t slice_index = slices_.size() - 1;
+  while (slice_index > 0 && slices_[slice_index]->dataSize() == 0) {
+    slice_index--;
+  }
+
+  // Then scan forward, matching the slices against the iovecs.
+  uint64_t num_iovecs_committed = 0;
+  while (num_iovecs_committed < num_iovecs && slice_index < slices_.size()) {
+    const RawSlice& reservation = iovecs[num_iovecs_committed];
+    if (reservation.len_ == 0) {
+      num_iovecs_committed++;
+      continue;
+    }
+    if (slices_[slice_index]->commit(reservation)) {
+      length_ += reservation.len_;
+      num_iovecs_committed++;
+    }
+    slice_index++;
+  }
+  ASSERT(num_iovecs_committed == num_iovecs);
 }
 
 void OwnedImpl::drain(uint64_t size) {
   ASSERT(size <= length());
-  int rc = evbuffer_drain(buffer_.get(), size);
-  ASSERT(rc == 0);
-  UNREFERENCED_PARAMETER(rc);
+  if (old_impl_) {
+    int rc = evbuffer_drain(buffer_.get(), size);
+    ASSERT(rc == 0);
+    UNREFERENCED_PARAMETER(rc);
+    return;
+  }
+
+  while (size != 0 && !slices_.empty()) {
+    const uint64_t slice_size = slices_.front()->dataSize();
+    if (slice_size <= size) {
+      slices_.pop_front();
+      length_ -= slice_size;
+      size -= slice_size;
+    } else {
+      slices_.front()->drain(size);
+      length_ -= size;
+      size = 0;
+    }
+  }
 }
 
 uint64_t OwnedImpl::getRawSlices(RawSlice* out, uint64_t out_size) const {
-  return evbuffer_peek(buffer_.get(), -1, nullptr, reinterpret_cast<evbuffer_iovec*>(out),
-                       out_size);
+  if (old_impl_) {
+    return evbuffer_peek(buffer_.get(), -1, nullptr, reinterpret_cast<evbuffer_iovec*>(out),
+                         out_size);
+  }
+
+  uint64_t num_slices = 0;
+  for (size_t i = 0; i < slices_.size(); i++) {
+    const SlicePtr& slice = slices_[i];
+    if (slice->dataSize() == 0) {
+      continue;
+    }
+    if (num_slices < out_size) {
+      out[num_slices].mem_ = const_cast<uint8_t*>(slice->data());
+      out[num_slices].len_ = slice->dataSize();
+    }
+    // Keep counting past out_size, so the caller learns how many slices there are in total.
+    num_slices++;
+  }
+  return num_slices;
 }
 
-uint64_t OwnedImpl::length() const { return evbuffer_get_length(buffer_.get()); }
+uint64_t OwnedImpl::length() const {
+  if (old_impl_) {
+    return evbuffer_get_length(buffer_.get());
+  }
+
+  return length_;
+}
 
 void* OwnedImpl::linearize(uint32_t size) {
   ASSERT(size <= length());
-  return evbuffer_pullup(buffer_.get(), size);
+  if (old_impl_) {
+    return evbuffer_pullup(buffer_.get(), size);
+  }
+
+  if (slices_.empty()) {
+    return nullptr;
+  }
+
+  uint64_t linearized_size = 0;
+  uint64_t num_slices_to_linearize = 0;
+  for (size_t i = 0; i < slices_.size(); i++) {
+    num_slices_to_linearize++;
+    linearized_size += slices_[i]->dataSize();
+    if (linearized_size >= size) {
+      break;
+    }
+  }
+
+  if (num_slices_to_linearize > 1) {
+    SlicePtr new_slice = OwnedSlice::create(linearized_size);
+    for (uint64_t i = 0; i < num_slices_to_linearize; i++) {
+      new_slice->append(slices_.front()->data(), slices_.front()->dataSize());
+      slices_.pop_front();
+    }
+    ASSERT(new_slice->dataSize() == linearized_size);
+    slices_.emplace_front(std::move(new_slice));
+  }
+
+  return slices_.front()->data();
 }
 
 void OwnedImpl::move(Instance& rhs) {
+  ASSERT(&rhs != this);
+  ASSERT(isSameBufferImpl(rhs));
   // We do the static cast here because in practice we only have one buffer implementation right
-  // now and this is safe. Using the evbuffer move routines require having access to both evbuffers.
-  // This is a reasonable compromise in a high performance path where we want to maintain an
-  // abstraction in case we get rid of evbuffer later.
-  int rc = evbuffer_add_buffer(buffer_.get(), static_cast<LibEventInstance&>(rhs).buffer().get());
-  ASSERT(rc == 0);
-  UNREFERENCED_PARAMETER(rc);
-  static_cast<LibEventInstance&>(rhs).postProcess();
+  // now and this is safe. Moving data requires having access to both buffers' internals (the
+  // evbuffers or the slice queues). This is a reasonable compromise in a high performance path
+  // where we want to maintain an abstraction.
+  OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+  if (old_impl_) {
+    int rc = evbuffer_add_buffer(buffer_.get(), other.buffer().get());
+    ASSERT(rc == 0);
+    UNREFERENCED_PARAMETER(rc);
+  } else {
+    while (!other.slices_.empty()) {
+      const uint64_t slice_size = other.slices_.front()->dataSize();
+      if (slice_size != 0) {
+        slices_.emplace_back(std::move(other.slices_.front()));
+        length_ += slice_size;
+        other.length_ -= slice_size;
+      }
+      other.slices_.pop_front();
+    }
+  }
+  other.postProcess();
 }
 
 void OwnedImpl::move(Instance& rhs, uint64_t length) {
+  ASSERT(&rhs != this);
+  ASSERT(isSameBufferImpl(rhs));
   // See move() above for why we do the static cast.
-  int rc = evbuffer_remove_buffer(static_cast<LibEventInstance&>(rhs).buffer().get(), buffer_.get(),
-                                  length);
-  ASSERT(static_cast<uint64_t>(rc) == length);
-  UNREFERENCED_PARAMETER(rc);
-  static_cast<LibEventInstance&>(rhs).postProcess();
+  OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+  if (old_impl_) {
+    int rc = evbuffer_remove_buffer(other.buffer().get(), buffer_.get(), length);
+    ASSERT(static_cast<uint64_t>(rc) == length);
+    UNREFERENCED_PARAMETER(rc);
+  } else {
+    while (length != 0 && !other.slices_.empty()) {
+      const uint64_t slice_size = other.slices_.front()->dataSize();
+      const uint64_t copy_size = std::min(slice_size, length);
+      if (copy_size == 0) {
+        other.slices_.pop_front();
+      } else if (copy_size < slice_size) {
+        // Only part of this slice is being moved, so copy that part and leave the slice in place.
+        add(other.slices_.front()->data(), copy_size);
+        other.slices_.front()->drain(copy_size);
+        other.length_ -= copy_size;
+      } else {
+        slices_.emplace_back(std::move(other.slices_.front()));
+        other.slices_.pop_front();
+        length_ += slice_size;
+        other.length_ -= slice_size;
+      }
+      length -= copy_size;
+    }
+  }
+  other.postProcess();
 }
 
 int OwnedImpl::read(int fd, uint64_t max_length) {
-  return evbuffer_read(buffer_.get(), fd, max_length);
+  if (old_impl_) {
+    return evbuffer_read(buffer_.get(), fd, max_length);
+  }
+
+  if (max_length == 0) {
+    return 0;
+  }
+
+  // Large reads are scattered across several slices of at most MAX_READ_SLICE_SIZE bytes, so that
+  // the backing memory stays within the size classes recycled by the slice pool. The first iovec
+  // fills any space left at the end of the buffer.
+  static const uint64_t MAX_SLICES = 16;
+  static const uint64_t MAX_READ_SLICE_SIZE = 16384;
+  RawSlice slices[MAX_SLICES];
+  const size_t previous_num_slices = slices_.size();
+  uint64_t num_slices = reserve(std::min(max_length, MAX_READ_SLICE_SIZE), slices, 1);
+  uint64_t bytes_reserved = slices[0].len_;
+  while (bytes_reserved < max_length && num_slices < MAX_SLICES) {
+    slices_.emplace_back(
+        OwnedSlice::create(std::min(max_length - bytes_reserved, MAX_READ_SLICE_SIZE)));
+    slices[num_slices] = slices_.back()->reserve(max_length - bytes_reserved);
+    bytes_reserved += slices[num_slices].len_;
+    num_slices++;
+  }
+
+  const ssize_t rc = ::readv(fd, reinterpret_cast<iovec*>(slices), num_slices);
+  if (rc > 0) {
+    uint64_t num_slices_to_commit = 0;
+    uint64_t bytes_to_commit = rc;
+    while (bytes_to_commit != 0) {
+      slices[num_slices_to_commit].len_ =
+          std::min<uint64_t>(slices[num_slices_to_commit].len_, bytes_to_commit);
+      bytes_to_commit -= slices[num_slices_to_commit].len_;
+      num_slices_to_commit++;
+    }
+    ASSERT(num_slices_to_commit <= num_slices);
+    commit(slices, num_slices_to_commit);
+  }
+
+  // Release any slices added for this read that did not receive data.
+  while (slices_.size() > previous_num_slices && slices_.back()->dataSize() == 0) {
+    slices_.pop_back();
+  }
+  return rc;
 }
 
 uint64_t OwnedImpl::reserve(uint64_t length, RawSlice* iovecs, uint64_t num_iovecs) {
-  uint64_t ret = evbuffer_reserve_space(buffer_.get(), length,
-                                        reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(ret >= 1);
-  return ret;
+  if (old_impl_) {
+    uint64_t ret = evbuffer_reserve_space(buffer_.get(), length,
+                                          reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
+    ASSERT(ret >= 1);
+    return ret;
+  }
+
+  if (num_iovecs == 0 || length == 0) {
+    return 0;
+  }
+
+  // Find the sequence of reservable slices at the back of the buffer. Only the last slice holding
+  // data and any empty slices after it can take part in the reservation.
+  size_t first_reservable_slice = slices_.size();
+  while (first_reservable_slice > 0) {
+    if (slices_[first_reservable_slice - 1]->reservableSize() == 0) {
+      break;
+    }
+    first_reservable_slice--;
+    if (slices_[first_reservable_slice]->dataSize() != 0) {
+      // There is some content in this slice, so anything in front of it is not reservable.
+      break;
+    }
+  }
+
+  // Reserve as much space as possible from each of those slices.
+  uint64_t num_slices_used = 0;
+  uint64_t bytes_remaining = length;
+  size_t slice_index = first_reservable_slice;
+  while (slice_index < slices_.size() && bytes_remaining != 0 && num_slices_used < num_iovecs) {
+    const SlicePtr& slice = slices_[slice_index];
+    const uint64_t reservation_size = std::min(slice->reservableSize(), bytes_remaining);
+    if (num_slices_used + 1 == num_iovecs && reservation_size < bytes_remaining) {
+      // There is only one iovec left and this slice cannot complete the reservation. Leave the
+      // last iovec for a new slice that holds the rest of the reservation.
+      break;
+    }
+    iovecs[num_slices_used] = slice->reserve(reservation_size);
+    bytes_remaining -= iovecs[num_slices_used].len_;
+    num_slices_used++;
+    slice_index++;
+  }
+
+  // If needed, allocate one more slice at the end to provide the remainder of the reservation.
+  if (bytes_remaining != 0) {
+    slices_.emplace_back(OwnedSlice::create(bytes_remaining));
+    iovecs[num_slices_used] = slices_.back()->reserve(bytes_remaining);
+    bytes_remaining -= iovecs[num_slices_used].len_;
+    num_slices_used++;
+  }
+
+  ASSERT(num_slices_used <= num_iovecs);
+  ASSERT(bytes_remaining == 0);
+  return num_slices_used;
+}
+
+bool OwnedImpl::matchesAt(size_t slice_index, uint64_t offset, const uint8_t* data,
+                          uint64_t size) const {
+  while (size != 0 && slice_index < slices_.size()) {
+    const SlicePtr& slice = slices_[slice_index];
+    const uint64_t compare_size = std::min(slice->dataSize() - offset, size);
+    if (memcmp(slice->data() + offset, data, compare_size) != 0) {
+      return false;
+    }
+    data += compare_size;
+    size -= compare_size;
+    slice_index++;
+    offset = 0;
+  }
+  return size == 0;
 }
 
 ssize_t OwnedImpl::search(const void* data, uint64_t size, size_t start) const {
-  evbuffer_ptr start_ptr;
-  if (-1 == evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET)) {
+  if (old_impl_) {
+    evbuffer_ptr start_ptr;
+    if (-1 == evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET)) {
+      return -1;
+    }
+
+    evbuffer_ptr result_ptr =
+        evbuffer_search(buffer_.get(), static_cast<const char*>(data), size, &start_ptr);
+    return result_ptr.pos;
+  }
+
+  if (start > length_) {
     return -1;
   }
+  if (size == 0) {
+    return start;
+  }
+
+  // Like evbuffer_search(), this is a naive scan that requires O(M*N) comparisons in the worst
+  // case, but memchr() makes skipping to candidate positions fast.
+  const uint8_t* needle = static_cast<const uint8_t*>(data);
+  uint64_t slice_start = 0;
+  for (size_t slice_index = 0; slice_index < slices_.size(); slice_index++) {
+    const SlicePtr& slice = slices_[slice_index];
+    const uint64_t slice_size = slice->dataSize();
+    if (slice_start + slice_size <= start) {
+      slice_start += slice_size;
+      continue;
+    }
 
-  evbuffer_ptr result_ptr =
-      evbuffer_search(buffer_.get(), static_cast<const char*>(data), size, &start_ptr);
-  return result_ptr.pos;
+    const uint8_t* slice_data = slice->data();
+    const uint8_t* haystack_end = slice_data + slice_size;
+    const uint8_t* haystack = slice_data + (start > slice_start ? start - slice_start : 0);
+    while (haystack < haystack_end) {
+      haystack = static_cast<const uint8_t*>(memchr(haystack, needle[0], haystack_end - haystack));
+      if (haystack == nullptr) {
+        break;
+      }
+      const uint64_t offset = haystack - slice_data;
+      if (matchesAt(slice_index, offset, needle, size)) {
+        return slice_start + offset;
+      }
+      haystack++;
+    }
+    slice_start += slice_size;
+  }
+  return -1;
 }
 
-int OwnedImpl::write(int fd) { return evbuffer_write(buffer_.get(), fd); }
+int OwnedImpl::write(int fd) {
+  if (old_impl_) {
+    return evbuffer_write(buffer_.get(), fd);
+  }
+
+  // Write as many slices as a single writev() accepts.
+  RawSlice slices[IOV_MAX];
+  const uint64_t num_slices = std::min<uint64_t>(getRawSlices(slices, IOV_MAX), IOV_MAX);
+  if (num_slices == 0) {
+    return 0;
+  }
+  const ssize_t rc = ::writev(fd, reinterpret_cast<const iovec*>(slices), num_slices);
+  if (rc > 0) {
+    drain(rc);
+  }
+  return rc;
+}
 
-OwnedImpl::OwnedImpl() : buffer_(evbuffer_new()) {}
+OwnedImpl::OwnedImpl() : old_impl_(use_old_impl_) {
+  if (old_impl_) {
+    buffer_.reset(evbuffer_new());
+  }
+}
 
 OwnedImpl::OwnedImpl(const std::string& data) : OwnedImpl() { add(data); }
 
@@ -1,15 +1,408 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
 #include <string>
 
 #include "envoy/buffer/buffer.h"
 
+#include "common/buffer/slice_pool.h"
+#include "common/common/assert.h"
+#include "common/common/non_copyable.h"
 #include "common/event/libevent.h"
 
 namespace Envoy {
 namespace Buffer {
 
+/**
+ * A Slice manages a contiguous block of bytes. The block is arranged like this:
+ *
+ *                   |<- dataSize() ->|<- reservableSize() ->|
+ * +-----------------+----------------+----------------------+
+ * | Drained         | Data           | Reservable           |
+ * | Unused space    | Usable content | New content can be   |
+ * | that formerly   |                | added here with      |
+ * | was in the Data |                | reserve()/commit()   |
+ * | section         |                |                      |
+ * +-----------------+----------------+----------------------+
+ *                   ^
+ *                   data()
+ *
+ * The drained space at the front of a slice is reused by prepend(), which makes prepending to a
+ * buffer whose first slice has been partially drained free of allocations.
+ */
+class Slice {
+public:
+  virtual ~Slice() {}
+
+  /**
+   * @return a pointer to the start of the usable content.
+   */
+  const uint8_t* data() const { return base_ + data_; }
+  uint8_t* data() { return base_ + data_; }
+
+  /**
+   * @return the size in bytes of the usable content.
+   */
+  uint64_t dataSize() const { return reservable_ - data_; }
+
+  /**
+   * Remove the first size bytes of usable content. Runs in O(1) time.
+   * @param size number of bytes to remove. If greater than dataSize(), the result is undefined.
+   */
+  void drain(uint64_t size) {
+    ASSERT(data_ + size <= reservable_);
+    data_ += size;
+    if (data_ == reservable_ && writable_) {
+      // All the data in the slice has been drained. Reset the offsets so all the data can be
+      // reused.
+      data_ = 0;
+      reservable_ = 0;
+    }
+  }
+
+  /**
+   * @return the number of bytes available to be reserved.
+   */
+  uint64_t reservableSize() const { return capacity_ - reservable_; }
+
+  /**
+   * Reserve size bytes at the end of the usable content. Nothing is committed until commit() is
+   * called; a later reserve() will return the same memory.
+   * @param size the number of bytes to reserve.
+   * @return a RawSlice covering the reserved memory, which may be smaller than size if the slice
+   *         does not have enough room.
+   */
+  RawSlice reserve(uint64_t size) {
+    if (size == 0 || !writable_) {
+      return {nullptr, 0};
+    }
+    const uint64_t available_size = reservableSize();
+    if (available_size == 0) {
+      return {nullptr, 0};
+    }
+    return {base_ + reservable_, std::min(size, available_size)};
+  }
+
+  /**
+   * Commit a reservation previously obtained from reserve().
+   * @param reservation supplies the reservation, with len_ adjusted to the number of bytes that
+   *        were actually written.
+   * @return true if the reservation belonged to this slice and was committed, false otherwise.
+   */
+  bool commit(const RawSlice& reservation) {
+    if (static_cast<const uint8_t*>(reservation.mem_) != base_ + reservable_ ||
+        reservable_ + reservation.len_ > capacity_ || reservable_ >= capacity_) {
+      return false;
+    }
+    reservable_ += reservation.len_;
+    return true;
+  }
+
+  /**
+   * Copy as much of the supplied data as will fit into the reservable area of the slice.
+   * @param data supplies the data to copy.
+   * @param size supplies the length of the data.
+   * @return the number of bytes copied, which may be less than size.
+   */
+  uint64_t append(const void* data, uint64_t size) {
+    if (!writable_) {
+      return 0;
+    }
+    const uint64_t copy_size = std::min(size, reservableSize());
+    if (copy_size != 0) {
+      memcpy(base_ + reservable_, data, copy_size);
+      reservable_ += copy_size;
+    }
+    return copy_size;
+  }
+
+  /**
+   * Copy as much of the tail of the supplied data as will fit into the space in front of the
+   * usable content.
+   * @param data supplies the data to copy.
+   * @param size supplies the length of the data.
+   * @return the number of bytes copied, which may be less than size. The bytes copied are always
+   *         the last bytes of data.
+   */
+  uint64_t prepend(const void* data, uint64_t size) {
+    if (!writable_) {
+      return 0;
+    }
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    uint64_t copy_size;
+    if (dataSize() == 0) {
+      // There is nothing in the slice, so put the data at the very end in case the caller later
+      // prepends anything else in front of it.
+      copy_size = std::min(size, capacity_);
+      reservable_ = capacity_;
+      data_ = capacity_ - copy_size;
+    } else {
+      copy_size = std::min(size, data_);
+      data_ -= copy_size;
+    }
+    memcpy(base_ + data_, src + size - copy_size, copy_size);
+    return copy_size;
+  }
+
+protected:
+  Slice(uint64_t data, uint64_t reservable, uint64_t capacity)
+      : data_(data), reservable_(reservable), capacity_(capacity) {}
+
+  // Offset in bytes from the start of the slice to the start of the data.
+  uint64_t data_;
+  // Offset in bytes from the start of the slice to the start of the reservable space.
+  uint64_t reservable_;
+  // Total number of bytes in the slice.
+  uint64_t capacity_;
+  // Start of the slice. Subclasses must set this.
+  uint8_t* base_{nullptr};
+  // Whether the memory of the slice may be written to. Slices that reference external memory are
+  // read only, and keep their offsets when fully drained so no new data is ever placed in them.
+  bool writable_{true};
+};
+
+typedef std::unique_ptr<Slice> SlicePtr;
+
+/**
+ * A Slice whose storage is allocated inline, in the same heap block as the slice itself. Blocks are
+ * allocated from the calling thread's SlicePool, if it has one.
+ */
+class OwnedSlice : public Slice {
+public:
+  /**
+   * Create an empty OwnedSlice.
+   * @param capacity number of bytes of space the slice should have. The actual capacity is rounded
+   *        up so that the whole heap block fills a multiple of the page size, which also makes
+   *        the block poolable.
+   * @return an OwnedSlice with at least the specified capacity.
+   */
+  static SlicePtr create(uint64_t capacity) {
+    const uint64_t slice_capacity = sliceSize(capacity);
+    return SlicePtr(new (slice_capacity) OwnedSlice(slice_capacity));
+  }
+
+  /**
+   * Create an OwnedSlice and initialize it with a copy of the supplied data.
+   * @param data supplies the data to copy.
+   * @param size supplies the length of the data.
+   * @return an OwnedSlice containing a copy of the data.
+   */
+  static SlicePtr create(const void* data, uint64_t size) {
+    SlicePtr slice = create(size);
+    slice->append(data, size);
+    return slice;
+  }
+
+  // The object and its inline storage are a single allocation.
+  static void* operator new(size_t object_size, size_t data_size) {
+    return SlicePool::allocate(object_size + data_size);
+  }
+  static void operator delete(void* address) { SlicePool::release(address); }
+  static void operator delete(void* address, size_t) { SlicePool::release(address); }
+
+private:
+  OwnedSlice(uint64_t capacity) : Slice(0, 0, capacity) { base_ = storage_; }
+
+  /**
+   * Compute a slice size big enough to hold a specified amount of data, with the total size of
+   * the heap block (header plus data) rounded up to a multiple of the page size.
+   * @param data_size the minimum amount of data the slice must be able to store, in bytes.
+   * @return a recommended slice size, in bytes.
+   */
+  static uint64_t sliceSize(uint64_t data_size) {
+    const uint64_t overhead = SlicePool::HEADER_SIZE + sizeof(OwnedSlice);
+    const uint64_t page_size = SlicePool::PAGE_SIZE_BYTES;
+    const uint64_t num_pages = (overhead + data_size + page_size - 1) / page_size;
+    return num_pages * page_size - overhead;
+  }
+
+  uint8_t storage_[];
+};
+
+/**
+ * A read only Slice that references externally owned memory described by a BufferFragment. The
+ * fragment is released when the slice is destroyed.
+ */
+class UnownedSlice : public Slice {
+public:
+  UnownedSlice(BufferFragment& fragment)
+      : Slice(0, fragment.size(), fragment.size()), fragment_(fragment) {
+    base_ = static_cast<uint8_t*>(const_cast<void*>(fragment.data()));
+    writable_ = false;
+  }
+
+  ~UnownedSlice() override { fragment_.done(); }
+
+private:
+  BufferFragment& fragment_;
+};
+
+/**
+ * Queue of SlicePtr that supports efficient read and write access to both the front and the back
+ * of the queue. The first few slices are held inline in the queue object, so buffers that never
+ * hold more than a handful of slices never allocate for the queue itself.
+ */
+class SliceDeque {
+public:
+  SliceDeque() : ring_(inline_ring_), capacity_(INLINE_RING_CAPACITY) {}
+
+  SliceDeque(SliceDeque&& rhs) noexcept {
+    // This custom move constructor is needed so that ring_ will be updated properly.
+    std::move(rhs.inline_ring_, rhs.inline_ring_ + INLINE_RING_CAPACITY, inline_ring_);
+    external_ring_ = std::move(rhs.external_ring_);
+    ring_ = (external_ring_ != nullptr) ? external_ring_.get() : inline_ring_;
+    start_ = rhs.start_;
+    size_ = rhs.size_;
+    capacity_ = rhs.capacity_;
+    rhs.ring_ = rhs.inline_ring_;
+    rhs.start_ = 0;
+    rhs.size_ = 0;
+    rhs.capacity_ = INLINE_RING_CAPACITY;
+  }
+
+  SliceDeque& operator=(SliceDeque&& rhs) noexcept {
+    // This custom move assignment operator is needed so that ring_ will be updated properly.
+    std::move(rhs.inline_ring_, rhs.inline_ring_ + INLINE_RING_CAPACITY, inline_ring_);
+    external_ring_ = std::move(rhs.external_ring_);
+    ring_ = (external_ring_ != nullptr) ? external_ring_.get() : inline_ring_;
+    start_ = rhs.start_;
+    size_ = rhs.size_;
+    capacity_ = rhs.capacity_;
+    rhs.ring_ = rhs.inline_ring_;
+    rhs.start_ = 0;
+    rhs.size_ = 0;
+    rhs.capacity_ = INLINE_RING_CAPACITY;
+    return *this;
+  }
+
+  void emplace_back(SlicePtr&& slice) {
+    growRing();
+    size_t index = internalIndex(size_);
+    ring_[index] = std::move(slice);
+    size_++;
+  }
+
+  void emplace_front(SlicePtr&& slice) {
+    growRing();
+    start_ = (start_ == 0) ? capacity_ - 1 : start_ - 1;
+    ring_[start_] = std::move(slice);
+    size_++;
+  }
+
+  bool empty() const { return size() == 0; }
+  size_t size() const { return size_; }
+
+  SlicePtr& front() { return ring_[start_]; }
+  const SlicePtr& front() const { return ring_[start_]; }
+  SlicePtr& back() { return ring_[internalIndex(size_ - 1)]; }
+  const SlicePtr& back() const { return ring_[internalIndex(size_ - 1)]; }
+
+  SlicePtr& operator[](size_t i) { return ring_[internalIndex(i)]; }
+  const SlicePtr& operator[](size_t i) const { return ring_[internalIndex(i)]; }
+
+  void pop_front() {
+    if (size() == 0) {
+      return;
+    }
+    front() = SlicePtr();
+    size_--;
+    start_++;
+    if (start_ == capacity_) {
+      start_ = 0;
+    }
+  }
+
+  void pop_back() {
+    if (size() == 0) {
+      return;
+    }
+    back() = SlicePtr();
+    size_--;
+  }
+
+private:
+  static const size_t INLINE_RING_CAPACITY = 8;
+
+  size_t internalIndex(size_t index) const {
+    size_t internal_index = start_ + index;
+    if (internal_index >= capacity_) {
+      internal_index -= capacity_;
+      ASSERT(internal_index < capacity_);
+    }
+    return internal_index;
+  }
+
+  void growRing() {
+    if (size_ < capacity_) {
+      return;
+    }
+    const size_t new_capacity = capacity_ * 2;
+    std::unique_ptr<SlicePtr[]> new_ring(new SlicePtr[new_capacity]);
+    for (size_t i = 0; i < new_capacity; i++) {
+      ASSERT(new_ring[i] == nullptr);
+    }
+    size_t src = start_;
+    size_t dst = 0;
+    for (size_t i = 0; i < size_; i++) {
+      new_ring[dst++] = std::move(ring_[src++]);
+      if (src == capacity_) {
+        src = 0;
+      }
+    }
+    external_ring_.swap(new_ring);
+    ring_ = external_ring_.get();
+    start_ = 0;
+    capacity_ = new_capacity;
+  }
+
+  SlicePtr inline_ring_[INLINE_RING_CAPACITY];
+  std::unique_ptr<SlicePtr[]> external_ring_;
+  SlicePtr* ring_; // points to start of either inline or external ring.
+  size_t start_{0};
+  size_t size_{0};
+  size_t capacity_;
+};
+
+/**
+ * An implementation of BufferFragment where a releasor callback is called when the data is
+ * no longer needed.
+ */
+class BufferFragmentImpl : NonCopyable, public BufferFragment {
+public:
+  typedef std::function<void(const void*, size_t, const BufferFragmentImpl*)> Releasor;
+
+  /**
+   * Creates a new wrapper around the externally owned <data> of size <size>.
+   * The caller must ensure <data> is valid until releasor() is called, or for the lifetime of the
+   * fragment. releasor() is called with <data>, <size> and <this> to allow caller to delete the
+   * fragment object.
+   * @param data external data to reference.
+   * @param size size of data.
+   * @param releasor a callback function to be called when data is no longer needed. May be nullptr
+   *        for data with static lifetime.
+   */
+  BufferFragmentImpl(const void* data, size_t size, const Releasor& releasor)
+      : data_(data), size_(size), releasor_(releasor) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return data_; }
+  size_t size() const override { return size_; }
+  void done() override {
+    if (releasor_) {
+      releasor_(data_, size_, this);
+    }
+  }
+
+private:
+  const void* const data_;
+  const size_t size_;
+  const Releasor releasor_;
+};
+
 class LibEventInstance : public Instance {
 public:
   // Allows access into the underlying buffer for move() optimizations.
@@ -19,10 +412,15 @@ public:
 };
 
 /**
- * Wraps an allocated and owned evbuffer.
+ * Wraps an allocated and owned buffer.
+ *
+ * By default the buffer is a queue of Slices managed natively. For compatibility it can
+ * alternatively wrap a libevent evbuffer (see useOldImpl()). Both implementations expose the
+ * same Instance semantics, but a buffer may only move() data to and from buffers of the same
+ * implementation.
  *
- * Note that due to the internals of move() accessing buffer(), OwnedImpl is not
- * compatible with non-LibEventInstance buffers.
+ * Note that due to the internals of move(), OwnedImpl is not compatible with non-OwnedImpl
+ * buffers.
  */
 class OwnedImpl : public LibEventInstance {
 public:
@@ -33,8 +431,11 @@ public:
 
   // LibEventInstance
   void add(const void* data, uint64_t size) override;
+  void addBufferFragment(BufferFragment& fragment) override;
   void add(const std::string& data) override;
   void add(const Instance& data) override;
+  void prepend(const std::string& data) override;
+  void prepend(Instance& data) override;
   void commit(RawSlice* iovecs, uint64_t num_iovecs) override;
   void drain(uint64_t size) override;
   uint64_t getRawSlices(RawSlice* out, uint64_t out_size) const override;
@@ -48,10 +449,49 @@ public:
   int write(int fd) override;
   void postProcess() override {}
 
-  Event::Libevent::BufferPtr& buffer() override { return buffer_; }
+  Event::Libevent::BufferPtr& buffer() override;
+
+  /**
+   * Select the buffer implementation used by OwnedImpl objects created after this call. This is
+   * intended to be called once, at startup, before any buffers are created.
+   * @param use_old_impl supplies whether to wrap libevent evbuffers (true) or to use the native
+   *        slice based implementation (false, the default).
+   */
+  static void useOldImpl(bool use_old_impl);
+
+  /**
+   * @return whether this buffer wraps a libevent evbuffer.
+   */
+  bool usesOldImpl() const { return old_impl_; }
 
 private:
+  /**
+   * @param rhs another buffer.
+   * @return whether the rhs buffer is also an OwnedImpl using the same implementation.
+   */
+  bool isSameBufferImpl(const Instance& rhs) const;
+
+  /**
+   * Compare the data starting at a given slice and offset against a pattern.
+   * @param slice_index supplies the index of the slice in which to start.
+   * @param offset supplies the offset within that slice to start.
+   * @param data supplies the pattern.
+   * @param size supplies the length of the pattern.
+   * @return whether the buffer contains the pattern at the given position.
+   */
+  bool matchesAt(size_t slice_index, uint64_t offset, const uint8_t* data, uint64_t size) const;
+
+  // Whether this buffer wraps an evbuffer rather than using the native implementation.
+  const bool old_impl_;
+
+  // Used by the native implementation.
+  SliceDeque slices_;
+  uint64_t length_{0};
+
+  // Used by the libevent implementation.
   Event::Libevent::BufferPtr buffer_;
+
+  static bool use_old_impl_;
 };
 
 } // namespace Buffer
@@ -0,0 +1,154 @@
+#include "common/buffer/slice_pool.h"
+
+#include <new>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Buffer {
+
+namespace {
+
+// How many allocations and releases are accumulated before the stats are flushed.
+const uint32_t STATS_FLUSH_INTERVAL = 128;
+
+struct BlockHeader {
+  size_t size_;
+};
+
+static_assert(sizeof(BlockHeader) <= SlicePool::HEADER_SIZE, "BlockHeader too large");
+
+} // namespace
+
+const size_t SlicePool::HEADER_SIZE;
+const size_t SlicePool::PAGE_SIZE_BYTES;
+const size_t SlicePool::MAX_POOLED_PAGES;
+
+thread_local SlicePool* SlicePool::thread_local_pool_{};
+
+SlicePool::SlicePool(SlicePoolStats& stats, uint64_t max_cached_bytes)
+    : stats_(stats), max_cached_bytes_(max_cached_bytes) {}
+
+SlicePool::~SlicePool() {
+  ASSERT(thread_local_pool_ != this);
+  for (FreeBlock*& head : freelists_) {
+    while (head != nullptr) {
+      FreeBlock* block = head;
+      head = block->next_;
+      ::operator delete(block);
+    }
+  }
+  cached_bytes_ = 0;
+  flushStats();
+}
+
+void* SlicePool::allocate(size_t size) {
+  const size_t block_size = size + HEADER_SIZE;
+  void* block = nullptr;
+  if (thread_local_pool_ != nullptr) {
+    block = thread_local_pool_->allocateBlock(block_size);
+  }
+  if (block == nullptr) {
+    block = ::operator new(block_size);
+  }
+
+  static_cast<BlockHeader*>(block)->size_ = block_size;
+  return static_cast<uint8_t*>(block) + HEADER_SIZE;
+}
+
+void SlicePool::release(void* memory) {
+  if (memory == nullptr) {
+    return;
+  }
+
+  void* block = static_cast<uint8_t*>(memory) - HEADER_SIZE;
+  const size_t block_size = static_cast<BlockHeader*>(block)->size_;
+  if (thread_local_pool_ == nullptr || !thread_local_pool_->releaseBlock(block, block_size)) {
+    ::operator delete(block);
+  }
+}
+
+void SlicePool::setThreadLocal(SlicePool* pool) { thread_local_pool_ = pool; }
+
+size_t SlicePool::freelistIndex(size_t block_size) {
+  if (block_size % PAGE_SIZE_BYTES != 0 || block_size > MAX_POOLED_PAGES * PAGE_SIZE_BYTES) {
+    return MAX_POOLED_PAGES;
+  }
+  return block_size / PAGE_SIZE_BYTES - 1;
+}
+
+void* SlicePool::allocateBlock(size_t block_size) {
+  const size_t index = freelistIndex(block_size);
+  if (index == MAX_POOLED_PAGES) {
+    return nullptr;
+  }
+
+  FreeBlock* block = freelists_[index];
+  if (block == nullptr) {
+    pending_alloc_miss_++;
+  } else {
+    freelists_[index] = block->next_;
+    cached_bytes_ -= block_size;
+    pending_alloc_hit_++;
+  }
+  maybeFlushStats();
+  return block;
+}
+
+bool SlicePool::releaseBlock(void* block, size_t block_size) {
+  const size_t index = freelistIndex(block_size);
+  if (index == MAX_POOLED_PAGES) {
+    return false;
+  }
+
+  if (cached_bytes_ + block_size > max_cached_bytes_) {
+    pending_release_freed_++;
+    maybeFlushStats();
+    return false;
+  }
+
+  FreeBlock* free_block = static_cast<FreeBlock*>(block);
+  free_block->next_ = freelists_[index];
+  freelists_[index] = free_block;
+  cached_bytes_ += block_size;
+  pending_release_cached_++;
+  maybeFlushStats();
+  return true;
+}
+
+void SlicePool::maybeFlushStats() {
+  if (++ops_since_flush_ >= STATS_FLUSH_INTERVAL) {
+    flushStats();
+  }
+}
+
+void SlicePool::flushStats() {
+  // Avoid touching stats that did not change, so unused stats are not marked as used.
+  if (pending_alloc_hit_ > 0) {
+    stats_.alloc_hit_.add(pending_alloc_hit_);
+  }
+  if (pending_alloc_miss_ > 0) {
+    stats_.alloc_miss_.add(pending_alloc_miss_);
+  }
+  if (pending_release_cached_ > 0) {
+    stats_.release_cached_.add(pending_release_cached_);
+  }
+  if (pending_release_freed_ > 0) {
+    stats_.release_freed_.add(pending_release_freed_);
+  }
+  if (cached_bytes_ > flushed_cached_bytes_) {
+    stats_.resident_bytes_.add(cached_bytes_ - flushed_cached_bytes_);
+  } else if (cached_bytes_ < flushed_cached_bytes_) {
+    stats_.resident_bytes_.sub(flushed_cached_bytes_ - cached_bytes_);
+  }
+
+  flushed_cached_bytes_ = cached_bytes_;
+  pending_alloc_hit_ = 0;
+  pending_alloc_miss_ = 0;
+  pending_release_cached_ = 0;
+  pending_release_freed_ = 0;
+  ops_since_flush_ = 0;
+}
+
+} // namespace Buffer
+} // namespace Envoy
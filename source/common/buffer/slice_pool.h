@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * All slice pool stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_SLICE_POOL_STATS(COUNTER, GAUGE)                                                       \
+  COUNTER(alloc_hit)                                                                               \
+  COUNTER(alloc_miss)                                                                              \
+  COUNTER(release_cached)                                                                          \
+  COUNTER(release_freed)                                                                           \
+  GAUGE  (resident_bytes)
+// clang-format on
+
+/**
+ * Struct definition for all slice pool stats. @see stats_macros.h
+ */
+struct SlicePoolStats {
+  ALL_SLICE_POOL_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * A per thread freelist allocator for the memory blocks backing buffer slices. Blocks whose size
+ * is a small multiple of the page size are kept on a freelist when released, and handed out again
+ * to the next allocation of the same size on the same thread. This keeps the steady state churn of
+ * read and write buffers on worker threads away from malloc.
+ *
+ * Pools are installed per thread with setThreadLocal(). Threads without a pool allocate directly
+ * from the heap. A block may be released on a different thread than the one that allocated it; it
+ * is then cached by (or freed to the heap from) the releasing thread.
+ */
+class SlicePool : NonCopyable {
+public:
+  /**
+   * @param stats supplies the stats to update. These may be shared by the pools of several
+   *        threads.
+   * @param max_cached_bytes supplies the maximum number of bytes the pool keeps on its freelists.
+   */
+  SlicePool(SlicePoolStats& stats, uint64_t max_cached_bytes);
+  ~SlicePool();
+
+  /**
+   * Allocate memory for a slice, from the calling thread's pool if it has one.
+   * @param size supplies the number of bytes needed.
+   * @return the allocated memory, which must be released with release().
+   */
+  static void* allocate(size_t size);
+
+  /**
+   * Release memory obtained from allocate(), to the calling thread's pool if it has one.
+   * @param memory supplies the memory to release.
+   */
+  static void release(void* memory);
+
+  /**
+   * Install the pool used by allocate() and release() on the calling thread.
+   * @param pool supplies the pool, or nullptr to allocate from the heap.
+   */
+  static void setThreadLocal(SlicePool* pool);
+
+  /**
+   * @return the number of bytes currently cached on the freelists.
+   */
+  uint64_t cachedBytes() const { return cached_bytes_; }
+
+  // Every block carries a header recording its size, so that release() can find the right
+  // freelist. Callers that want their blocks to be poolable should size them so that the size
+  // passed to allocate() plus HEADER_SIZE is a multiple of PAGE_SIZE_BYTES.
+  static const size_t HEADER_SIZE = 16;
+  static const size_t PAGE_SIZE_BYTES = 4096;
+  // Blocks of up to MAX_POOLED_PAGES pages are cached.
+  static const size_t MAX_POOLED_PAGES = 16;
+
+private:
+  struct FreeBlock {
+    FreeBlock* next_;
+  };
+
+  /**
+   * @return a cached block of block_size bytes or nullptr if there is none.
+   */
+  void* allocateBlock(size_t block_size);
+
+  /**
+   * Cache a block of block_size bytes.
+   * @return whether the block was cached. If not, the caller must free it.
+   */
+  bool releaseBlock(void* block, size_t block_size);
+
+  /**
+   * @return the freelist index for blocks of block_size bytes, or MAX_POOLED_PAGES if blocks of
+   *         this size are not pooled.
+   */
+  static size_t freelistIndex(size_t block_size);
+
+  void maybeFlushStats();
+  void flushStats();
+
+  SlicePoolStats& stats_;
+  const uint64_t max_cached_bytes_;
+  uint64_t cached_bytes_{};
+  // freelists_[i] holds blocks of (i + 1) pages.
+  std::array<FreeBlock*, MAX_POOLED_PAGES> freelists_{};
+
+  // Stats are accumulated locally and flushed periodically, so that workers do not contend on the
+  // shared stat storage on every allocation.
+  uint64_t pending_alloc_hit_{};
+  uint64_t pending_alloc_miss_{};
+  uint64_t pending_release_cached_{};
+  uint64_t pending_release_freed_{};
+  uint64_t flushed_cached_bytes_{};
+  uint32_t ops_since_flush_{};
+
+  static thread_local SlicePool* thread_local_pool_;
+};
+
+} // namespace Buffer
+} // namespace Envoy
@@ -5,11 +5,22 @@
 namespace Envoy {
 namespace Buffer {
 
+WatermarkBuffer::~WatermarkBuffer() {
+  if (account_) {
+    account_->credit(charged_bytes_);
+  }
+}
+
 void WatermarkBuffer::add(const void* data, uint64_t size) {
   OwnedImpl::add(data, size);
   checkHighWatermark();
 }
 
+void WatermarkBuffer::addBufferFragment(BufferFragment& fragment) {
+  OwnedImpl::addBufferFragment(fragment);
+  checkHighWatermark();
+}
+
 void WatermarkBuffer::add(const std::string& data) {
   OwnedImpl::add(data);
   checkHighWatermark();
@@ -20,6 +31,16 @@ void WatermarkBuffer::add(const Instance& data) {
   checkHighWatermark();
 }
 
+void WatermarkBuffer::prepend(const std::string& data) {
+  OwnedImpl::prepend(data);
+  checkHighWatermark();
+}
+
+void WatermarkBuffer::prepend(Instance& data) {
+  OwnedImpl::prepend(data);
+  checkHighWatermark();
+}
+
 void WatermarkBuffer::commit(RawSlice* iovecs, uint64_t num_iovecs) {
   OwnedImpl::commit(iovecs, num_iovecs);
   checkHighWatermark();
@@ -66,7 +87,27 @@ void WatermarkBuffer::setWatermarks(uint32_t low_watermark, uint32_t high_waterm
   checkLowWatermark();
 }
 
+void WatermarkBuffer::setMemoryAccount(MemoryAccountSharedPtr account) {
+  if (account_) {
+    account_->credit(charged_bytes_);
+  }
+  account_ = std::move(account);
+  charged_bytes_ = 0;
+  updateMemoryAccount();
+}
+
+void WatermarkBuffer::chargeMemoryAccount() {
+  const uint64_t bytes = OwnedImpl::length();
+  if (bytes > charged_bytes_) {
+    account_->charge(bytes - charged_bytes_);
+  } else if (bytes < charged_bytes_) {
+    account_->credit(charged_bytes_ - bytes);
+  }
+  charged_bytes_ = bytes;
+}
+
 void WatermarkBuffer::checkLowWatermark() {
+  updateMemoryAccount();
   if (!above_high_watermark_called_ ||
       (high_watermark_ != 0 && OwnedImpl::length() >= low_watermark_)) {
     return;
@@ -77,6 +118,7 @@ void WatermarkBuffer::checkLowWatermark() {
 }
 
 void WatermarkBuffer::checkHighWatermark() {
+  updateMemoryAccount();
   if (above_high_watermark_called_ || high_watermark_ == 0 ||
       OwnedImpl::length() <= high_watermark_) {
     return;
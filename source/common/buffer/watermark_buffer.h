@@ -18,12 +18,16 @@ public:
   WatermarkBuffer(std::function<void()> below_low_watermark,
                   std::function<void()> above_high_watermark)
       : below_low_watermark_(below_low_watermark), above_high_watermark_(above_high_watermark) {}
+  ~WatermarkBuffer();
 
   // Override all functions from Instance which can result in changing the size
   // of the underlying buffer.
   void add(const void* data, uint64_t size) override;
+  void addBufferFragment(BufferFragment& fragment) override;
   void add(const std::string& data) override;
   void add(const Instance& data) override;
+  void prepend(const std::string& data) override;
+  void prepend(Instance& data) override;
   void commit(RawSlice* iovecs, uint64_t num_iovecs) override;
   void drain(uint64_t size) override;
   void move(Instance& rhs) override;
@@ -37,9 +41,22 @@ public:
   void setWatermarks(uint32_t low_watermark, uint32_t high_watermark);
   uint32_t highWatermark() const { return high_watermark_; }
 
+  /**
+   * Charge the memory held by this buffer to an account. Data already in the buffer moves from the
+   * previous account, if any, to the new one.
+   * @param account supplies the account, or nullptr to stop charging.
+   */
+  void setMemoryAccount(MemoryAccountSharedPtr account);
+
 private:
   void checkHighWatermark();
   void checkLowWatermark();
+  void updateMemoryAccount() {
+    if (account_) {
+      chargeMemoryAccount();
+    }
+  }
+  void chargeMemoryAccount();
 
   std::function<void()> below_low_watermark_;
   std::function<void()> above_high_watermark_;
@@ -52,6 +69,9 @@ private:
   // True between the time above_high_watermark_ has been called until above_high_watermark_ has
   // been called.
   bool above_high_watermark_called_{false};
+  MemoryAccountSharedPtr account_;
+  // The buffer length last charged to account_.
+  uint64_t charged_bytes_{0};
 };
 
 typedef std::unique_ptr<WatermarkBuffer> WatermarkBufferPtr;
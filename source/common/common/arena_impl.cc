@@ -0,0 +1,60 @@
+#include "common/common/arena_impl.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+
+const size_t ArenaImpl::DEFAULT_BLOCK_SIZE;
+const size_t ArenaImpl::MAX_BLOCK_SIZE;
+
+ArenaImpl::ArenaImpl(void* initial_block, size_t initial_block_size)
+    : next_(static_cast<char*>(initial_block)),
+      end_(initial_block != nullptr ? next_ + initial_block_size : nullptr),
+      next_block_size_(initial_block != nullptr ? std::min(initial_block_size * 2, MAX_BLOCK_SIZE)
+                                                : initial_block_size) {}
+
+ArenaImpl::~ArenaImpl() {
+  while (last_heap_block_ != nullptr) {
+    HeapBlock* previous = last_heap_block_->previous_;
+    delete[] reinterpret_cast<char*>(last_heap_block_);
+    last_heap_block_ = previous;
+  }
+}
+
+void* ArenaImpl::allocate(size_t size, size_t alignment) {
+  ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0);
+  allocations_++;
+
+  uintptr_t start = (reinterpret_cast<uintptr_t>(next_) + alignment - 1) & ~(alignment - 1);
+  if (next_ == nullptr || start + size > reinterpret_cast<uintptr_t>(end_)) {
+    addHeapBlock(size + alignment);
+    start = (reinterpret_cast<uintptr_t>(next_) + alignment - 1) & ~(alignment - 1);
+  }
+
+  next_ = reinterpret_cast<char*>(start + size);
+  return reinterpret_cast<void*>(start);
+}
+
+void ArenaImpl::addHeapBlock(size_t min_size) {
+  // An allocation too large for the next block gets a block of its own size, which doesn't change
+  // the size of the blocks after it.
+  const size_t block_size = std::max(next_block_size_, min_size + sizeof(HeapBlock));
+  if (block_size == next_block_size_) {
+    next_block_size_ = std::min(next_block_size_ * 2, MAX_BLOCK_SIZE);
+  }
+
+  // new[] returns memory aligned for any fundamental type, so the header keeps the space after it
+  // aligned to at least its own size.
+  char* block = new char[block_size];
+  HeapBlock* header = reinterpret_cast<HeapBlock*>(block);
+  header->previous_ = last_heap_block_;
+  last_heap_block_ = header;
+  heap_blocks_++;
+
+  next_ = block + sizeof(HeapBlock);
+  end_ = block + block_size;
+}
+
+} // namespace Envoy
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "envoy/common/arena.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+
+/**
+ * An arena that bumps a pointer through blocks of memory. Blocks after the first are taken from
+ * the heap, each twice the size of the one before up to MAX_BLOCK_SIZE. The first block can be
+ * supplied by the owner, e.g. as storage inside the object that owns the arena, so that an arena
+ * which stays small doesn't touch the heap at all.
+ */
+class ArenaImpl : public Arena, NonCopyable {
+public:
+  /**
+   * @param initial_block supplies memory to allocate from first, or nullptr. It must outlive the
+   *        arena.
+   * @param initial_block_size supplies the size of initial_block. If there is none, this is the
+   *        size of the first heap block.
+   */
+  ArenaImpl(void* initial_block, size_t initial_block_size);
+  ArenaImpl() : ArenaImpl(nullptr, DEFAULT_BLOCK_SIZE) {}
+  ~ArenaImpl();
+
+  // Arena
+  void* allocate(size_t size, size_t alignment) override;
+
+  /**
+   * @return uint64_t the number of allocations made from the arena.
+   */
+  uint64_t allocations() const { return allocations_; }
+
+  /**
+   * @return uint64_t the number of blocks taken from the heap.
+   */
+  uint64_t heapBlocks() const { return heap_blocks_; }
+
+  static const size_t DEFAULT_BLOCK_SIZE = 1024;
+  static const size_t MAX_BLOCK_SIZE = 64 * 1024;
+
+private:
+  // Header at the start of each heap block, linking it to the block allocated before it.
+  struct HeapBlock {
+    HeapBlock* previous_;
+  };
+
+  void addHeapBlock(size_t min_size);
+
+  char* next_;
+  char* end_;
+  size_t next_block_size_;
+  HeapBlock* last_heap_block_{};
+  uint64_t allocations_{};
+  uint64_t heap_blocks_{};
+};
+
+} // namespace Envoy
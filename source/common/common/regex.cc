@@ -0,0 +1,89 @@
+#include "common/common/regex.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/logger.h"
+
+#include "fmt/format.h"
+
+namespace Envoy {
+
+namespace {
+
+RE2::Options regexOptions() {
+  RE2::Options options;
+  // Errors are reported in the exception instead.
+  options.set_log_errors(false);
+  return options;
+}
+
+// Added last to every set. It matches any input, so a match that finds no regexes at all has
+// failed rather than found none.
+const char SET_SENTINEL[] = "(?s).*";
+
+} // namespace
+
+const uint64_t RegexUtil::DEFAULT_MAX_PROGRAM_SIZE;
+const uint64_t RegexUtil::WARN_PROGRAM_SIZE;
+const uint64_t RegexUtil::SET_MEMORY_PER_INSTRUCTION;
+
+std::unique_ptr<RE2> RegexUtil::parseRegex(const std::string& regex, uint64_t max_program_size) {
+  std::unique_ptr<RE2> compiled(new RE2(regex, regexOptions()));
+  if (!compiled->ok()) {
+    throw EnvoyException(fmt::format("invalid regex '{}': {}", regex, compiled->error()));
+  }
+  const uint64_t program_size = static_cast<uint64_t>(compiled->ProgramSize());
+  if (program_size > max_program_size) {
+    throw EnvoyException(fmt::format("regex '{}' is too complex: program size {} exceeds {}", regex,
+                                     program_size, max_program_size));
+  }
+  if (program_size > WARN_PROGRAM_SIZE) {
+    ENVOY_LOG_MISC(warn, "regex '{}' is costly to match: program size {} exceeds {}", regex,
+                   program_size, WARN_PROGRAM_SIZE);
+  }
+  return compiled;
+}
+
+std::unique_ptr<RE2::Set> RegexUtil::parseRegexSet(const std::vector<std::string>& regexes,
+                                                   uint64_t max_program_size) {
+  uint64_t program_size = 0;
+  for (const std::string& regex : regexes) {
+    program_size += static_cast<uint64_t>(parseRegex(regex, max_program_size)->ProgramSize());
+  }
+  // RE2 rejects a set whose DFA doesn't fit in max_mem, and a set that runs out of memory while
+  // matching fails the match, so the default budget is raised for large sets.
+  RE2::Options options = regexOptions();
+  options.set_max_mem(std::max<int64_t>(RE2::Options::kDefaultMaxMem,
+                                        program_size * SET_MEMORY_PER_INSTRUCTION));
+  std::unique_ptr<RE2::Set> set(new RE2::Set(options, RE2::ANCHOR_BOTH));
+  for (const std::string& regex : regexes) {
+    std::string error;
+    if (set->Add(regex, &error) < 0) {
+      throw EnvoyException(fmt::format("invalid regex '{}': {}", regex, error));
+    }
+  }
+  set->Add(SET_SENTINEL, nullptr);
+  if (!set->Compile()) {
+    throw EnvoyException(fmt::format("unable to compile a set of {} regexes", regexes.size()));
+  }
+  return set;
+}
+
+bool RegexUtil::matchRegexSet(const RE2::Set& set, re2::StringPiece input,
+                              std::vector<int>& matched) {
+  if (!set.Match(input, &matched)) {
+    // The sentinel matches every input, so RE2 failed.
+    return false;
+  }
+  // The sentinel is the last regex in the set, so it has the largest index.
+  matched.erase(std::max_element(matched.begin(), matched.end()));
+  return true;
+}
+
+} // namespace Envoy
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "re2/re2.h"
+#include "re2/set.h"
+
+namespace Envoy {
+
+/**
+ * Utilities for compiling the regular expressions found in configuration. The RE2 grammar is used,
+ * which guarantees matching in time linear in the size of the input.
+ */
+class RegexUtil {
+public:
+  /**
+   * Compile a regex. Throws EnvoyException if the regex is invalid, or if its compiled program is
+   * larger than max_program_size. A warning is logged if the program is larger than
+   * WARN_PROGRAM_SIZE.
+   * @param regex supplies the regex.
+   * @param max_program_size supplies the largest compiled program that is accepted.
+   * @return std::unique_ptr<RE2> the compiled regex.
+   */
+  static std::unique_ptr<RE2> parseRegex(const std::string& regex,
+                                         uint64_t max_program_size = DEFAULT_MAX_PROGRAM_SIZE);
+
+  /**
+   * Compile regexes into a set that finds all of them that match an entire input in a single pass.
+   * Each regex is checked as by parseRegex(). The index of a regex in the set is its position in
+   * the vector. The set may only be matched with matchRegexSet(). Its memory budget grows with the
+   * total program size of the regexes, so that large sets still compile.
+   * @param regexes supplies the regexes.
+   * @param max_program_size supplies the largest compiled program that is accepted for each regex.
+   * @return std::unique_ptr<RE2::Set> the compiled set.
+   */
+  static std::unique_ptr<RE2::Set>
+  parseRegexSet(const std::vector<std::string>& regexes,
+                uint64_t max_program_size = DEFAULT_MAX_PROGRAM_SIZE);
+
+  /**
+   * Find the regexes in a set built by parseRegexSet() that match an entire input.
+   * @param set supplies the set.
+   * @param input supplies the input.
+   * @param matched receives the indexes of the matching regexes, in no particular order.
+   * @return bool false if RE2 was unable to match the set, e.g. because it ran out of memory. Any
+   *         regex in the set may then match the input, and matched is incomplete.
+   */
+  static bool matchRegexSet(const RE2::Set& set, re2::StringPiece input, std::vector<int>& matched);
+
+  // The largest compiled program that a configured regex may have by default. Program size is a
+  // measure of how expensive a regex is to match, so this rejects pathological patterns at load
+  // time. Bounded character class repetitions such as [a-zA-Z0-9_-]{1,64} fit comfortably.
+  static const uint64_t DEFAULT_MAX_PROGRAM_SIZE = 1000;
+
+  // Regexes with a larger program are accepted, but logged as costly to match.
+  static const uint64_t WARN_PROGRAM_SIZE = 100;
+
+  // The memory budget of a set per instruction of its regexes' programs, above RE2's default. Most
+  // of it is for the DFA's state cache, whose states grow with the set's program size.
+  static const uint64_t SET_MEMORY_PER_INSTRUCTION = 128;
+};
+
+} // namespace Envoy
@@ -0,0 +1,204 @@
+#include "common/compressor/zlib_compressor.h"
+
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+namespace Envoy {
+namespace Compressor {
+
+namespace {
+
+// Space reserved in the output buffer for each deflate() call.
+const uint64_t OUTPUT_CHUNK_SIZE = 16384;
+
+// deflateInit2() selects the gzip wrapper when 16 is added to the window bits.
+const int GZIP_WINDOW_BITS_OFFSET = 16;
+
+// inflateInit2() detects the gzip or zlib wrapper when 32 is added to the window bits.
+const int INFLATE_WINDOW_BITS = 15 + 32;
+
+/**
+ * Idle deflate streams of one thread, most recently released last.
+ */
+class StreamCache {
+public:
+  ~StreamCache() {
+    for (Entry& entry : entries_) {
+      deflateEnd(entry.stream_.get());
+    }
+  }
+
+  std::unique_ptr<z_stream> acquire(const ZlibParams& params) {
+    for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+      if (it->params_ == params) {
+        std::unique_ptr<z_stream> stream = std::move(it->stream_);
+        entries_.erase(std::next(it).base());
+        return stream;
+      }
+    }
+    return nullptr;
+  }
+
+  void release(const ZlibParams& params, std::unique_ptr<z_stream>&& stream) {
+    if (deflateReset(stream.get()) != Z_OK) {
+      deflateEnd(stream.get());
+      return;
+    }
+    if (entries_.size() == ZlibCompressor::MAX_CACHED_STREAMS) {
+      // Evict the least recently released stream.
+      deflateEnd(entries_.front().stream_.get());
+      entries_.erase(entries_.begin());
+    }
+    entries_.push_back({params, std::move(stream)});
+  }
+
+  size_t size() const { return entries_.size(); }
+
+private:
+  struct Entry {
+    ZlibParams params_;
+    std::unique_ptr<z_stream> stream_;
+  };
+
+  std::vector<Entry> entries_;
+};
+
+StreamCache& streamCache() {
+  static thread_local StreamCache cache;
+  return cache;
+}
+
+} // namespace
+
+const size_t ZlibCompressor::MAX_CACHED_STREAMS;
+
+ZlibCompressor::ZlibCompressor(const ZlibParams& params)
+    : params_(params), stream_(streamCache().acquire(params)) {
+  if (stream_) {
+    return;
+  }
+
+  stream_.reset(new z_stream());
+  const int window_bits = params_.format_ == ZlibParams::Format::Gzip
+                              ? params_.window_bits_ + GZIP_WINDOW_BITS_OFFSET
+                              : params_.window_bits_;
+  const int result = deflateInit2(stream_.get(), params_.level_, Z_DEFLATED, window_bits,
+                                  params_.mem_level_, Z_DEFAULT_STRATEGY);
+  RELEASE_ASSERT(result == Z_OK);
+}
+
+ZlibCompressor::~ZlibCompressor() { streamCache().release(params_, std::move(stream_)); }
+
+size_t ZlibCompressor::cachedStreams() { return streamCache().size(); }
+
+void ZlibCompressor::compress(Buffer::Instance& input, Buffer::Instance& output, bool finish) {
+  uint64_t num_slices = input.getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  input.getRawSlices(slices, num_slices);
+  for (const Buffer::RawSlice& slice : slices) {
+    stream_->next_in = static_cast<Bytef*>(slice.mem_);
+    stream_->avail_in = slice.len_;
+    process(output, Z_NO_FLUSH);
+  }
+  input.drain(input.length());
+
+  // A sync flush writes out everything consumed so far, so that data that is streamed, e.g.
+  // server sent events, reaches the client without waiting for more input. deflate() writes
+  // nothing if there was no input since the last flush.
+  process(output, finish ? Z_FINISH : Z_SYNC_FLUSH);
+}
+
+void ZlibCompressor::process(Buffer::Instance& output, int flush) {
+  while (true) {
+    Buffer::RawSlice reservation;
+    output.reserve(OUTPUT_CHUNK_SIZE, &reservation, 1);
+    stream_->next_out = static_cast<Bytef*>(reservation.mem_);
+    stream_->avail_out = reservation.len_;
+
+    const int result = deflate(stream_.get(), flush);
+    // Z_BUF_ERROR only means that no progress was possible, which happens when there was no input
+    // and nothing to flush.
+    ASSERT(result == Z_OK || result == Z_STREAM_END || result == Z_BUF_ERROR);
+
+    reservation.len_ -= stream_->avail_out;
+    output.commit(&reservation, 1);
+
+    if (flush == Z_FINISH) {
+      if (result == Z_STREAM_END) {
+        break;
+      }
+    } else if (stream_->avail_in == 0 && stream_->avail_out != 0) {
+      break;
+    }
+  }
+}
+
+ZlibDecompressor::ZlibDecompressor() {
+  const int result = inflateInit2(&stream_, INFLATE_WINDOW_BITS);
+  RELEASE_ASSERT(result == Z_OK);
+}
+
+ZlibDecompressor::~ZlibDecompressor() { inflateEnd(&stream_); }
+
+void ZlibDecompressor::reset() {
+  const int result = inflateReset(&stream_);
+  ASSERT(result == Z_OK);
+  UNREFERENCED_PARAMETER(result);
+  finished_ = false;
+}
+
+bool ZlibDecompressor::decompress(Buffer::Instance& input, Buffer::Instance& output,
+                                  uint64_t max_output) {
+  uint64_t num_slices = input.getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  input.getRawSlices(slices, num_slices);
+  uint64_t output_length = 0;
+  bool valid = true;
+  for (const Buffer::RawSlice& slice : slices) {
+    if (slice.len_ == 0) {
+      continue;
+    }
+    if (finished_) {
+      // Trailing data after the end of the stream.
+      valid = false;
+      break;
+    }
+
+    stream_.next_in = static_cast<Bytef*>(slice.mem_);
+    stream_.avail_in = slice.len_;
+    // Keep going while there is input left, or while the output chunk was filled and inflate may
+    // still hold decompressed data back.
+    do {
+      Buffer::RawSlice reservation;
+      output.reserve(OUTPUT_CHUNK_SIZE, &reservation, 1);
+      stream_.next_out = static_cast<Bytef*>(reservation.mem_);
+      stream_.avail_out = reservation.len_;
+
+      const int result = inflate(&stream_, Z_NO_FLUSH);
+      reservation.len_ -= stream_.avail_out;
+      output.commit(&reservation, 1);
+      output_length += reservation.len_;
+
+      if (result == Z_STREAM_END) {
+        finished_ = true;
+        valid = stream_.avail_in == 0;
+      } else if (result != Z_OK && result != Z_BUF_ERROR) {
+        valid = false;
+      }
+      if (output_length > max_output) {
+        valid = false;
+      }
+    } while (valid && !finished_ && (stream_.avail_in != 0 || stream_.avail_out == 0));
+
+    if (!valid) {
+      break;
+    }
+  }
+  input.drain(input.length());
+  return valid;
+}
+
+} // namespace Compressor
+} // namespace Envoy
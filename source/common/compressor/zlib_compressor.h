@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/buffer/buffer.h"
+
+#include "common/common/non_copyable.h"
+
+#include "zlib.h"
+
+namespace Envoy {
+namespace Compressor {
+
+/**
+ * Parameters of a deflate stream. @see deflateInit2().
+ */
+struct ZlibParams {
+  enum class Format {
+    // RFC 1952 gzip header and trailer.
+    Gzip,
+    // RFC 1950 zlib header and trailer, as used by the "deflate" content coding.
+    Zlib
+  };
+
+  bool operator==(const ZlibParams& rhs) const {
+    return format_ == rhs.format_ && level_ == rhs.level_ && window_bits_ == rhs.window_bits_ &&
+           mem_level_ == rhs.mem_level_;
+  }
+
+  Format format_{Format::Gzip};
+  // 0 (no compression) to 9 (best compression), or Z_DEFAULT_COMPRESSION.
+  int level_{Z_DEFAULT_COMPRESSION};
+  // Base two logarithm of the window size, 9 to 15.
+  int window_bits_{15};
+  // Amount of memory used for the internal compression state, 1 to 9.
+  int mem_level_{8};
+};
+
+/**
+ * A streaming deflate compressor over buffers.
+ *
+ * Setting up a deflate stream allocates a few hundred KiB of state, which costs more than
+ * compressing a small response. Streams are therefore kept in a small per thread cache when a
+ * compressor is destroyed, and reset and reused by the next compressor with the same parameters
+ * on the same thread.
+ */
+class ZlibCompressor : NonCopyable {
+public:
+  ZlibCompressor(const ZlibParams& params);
+  ~ZlibCompressor();
+
+  /**
+   * Compress data.
+   * @param input supplies the data to compress. It is drained.
+   * @param output supplies the buffer that the compressed data is appended to. The stream is
+   *        flushed, so the output decompresses to all the input given so far even if the stream is
+   *        not finished. Each flush costs a few bytes and resets the match search, so callers
+   *        should pass input in chunks of a reasonable size.
+   * @param finish supplies whether this is the end of the data. All pending output and the
+   *        trailer are written, and the compressor must not be used again.
+   */
+  void compress(Buffer::Instance& input, Buffer::Instance& output, bool finish);
+
+  /**
+   * @return uint64_t the total number of bytes consumed.
+   */
+  uint64_t totalIn() const { return stream_->total_in; }
+
+  /**
+   * @return uint64_t the total number of bytes produced.
+   */
+  uint64_t totalOut() const { return stream_->total_out; }
+
+  /**
+   * @return size_t the number of idle streams cached on the calling thread.
+   */
+  static size_t cachedStreams();
+
+  // The most idle streams kept per thread.
+  static const size_t MAX_CACHED_STREAMS = 8;
+
+private:
+  /**
+   * Run deflate over the current input until it has all been consumed and, if flush is not
+   * Z_NO_FLUSH, all pending output has been written.
+   */
+  void process(Buffer::Instance& output, int flush);
+
+  const ZlibParams params_;
+  std::unique_ptr<z_stream> stream_;
+};
+
+/**
+ * A streaming inflate decompressor over buffers. The gzip and zlib formats are both accepted and
+ * told apart by their header.
+ */
+class ZlibDecompressor : NonCopyable {
+public:
+  ZlibDecompressor();
+  ~ZlibDecompressor();
+
+  /**
+   * Decompress data.
+   * @param input supplies the compressed data. It is drained.
+   * @param output supplies the buffer that the decompressed data is appended to.
+   * @param max_output supplies the most bytes that may be appended to output.
+   * @return bool false if the data is not valid, continues past the end of the compressed stream,
+   *         or decompresses to more than max_output bytes. The decompressor must not be used again
+   *         without reset().
+   */
+  bool decompress(Buffer::Instance& input, Buffer::Instance& output, uint64_t max_output);
+
+  /**
+   * @return bool whether the end of the compressed stream has been reached.
+   */
+  bool finished() const { return finished_; }
+
+  /**
+   * Start decompressing a new stream, reusing the allocated state.
+   */
+  void reset();
+
+private:
+  z_stream stream_{};
+  bool finished_{};
+};
+
+} // namespace Compressor
+} // namespace Envoy
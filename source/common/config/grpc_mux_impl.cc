@@ -25,9 +25,11 @@ GrpcMuxImpl::GrpcMuxImpl(const envoy::api::v2::Node& node,
     : GrpcMuxImpl(node,
                   std::unique_ptr<Grpc::AsyncClientImpl<envoy::api::v2::DiscoveryRequest,
                                                         envoy::api::v2::DiscoveryResponse>>(
+                      // Discovery responses can be large, and the management server is trusted.
                       new Grpc::AsyncClientImpl<envoy::api::v2::DiscoveryRequest,
                                                 envoy::api::v2::DiscoveryResponse>(
-                          cluster_manager, remote_cluster_name)),
+                          cluster_manager, remote_cluster_name, Grpc::CompressionAlgorithm::None,
+                          UINT64_MAX)),
                   dispatcher, service_method) {}
 
 GrpcMuxImpl::~GrpcMuxImpl() {
@@ -21,9 +21,10 @@ public:
             node,
             std::unique_ptr<Grpc::AsyncClientImpl<envoy::api::v2::DiscoveryRequest,
                                                   envoy::api::v2::DiscoveryResponse>>(
+                // Discovery responses can be large, and the management server is trusted.
                 new Grpc::AsyncClientImpl<envoy::api::v2::DiscoveryRequest,
-                                          envoy::api::v2::DiscoveryResponse>(cm,
-                                                                             remote_cluster_name)),
+                                          envoy::api::v2::DiscoveryResponse>(
+                    cm, remote_cluster_name, Grpc::CompressionAlgorithm::None, UINT64_MAX)),
             dispatcher, service_method, stats) {}
 
   GrpcSubscriptionImpl(const envoy::api::v2::Node& node,
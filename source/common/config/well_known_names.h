@@ -96,10 +96,14 @@ public:
   const std::string GRPC_JSON_TRANSCODER = "envoy.grpc_json_transcoder";
   // GRPC web filter
   const std::string GRPC_WEB = "envoy.grpc_web";
+  // Gzip filter
+  const std::string GZIP = "envoy.gzip";
   // IP tagging filter
   const std::string IP_TAGGING = "envoy.ip_tagging";
   // Rate limit filter
   const std::string RATE_LIMIT = "envoy.rate_limit";
+  // Response cache filter
+  const std::string RESPONSE_CACHE = "envoy.response_cache";
   // Router filter
   const std::string ROUTER = "envoy.router";
   // Health checking filter
@@ -110,7 +114,8 @@ public:
 
   HttpFilterNameValues()
       : v1_converter_({BUFFER, CORS, DYNAMO, FAULT, GRPC_HTTP1_BRIDGE, GRPC_JSON_TRANSCODER,
-                       GRPC_WEB, HEALTH_CHECK, IP_TAGGING, RATE_LIMIT, ROUTER}) {}
+                       GRPC_WEB, GZIP, HEALTH_CHECK, IP_TAGGING, RATE_LIMIT, RESPONSE_CACHE,
+                       ROUTER}) {}
 };
 
 typedef ConstSingleton<HttpFilterNameValues> HttpFilterNames;
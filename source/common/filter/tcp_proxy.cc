@@ -121,7 +121,8 @@ void TcpProxy::initializeReadFilterCallbacks(Network::ReadFilterCallbacks& callb
       {config_->stats().downstream_cx_rx_bytes_total_,
        config_->stats().downstream_cx_rx_bytes_buffered_,
        config_->stats().downstream_cx_tx_bytes_total_,
-       config_->stats().downstream_cx_tx_bytes_buffered_, nullptr});
+       config_->stats().downstream_cx_tx_bytes_buffered_, nullptr,
+       &config_->stats().downstream_cx_rx_syscalls_total_});
 }
 
 void TcpProxy::readDisableUpstream(bool disable) {
@@ -222,7 +223,8 @@ Network::FilterStatus TcpProxy::initializeUpstreamConnection() {
        read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_rx_bytes_buffered_,
        read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_tx_bytes_total_,
        read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_tx_bytes_buffered_,
-       &read_callbacks_->upstreamHost()->cluster().stats().bind_errors_});
+       &read_callbacks_->upstreamHost()->cluster().stats().bind_errors_,
+       &read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_rx_syscalls_total_});
   upstream_connection_->connect();
   upstream_connection_->noDelay(true);
 
@@ -274,6 +276,24 @@ void TcpProxy::onUpstreamData(Buffer::Instance& data) {
   ASSERT(0 == data.length());
 }
 
+void TcpProxy::spliceConnections() {
+  // WebSocket proxying (no config) writes downstream data through the HTTP connection manager.
+  if (!config_) {
+    return;
+  }
+
+  // Plain proxying never looks at the data, so have the kernel move it in each direction where
+  // neither connection needs to see it. Data otherwise keeps flowing through onData() and
+  // onUpstreamData().
+  const bool downstream_spliced = read_callbacks_->connection().spliceTo(*upstream_connection_);
+  const bool upstream_spliced = upstream_connection_->spliceTo(read_callbacks_->connection());
+  ENVOY_CONN_LOG(debug, "splicing: downstream={} upstream={}", read_callbacks_->connection(),
+                 downstream_spliced, upstream_spliced);
+  if (downstream_spliced || upstream_spliced) {
+    config_->stats().downstream_cx_spliced_.inc();
+  }
+}
+
 void TcpProxy::onUpstreamEvent(Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose) {
     read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_destroy_remote_.inc();
@@ -292,6 +312,7 @@ void TcpProxy::onUpstreamEvent(Network::ConnectionEvent event) {
     onConnectionFailure();
   } else if (event == Network::ConnectionEvent::Connected) {
     connect_timespan_->complete();
+    spliceConnections();
     onConnectionSuccess();
   }
 
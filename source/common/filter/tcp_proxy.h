@@ -28,10 +28,12 @@ namespace Filter {
 #define ALL_TCP_PROXY_STATS(COUNTER, GAUGE)                                                        \
   COUNTER(downstream_cx_rx_bytes_total)                                                            \
   GAUGE  (downstream_cx_rx_bytes_buffered)                                                         \
+  COUNTER(downstream_cx_rx_syscalls_total)                                                         \
   COUNTER(downstream_cx_tx_bytes_total)                                                            \
   GAUGE  (downstream_cx_tx_bytes_buffered)                                                         \
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_no_route)                                                                  \
+  COUNTER(downstream_cx_spliced)                                                                   \
   COUNTER(downstream_flow_control_paused_reading_total)                                            \
   COUNTER(downstream_flow_control_resumed_reading_total)
 // clang-format on
@@ -166,6 +168,7 @@ protected:
   void onConnectTimeout();
   void onDownstreamEvent(Network::ConnectionEvent event);
   void onUpstreamData(Buffer::Instance& data);
+  void spliceConnections();
   void onUpstreamEvent(Network::ConnectionEvent event);
 
   TcpProxyConfigSharedPtr config_;
@@ -20,8 +20,21 @@ template <class RequestType, class ResponseType> class AsyncRequestImpl;
 template <class RequestType, class ResponseType>
 class AsyncClientImpl final : public AsyncClient<RequestType, ResponseType> {
 public:
-  AsyncClientImpl(Upstream::ClusterManager& cm, const std::string& remote_cluster_name)
-      : cm_(cm), remote_cluster_name_(remote_cluster_name) {}
+  /**
+   * @param cm supplies the cluster manager.
+   * @param remote_cluster_name supplies the cluster that calls are made to.
+   * @param request_compression supplies the algorithm that request messages are compressed with.
+   *        The remote end must support it. Responses are decompressed whatever this is.
+   * @param max_message_length supplies the longest decompressed response message accepted. The
+   *        stream fails with an INTERNAL error on a message that decompresses to more. Clients of
+   *        trusted servers whose messages may be large, e.g. management servers, can pass
+   *        UINT64_MAX to only be bounded by the gRPC framing.
+   */
+  AsyncClientImpl(Upstream::ClusterManager& cm, const std::string& remote_cluster_name,
+                  CompressionAlgorithm request_compression = CompressionAlgorithm::None,
+                  uint64_t max_message_length = Decoder::DEFAULT_MAX_MESSAGE_LENGTH)
+      : cm_(cm), remote_cluster_name_(remote_cluster_name),
+        request_compression_(request_compression), max_message_length_(max_message_length) {}
 
   ~AsyncClientImpl() override {
     while (!active_streams_.empty()) {
@@ -65,6 +78,8 @@ public:
 private:
   Upstream::ClusterManager& cm_;
   const std::string remote_cluster_name_;
+  const CompressionAlgorithm request_compression_;
+  const uint64_t max_message_length_;
   std::list<std::unique_ptr<AsyncStreamImpl<RequestType, ResponseType>>> active_streams_;
 
   friend class AsyncStreamImpl<RequestType, ResponseType>;
@@ -97,6 +112,16 @@ public:
     headers_message_ =
         Common::prepareHeaders(parent_.remote_cluster_name_, service_method_.service()->full_name(),
                                service_method_.name());
+    // Let the server compress responses, which can be large for discovery services.
+    headers_message_->headers().insertGrpcAcceptEncoding().value().setReference(
+        Http::Headers::get().GrpcAcceptEncodingValues.Default);
+    if (parent_.request_compression_ == CompressionAlgorithm::Gzip) {
+      headers_message_->headers().addReference(Http::Headers::get().GrpcEncoding,
+                                               Http::Headers::get().GrpcEncodingValues.Gzip);
+    } else if (parent_.request_compression_ == CompressionAlgorithm::Deflate) {
+      headers_message_->headers().addReference(Http::Headers::get().GrpcEncoding,
+                                               Http::Headers::get().GrpcEncodingValues.Deflate);
+    }
     callbacks_.onCreateInitialMetadata(headers_message_->headers());
     stream_->sendHeaders(headers_message_->headers(), false);
   }
@@ -119,6 +144,8 @@ public:
       onTrailers(std::move(headers));
       return;
     }
+    decoder_.setDecompression(Common::getCompressionAlgorithm(*headers),
+                              parent_.max_message_length_);
     callbacks_.onReceiveInitialMetadata(std::move(headers));
   }
 
@@ -137,10 +164,11 @@ public:
 
     for (auto& frame : decoded_frames_) {
       std::unique_ptr<ResponseType> response(new ResponseType());
-      // TODO(htuch): Need to add support for compressed responses as well here.
       if (frame.length_ > 0) {
         Buffer::ZeroCopyInputStreamImpl stream(std::move(frame.data_));
 
+        // Compressed frames are only left compressed if the server compressed them without naming
+        // an algorithm we support in grpc-encoding.
         if (frame.flags_ != GRPC_FH_DEFAULT || !response->ParseFromZeroCopyStream(&stream)) {
           streamError(Status::GrpcStatus::Internal);
           return;
@@ -179,7 +207,7 @@ public:
 
   // Grpc::AsyncStream
   void sendMessage(const RequestType& request, bool end_stream) override {
-    stream_->sendData(*Common::serializeBody(request), end_stream);
+    stream_->sendData(*Common::serializeBody(request, parent_.request_compression_), end_stream);
     if (end_stream) {
       closeLocal();
     }
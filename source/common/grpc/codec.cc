@@ -1,5 +1,6 @@
 #include "common/grpc/codec.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <vector>
@@ -19,6 +20,38 @@ void Encoder::newFrame(uint8_t flags, uint64_t length, std::array<uint8_t, 5>& o
   output[4] = static_cast<uint8_t>(length);
 }
 
+const uint64_t Encoder::MIN_COMPRESSION_LENGTH;
+
+void Encoder::encodeMessage(Buffer::Instance& message, CompressionAlgorithm algorithm,
+                            Buffer::Instance& output) {
+  std::array<uint8_t, 5> header;
+  if (algorithm != CompressionAlgorithm::None && message.length() >= MIN_COMPRESSION_LENGTH) {
+    Compressor::ZlibParams params;
+    // gRPC's "deflate" is the zlib format, as for the HTTP content coding.
+    params.format_ = algorithm == CompressionAlgorithm::Gzip ? Compressor::ZlibParams::Format::Gzip
+                                                             : Compressor::ZlibParams::Format::Zlib;
+    Compressor::ZlibCompressor compressor(params);
+    // Compress a copy, since the message is sent as it is if compression doesn't pay off.
+    Buffer::OwnedImpl input;
+    input.add(message);
+    Buffer::OwnedImpl compressed;
+    compressor.compress(input, compressed, true);
+    if (compressed.length() < message.length()) {
+      newFrame(GRPC_FH_COMPRESSED, compressed.length(), header);
+      output.add(header.data(), header.size());
+      output.move(compressed);
+      message.drain(message.length());
+      return;
+    }
+  }
+
+  newFrame(GRPC_FH_DEFAULT, message.length(), header);
+  output.add(header.data(), header.size());
+  output.move(message);
+}
+
+const uint64_t Decoder::DEFAULT_MAX_MESSAGE_LENGTH;
+
 Decoder::Decoder() : state_(State::FH_FLAG) {}
 
 bool Decoder::decode(Buffer::Instance& input, std::vector<Frame>& output) {
@@ -61,6 +94,9 @@ bool Decoder::decode(Buffer::Instance& input, std::vector<Frame>& output) {
       case State::FH_LEN_3:
         frame_.length_ |= static_cast<uint32_t>(c);
         if (frame_.length_ == 0) {
+          if (!decompressFrame()) {
+            return false;
+          }
           output.push_back(std::move(frame_));
           state_ = State::FH_FLAG;
         } else {
@@ -83,6 +119,9 @@ bool Decoder::decode(Buffer::Instance& input, std::vector<Frame>& output) {
           j += remain_in_frame;
         }
         if (frame_.length_ == frame_.data_->length()) {
+          if (!decompressFrame()) {
+            return false;
+          }
           output.push_back(std::move(frame_));
           frame_.flags_ = 0;
           frame_.length_ = 0;
@@ -96,5 +135,34 @@ bool Decoder::decode(Buffer::Instance& input, std::vector<Frame>& output) {
   return true;
 }
 
+bool Decoder::decompressFrame() {
+  if (decompression_ == CompressionAlgorithm::None || !(frame_.flags_ & GRPC_FH_COMPRESSED)) {
+    return true;
+  }
+
+  frame_.flags_ = GRPC_FH_DEFAULT;
+  if (frame_.length_ == 0) {
+    // An empty message, whatever the flag says.
+    return true;
+  }
+
+  if (decompressor_) {
+    decompressor_->reset();
+  } else {
+    decompressor_.reset(new Compressor::ZlibDecompressor());
+  }
+  // The zlib and gzip formats are told apart by their header, so one decompressor serves both
+  // algorithms. The decompressed message must still fit the frame's length field.
+  Buffer::InstancePtr message(new Buffer::OwnedImpl());
+  if (!decompressor_->decompress(*frame_.data_, *message,
+                                 std::min<uint64_t>(max_message_length_, UINT32_MAX)) ||
+      !decompressor_->finished()) {
+    return false;
+  }
+  frame_.length_ = message->length();
+  frame_.data_ = std::move(message);
+  return true;
+}
+
 } // namespace Grpc
 } // namespace Envoy
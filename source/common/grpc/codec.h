@@ -2,10 +2,13 @@
 
 #include <array>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "envoy/buffer/buffer.h"
 
+#include "common/compressor/zlib_compressor.h"
+
 namespace Envoy {
 namespace Grpc {
 // Last bit for an expanded message without compression.
@@ -13,7 +16,8 @@ const uint8_t GRPC_FH_DEFAULT = 0b0u;
 // Last bit for a compressed message.
 const uint8_t GRPC_FH_COMPRESSED = 0b1u;
 
-enum class CompressionAlgorithm { None, Gzip };
+// Message compression algorithms, as named by the grpc-encoding header.
+enum class CompressionAlgorithm { None, Gzip, Deflate };
 
 struct Frame {
   uint8_t flags_;
@@ -30,6 +34,19 @@ public:
   // @param length supplies the GRPC data frame length.
   // @param output the buffer to store the encoded data. Its size must be 5.
   void newFrame(uint8_t flags, uint64_t length, std::array<uint8_t, 5>& output);
+
+  // Appends a GRPC data frame holding the given message to the output buffer. The message is
+  // compressed with the given algorithm and the frame flagged as compressed, unless the message is
+  // shorter than MIN_COMPRESSION_LENGTH or compression would not make it any smaller.
+  // @param message supplies the serialized message. It is drained.
+  // @param algorithm supplies the compression algorithm negotiated for the stream.
+  // @param output supplies the buffer to append the frame to.
+  void encodeMessage(Buffer::Instance& message, CompressionAlgorithm algorithm,
+                     Buffer::Instance& output);
+
+  // Messages shorter than this are sent uncompressed, since the gzip header and trailer would
+  // outweigh what compression saves.
+  static const uint64_t MIN_COMPRESSION_LENGTH = 256;
 };
 
 class Decoder {
@@ -50,7 +67,29 @@ public:
   // the frame.
   uint32_t length() const { return frame_.length_; }
 
+  // Decompress compressed frames before they are returned by decode(). Their flags are cleared and
+  // their length updated to that of the decompressed message. Without this compressed frames are
+  // returned as they are.
+  // @param algorithm supplies the compression algorithm named by the grpc-encoding header of the
+  //        stream, None to return compressed frames as they are.
+  // @param max_message_length supplies the longest decompressed message accepted. decode() fails
+  //        on a frame that decompresses to more, so that a small frame cannot inflate without
+  //        bound.
+  void setDecompression(CompressionAlgorithm algorithm,
+                        uint64_t max_message_length = DEFAULT_MAX_MESSAGE_LENGTH) {
+    decompression_ = algorithm;
+    max_message_length_ = max_message_length;
+  }
+
+  // The longest decompressed message accepted by default, which is the default maximum receive
+  // message size of gRPC implementations.
+  static const uint64_t DEFAULT_MAX_MESSAGE_LENGTH = 4 * 1024 * 1024;
+
 private:
+  // Replaces the data of a compressed frame with the decompressed message.
+  // @return bool false if the data is not a valid compressed message.
+  bool decompressFrame();
+
   // Wire format (http://www.grpc.io/docs/guides/wire.html) of GRPC data frame
   // header:
   //
@@ -85,6 +124,9 @@ private:
 
   State state_;
   Frame frame_;
+  CompressionAlgorithm decompression_{CompressionAlgorithm::None};
+  uint64_t max_message_length_{DEFAULT_MAX_MESSAGE_LENGTH};
+  std::unique_ptr<Compressor::ZlibDecompressor> decompressor_;
 };
 } // namespace Grpc
 } // namespace Envoy
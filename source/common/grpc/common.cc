@@ -2,6 +2,7 @@
 
 #include <arpa/inet.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <string>
@@ -100,6 +101,37 @@ std::string Common::getGrpcMessage(const Http::HeaderMap& trailers) {
   return entry ? entry->value().c_str() : EMPTY_STRING;
 }
 
+CompressionAlgorithm Common::getCompressionAlgorithm(const Http::HeaderMap& headers) {
+  const Http::HeaderEntry* grpc_encoding = headers.get(Http::Headers::get().GrpcEncoding);
+  if (grpc_encoding == nullptr) {
+    return CompressionAlgorithm::None;
+  }
+  if (grpc_encoding->value() == Http::Headers::get().GrpcEncodingValues.Gzip.c_str()) {
+    return CompressionAlgorithm::Gzip;
+  }
+  if (grpc_encoding->value() == Http::Headers::get().GrpcEncodingValues.Deflate.c_str()) {
+    return CompressionAlgorithm::Deflate;
+  }
+  return CompressionAlgorithm::None;
+}
+
+bool Common::isCompressionAccepted(const std::string& grpc_accept_encoding,
+                                   CompressionAlgorithm algorithm) {
+  if (algorithm == CompressionAlgorithm::None) {
+    return true;
+  }
+  const std::string& name = algorithm == CompressionAlgorithm::Gzip
+                                ? Http::Headers::get().GrpcEncodingValues.Gzip
+                                : Http::Headers::get().GrpcEncodingValues.Deflate;
+  for (std::string accepted : StringUtil::split(grpc_accept_encoding, ',')) {
+    accepted.erase(std::remove(accepted.begin(), accepted.end(), ' '), accepted.end());
+    if (accepted == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool Common::resolveServiceAndMethod(const Http::HeaderEntry* path, std::string* service,
                                      std::string* method) {
   if (path == nullptr || path->value().c_str() == nullptr) {
@@ -218,6 +250,19 @@ Buffer::InstancePtr Common::serializeBody(const Protobuf::Message& message) {
   return body;
 }
 
+Buffer::InstancePtr Common::serializeBody(const Protobuf::Message& message,
+                                          CompressionAlgorithm algorithm) {
+  if (algorithm == CompressionAlgorithm::None ||
+      static_cast<uint64_t>(message.ByteSize()) < Encoder::MIN_COMPRESSION_LENGTH) {
+    return serializeBody(message);
+  }
+
+  Buffer::OwnedImpl serialized(message.SerializeAsString());
+  Buffer::InstancePtr body(new Buffer::OwnedImpl());
+  Encoder().encodeMessage(serialized, algorithm, *body);
+  return body;
+}
+
 Http::MessagePtr Common::prepareHeaders(const std::string& upstream_cluster,
                                         const std::string& service_full_name,
                                         const std::string& method_name) {
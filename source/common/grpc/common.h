@@ -11,6 +11,7 @@
 #include "envoy/http/message.h"
 #include "envoy/stats/stats.h"
 
+#include "common/grpc/codec.h"
 #include "common/protobuf/protobuf.h"
 
 namespace Envoy {
@@ -48,6 +49,22 @@ public:
    */
   static std::string getGrpcMessage(const Http::HeaderMap& trailers);
 
+  /**
+   * Returns the message compression algorithm named by the grpc-encoding header, if present.
+   * @param headers the headers to parse.
+   * @return CompressionAlgorithm the algorithm, None if the header is absent, names identity, or
+   *         names an algorithm that is not supported.
+   */
+  static CompressionAlgorithm getCompressionAlgorithm(const Http::HeaderMap& headers);
+
+  /**
+   * @param grpc_accept_encoding supplies the value of a grpc-accept-encoding header.
+   * @param algorithm supplies a compression algorithm.
+   * @return bool whether the algorithm is listed in the header value. None is always accepted.
+   */
+  static bool isCompressionAccepted(const std::string& grpc_accept_encoding,
+                                    CompressionAlgorithm algorithm);
+
   /**
    * Returns the gRPC status code from a given HTTP response status code. Ordinarily, it is expected
    * that a 200 response is provided, but gRPC defines a mapping for intermediaries that are not
@@ -112,6 +129,13 @@ public:
    */
   static Buffer::InstancePtr serializeBody(const Protobuf::Message& message);
 
+  /**
+   * Serialize protobuf message, compressing it with the given algorithm if that makes it smaller.
+   * @see Encoder::encodeMessage().
+   */
+  static Buffer::InstancePtr serializeBody(const Protobuf::Message& message,
+                                           CompressionAlgorithm algorithm);
+
   /**
    * Prepare headers for protobuf service.
    */
@@ -66,6 +66,11 @@ Http::FilterHeadersStatus GrpcWebFilter::decodeHeaders(Http::HeaderMap& headers,
 
   // Adds te:trailers to upstream HTTP2 request. It's required for gRPC.
   headers.insertTE().value().setReference(Http::Headers::get().TEValues.Trailers);
+  // Remembers which compressed responses the client itself can take. Responses compressed any other
+  // way are decompressed before they are passed on.
+  if (headers.GrpcAcceptEncoding() != nullptr) {
+    client_accept_encoding_ = headers.GrpcAcceptEncoding()->value().c_str();
+  }
   // Adds grpc-accept-encoding:identity,deflate,gzip. It's required for gRPC.
   headers.insertGrpcAcceptEncoding().value().setReference(
       Http::Headers::get().GrpcAcceptEncodingValues.Default);
@@ -125,6 +130,16 @@ Http::FilterHeadersStatus GrpcWebFilter::encodeHeaders(Http::HeaderMap& headers,
     headers.insertContentType().value().setReference(
         Http::Headers::get().ContentTypeValues.GrpcWebProto);
   }
+
+  const CompressionAlgorithm compression = Common::getCompressionAlgorithm(headers);
+  if (!Common::isCompressionAccepted(client_accept_encoding_, compression)) {
+    headers.remove(Http::Headers::get().GrpcEncoding);
+    // Decompressed messages are bounded by the stream's buffer limit, if it has one.
+    const uint32_t buffer_limit = encoder_callbacks_->encoderBufferLimit();
+    decoder_.setDecompression(compression, buffer_limit > 0 ? buffer_limit
+                                                            : Decoder::DEFAULT_MAX_MESSAGE_LENGTH);
+    is_decompressing_response_ = true;
+  }
   return Http::FilterHeadersStatus::Continue;
 }
 
@@ -133,7 +148,7 @@ Http::FilterDataStatus GrpcWebFilter::encodeData(Buffer::Instance& data, bool) {
     return Http::FilterDataStatus::Continue;
   }
 
-  if (!is_text_response_) {
+  if (!is_text_response_ && !is_decompressing_response_) {
     // No additional transcoding required if gRPC-Web client asked for binary response.
     return Http::FilterDataStatus::Continue;
   }
@@ -141,23 +156,31 @@ Http::FilterDataStatus GrpcWebFilter::encodeData(Buffer::Instance& data, bool) {
   // The decoder always consumes and drains the given buffer. Incomplete data frame is buffered
   // inside the decoder.
   std::vector<Frame> frames;
-  decoder_.decode(data, frames);
+  if (!decoder_.decode(data, frames)) {
+    // The response can't be decompressed, and there is no way left to tell the client.
+    encoder_callbacks_->resetStream();
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
   if (frames.empty()) {
     // We don't have enough data to decode for one single frame, stop iteration until more data
     // comes in.
     return Http::FilterDataStatus::StopIterationNoBuffer;
   }
 
-  // Encodes the decoded gRPC frames with base64.
+  // Encodes the decoded gRPC frames, with base64 for a text response.
   for (auto& frame : frames) {
     Buffer::OwnedImpl temp;
     temp.add(&frame.flags_, 1);
     const uint32_t length = htonl(frame.length_);
     temp.add(&length, 4);
     if (frame.length_ > 0) {
-      temp.add(*frame.data_);
+      temp.move(*frame.data_);
+    }
+    if (is_text_response_) {
+      data.add(Base64::encode(temp, temp.length()));
+    } else {
+      data.move(temp);
     }
-    data.add(Base64::encode(temp, temp.length()));
   }
   return Http::FilterDataStatus::Continue;
 }
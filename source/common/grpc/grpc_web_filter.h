@@ -57,6 +57,9 @@ private:
   Http::StreamEncoderFilterCallbacks* encoder_callbacks_{};
   bool is_text_request_{};
   bool is_text_response_{};
+  // Set when the upstream response is compressed in a way the client did not accept.
+  bool is_decompressing_response_{};
+  std::string client_accept_encoding_;
   Buffer::OwnedImpl decoding_buffer_;
   Decoder decoder_;
   std::string grpc_service_;
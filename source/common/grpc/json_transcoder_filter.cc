@@ -206,6 +206,9 @@ Http::FilterHeadersStatus JsonTranscoderFilter::decodeHeaders(Http::HeaderMap& h
   headers.insertPath().value("/" + method_->service()->full_name() + "/" + method_->name());
   headers.insertMethod().value().setReference(Http::Headers::get().MethodValues.Post);
   headers.insertTE().value().setReference(Http::Headers::get().TEValues.Trailers);
+  // Compressed responses are decompressed before they are transcoded.
+  headers.insertGrpcAcceptEncoding().value().setReference(
+      Http::Headers::get().GrpcAcceptEncodingValues.Default);
 
   decoder_callbacks_->clearRouteCache();
 
@@ -291,6 +294,16 @@ Http::FilterHeadersStatus JsonTranscoderFilter::encodeHeaders(Http::HeaderMap& h
 
   response_headers_ = &headers;
   headers.insertContentType().value().setReference(Http::Headers::get().ContentTypeValues.Json);
+  const CompressionAlgorithm compression = Common::getCompressionAlgorithm(headers);
+  if (compression != CompressionAlgorithm::None) {
+    // The transcoder only reads uncompressed messages.
+    headers.remove(Http::Headers::get().GrpcEncoding);
+    // Decompressed messages are bounded by the stream's buffer limit, if it has one.
+    const uint32_t buffer_limit = encoder_callbacks_->encoderBufferLimit();
+    response_decoder_.setDecompression(
+        compression, buffer_limit > 0 ? buffer_limit : Decoder::DEFAULT_MAX_MESSAGE_LENGTH);
+    is_decompressing_response_ = true;
+  }
   if (!method_->server_streaming() && !end_stream) {
     return Http::FilterHeadersStatus::StopIteration;
   }
@@ -302,6 +315,13 @@ Http::FilterDataStatus JsonTranscoderFilter::encodeData(Buffer::Instance& data,
     return Http::FilterDataStatus::Continue;
   }
 
+  if (is_decompressing_response_ && !decompressResponse(data)) {
+    ENVOY_LOG(debug, "Invalid compressed response");
+    error_ = true;
+    encoder_callbacks_->resetStream();
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+
   response_in_.move(data);
 
   if (end_stream) {
@@ -362,6 +382,25 @@ void JsonTranscoderFilter::setEncoderFilterCallbacks(
   encoder_callbacks_ = &callbacks;
 }
 
+bool JsonTranscoderFilter::decompressResponse(Buffer::Instance& data) {
+  // The decoder drains the data and holds on to any incomplete frame.
+  std::vector<Frame> frames;
+  if (!response_decoder_.decode(data, frames)) {
+    return false;
+  }
+
+  Encoder encoder;
+  for (Frame& frame : frames) {
+    std::array<uint8_t, 5> header;
+    encoder.newFrame(frame.flags_, frame.length_, header);
+    data.add(header.data(), header.size());
+    if (frame.length_ > 0) {
+      data.move(*frame.data_);
+    }
+  }
+  return true;
+}
+
 // TODO(lizan): Incorporate watermarks to bound buffer sizes
 bool JsonTranscoderFilter::readToBuffer(Protobuf::io::ZeroCopyInputStream& stream,
                                         Buffer::Instance& data) {
@@ -6,6 +6,7 @@
 #include "envoy/json/json_object.h"
 
 #include "common/common/logger.h"
+#include "common/grpc/codec.h"
 #include "common/grpc/transcoder_input_stream_impl.h"
 #include "common/protobuf/protobuf.h"
 
@@ -101,6 +102,12 @@ public:
 private:
   bool readToBuffer(Protobuf::io::ZeroCopyInputStream& stream, Buffer::Instance& data);
 
+  /**
+   * Replace compressed response frames with decompressed ones.
+   * @return bool false if the data is not a valid compressed response.
+   */
+  bool decompressResponse(Buffer::Instance& data);
+
   JsonTranscoderConfig& config_;
   std::unique_ptr<google::grpc::transcoding::Transcoder> transcoder_;
   TranscoderInputStreamImpl request_in_;
@@ -109,6 +116,8 @@ private:
   Http::StreamEncoderFilterCallbacks* encoder_callbacks_{nullptr};
   const Protobuf::MethodDescriptor* method_{nullptr};
   Http::HeaderMap* response_headers_{nullptr};
+  Decoder response_decoder_;
+  bool is_decompressing_response_{false};
 
   bool error_{false};
   bool stream_reset_{false};
@@ -85,7 +85,7 @@ void ConnectionManagerImpl::initializeReadFilterCallbacks(Network::ReadFilterCal
   read_callbacks_->connection().setConnectionStats(
       {stats_.named_.downstream_cx_rx_bytes_total_, stats_.named_.downstream_cx_rx_bytes_buffered_,
        stats_.named_.downstream_cx_tx_bytes_total_, stats_.named_.downstream_cx_tx_bytes_buffered_,
-       nullptr});
+       nullptr, &stats_.named_.downstream_cx_rx_syscalls_total_});
 }
 
 ConnectionManagerImpl::~ConnectionManagerImpl() {
@@ -344,10 +344,13 @@ void ConnectionManagerImpl::chargeTracingStats(const Tracing::Reason& tracing_re
 }
 
 ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connection_manager)
-    : connection_manager_(connection_manager),
+    : arena_(&arena_storage_, INLINE_ARENA_SIZE), connection_manager_(connection_manager),
       snapped_route_config_(connection_manager.config_.routeConfigProvider().config()),
       stream_id_(ConnectionManagerUtility::generateStreamId(*snapped_route_config_,
                                                             connection_manager.random_generator_)),
+      decoder_filters_(ArenaAllocator<ActiveStreamDecoderFilterPtr>(arena_)),
+      encoder_filters_(ArenaAllocator<ActiveStreamEncoderFilterPtr>(arena_)),
+      access_log_handlers_(ArenaAllocator<Http::AccessLog::InstanceSharedPtr>(arena_)),
       request_timer_(connection_manager_.stats_.named_.downstream_rq_time_.allocateSpan()),
       request_info_(connection_manager_.codec_->protocol()) {
   connection_manager_.stats_.named_.downstream_rq_total_.inc();
@@ -357,6 +360,9 @@ ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connect
   } else {
     connection_manager_.stats_.named_.downstream_rq_http1_total_.inc();
   }
+
+  decoder_filters_.reserve(RESERVED_FILTERS);
+  encoder_filters_.reserve(RESERVED_FILTERS);
 }
 
 ConnectionManagerImpl::ActiveStream::~ActiveStream() {
@@ -380,16 +386,18 @@ ConnectionManagerImpl::ActiveStream::~ActiveStream() {
 
 void ConnectionManagerImpl::ActiveStream::addStreamDecoderFilterWorker(
     StreamDecoderFilterSharedPtr filter, bool dual_filter) {
-  ActiveStreamDecoderFilterPtr wrapper(new ActiveStreamDecoderFilter(*this, filter, dual_filter));
+  ActiveStreamDecoderFilterPtr wrapper(
+      new (arena_) ActiveStreamDecoderFilter(*this, filter, dual_filter, decoder_filters_.size()));
   filter->setDecoderFilterCallbacks(*wrapper);
-  wrapper->moveIntoListBack(std::move(wrapper), decoder_filters_);
+  decoder_filters_.push_back(std::move(wrapper));
 }
 
 void ConnectionManagerImpl::ActiveStream::addStreamEncoderFilterWorker(
     StreamEncoderFilterSharedPtr filter, bool dual_filter) {
-  ActiveStreamEncoderFilterPtr wrapper(new ActiveStreamEncoderFilter(*this, filter, dual_filter));
+  ActiveStreamEncoderFilterPtr wrapper(
+      new (arena_) ActiveStreamEncoderFilter(*this, filter, dual_filter, encoder_filters_.size()));
   filter->setEncoderFilterCallbacks(*wrapper);
-  wrapper->moveIntoListBack(std::move(wrapper), encoder_filters_);
+  encoder_filters_.push_back(std::move(wrapper));
 }
 
 void ConnectionManagerImpl::ActiveStream::addAccessLogHandler(
@@ -561,24 +569,17 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(HeaderMapPtr&& headers,
 
 void ConnectionManagerImpl::ActiveStream::decodeHeaders(ActiveStreamDecoderFilter* filter,
                                                         HeaderMap& headers, bool end_stream) {
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry;
-  std::list<ActiveStreamDecoderFilterPtr>::iterator continue_data_entry = decoder_filters_.end();
-  if (!filter) {
-    entry = decoder_filters_.begin();
-  } else {
-    entry = std::next(filter->entry());
-  }
-
-  for (; entry != decoder_filters_.end(); entry++) {
+  ActiveStreamDecoderFilter* continue_data_entry = nullptr;
+  for (size_t i = filter == nullptr ? 0 : filter->index_ + 1; i < decoder_filters_.size(); i++) {
+    ActiveStreamDecoderFilter* entry = decoder_filters_[i].get();
     ASSERT(!(state_.filter_call_state_ & FilterCallState::DecodeHeaders));
     state_.filter_call_state_ |= FilterCallState::DecodeHeaders;
-    FilterHeadersStatus status = (*entry)->handle_->decodeHeaders(
-        headers, end_stream && continue_data_entry == decoder_filters_.end());
+    FilterHeadersStatus status =
+        entry->handle_->decodeHeaders(headers, end_stream && continue_data_entry == nullptr);
     state_.filter_call_state_ &= ~FilterCallState::DecodeHeaders;
     ENVOY_STREAM_LOG(trace, "decode headers called: filter={} status={}", *this,
-                     static_cast<const void*>((*entry).get()), static_cast<uint64_t>(status));
-    if (!(*entry)->commonHandleAfterHeadersCallback(status) &&
-        std::next(entry) != decoder_filters_.end()) {
+                     static_cast<const void*>(entry), static_cast<uint64_t>(status));
+    if (!entry->commonHandleAfterHeadersCallback(status) && i + 1 < decoder_filters_.size()) {
       // Stop iteration IFF this is not the last filter. If it is the last filter, continue with
       // processing since we need to handle the case where a terminal filter wants to buffer, but
       // a previous filter has added body.
@@ -587,17 +588,17 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(ActiveStreamDecoderFilte
 
     // Here we handle the case where we have a header only request, but a filter adds a body
     // to it. We need to not raise end_stream = true to further filters during inline iteration.
-    if (end_stream && buffered_request_data_ && continue_data_entry == decoder_filters_.end()) {
+    if (end_stream && buffered_request_data_ && continue_data_entry == nullptr) {
       continue_data_entry = entry;
     }
   }
 
-  if (continue_data_entry != decoder_filters_.end()) {
+  if (continue_data_entry != nullptr) {
     // We use the continueDecoding() code since it will correctly handle not calling
     // decodeHeaders() again. Fake setting stopped_ since the continueDecoding() code expects it.
     ASSERT(buffered_request_data_);
-    (*continue_data_entry)->stopped_ = true;
-    (*continue_data_entry)->continueDecoding();
+    continue_data_entry->stopped_ = true;
+    continue_data_entry->continueDecoding();
   }
 }
 
@@ -620,21 +621,15 @@ void ConnectionManagerImpl::ActiveStream::decodeData(ActiveStreamDecoderFilter*
     return;
   }
 
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry;
-  if (!filter) {
-    entry = decoder_filters_.begin();
-  } else {
-    entry = std::next(filter->entry());
-  }
-
-  for (; entry != decoder_filters_.end(); entry++) {
+  for (size_t i = filter == nullptr ? 0 : filter->index_ + 1; i < decoder_filters_.size(); i++) {
+    ActiveStreamDecoderFilter* entry = decoder_filters_[i].get();
     ASSERT(!(state_.filter_call_state_ & FilterCallState::DecodeData));
     state_.filter_call_state_ |= FilterCallState::DecodeData;
-    FilterDataStatus status = (*entry)->handle_->decodeData(data, end_stream);
+    FilterDataStatus status = entry->handle_->decodeData(data, end_stream);
     state_.filter_call_state_ &= ~FilterCallState::DecodeData;
     ENVOY_STREAM_LOG(trace, "decode data called: filter={} status={}", *this,
-                     static_cast<const void*>((*entry).get()), static_cast<uint64_t>(status));
-    if (!(*entry)->commonHandleAfterDataCallback(status, data, state_.decoder_filters_streaming_)) {
+                     static_cast<const void*>(entry), static_cast<uint64_t>(status));
+    if (!entry->commonHandleAfterDataCallback(status, data, state_.decoder_filters_streaming_)) {
       return;
     }
   }
@@ -674,29 +669,22 @@ void ConnectionManagerImpl::ActiveStream::decodeTrailers(ActiveStreamDecoderFilt
     return;
   }
 
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry;
-  if (!filter) {
-    entry = decoder_filters_.begin();
-  } else {
-    entry = std::next(filter->entry());
-  }
-
-  for (; entry != decoder_filters_.end(); entry++) {
+  for (size_t i = filter == nullptr ? 0 : filter->index_ + 1; i < decoder_filters_.size(); i++) {
+    ActiveStreamDecoderFilter* entry = decoder_filters_[i].get();
     ASSERT(!(state_.filter_call_state_ & FilterCallState::DecodeTrailers));
     state_.filter_call_state_ |= FilterCallState::DecodeTrailers;
-    FilterTrailersStatus status = (*entry)->handle_->decodeTrailers(trailers);
+    FilterTrailersStatus status = entry->handle_->decodeTrailers(trailers);
     state_.filter_call_state_ &= ~FilterCallState::DecodeTrailers;
     ENVOY_STREAM_LOG(trace, "decode trailers called: filter={} status={}", *this,
-                     static_cast<const void*>((*entry).get()), static_cast<uint64_t>(status));
-    if (!(*entry)->commonHandleAfterTrailersCallback(status)) {
+                     static_cast<const void*>(entry), static_cast<uint64_t>(status));
+    if (!entry->commonHandleAfterTrailersCallback(status)) {
       return;
     }
   }
 }
 
-std::list<ConnectionManagerImpl::ActiveStreamEncoderFilterPtr>::iterator
-ConnectionManagerImpl::ActiveStream::commonEncodePrefix(ActiveStreamEncoderFilter* filter,
-                                                        bool end_stream) {
+size_t ConnectionManagerImpl::ActiveStream::commonEncodePrefix(ActiveStreamEncoderFilter* filter,
+                                                               bool end_stream) {
   // Only do base state setting on the initial call. Subsequent calls for filtering do not touch
   // the base state.
   if (filter == nullptr) {
@@ -704,11 +692,7 @@ ConnectionManagerImpl::ActiveStream::commonEncodePrefix(ActiveStreamEncoderFilte
     state_.local_complete_ = end_stream;
   }
 
-  if (!filter) {
-    return encoder_filters_.begin();
-  } else {
-    return std::next(filter->entry());
-  }
+  return filter == nullptr ? 0 : filter->index_ + 1;
 }
 
 void ConnectionManagerImpl::startDrainSequence() {
@@ -722,24 +706,23 @@ void ConnectionManagerImpl::startDrainSequence() {
 
 void ConnectionManagerImpl::ActiveStream::encodeHeaders(ActiveStreamEncoderFilter* filter,
                                                         HeaderMap& headers, bool end_stream) {
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry = commonEncodePrefix(filter, end_stream);
-  std::list<ActiveStreamEncoderFilterPtr>::iterator continue_data_entry = encoder_filters_.end();
-
-  for (; entry != encoder_filters_.end(); entry++) {
+  ActiveStreamEncoderFilter* continue_data_entry = nullptr;
+  for (size_t i = commonEncodePrefix(filter, end_stream); i < encoder_filters_.size(); i++) {
+    ActiveStreamEncoderFilter* entry = encoder_filters_[i].get();
     ASSERT(!(state_.filter_call_state_ & FilterCallState::EncodeHeaders));
     state_.filter_call_state_ |= FilterCallState::EncodeHeaders;
-    FilterHeadersStatus status = (*entry)->handle_->encodeHeaders(
-        headers, end_stream && continue_data_entry == encoder_filters_.end());
+    FilterHeadersStatus status =
+        entry->handle_->encodeHeaders(headers, end_stream && continue_data_entry == nullptr);
     state_.filter_call_state_ &= ~FilterCallState::EncodeHeaders;
     ENVOY_STREAM_LOG(trace, "encode headers called: filter={} status={}", *this,
-                     static_cast<const void*>((*entry).get()), static_cast<uint64_t>(status));
-    if (!(*entry)->commonHandleAfterHeadersCallback(status)) {
+                     static_cast<const void*>(entry), static_cast<uint64_t>(status));
+    if (!entry->commonHandleAfterHeadersCallback(status)) {
       return;
     }
 
     // Here we handle the case where we have a header only response, but a filter adds a body
     // to it. We need to not raise end_stream = true to further filters during inline iteration.
-    if (end_stream && buffered_response_data_ && continue_data_entry == encoder_filters_.end()) {
+    if (end_stream && buffered_response_data_ && continue_data_entry == nullptr) {
       continue_data_entry = entry;
     }
   }
@@ -788,7 +771,7 @@ void ConnectionManagerImpl::ActiveStream::encodeHeaders(ActiveStreamEncoderFilte
   chargeStats(headers);
 
   ENVOY_STREAM_LOG(debug, "encoding headers via codec (end_stream={}):", *this,
-                   end_stream && continue_data_entry == encoder_filters_.end());
+                   end_stream && continue_data_entry == nullptr);
 #ifndef NVLOG
   headers.iterate(
       [](const HeaderEntry& header, void* context) -> void {
@@ -799,15 +782,14 @@ void ConnectionManagerImpl::ActiveStream::encodeHeaders(ActiveStreamEncoderFilte
 #endif
 
   // Now actually encode via the codec.
-  response_encoder_->encodeHeaders(headers,
-                                   end_stream && continue_data_entry == encoder_filters_.end());
+  response_encoder_->encodeHeaders(headers, end_stream && continue_data_entry == nullptr);
 
-  if (continue_data_entry != encoder_filters_.end()) {
+  if (continue_data_entry != nullptr) {
     // We use the continueEncoding() code since it will correctly handle not calling
     // encodeHeaders() again. Fake setting stopped_ since the continueEncoding() code expects it.
     ASSERT(buffered_response_data_);
-    (*continue_data_entry)->stopped_ = true;
-    (*continue_data_entry)->continueEncoding();
+    continue_data_entry->stopped_ = true;
+    continue_data_entry->continueEncoding();
   } else {
     maybeEndEncode(end_stream);
   }
@@ -835,15 +817,15 @@ void ConnectionManagerImpl::ActiveStream::addEncodedData(ActiveStreamEncoderFilt
 
 void ConnectionManagerImpl::ActiveStream::encodeData(ActiveStreamEncoderFilter* filter,
                                                      Buffer::Instance& data, bool end_stream) {
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry = commonEncodePrefix(filter, end_stream);
-  for (; entry != encoder_filters_.end(); entry++) {
+  for (size_t i = commonEncodePrefix(filter, end_stream); i < encoder_filters_.size(); i++) {
+    ActiveStreamEncoderFilter* entry = encoder_filters_[i].get();
     ASSERT(!(state_.filter_call_state_ & FilterCallState::EncodeData));
     state_.filter_call_state_ |= FilterCallState::EncodeData;
-    FilterDataStatus status = (*entry)->handle_->encodeData(data, end_stream);
+    FilterDataStatus status = entry->handle_->encodeData(data, end_stream);
     state_.filter_call_state_ &= ~FilterCallState::EncodeData;
     ENVOY_STREAM_LOG(trace, "encode data called: filter={} status={}", *this,
-                     static_cast<const void*>((*entry).get()), static_cast<uint64_t>(status));
-    if (!(*entry)->commonHandleAfterDataCallback(status, data, state_.encoder_filters_streaming_)) {
+                     static_cast<const void*>(entry), static_cast<uint64_t>(status));
+    if (!entry->commonHandleAfterDataCallback(status, data, state_.encoder_filters_streaming_)) {
       return;
     }
   }
@@ -858,15 +840,15 @@ void ConnectionManagerImpl::ActiveStream::encodeData(ActiveStreamEncoderFilter*
 
 void ConnectionManagerImpl::ActiveStream::encodeTrailers(ActiveStreamEncoderFilter* filter,
                                                          HeaderMap& trailers) {
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry = commonEncodePrefix(filter, true);
-  for (; entry != encoder_filters_.end(); entry++) {
+  for (size_t i = commonEncodePrefix(filter, true); i < encoder_filters_.size(); i++) {
+    ActiveStreamEncoderFilter* entry = encoder_filters_[i].get();
     ASSERT(!(state_.filter_call_state_ & FilterCallState::EncodeTrailers));
     state_.filter_call_state_ |= FilterCallState::EncodeTrailers;
-    FilterTrailersStatus status = (*entry)->handle_->encodeTrailers(trailers);
+    FilterTrailersStatus status = entry->handle_->encodeTrailers(trailers);
     state_.filter_call_state_ &= ~FilterCallState::EncodeTrailers;
     ENVOY_STREAM_LOG(trace, "encode trailers called: filter={} status={}", *this,
-                     static_cast<const void*>((*entry).get()), static_cast<uint64_t>(status));
-    if (!(*entry)->commonHandleAfterTrailersCallback(status)) {
+                     static_cast<const void*>(entry), static_cast<uint64_t>(status));
+    if (!entry->commonHandleAfterTrailersCallback(status)) {
       return;
     }
   }
@@ -1081,6 +1063,8 @@ Buffer::WatermarkBufferPtr ConnectionManagerImpl::ActiveStreamDecoderFilter::cre
       new Buffer::WatermarkBuffer([this]() -> void { this->requestDataDrained(); },
                                   [this]() -> void { this->requestDataTooLarge(); })};
   buffer->setWatermarks(parent_.buffer_limit_);
+  buffer->setMemoryAccount(
+      parent_.connection_manager_.read_callbacks_->connection().bufferMemoryAccount());
   return buffer;
 }
 
@@ -1159,6 +1143,8 @@ Buffer::WatermarkBufferPtr ConnectionManagerImpl::ActiveStreamEncoderFilter::cre
   auto buffer = new Buffer::WatermarkBuffer([this]() -> void { this->responseDataDrained(); },
                                             [this]() -> void { this->responseDataTooLarge(); });
   buffer->setWatermarks(parent_.buffer_limit_);
+  buffer->setMemoryAccount(
+      parent_.connection_manager_.read_callbacks_->connection().bufferMemoryAccount());
   return Buffer::WatermarkBufferPtr{buffer};
 }
 
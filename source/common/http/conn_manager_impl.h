@@ -1,13 +1,16 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <list>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include "envoy/common/arena.h"
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/http/access_log.h"
 #include "envoy/http/codec.h"
@@ -24,6 +27,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/buffer/watermark_buffer.h"
+#include "common/common/arena_impl.h"
 #include "common/common/linked_object.h"
 #include "common/http/access_log/request_info_impl.h"
 #include "common/http/date_provider.h"
@@ -59,6 +63,7 @@ namespace Http {
   TIMER  (downstream_cx_length_ms)                                                                 \
   COUNTER(downstream_cx_rx_bytes_total)                                                            \
   GAUGE  (downstream_cx_rx_bytes_buffered)                                                         \
+  COUNTER(downstream_cx_rx_syscalls_total)                                                         \
   COUNTER(downstream_cx_tx_bytes_total)                                                            \
   GAUGE  (downstream_cx_tx_bytes_buffered)                                                         \
   COUNTER(downstream_cx_drain_close)                                                               \
@@ -358,21 +363,33 @@ private:
     Tracing::Span& activeSpan() override;
     const std::string& downstreamAddress() override;
 
+    // Wrappers are placed in their stream's arena, which releases their memory along with the
+    // rest of the stream's.
+    static void* operator new(size_t size, Arena& arena) {
+      return arena.allocate(size, alignof(std::max_align_t));
+    }
+    static void operator delete(void*, Arena&) {}
+    static void operator delete(void*) {}
+
     ActiveStream& parent_;
     bool headers_continued_ : 1;
     bool stopped_ : 1;
     const bool dual_filter_ : 1;
   };
 
+  struct ActiveStreamDecoderFilter;
+  typedef std::unique_ptr<ActiveStreamDecoderFilter> ActiveStreamDecoderFilterPtr;
+  typedef std::vector<ActiveStreamDecoderFilterPtr, ArenaAllocator<ActiveStreamDecoderFilterPtr>>
+      ActiveStreamDecoderFilterVector;
+
   /**
    * Wrapper for a stream decoder filter.
    */
   struct ActiveStreamDecoderFilter : public ActiveStreamFilterBase,
-                                     public StreamDecoderFilterCallbacks,
-                                     LinkedObject<ActiveStreamDecoderFilter> {
+                                     public StreamDecoderFilterCallbacks {
     ActiveStreamDecoderFilter(ActiveStream& parent, StreamDecoderFilterSharedPtr filter,
-                              bool dual_filter)
-        : ActiveStreamFilterBase(parent, dual_filter), handle_(filter) {}
+                              bool dual_filter, size_t index)
+        : ActiveStreamFilterBase(parent, dual_filter), handle_(filter), index_(index) {}
 
     // ActiveStreamFilterBase
     Buffer::WatermarkBufferPtr createBuffer() override;
@@ -409,19 +426,23 @@ private:
     void requestDataDrained();
 
     StreamDecoderFilterSharedPtr handle_;
+    // Position in the stream's decoder filters.
+    const size_t index_;
   };
 
-  typedef std::unique_ptr<ActiveStreamDecoderFilter> ActiveStreamDecoderFilterPtr;
+  struct ActiveStreamEncoderFilter;
+  typedef std::unique_ptr<ActiveStreamEncoderFilter> ActiveStreamEncoderFilterPtr;
+  typedef std::vector<ActiveStreamEncoderFilterPtr, ArenaAllocator<ActiveStreamEncoderFilterPtr>>
+      ActiveStreamEncoderFilterVector;
 
   /**
    * Wrapper for a stream encoder filter.
    */
   struct ActiveStreamEncoderFilter : public ActiveStreamFilterBase,
-                                     public StreamEncoderFilterCallbacks,
-                                     LinkedObject<ActiveStreamEncoderFilter> {
+                                     public StreamEncoderFilterCallbacks {
     ActiveStreamEncoderFilter(ActiveStream& parent, StreamEncoderFilterSharedPtr filter,
-                              bool dual_filter)
-        : ActiveStreamFilterBase(parent, dual_filter), handle_(filter) {}
+                              bool dual_filter, size_t index)
+        : ActiveStreamFilterBase(parent, dual_filter), handle_(filter), index_(index) {}
 
     // ActiveStreamFilterBase
     Buffer::WatermarkBufferPtr createBuffer() override;
@@ -451,13 +472,21 @@ private:
     void responseDataDrained();
 
     StreamEncoderFilterSharedPtr handle_;
+    // Position in the stream's encoder filters.
+    const size_t index_;
   };
 
-  typedef std::unique_ptr<ActiveStreamEncoderFilter> ActiveStreamEncoderFilterPtr;
-
   /**
    * Wraps a single active stream on the connection. These are either full request/response pairs
    * or pushes.
+   *
+   * The filter wrappers, the filters that are created with arena(), and the nodes of the stream's
+   * lists are placed in an arena that starts out in storage inside the stream, so that setting up
+   * a typical filter chain costs no heap allocations beyond the stream itself. It is released in
+   * one go when the stream is deleted.
+   *
+   * The wrappers are kept in arrays in filter chain order, and each knows its own position, so
+   * that iteration, including resuming after a filter that stopped, is an indexed loop.
    */
   struct ActiveStream : LinkedObject<ActiveStream>,
                         public Event::DeferredDeletable,
@@ -472,8 +501,7 @@ private:
     void addStreamDecoderFilterWorker(StreamDecoderFilterSharedPtr filter, bool dual_filter);
     void addStreamEncoderFilterWorker(StreamEncoderFilterSharedPtr filter, bool dual_filter);
     void chargeStats(HeaderMap& headers);
-    std::list<ActiveStreamEncoderFilterPtr>::iterator
-    commonEncodePrefix(ActiveStreamEncoderFilter* filter, bool end_stream);
+    size_t commonEncodePrefix(ActiveStreamEncoderFilter* filter, bool end_stream);
     uint64_t connectionId();
     const Network::Connection* connection();
     Ssl::Connection* ssl();
@@ -510,6 +538,7 @@ private:
       addStreamEncoderFilterWorker(filter, true);
     }
     void addAccessLogHandler(Http::AccessLog::InstanceSharedPtr handler) override;
+    Arena& arena() override { return arena_; }
 
     // Http::WsHandlerCallbacks
     void sendHeadersOnlyResponse(HeaderMap& headers) override {
@@ -558,6 +587,19 @@ private:
     // Possibly increases buffer_limit_ to the value of limit.
     void setBufferLimit(uint32_t limit);
 
+    typedef std::list<Http::AccessLog::InstanceSharedPtr,
+                      ArenaAllocator<Http::AccessLog::InstanceSharedPtr>>
+        AccessLogHandlerList;
+
+    // Room for the wrappers and filters of a typical filter chain.
+    static const size_t INLINE_ARENA_SIZE = 2048;
+    // The filter arrays are sized for this many filters up front, since growing them wastes arena
+    // memory.
+    static const size_t RESERVED_FILTERS = 8;
+
+    // The arena comes first, so that it is destroyed after every member that may use it.
+    std::aligned_storage<INLINE_ARENA_SIZE>::type arena_storage_;
+    ArenaImpl arena_;
     ConnectionManagerImpl& connection_manager_;
     Router::ConfigConstSharedPtr snapped_route_config_;
     Tracing::SpanPtr active_span_{new Tracing::NullSpan()};
@@ -569,9 +611,9 @@ private:
     HeaderMapPtr request_headers_;
     Buffer::WatermarkBufferPtr buffered_request_data_;
     HeaderMapPtr request_trailers_;
-    std::list<ActiveStreamDecoderFilterPtr> decoder_filters_;
-    std::list<ActiveStreamEncoderFilterPtr> encoder_filters_;
-    std::list<Http::AccessLog::InstanceSharedPtr> access_log_handlers_;
+    ActiveStreamDecoderFilterVector decoder_filters_;
+    ActiveStreamEncoderFilterVector encoder_filters_;
+    AccessLogHandlerList access_log_handlers_;
     Stats::TimespanPtr request_timer_;
     State state_;
     AccessLog::RequestInfoImpl request_info_;
@@ -0,0 +1,295 @@
+#include "common/http/filter/gzip_filter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <vector>
+
+#include "envoy/router/router.h"
+#include "envoy/stats/stats.h"
+
+#include "common/common/assert.h"
+#include "common/common/utility.h"
+#include "common/http/headers.h"
+#include "common/json/config_schemas.h"
+
+namespace Envoy {
+namespace Http {
+
+namespace {
+
+// Compressing a body shorter than this rarely pays for the gzip header and trailer.
+const uint64_t DEFAULT_MIN_CONTENT_LENGTH = 30;
+
+const std::vector<std::string>& defaultContentTypes() {
+  static const std::vector<std::string>* types = new std::vector<std::string>{
+      "application/javascript", "application/json", "application/xml", "image/svg+xml",
+      "text/css",               "text/html",        "text/plain",      "text/xml"};
+  return *types;
+}
+
+std::string trim(const std::string& source) {
+  const size_t begin = source.find_first_not_of(" \t");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  const size_t end = source.find_last_not_of(" \t");
+  return source.substr(begin, end - begin + 1);
+}
+
+std::string toLower(std::string source) {
+  std::transform(source.begin(), source.end(), source.begin(), ::tolower);
+  return source;
+}
+
+/**
+ * @return the lower case media type of a content-type value, without parameters.
+ */
+std::string mediaType(const std::string& content_type) {
+  return toLower(trim(content_type.substr(0, content_type.find(';'))));
+}
+
+/**
+ * Whether a coding is listed in an accept-encoding header, and if so whether it is acceptable.
+ */
+enum class Acceptance { NotListed, Accepted, Refused };
+
+/**
+ * @return whether the parameters of an accept-encoding element set a zero quality value.
+ */
+bool hasZeroQuality(const std::vector<std::string>& params) {
+  for (size_t i = 1; i < params.size(); i++) {
+    const std::string param = trim(params[i]);
+    if (!StringUtil::startsWith(param.c_str(), "q=", false)) {
+      continue;
+    }
+    // A qvalue is at most 1 with three decimals, so it is zero when it has no non zero digit.
+    const std::string qvalue = param.substr(2);
+    return !qvalue.empty() && qvalue[0] == '0' &&
+           qvalue.find_first_not_of("0.", 1) == std::string::npos;
+  }
+  return false;
+}
+
+bool isAcceptable(Acceptance coding, Acceptance any) {
+  return coding == Acceptance::Accepted ||
+         (coding == Acceptance::NotListed && any == Acceptance::Accepted);
+}
+
+} // namespace
+
+const std::string GzipFilter::ROUTE_ENABLED_KEY = "gzip.enabled";
+const std::string GzipFilter::ROUTE_COMPRESSION_LEVEL_KEY = "gzip.compression_level";
+
+GzipFilterConfig::GzipFilterConfig(const Json::Object& json_config,
+                                   const std::string& stats_prefix, Stats::Scope& scope)
+    : stats_(generateStats(stats_prefix, scope)) {
+  json_config.validateSchema(Json::Schema::GZIP_HTTP_FILTER_SCHEMA);
+
+  compression_level_ = json_config.getInteger("compression_level", Z_DEFAULT_COMPRESSION);
+  window_bits_ = json_config.getInteger("window_bits", 15);
+  memory_level_ = json_config.getInteger("memory_level", 8);
+  min_content_length_ = static_cast<uint64_t>(
+      json_config.getInteger("min_content_length", DEFAULT_MIN_CONTENT_LENGTH));
+
+  const std::vector<std::string> content_types =
+      json_config.hasObject("content_types") ? json_config.getStringArray("content_types")
+                                             : defaultContentTypes();
+  for (const std::string& content_type : content_types) {
+    content_types_.insert(mediaType(content_type));
+  }
+}
+
+bool GzipFilterConfig::isContentTypeAllowed(const std::string& content_type) const {
+  return content_types_.count(mediaType(content_type)) != 0;
+}
+
+GzipFilterStats GzipFilterConfig::generateStats(const std::string& prefix, Stats::Scope& scope) {
+  std::string final_prefix = prefix + "gzip.";
+  return {ALL_GZIP_FILTER_STATS(POOL_COUNTER_PREFIX(scope, final_prefix))};
+}
+
+GzipFilter::GzipFilter(GzipFilterConfigSharedPtr config)
+    : config_(config), compression_level_(config_->compressionLevel()) {}
+
+GzipFilter::ContentCoding GzipFilter::negotiate(const std::string& accept_encoding) {
+  Acceptance gzip = Acceptance::NotListed;
+  Acceptance deflate = Acceptance::NotListed;
+  Acceptance any = Acceptance::NotListed;
+  for (const std::string& element : StringUtil::split(accept_encoding, ',')) {
+    const std::vector<std::string> params = StringUtil::split(element, ';');
+    if (params.empty()) {
+      continue;
+    }
+    const std::string coding = trim(params[0]);
+    const Acceptance acceptance =
+        hasZeroQuality(params) ? Acceptance::Refused : Acceptance::Accepted;
+    if (StringUtil::caseInsensitiveCompare(coding.c_str(), "gzip") == 0 ||
+        StringUtil::caseInsensitiveCompare(coding.c_str(), "x-gzip") == 0) {
+      gzip = acceptance;
+    } else if (StringUtil::caseInsensitiveCompare(coding.c_str(), "deflate") == 0) {
+      deflate = acceptance;
+    } else if (coding == "*") {
+      any = acceptance;
+    }
+  }
+
+  if (isAcceptable(gzip, any)) {
+    return ContentCoding::Gzip;
+  }
+  if (isAcceptable(deflate, any)) {
+    return ContentCoding::Deflate;
+  }
+  return ContentCoding::Identity;
+}
+
+void GzipFilter::onDestroy() {
+  // Hand the compression state back to the per thread cache if the response did not finish.
+  compressor_.reset();
+}
+
+FilterHeadersStatus GzipFilter::decodeHeaders(HeaderMap& headers, bool) {
+  const HeaderEntry* accept_encoding = headers.get(Headers::get().AcceptEncoding);
+  if (accept_encoding != nullptr) {
+    content_coding_ = negotiate(accept_encoding->value().c_str());
+  }
+  readRoutePolicy();
+  return FilterHeadersStatus::Continue;
+}
+
+void GzipFilter::readRoutePolicy() {
+  Router::RouteConstSharedPtr route = decoder_callbacks_->route();
+  if (!route || !route->routeEntry()) {
+    return;
+  }
+
+  const std::multimap<std::string, std::string>& opaque_config =
+      route->routeEntry()->opaqueConfig();
+  auto enabled = opaque_config.find(ROUTE_ENABLED_KEY);
+  if (enabled != opaque_config.end()) {
+    route_enabled_ = enabled->second != "false";
+  }
+  auto level = opaque_config.find(ROUTE_COMPRESSION_LEVEL_KEY);
+  uint64_t compression_level;
+  if (level != opaque_config.end() && StringUtil::atoul(level->second.c_str(), compression_level) &&
+      compression_level >= 1 && compression_level <= 9) {
+    compression_level_ = static_cast<int>(compression_level);
+  }
+}
+
+bool GzipFilter::isResponseCompressible(const HeaderMap& headers) const {
+  if (headers.get(Headers::get().ContentEncoding) != nullptr) {
+    return false;
+  }
+
+  // Partial content can't be compressed without breaking the range it covers.
+  if (headers.Status() != nullptr && headers.Status()->value() == "206") {
+    return false;
+  }
+
+  const HeaderEntry* cache_control = headers.get(Headers::get().CacheControl);
+  if (cache_control != nullptr &&
+      toLower(cache_control->value().c_str())
+              .find(Headers::get().CacheControlValues.NoTransform) != std::string::npos) {
+    return false;
+  }
+
+  uint64_t content_length;
+  if (headers.ContentLength() != nullptr &&
+      StringUtil::atoul(headers.ContentLength()->value().c_str(), content_length) &&
+      content_length < config_->minContentLength()) {
+    return false;
+  }
+
+  return headers.ContentType() != nullptr &&
+         config_->isContentTypeAllowed(headers.ContentType()->value().c_str());
+}
+
+FilterHeadersStatus GzipFilter::encodeHeaders(HeaderMap& headers, bool end_stream) {
+  if (end_stream) {
+    return FilterHeadersStatus::Continue;
+  }
+
+  if (!route_enabled_ || !isResponseCompressible(headers)) {
+    config_->stats().not_compressed_.inc();
+    return FilterHeadersStatus::Continue;
+  }
+
+  // The representation depends on accept-encoding from here on, whatever this client accepts, so
+  // caches must key on it.
+  const HeaderEntry* vary = headers.get(Headers::get().Vary);
+  if (vary == nullptr) {
+    headers.addReference(Headers::get().Vary, Headers::get().VaryValues.AcceptEncoding);
+  } else {
+    const std::string value = vary->value().c_str();
+    const std::string lower_case_value = toLower(value);
+    if (lower_case_value != "*" &&
+        lower_case_value.find(Headers::get().AcceptEncoding.get()) == std::string::npos) {
+      headers.remove(Headers::get().Vary);
+      headers.addCopy(Headers::get().Vary, value + ", " + Headers::get().VaryValues.AcceptEncoding);
+    }
+  }
+
+  if (content_coding_ == ContentCoding::Identity) {
+    config_->stats().no_accept_encoding_.inc();
+    return FilterHeadersStatus::Continue;
+  }
+
+  Compressor::ZlibParams params;
+  params.format_ = content_coding_ == ContentCoding::Gzip ? Compressor::ZlibParams::Format::Gzip
+                                                          : Compressor::ZlibParams::Format::Zlib;
+  params.level_ = compression_level_;
+  params.window_bits_ = config_->windowBits();
+  params.mem_level_ = config_->memoryLevel();
+  compressor_.reset(new Compressor::ZlibCompressor(params));
+
+  headers.removeContentLength();
+  headers.addReference(Headers::get().ContentEncoding,
+                       content_coding_ == ContentCoding::Gzip
+                           ? Headers::get().ContentEncodingValues.Gzip
+                           : Headers::get().ContentEncodingValues.Deflate);
+  // The compressed body is no longer byte for byte identical to the one a strong entity tag
+  // identifies.
+  const HeaderEntry* etag = headers.get(Headers::get().Etag);
+  if (etag != nullptr && !StringUtil::startsWith(etag->value().c_str(), "W/")) {
+    const std::string value = etag->value().c_str();
+    headers.remove(Headers::get().Etag);
+    headers.addCopy(Headers::get().Etag, "W/" + value);
+  }
+
+  config_->stats().compressed_.inc();
+  return FilterHeadersStatus::Continue;
+}
+
+FilterDataStatus GzipFilter::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (compressor_) {
+    compress(data, end_stream);
+  }
+  return FilterDataStatus::Continue;
+}
+
+FilterTrailersStatus GzipFilter::encodeTrailers(HeaderMap&) {
+  if (compressor_) {
+    Buffer::OwnedImpl data;
+    compress(data, true);
+    encoder_callbacks_->addEncodedData(data, true);
+  }
+  return FilterTrailersStatus::Continue;
+}
+
+void GzipFilter::compress(Buffer::Instance& data, bool end_stream) {
+  // The output replaces the input before the data continues down the chain, so the filter holds
+  // nothing beyond the compressor's own window and the connection manager's watermarks apply to
+  // the compressed body as they would to any other. The compressor flushes each chunk, so a
+  // response that is streamed is not held back.
+  config_->stats().total_uncompressed_bytes_.add(data.length());
+  compressor_->compress(data, compressed_, end_stream);
+  config_->stats().total_compressed_bytes_.add(compressed_.length());
+  data.move(compressed_);
+  if (end_stream) {
+    compressor_.reset();
+  }
+}
+
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include "envoy/http/filter.h"
+#include "envoy/json/json_object.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/compressor/zlib_compressor.h"
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * All stats for the gzip filter. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_GZIP_FILTER_STATS(COUNTER)                                                             \
+  COUNTER(compressed)                                                                              \
+  COUNTER(not_compressed)                                                                          \
+  COUNTER(no_accept_encoding)                                                                      \
+  COUNTER(total_uncompressed_bytes)                                                                \
+  COUNTER(total_compressed_bytes)
+// clang-format on
+
+/**
+ * Wrapper struct for gzip filter stats. @see stats_macros.h
+ */
+struct GzipFilterStats {
+  ALL_GZIP_FILTER_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Configuration for the gzip filter.
+ */
+class GzipFilterConfig {
+public:
+  GzipFilterConfig(const Json::Object& json_config, const std::string& stats_prefix,
+                   Stats::Scope& scope);
+
+  GzipFilterStats& stats() { return stats_; }
+  int compressionLevel() const { return compression_level_; }
+  int windowBits() const { return window_bits_; }
+  int memoryLevel() const { return memory_level_; }
+  uint64_t minContentLength() const { return min_content_length_; }
+
+  /**
+   * @param content_type supplies the value of a content-type header.
+   * @return bool whether responses of this media type may be compressed.
+   */
+  bool isContentTypeAllowed(const std::string& content_type) const;
+
+private:
+  static GzipFilterStats generateStats(const std::string& prefix, Stats::Scope& scope);
+
+  GzipFilterStats stats_;
+  int compression_level_;
+  int window_bits_;
+  int memory_level_;
+  uint64_t min_content_length_;
+  // Lower case media types without parameters.
+  std::unordered_set<std::string> content_types_;
+};
+
+typedef std::shared_ptr<GzipFilterConfig> GzipFilterConfigSharedPtr;
+
+/**
+ * A filter that compresses response bodies with gzip or deflate, as negotiated with the
+ * accept-encoding request header. Bodies are compressed as they stream through, so the filter
+ * never buffers a response.
+ */
+class GzipFilter : public StreamFilter {
+public:
+  GzipFilter(GzipFilterConfigSharedPtr config);
+
+  /**
+   * The content codings the filter can produce, in order of preference.
+   */
+  enum class ContentCoding { Identity, Gzip, Deflate };
+
+  /**
+   * Choose a content coding from an accept-encoding header value. gzip is preferred over deflate
+   * when both are acceptable. A coding is acceptable if it is listed, or covered by "*", with a
+   * non zero quality value.
+   * @param accept_encoding supplies the header value.
+   * @return ContentCoding the chosen coding, Identity if neither gzip nor deflate is acceptable.
+   */
+  static ContentCoding negotiate(const std::string& accept_encoding);
+
+  // Route opaque config keys that control compression per route.
+  static const std::string ROUTE_ENABLED_KEY;
+  static const std::string ROUTE_COMPRESSION_LEVEL_KEY;
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  FilterHeadersStatus decodeHeaders(HeaderMap& headers, bool end_stream) override;
+  FilterDataStatus decodeData(Buffer::Instance&, bool) override {
+    return FilterDataStatus::Continue;
+  }
+  FilterTrailersStatus decodeTrailers(HeaderMap&) override {
+    return FilterTrailersStatus::Continue;
+  }
+  void setDecoderFilterCallbacks(StreamDecoderFilterCallbacks& callbacks) override {
+    decoder_callbacks_ = &callbacks;
+  }
+
+  // Http::StreamEncoderFilter
+  FilterHeadersStatus encodeHeaders(HeaderMap& headers, bool end_stream) override;
+  FilterDataStatus encodeData(Buffer::Instance& data, bool end_stream) override;
+  FilterTrailersStatus encodeTrailers(HeaderMap& trailers) override;
+  void setEncoderFilterCallbacks(StreamEncoderFilterCallbacks& callbacks) override {
+    encoder_callbacks_ = &callbacks;
+  }
+
+private:
+  /**
+   * @return bool whether the response is one the filter may compress, regardless of what the
+   *         client accepts.
+   */
+  bool isResponseCompressible(const HeaderMap& headers) const;
+
+  /**
+   * Read the per route policy from the route's opaque config.
+   */
+  void readRoutePolicy();
+
+  /**
+   * Compress data into the stream's compressor and replace it with the output.
+   */
+  void compress(Buffer::Instance& data, bool end_stream);
+
+  GzipFilterConfigSharedPtr config_;
+  StreamDecoderFilterCallbacks* decoder_callbacks_{};
+  StreamEncoderFilterCallbacks* encoder_callbacks_{};
+  ContentCoding content_coding_{ContentCoding::Identity};
+  bool route_enabled_{true};
+  int compression_level_;
+  std::unique_ptr<Compressor::ZlibCompressor> compressor_;
+  Buffer::OwnedImpl compressed_;
+};
+
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,709 @@
+#include "common/http/filter/response_cache_filter.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <vector>
+
+#include "envoy/stats/stats.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/enum_to_int.h"
+#include "common/common/utility.h"
+#include "common/http/headers.h"
+#include "common/http/utility.h"
+#include "common/json/config_schemas.h"
+
+#include "fmt/format.h"
+
+namespace Envoy {
+namespace Http {
+
+namespace {
+
+const uint64_t DEFAULT_MAX_SIZE_BYTES = 64 * 1024 * 1024;
+const uint64_t DEFAULT_MAX_ENTRY_SIZE_BYTES = 1024 * 1024;
+const uint32_t DEFAULT_SHARDS = 16;
+const uint64_t DEFAULT_HIT_FOR_PASS_MS = 10000;
+const uint64_t DEFAULT_MAX_WAIT_MS = 5000;
+
+// The response headers that a 304 carries over from the cached response. RFC 7232 section 4.1.
+const std::vector<LowerCaseString>& notModifiedHeaders() {
+  static const std::vector<LowerCaseString>* headers = new std::vector<LowerCaseString>{
+      Headers::get().CacheControl, Headers::get().Date,         Headers::get().Etag,
+      Headers::get().Expires,      Headers::get().LastModified, Headers::get().Vary};
+  return *headers;
+}
+
+std::string trim(const std::string& source) {
+  const size_t begin = source.find_first_not_of(" \t");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  const size_t end = source.find_last_not_of(" \t");
+  return source.substr(begin, end - begin + 1);
+}
+
+std::string toLower(std::string source) {
+  std::transform(source.begin(), source.end(), source.begin(), ::tolower);
+  return source;
+}
+
+/**
+ * @return the directives of a cache-control header, by lower case name. A directive without an
+ *         argument maps to an empty string.
+ */
+std::unordered_map<std::string, std::string> parseCacheControl(const HeaderEntry* cache_control) {
+  std::unordered_map<std::string, std::string> directives;
+  if (cache_control == nullptr) {
+    return directives;
+  }
+  for (const std::string& element : StringUtil::split(cache_control->value().c_str(), ',')) {
+    const size_t equal = element.find('=');
+    std::string argument = equal == std::string::npos ? "" : trim(element.substr(equal + 1));
+    if (argument.size() >= 2 && argument.front() == '"' && argument.back() == '"') {
+      argument = argument.substr(1, argument.size() - 2);
+    }
+    directives.emplace(toLower(trim(element.substr(0, equal))), argument);
+  }
+  return directives;
+}
+
+/**
+ * @return the value of a header, or an empty string if the header is not present.
+ */
+std::string headerValue(const HeaderMap& headers, const LowerCaseString& key) {
+  const HeaderEntry* entry = headers.get(key);
+  return entry != nullptr ? entry->value().c_str() : "";
+}
+
+/**
+ * @return an entity tag without its weakness indicator, for weak comparison.
+ */
+std::string weakTag(const std::string& tag) {
+  return StringUtil::startsWith(tag.c_str(), "W/") ? tag.substr(2) : tag;
+}
+
+} // namespace
+
+bool CachedResponse::varyMatches(const HeaderMap& request_headers) const {
+  for (const auto& vary : vary_) {
+    if (headerValue(request_headers, vary.first) != vary.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const size_t ResponseCache::MAX_PASS_KEYS_PER_SHARD;
+const size_t ResponseCache::MAX_VARIANTS_PER_KEY;
+
+ResponseCache::ResponseCache(uint64_t max_size_bytes, uint32_t shard_count,
+                             std::chrono::milliseconds hit_for_pass_ttl, ResponseCacheStats stats)
+    : max_shard_size_bytes_(max_size_bytes / shard_count), hit_for_pass_ttl_(hit_for_pass_ttl),
+      stats_(stats) {
+  ASSERT(shard_count > 0);
+  for (uint32_t i = 0; i < shard_count; i++) {
+    shards_.emplace_back(new Shard());
+  }
+}
+
+ResponseCache::Shard& ResponseCache::shardForKey(const std::string& key) {
+  return *shards_[std::hash<std::string>()(key) % shards_.size()];
+}
+
+ResponseCache::LookupStatus ResponseCache::lookup(const std::string& key,
+                                                  const HeaderMap& request_headers, SystemTime now,
+                                                  Event::Dispatcher& dispatcher, WaiterCb waiter_cb,
+                                                  bool may_lead,
+                                                  CachedResponseConstSharedPtr& response) {
+  Shard& shard = shardForKey(key);
+  std::lock_guard<std::mutex> lock(shard.lock_);
+  auto entry = shard.entries_.find(key);
+  if (entry != shard.entries_.end()) {
+    std::vector<std::list<Entry>::iterator>& variants = entry->second;
+    std::vector<std::list<Entry>::iterator> expired;
+    CachedResponseConstSharedPtr hit;
+    for (size_t i = 0; i < variants.size(); i++) {
+      const CachedResponseConstSharedPtr& cached = variants[i]->response_;
+      if (cached->expires_ <= now) {
+        expired.push_back(variants[i]);
+      } else if (hit == nullptr && cached->varyMatches(request_headers)) {
+        // The key's variants are kept most recently used first too.
+        std::rotate(variants.begin(), variants.begin() + i, variants.begin() + i + 1);
+        shard.lru_.splice(shard.lru_.begin(), shard.lru_, variants.front());
+        hit = cached;
+      }
+    }
+    for (std::list<Entry>::iterator variant : expired) {
+      removeLocked(shard, variant);
+    }
+    if (hit != nullptr) {
+      response = hit;
+      stats_.hit_.inc();
+      return LookupStatus::Hit;
+    }
+  }
+
+  auto pass = shard.pass_.find(key);
+  if (pass != shard.pass_.end()) {
+    if (pass->second > now) {
+      stats_.pass_.inc();
+      return LookupStatus::Pass;
+    }
+    shard.pass_.erase(pass);
+  }
+
+  auto pending = shard.pending_.find(key);
+  if (pending != shard.pending_.end()) {
+    pending->second.push_back({dispatcher, waiter_cb});
+    stats_.coalesced_.inc();
+    return LookupStatus::Wait;
+  }
+
+  stats_.miss_.inc();
+  if (!may_lead) {
+    return LookupStatus::Pass;
+  }
+  shard.pending_.emplace(key, std::vector<Waiter>());
+  return LookupStatus::Miss;
+}
+
+void ResponseCache::complete(const std::string& key, CachedResponseConstSharedPtr response) {
+  std::vector<Waiter> waiters;
+  {
+    Shard& shard = shardForKey(key);
+    std::lock_guard<std::mutex> lock(shard.lock_);
+    waiters = takeWaitersLocked(shard, key);
+
+    if (response != nullptr && response->size() <= max_shard_size_bytes_) {
+      auto existing = shard.entries_.find(key);
+      if (existing != shard.entries_.end()) {
+        // The response replaces the key's response for the same variant, or its least recently
+        // used variant if it has as many as it may keep.
+        const std::vector<std::list<Entry>::iterator>& variants = existing->second;
+        auto replaced = std::find_if(variants.begin(), variants.end(),
+                                     [&response](std::list<Entry>::iterator variant) -> bool {
+                                       return variant->response_->sameVariant(*response);
+                                     });
+        if (replaced != variants.end()) {
+          removeLocked(shard, *replaced);
+        } else if (variants.size() >= MAX_VARIANTS_PER_KEY) {
+          removeLocked(shard, variants.back());
+          stats_.eviction_.inc();
+        }
+      }
+
+      shard.lru_.push_front({key, response});
+      std::vector<std::list<Entry>::iterator>& variants = shard.entries_[key];
+      variants.insert(variants.begin(), shard.lru_.begin());
+      shard.size_bytes_ += response->size();
+      stats_.entries_.inc();
+      stats_.size_bytes_.add(response->size());
+      stats_.insert_.inc();
+
+      while (shard.size_bytes_ > max_shard_size_bytes_) {
+        removeLocked(shard, std::prev(shard.lru_.end()));
+        stats_.eviction_.inc();
+      }
+    }
+  }
+
+  notifyWaiters(waiters, response);
+}
+
+void ResponseCache::pass(const std::string& key, SystemTime now) {
+  std::vector<Waiter> waiters;
+  {
+    Shard& shard = shardForKey(key);
+    std::lock_guard<std::mutex> lock(shard.lock_);
+    waiters = takeWaitersLocked(shard, key);
+
+    if (hit_for_pass_ttl_.count() > 0) {
+      if (shard.pass_.size() >= MAX_PASS_KEYS_PER_SHARD) {
+        for (auto it = shard.pass_.begin(); it != shard.pass_.end();) {
+          it = it->second <= now ? shard.pass_.erase(it) : std::next(it);
+        }
+      }
+      // A shard that still remembers too many keys coalesces this one again next time.
+      if (shard.pass_.size() < MAX_PASS_KEYS_PER_SHARD) {
+        shard.pass_[key] = now + hit_for_pass_ttl_;
+      }
+    }
+  }
+
+  notifyWaiters(waiters, nullptr);
+}
+
+std::vector<ResponseCache::Waiter> ResponseCache::takeWaitersLocked(Shard& shard,
+                                                                    const std::string& key) {
+  std::vector<Waiter> waiters;
+  auto pending = shard.pending_.find(key);
+  if (pending != shard.pending_.end()) {
+    waiters = std::move(pending->second);
+    shard.pending_.erase(pending);
+  }
+  return waiters;
+}
+
+void ResponseCache::notifyWaiters(std::vector<Waiter>& waiters,
+                                  CachedResponseConstSharedPtr response) {
+  // Waiters run on their own stream's thread, and never under the shard lock.
+  for (Waiter& waiter : waiters) {
+    WaiterCb cb = waiter.cb_;
+    waiter.dispatcher_.post([cb, response]() -> void { cb(response); });
+  }
+}
+
+void ResponseCache::removeLocked(Shard& shard, std::list<Entry>::iterator it) {
+  const uint64_t size = it->response_->size();
+  shard.size_bytes_ -= size;
+  stats_.entries_.dec();
+  stats_.size_bytes_.sub(size);
+  auto entry = shard.entries_.find(it->key_);
+  std::vector<std::list<Entry>::iterator>& variants = entry->second;
+  variants.erase(std::find(variants.begin(), variants.end(), it));
+  if (variants.empty()) {
+    shard.entries_.erase(entry);
+  }
+  shard.lru_.erase(it);
+}
+
+bool ResponseCache::remove(const std::string& key) {
+  Shard& shard = shardForKey(key);
+  std::lock_guard<std::mutex> lock(shard.lock_);
+  auto entry = shard.entries_.find(key);
+  if (entry == shard.entries_.end()) {
+    return false;
+  }
+  // Copied, since removing the last variant removes the key.
+  const std::vector<std::list<Entry>::iterator> variants = entry->second;
+  for (std::list<Entry>::iterator variant : variants) {
+    removeLocked(shard, variant);
+  }
+  return true;
+}
+
+void ResponseCache::clear() {
+  for (std::unique_ptr<Shard>& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->lock_);
+    while (!shard->lru_.empty()) {
+      removeLocked(*shard, shard->lru_.begin());
+    }
+  }
+}
+
+void ResponseCache::iterate(
+    std::function<void(const std::string& key, const CachedResponse& response)> cb) {
+  for (std::unique_ptr<Shard>& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->lock_);
+    for (const Entry& entry : shard->lru_) {
+      cb(entry.key_, *entry.response_);
+    }
+  }
+}
+
+ResponseCacheFilterConfig::ResponseCacheFilterConfig(const Json::Object& json_config,
+                                                     const std::string& stats_prefix,
+                                                     Stats::Scope& scope,
+                                                     SystemTimeSource& time_source)
+    : time_source_(time_source) {
+  json_config.validateSchema(Json::Schema::RESPONSE_CACHE_HTTP_FILTER_SCHEMA);
+
+  const uint64_t max_size_bytes =
+      static_cast<uint64_t>(json_config.getInteger("max_size_bytes", DEFAULT_MAX_SIZE_BYTES));
+  const uint32_t shards = static_cast<uint32_t>(json_config.getInteger("shards", DEFAULT_SHARDS));
+  max_entry_size_bytes_ = static_cast<uint64_t>(
+      json_config.getInteger("max_entry_size_bytes", DEFAULT_MAX_ENTRY_SIZE_BYTES));
+  max_wait_ =
+      std::chrono::milliseconds(json_config.getInteger("max_wait_ms", DEFAULT_MAX_WAIT_MS));
+  const std::chrono::milliseconds hit_for_pass_ttl(
+      json_config.getInteger("hit_for_pass_ms", DEFAULT_HIT_FOR_PASS_MS));
+  cache_.reset(new ResponseCache(max_size_bytes, shards, hit_for_pass_ttl,
+                                 generateStats(stats_prefix, scope)));
+}
+
+ResponseCacheStats ResponseCacheFilterConfig::generateStats(const std::string& prefix,
+                                                            Stats::Scope& scope) {
+  std::string final_prefix = prefix + "response_cache.";
+  return {ALL_RESPONSE_CACHE_STATS(POOL_COUNTER_PREFIX(scope, final_prefix),
+                                   POOL_GAUGE_PREFIX(scope, final_prefix))};
+}
+
+ResponseCacheFilter::ResponseCacheFilter(ResponseCacheFilterConfigSharedPtr config)
+    : config_(config), self_(std::make_shared<ResponseCacheFilter*>(this)) {}
+
+bool ResponseCacheFilter::parseHttpDate(const std::string& value, SystemTime& time) {
+  struct tm parsed {};
+  const char* end = strptime(value.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &parsed);
+  if (end == nullptr || *end != '\0') {
+    return false;
+  }
+  time = std::chrono::system_clock::from_time_t(timegm(&parsed));
+  return true;
+}
+
+bool ResponseCacheFilter::isCacheable(const HeaderMap& headers, SystemTime now,
+                                      std::chrono::seconds& lifetime, std::chrono::seconds& age) {
+  const uint64_t status = Utility::getResponseStatus(headers);
+  if (status != 200 && status != 203 && status != 301 && status != 404 && status != 410) {
+    return false;
+  }
+
+  // A response that sets a cookie is specific to one client, whatever its cache-control says.
+  if (headers.get(Headers::get().SetCookie) != nullptr ||
+      trim(headerValue(headers, Headers::get().Vary)) == "*") {
+    return false;
+  }
+
+  const auto directives = parseCacheControl(headers.get(Headers::get().CacheControl));
+  const auto& values = Headers::get().CacheControlValues;
+  if (directives.count(values.NoStore) != 0 || directives.count(values.NoCache) != 0 ||
+      directives.count(values.Private) != 0) {
+    return false;
+  }
+
+  SystemTime date = now;
+  const HeaderEntry* date_header = headers.Date();
+  if (date_header != nullptr && !parseHttpDate(date_header->value().c_str(), date)) {
+    date = now;
+  }
+
+  // This is a shared cache, so s-maxage takes precedence over max-age, which takes precedence
+  // over expires. Responses without any of them are not cached, rather than given a heuristic
+  // lifetime.
+  uint64_t seconds;
+  auto max_age = directives.find(values.SMaxAge);
+  if (max_age == directives.end()) {
+    max_age = directives.find(values.MaxAge);
+  }
+  if (max_age != directives.end()) {
+    if (!StringUtil::atoul(max_age->second.c_str(), seconds)) {
+      return false;
+    }
+    lifetime = std::chrono::seconds(seconds);
+  } else {
+    SystemTime expires;
+    const HeaderEntry* expires_header = headers.get(Headers::get().Expires);
+    if (expires_header == nullptr || !parseHttpDate(expires_header->value().c_str(), expires)) {
+      return false;
+    }
+    lifetime = std::chrono::duration_cast<std::chrono::seconds>(expires - date);
+  }
+
+  // The age is the larger of what upstream caches report and how long the response took to get
+  // here. RFC 7234 section 4.2.3.
+  age = std::chrono::seconds(0);
+  const HeaderEntry* age_header = headers.get(Headers::get().Age);
+  if (age_header != nullptr && StringUtil::atoul(age_header->value().c_str(), seconds)) {
+    age = std::chrono::seconds(seconds);
+  }
+  if (now > date) {
+    age = std::max(age, std::chrono::duration_cast<std::chrono::seconds>(now - date));
+  }
+
+  return lifetime > age;
+}
+
+void ResponseCacheFilter::onDestroy() {
+  stream_destroyed_ = true;
+  self_.reset();
+  wait_timer_.reset();
+  if (is_leader_) {
+    abandonInsert();
+  }
+}
+
+FilterHeadersStatus ResponseCacheFilter::decodeHeaders(HeaderMap& headers, bool end_stream) {
+  if (!end_stream || headers.Method() == nullptr ||
+      headers.Method()->value() != Headers::get().MethodValues.Get.c_str() ||
+      headers.Host() == nullptr || headers.Path() == nullptr ||
+      headers.Authorization() != nullptr) {
+    return FilterHeadersStatus::Continue;
+  }
+
+  // A client that asks for a fresh response gets one, and its response is not stored in place of
+  // what other clients are being served.
+  const auto directives = parseCacheControl(headers.get(Headers::get().CacheControl));
+  if (directives.count(Headers::get().CacheControlValues.NoStore) != 0 ||
+      directives.count(Headers::get().CacheControlValues.NoCache) != 0) {
+    config_->stats().bypass_.inc();
+    return FilterHeadersStatus::Continue;
+  }
+
+  request_headers_ = &headers;
+  key_ = headers.ForwardedProto() != nullptr
+             ? std::string(headers.ForwardedProto()->value().c_str()) + "://"
+             : "";
+  key_ += std::string(headers.Host()->value().c_str()) + headers.Path()->value().c_str();
+
+  // The response to a conditional or range request may be a 304, 206 or 412 that can't be cached,
+  // and would make every request for the key pass for a while. So such a request may be served
+  // from the cache or wait on a leader, which answer If-None-Match and If-Modified-Since locally,
+  // but it never leads.
+  const bool may_lead = headers.get(Headers::get().IfNoneMatch) == nullptr &&
+                        headers.get(Headers::get().IfModifiedSince) == nullptr &&
+                        headers.get(Headers::get().IfMatch) == nullptr &&
+                        headers.get(Headers::get().IfUnmodifiedSince) == nullptr &&
+                        headers.get(Headers::get().Range) == nullptr;
+
+  std::weak_ptr<ResponseCacheFilter*> weak_self = self_;
+  ResponseCache::WaiterCb waiter_cb = [weak_self](CachedResponseConstSharedPtr response) -> void {
+    std::shared_ptr<ResponseCacheFilter*> self = weak_self.lock();
+    if (self) {
+      (*self)->onLeaderComplete(response);
+    }
+  };
+
+  CachedResponseConstSharedPtr response;
+  switch (config_->cache()->lookup(key_, headers, config_->timeSource().currentTime(),
+                                   decoder_callbacks_->dispatcher(), waiter_cb, may_lead,
+                                   response)) {
+  case ResponseCache::LookupStatus::Hit:
+    serve(*response);
+    return FilterHeadersStatus::StopIteration;
+  case ResponseCache::LookupStatus::Miss:
+    is_leader_ = true;
+    return FilterHeadersStatus::Continue;
+  case ResponseCache::LookupStatus::Wait:
+    wait_timer_ =
+        decoder_callbacks_->dispatcher().createTimer([this]() -> void { onWaitTimeout(); });
+    wait_timer_->enableTimer(config_->maxWait());
+    waiting_ = true;
+    return FilterHeadersStatus::StopIteration;
+  case ResponseCache::LookupStatus::Pass:
+    return FilterHeadersStatus::Continue;
+  }
+
+  NOT_REACHED;
+}
+
+void ResponseCacheFilter::onLeaderComplete(CachedResponseConstSharedPtr response) {
+  if (!waiting_) {
+    // The stream stopped waiting and went upstream already.
+    return;
+  }
+  waiting_ = false;
+  wait_timer_.reset();
+
+  if (response != nullptr && response->varyMatches(*request_headers_)) {
+    serve(*response);
+  } else {
+    // The leader's response can't be shared, so this stream goes upstream on its own.
+    decoder_callbacks_->continueDecoding();
+  }
+}
+
+void ResponseCacheFilter::onWaitTimeout() {
+  // The leader is slow, so this stream stops waiting on it. The leader's response is ignored if
+  // it comes after all.
+  waiting_ = false;
+  config_->stats().coalesce_timeout_.inc();
+  decoder_callbacks_->continueDecoding();
+}
+
+bool ResponseCacheFilter::conditionsMatch(const CachedResponse& response) const {
+  const HeaderEntry* if_none_match = request_headers_->get(Headers::get().IfNoneMatch);
+  if (if_none_match != nullptr) {
+    const HeaderEntry* etag = response.headers_->get(Headers::get().Etag);
+    if (etag == nullptr) {
+      return false;
+    }
+    const std::string tag = weakTag(etag->value().c_str());
+    for (const std::string& element : StringUtil::split(if_none_match->value().c_str(), ',')) {
+      const std::string candidate = trim(element);
+      if (candidate == "*" || weakTag(candidate) == tag) {
+        return true;
+      }
+    }
+    // If-Modified-Since is ignored when If-None-Match is present. RFC 7232 section 3.3.
+    return false;
+  }
+
+  const HeaderEntry* if_modified_since = request_headers_->get(Headers::get().IfModifiedSince);
+  const HeaderEntry* last_modified = response.headers_->get(Headers::get().LastModified);
+  SystemTime since;
+  SystemTime modified;
+  return if_modified_since != nullptr && last_modified != nullptr &&
+         parseHttpDate(if_modified_since->value().c_str(), since) &&
+         parseHttpDate(last_modified->value().c_str(), modified) && modified <= since;
+}
+
+void ResponseCacheFilter::serve(const CachedResponse& response) {
+  const std::chrono::seconds age =
+      response.initial_age_ + std::chrono::duration_cast<std::chrono::seconds>(
+                                  config_->timeSource().currentTime() - response.response_time_);
+
+  HeaderMapPtr headers;
+  if (conditionsMatch(response)) {
+    headers.reset(new HeaderMapImpl{
+        {Headers::get().Status, std::to_string(enumToInt(Code::NotModified))}});
+    for (const LowerCaseString& key : notModifiedHeaders()) {
+      const HeaderEntry* entry = response.headers_->get(key);
+      if (entry != nullptr) {
+        headers->addCopy(key, entry->value().c_str());
+      }
+    }
+    config_->stats().validated_.inc();
+  } else {
+    headers.reset(new HeaderMapImpl(*response.headers_));
+  }
+  headers->addCopy(Headers::get().Age, std::to_string(age.count()));
+
+  const bool headers_only = headers->Status()->value() == "304" || response.body_.empty();
+  decoder_callbacks_->encodeHeaders(std::move(headers), headers_only);
+  if (!headers_only && !stream_destroyed_) {
+    Buffer::OwnedImpl body(response.body_);
+    decoder_callbacks_->encodeData(body, true);
+  }
+}
+
+FilterHeadersStatus ResponseCacheFilter::encodeHeaders(HeaderMap& headers, bool end_stream) {
+  if (!is_leader_) {
+    return FilterHeadersStatus::Continue;
+  }
+
+  const SystemTime now = config_->timeSource().currentTime();
+  std::chrono::seconds lifetime;
+  std::chrono::seconds age;
+  uint64_t content_length;
+  if (!isCacheable(headers, now, lifetime, age) ||
+      (headers.ContentLength() != nullptr &&
+       (!StringUtil::atoul(headers.ContentLength()->value().c_str(), content_length) ||
+        content_length > config_->maxEntrySizeBytes()))) {
+    notCacheable();
+    return FilterHeadersStatus::Continue;
+  }
+
+  pending_response_.reset(new CachedResponse());
+  pending_response_->headers_.reset(new HeaderMapImpl(headers));
+  // Hop by hop headers and the age are recomputed for each response that is served.
+  pending_response_->headers_->removeConnection();
+  pending_response_->headers_->removeKeepAlive();
+  pending_response_->headers_->removeProxyConnection();
+  pending_response_->headers_->removeTransferEncoding();
+  pending_response_->headers_->remove(Headers::get().Age);
+  const std::string vary = headerValue(headers, Headers::get().Vary);
+  for (const std::string& name : StringUtil::split(vary, ',')) {
+    const LowerCaseString key(trim(name));
+    pending_response_->vary_.emplace_back(key, headerValue(*request_headers_, key));
+  }
+  pending_response_->response_time_ = now;
+  pending_response_->initial_age_ = age;
+  pending_response_->expires_ = now + lifetime - age;
+
+  if (end_stream) {
+    finishInsert();
+  }
+  return FilterHeadersStatus::Continue;
+}
+
+FilterDataStatus ResponseCacheFilter::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (pending_response_ == nullptr) {
+    return FilterDataStatus::Continue;
+  }
+
+  if (pending_response_->body_.size() + data.length() > config_->maxEntrySizeBytes()) {
+    notCacheable();
+    return FilterDataStatus::Continue;
+  }
+
+  uint64_t num_slices = data.getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  data.getRawSlices(slices, num_slices);
+  for (const Buffer::RawSlice& slice : slices) {
+    pending_response_->body_.append(static_cast<const char*>(slice.mem_), slice.len_);
+  }
+
+  if (end_stream) {
+    finishInsert();
+  }
+  return FilterDataStatus::Continue;
+}
+
+FilterTrailersStatus ResponseCacheFilter::encodeTrailers(HeaderMap&) {
+  // Trailers are not cached, so neither is a response that has them.
+  if (is_leader_) {
+    notCacheable();
+  }
+  return FilterTrailersStatus::Continue;
+}
+
+void ResponseCacheFilter::abandonInsert() {
+  pending_response_.reset();
+  if (is_leader_) {
+    is_leader_ = false;
+    config_->cache()->complete(key_, nullptr);
+  }
+}
+
+void ResponseCacheFilter::notCacheable() {
+  config_->stats().not_cacheable_.inc();
+  pending_response_.reset();
+  is_leader_ = false;
+  config_->cache()->pass(key_, config_->timeSource().currentTime());
+}
+
+void ResponseCacheFilter::finishInsert() {
+  ASSERT(is_leader_);
+  pending_response_->headers_->insertContentLength().value(pending_response_->body_.size());
+  is_leader_ = false;
+  config_->cache()->complete(key_, CachedResponseConstSharedPtr{std::move(pending_response_)});
+}
+
+ResponseCacheAdmin::ResponseCacheAdmin(Server::Admin& admin) : admin_(admin) {
+  admin_.addHandler("/cache",
+                    "list cached responses, or purge them all (?purge) or one key (?purge=<key>)",
+                    MAKE_ADMIN_HANDLER(handlerCache), true);
+}
+
+ResponseCacheAdmin::~ResponseCacheAdmin() { admin_.removeHandler("/cache"); }
+
+void ResponseCacheAdmin::addCache(const std::string& name, ResponseCacheSharedPtr cache) {
+  // Caches of listeners that have been drained are gone, so drop them here rather than on removal.
+  caches_.remove_if([](const std::pair<std::string, std::weak_ptr<ResponseCache>>& cache) -> bool {
+    return cache.second.expired();
+  });
+  caches_.emplace_back(name, cache);
+}
+
+Http::Code ResponseCacheAdmin::handlerCache(const std::string& url, Buffer::Instance& response) {
+  const Utility::QueryParams params = Utility::parseQueryString(url);
+  auto purge = params.find("purge");
+  const SystemTime now = ProdSystemTimeSource::instance_.currentTime();
+  for (const auto& named_cache : caches_) {
+    ResponseCacheSharedPtr cache = named_cache.second.lock();
+    if (!cache) {
+      continue;
+    }
+
+    if (purge != params.end()) {
+      if (purge->second.empty()) {
+        cache->clear();
+      } else {
+        cache->remove(purge->second);
+      }
+      continue;
+    }
+
+    response.add(fmt::format("{}: {} entries, {} bytes\n", named_cache.first,
+                             cache->stats().entries_.value(), cache->stats().size_bytes_.value()));
+    cache->iterate([&](const std::string& key, const CachedResponse& cached) -> void {
+      const int64_t ttl =
+          std::chrono::duration_cast<std::chrono::seconds>(cached.expires_ - now).count();
+      response.add(fmt::format("  {}: {} bytes, {}\n", key, cached.size(),
+                               ttl > 0 ? fmt::format("fresh for {}s", ttl) : "stale"));
+    });
+  }
+
+  if (purge != params.end()) {
+    response.add("OK\n");
+  }
+  return Http::Code::OK;
+}
+
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,387 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/http/filter.h"
+#include "envoy/http/header_map.h"
+#include "envoy/json/json_object.h"
+#include "envoy/server/admin.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/logger.h"
+#include "common/http/header_map_impl.h"
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * All stats for the response cache filter. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_RESPONSE_CACHE_STATS(COUNTER, GAUGE)                                                   \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(validated)                                                                               \
+  COUNTER(coalesced)                                                                               \
+  COUNTER(coalesce_timeout)                                                                        \
+  COUNTER(pass)                                                                                    \
+  COUNTER(bypass)                                                                                  \
+  COUNTER(not_cacheable)                                                                           \
+  COUNTER(insert)                                                                                  \
+  COUNTER(eviction)                                                                                \
+  GAUGE  (entries)                                                                                 \
+  GAUGE  (size_bytes)
+// clang-format on
+
+/**
+ * Wrapper struct for response cache stats. @see stats_macros.h
+ */
+struct ResponseCacheStats {
+  ALL_RESPONSE_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * A complete response held by the cache. It is immutable once inserted, so it can be shared by
+ * streams on any thread.
+ */
+struct CachedResponse {
+  /**
+   * @param request_headers supplies the headers of a request.
+   * @return bool whether the request has the same values as the request that this response was
+   *         cached for, for every header that the response varies on.
+   */
+  bool varyMatches(const HeaderMap& request_headers) const;
+
+  /**
+   * @param other supplies another response for the same key.
+   * @return bool whether the other response was cached for the same values of the request headers
+   *         that this response varies on, so that it replaces this one.
+   */
+  bool sameVariant(const CachedResponse& other) const { return vary_ == other.vary_; }
+
+  /**
+   * @return uint64_t the number of bytes that the response is charged for in the cache.
+   */
+  uint64_t size() const { return headers_->byteSize() + body_.size(); }
+
+  // Response headers, without age.
+  HeaderMapPtr headers_;
+  std::string body_;
+  // The request header values that the response varies on, by header name.
+  std::vector<std::pair<LowerCaseString, std::string>> vary_;
+  // When the response was received, and its age at that point.
+  SystemTime response_time_;
+  std::chrono::seconds initial_age_;
+  // When the response stops being fresh.
+  SystemTime expires_;
+};
+
+typedef std::shared_ptr<const CachedResponse> CachedResponseConstSharedPtr;
+
+/**
+ * A size bounded LRU cache of responses, shared by all worker threads. Keys are spread over
+ * shards, each with its own lock and an equal share of the size limit, so workers rarely contend.
+ * A key holds a response for each set of values of the request headers that its responses vary on,
+ * up to a few per key.
+ *
+ * The cache also coalesces misses: while one stream (the leader) fetches a key from upstream, other
+ * streams that miss on the same key wait for it instead of going upstream themselves. A key whose
+ * response could not be cached is remembered for a while (hit for pass), and streams that miss on
+ * it in that time go upstream straight away, rather than being serialized behind a leader whose
+ * response they won't be able to use.
+ */
+class ResponseCache : Logger::Loggable<Logger::Id::filter> {
+public:
+  /**
+   * Called on the waiting stream's dispatcher when the leader finishes. The response is null if
+   * the leader's response could not be cached.
+   */
+  typedef std::function<void(CachedResponseConstSharedPtr)> WaiterCb;
+
+  ResponseCache(uint64_t max_size_bytes, uint32_t shard_count,
+                std::chrono::milliseconds hit_for_pass_ttl, ResponseCacheStats stats);
+
+  enum class LookupStatus {
+    // A fresh response was found.
+    Hit,
+    // No fresh response was found, and the caller is the leader. It must call complete() or pass()
+    // for the key once its response is known.
+    Miss,
+    // No fresh response was found, but another stream is fetching the key. The callback will be
+    // invoked when it is done.
+    Wait,
+    // No fresh response was found, and either the key's last response could not be cached or the
+    // caller may not lead. The caller goes upstream without being the leader.
+    Pass
+  };
+
+  /**
+   * Look up a response.
+   * @param key supplies the cache key.
+   * @param request_headers supplies the headers of the request, for vary.
+   * @param now supplies the current time.
+   * @param dispatcher supplies the dispatcher of the calling stream.
+   * @param waiter_cb supplies the callback to invoke if the lookup returns Wait.
+   * @param may_lead supplies whether the caller may become the leader. If not, a lookup that would
+   *        make it the leader returns Pass instead.
+   * @param response receives the response on a hit.
+   * @return LookupStatus the result.
+   */
+  LookupStatus lookup(const std::string& key, const HeaderMap& request_headers, SystemTime now,
+                      Event::Dispatcher& dispatcher, WaiterCb waiter_cb, bool may_lead,
+                      CachedResponseConstSharedPtr& response);
+
+  /**
+   * Finish a miss. The response, if any, is inserted in place of the key's response for the same
+   * variant, and every stream waiting on the key is given it.
+   * @param key supplies the cache key that the caller was the leader for.
+   * @param response supplies the response to cache, or null if it can't be cached.
+   */
+  void complete(const std::string& key, CachedResponseConstSharedPtr response);
+
+  /**
+   * Finish a miss whose response can't be cached. Every stream waiting on the key goes upstream,
+   * and so do streams that miss on the key before the hit for pass TTL is up.
+   * @param key supplies the cache key that the caller was the leader for.
+   * @param now supplies the current time.
+   */
+  void pass(const std::string& key, SystemTime now);
+
+  /**
+   * Remove the responses for a key.
+   * @return bool whether there was a response for the key.
+   */
+  bool remove(const std::string& key);
+
+  /**
+   * Remove every response.
+   */
+  void clear();
+
+  /**
+   * Invoke a callback for every cached response, most recently used first within each shard.
+   */
+  void iterate(std::function<void(const std::string& key, const CachedResponse& response)> cb);
+
+  ResponseCacheStats& stats() { return stats_; }
+
+private:
+  struct Waiter {
+    Event::Dispatcher& dispatcher_;
+    WaiterCb cb_;
+  };
+
+  struct Entry {
+    std::string key_;
+    CachedResponseConstSharedPtr response_;
+  };
+
+  struct Shard {
+    std::mutex lock_;
+    // Most recently used first.
+    std::list<Entry> lru_;
+    // The variants of each key.
+    std::unordered_map<std::string, std::vector<std::list<Entry>::iterator>> entries_;
+    uint64_t size_bytes_{};
+    // Streams waiting on a leader, by key. A key is present while its leader is fetching it.
+    std::unordered_map<std::string, std::vector<Waiter>> pending_;
+    // Keys whose last response could not be cached, and when that stops being assumed.
+    std::unordered_map<std::string, SystemTime> pass_;
+  };
+
+  Shard& shardForKey(const std::string& key);
+
+  /**
+   * Remove an entry from a shard. The shard's lock must be held.
+   */
+  void removeLocked(Shard& shard, std::list<Entry>::iterator it);
+
+  /**
+   * Remove a key from a shard's pending keys. The shard's lock must be held.
+   * @return the streams that were waiting on the key.
+   */
+  std::vector<Waiter> takeWaitersLocked(Shard& shard, const std::string& key);
+
+  /**
+   * Hand a leader's response to the streams that waited on it. No shard lock may be held.
+   */
+  void notifyWaiters(std::vector<Waiter>& waiters, CachedResponseConstSharedPtr response);
+
+  // The most keys that each shard remembers as not cacheable.
+  static const size_t MAX_PASS_KEYS_PER_SHARD = 1024;
+  // The most variants kept per key. Inserting another evicts the key's least recently used one.
+  static const size_t MAX_VARIANTS_PER_KEY = 8;
+
+  const uint64_t max_shard_size_bytes_;
+  const std::chrono::milliseconds hit_for_pass_ttl_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  ResponseCacheStats stats_;
+};
+
+typedef std::shared_ptr<ResponseCache> ResponseCacheSharedPtr;
+
+/**
+ * Configuration for the response cache filter.
+ */
+class ResponseCacheFilterConfig {
+public:
+  ResponseCacheFilterConfig(const Json::Object& json_config, const std::string& stats_prefix,
+                            Stats::Scope& scope, SystemTimeSource& time_source);
+
+  const ResponseCacheSharedPtr& cache() { return cache_; }
+  ResponseCacheStats& stats() { return cache_->stats(); }
+  uint64_t maxEntrySizeBytes() const { return max_entry_size_bytes_; }
+  const std::chrono::milliseconds& maxWait() const { return max_wait_; }
+  SystemTimeSource& timeSource() { return time_source_; }
+
+private:
+  static ResponseCacheStats generateStats(const std::string& prefix, Stats::Scope& scope);
+
+  ResponseCacheSharedPtr cache_;
+  uint64_t max_entry_size_bytes_;
+  std::chrono::milliseconds max_wait_;
+  SystemTimeSource& time_source_;
+};
+
+typedef std::shared_ptr<ResponseCacheFilterConfig> ResponseCacheFilterConfigSharedPtr;
+
+/**
+ * A filter that serves GET requests from an in memory cache of responses, and caches the responses
+ * that it can. @see docs/configuration/http_filters/response_cache_filter.rst
+ */
+class ResponseCacheFilter : public StreamFilter, Logger::Loggable<Logger::Id::filter> {
+public:
+  ResponseCacheFilter(ResponseCacheFilterConfigSharedPtr config);
+
+  /**
+   * Work out how long a response may be served from the cache.
+   * @param headers supplies the response headers.
+   * @param now supplies the time that the response was received.
+   * @param lifetime receives how long the response is fresh for from when it was generated.
+   * @param age receives how old the response already was when it was received.
+   * @return bool whether the response may be cached at all.
+   */
+  static bool isCacheable(const HeaderMap& headers, SystemTime now, std::chrono::seconds& lifetime,
+                          std::chrono::seconds& age);
+
+  /**
+   * Parse an HTTP date, in the preferred IMF-fixdate format.
+   * @param value supplies the header value.
+   * @param time receives the time.
+   * @return bool whether the value was a valid date.
+   */
+  static bool parseHttpDate(const std::string& value, SystemTime& time);
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  FilterHeadersStatus decodeHeaders(HeaderMap& headers, bool end_stream) override;
+  FilterDataStatus decodeData(Buffer::Instance&, bool) override {
+    return FilterDataStatus::Continue;
+  }
+  FilterTrailersStatus decodeTrailers(HeaderMap&) override {
+    return FilterTrailersStatus::Continue;
+  }
+  void setDecoderFilterCallbacks(StreamDecoderFilterCallbacks& callbacks) override {
+    decoder_callbacks_ = &callbacks;
+  }
+
+  // Http::StreamEncoderFilter
+  FilterHeadersStatus encodeHeaders(HeaderMap& headers, bool end_stream) override;
+  FilterDataStatus encodeData(Buffer::Instance& data, bool end_stream) override;
+  FilterTrailersStatus encodeTrailers(HeaderMap& trailers) override;
+  void setEncoderFilterCallbacks(StreamEncoderFilterCallbacks&) override {}
+
+private:
+  /**
+   * Called when the leader that this stream waited on is done.
+   */
+  void onLeaderComplete(CachedResponseConstSharedPtr response);
+
+  /**
+   * Called when this stream has waited on a leader for too long. It goes upstream on its own.
+   */
+  void onWaitTimeout();
+
+  /**
+   * Respond from the cache, with a 304 if the request's conditions allow it.
+   */
+  void serve(const CachedResponse& response);
+
+  /**
+   * @return bool whether a conditional request's validators match the cached response, so that a
+   *         304 may be sent instead of the response.
+   */
+  bool conditionsMatch(const CachedResponse& response) const;
+
+  /**
+   * Give up on caching the response, and let any waiting streams go upstream themselves.
+   */
+  void abandonInsert();
+
+  /**
+   * Give up on caching a response that can't be cached. Waiting streams go upstream themselves,
+   * and so do streams for the same key for the hit for pass TTL.
+   */
+  void notCacheable();
+
+  /**
+   * Hand the finished response to the cache.
+   */
+  void finishInsert();
+
+  ResponseCacheFilterConfigSharedPtr config_;
+  StreamDecoderFilterCallbacks* decoder_callbacks_{};
+  HeaderMap* request_headers_{};
+  std::string key_;
+  // Set while this stream is the leader for key_ and has not called ResponseCache::complete().
+  bool is_leader_{};
+  // Set while this stream waits on a leader, which it does for at most the configured time.
+  bool waiting_{};
+  Event::TimerPtr wait_timer_;
+  // Set while a response is being copied for the cache.
+  std::unique_ptr<CachedResponse> pending_response_;
+  // Waiter callbacks hold a weak reference, so that they do nothing once the stream is gone.
+  std::shared_ptr<ResponseCacheFilter*> self_;
+  bool stream_destroyed_{};
+};
+
+/**
+ * Admin endpoint for all response caches. It lists cached responses and purges them. There is one
+ * per server, shared through the singleton manager.
+ */
+class ResponseCacheAdmin : public Singleton::Instance {
+public:
+  ResponseCacheAdmin(Server::Admin& admin);
+  ~ResponseCacheAdmin();
+
+  /**
+   * Make a cache visible to the admin endpoint for as long as it exists.
+   * @param name supplies the name to show the cache under.
+   * @param cache supplies the cache.
+   */
+  void addCache(const std::string& name, ResponseCacheSharedPtr cache);
+
+  Http::Code handlerCache(const std::string& url, Buffer::Instance& response);
+
+private:
+  Server::Admin& admin_;
+  std::list<std::pair<std::string, std::weak_ptr<ResponseCache>>> caches_;
+};
+
+} // namespace Http
+} // namespace Envoy
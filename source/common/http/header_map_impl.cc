@@ -1,7 +1,8 @@
 #include "common/http/header_map_impl.h"
 
+#include <algorithm>
 #include <cstdint>
-#include <list>
+#include <cstring>
 #include <string>
 
 #include "common/common/assert.h"
@@ -212,8 +213,96 @@ void HeaderMapImpl::HeaderEntryImpl::value(const HeaderEntry& header) {
   value(header.value().c_str(), header.value().size());
 }
 
+const size_t HeaderMapImpl::HeaderEntryList::MIN_BLOCK_ENTRIES;
+
+HeaderMapImpl::HeaderEntryList& HeaderMapImpl::HeaderEntryList::
+operator=(HeaderEntryList&& rhs) noexcept {
+  if (this == &rhs) {
+    return *this;
+  }
+
+  clear();
+  head_ = rhs.head_;
+  tail_ = rhs.tail_;
+  size_ = rhs.size_;
+  blocks_ = rhs.blocks_;
+  capacity_ = rhs.capacity_;
+  free_slots_ = rhs.free_slots_;
+  rhs.head_ = rhs.tail_ = nullptr;
+  rhs.size_ = rhs.capacity_ = 0;
+  rhs.blocks_ = nullptr;
+  rhs.free_slots_ = nullptr;
+  return *this;
+}
+
+void HeaderMapImpl::HeaderEntryList::erase(HeaderEntryImpl& entry) {
+  if (entry.prev_ != nullptr) {
+    entry.prev_->next_ = entry.next_;
+  } else {
+    head_ = entry.next_;
+  }
+  if (entry.next_ != nullptr) {
+    entry.next_->prev_ = entry.prev_;
+  } else {
+    tail_ = entry.prev_;
+  }
+  size_--;
+
+  entry.~HeaderEntryImpl();
+  Slot* slot = reinterpret_cast<Slot*>(&entry);
+  *reinterpret_cast<Slot**>(slot) = free_slots_;
+  free_slots_ = slot;
+}
+
+void HeaderMapImpl::HeaderEntryList::reserve(size_t size) {
+  if (blocks_ == nullptr) {
+    addBlock(std::max(MIN_BLOCK_ENTRIES, size));
+  }
+}
+
+HeaderMapImpl::HeaderEntryList::Slot* HeaderMapImpl::HeaderEntryList::allocateSlot() {
+  if (free_slots_ != nullptr) {
+    Slot* slot = free_slots_;
+    free_slots_ = *reinterpret_cast<Slot**>(slot);
+    return slot;
+  }
+
+  if (blocks_ == nullptr || blocks_->used_ == blocks_->capacity_) {
+    addBlock(std::max(MIN_BLOCK_ENTRIES, capacity_));
+  }
+  return &blocks_->slots()[blocks_->used_++];
+}
+
+void HeaderMapImpl::HeaderEntryList::addBlock(size_t capacity) {
+  Block* block = static_cast<Block*>(::operator new(sizeof(Block) + capacity * sizeof(Slot)));
+  block->next_ = blocks_;
+  block->capacity_ = capacity;
+  block->used_ = 0;
+  blocks_ = block;
+  capacity_ += capacity;
+}
+
+void HeaderMapImpl::HeaderEntryList::clear() {
+  HeaderEntryImpl* entry = head_;
+  while (entry != nullptr) {
+    HeaderEntryImpl* next = entry->next_;
+    entry->~HeaderEntryImpl();
+    entry = next;
+  }
+
+  while (blocks_ != nullptr) {
+    Block* next = blocks_->next_;
+    ::operator delete(blocks_);
+    blocks_ = next;
+  }
+
+  head_ = tail_ = nullptr;
+  size_ = capacity_ = 0;
+  free_slots_ = nullptr;
+}
+
 #define INLINE_HEADER_STATIC_MAP_ENTRY(name)                                                       \
-  add(Headers::get().name.get().c_str(), [](HeaderMapImpl& h) -> StaticLookupResponse {            \
+  add(Headers::get().name, [](HeaderMapImpl& h) -> StaticLookupResponse {                          \
     return {&h.inline_headers_.name##_, &Headers::get().name};                                     \
   });
 
@@ -221,43 +310,64 @@ HeaderMapImpl::StaticLookupTable::StaticLookupTable() {
   ALL_INLINE_HEADERS(INLINE_HEADER_STATIC_MAP_ENTRY)
 
   // Special case where we map a legacy host header to :authority.
-  add(Headers::get().HostLegacy.get().c_str(), [](HeaderMapImpl& h) -> StaticLookupResponse {
+  add(Headers::get().HostLegacy, [](HeaderMapImpl& h) -> StaticLookupResponse {
     return {&h.inline_headers_.Host_, &Headers::get().Host};
   });
-}
 
-void HeaderMapImpl::StaticLookupTable::add(const char* key, StaticLookupEntry::EntryCb cb) {
-  StaticLookupEntry* current = &root_;
-  while (uint8_t c = *key) {
-    if (!current->entries_[c]) {
-      current->entries_[c].reset(new StaticLookupEntry());
-    }
+  ASSERT(num_entries_ == NUM_ENTRIES);
+  uint32_t seed = 0;
+  while (!build(seed)) {
+    seed++;
+    RELEASE_ASSERT(seed < 1000);
+  }
+}
 
-    current = current->entries_[c].get();
-    key++;
+size_t HeaderMapImpl::StaticLookupTable::slot(const char* key, size_t size, uint32_t seed) {
+  // Seeded FNV-1a, folded so that the high bits of the hash affect the slot.
+  uint32_t hash = 2166136261U ^ seed;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ static_cast<uint8_t>(key[i])) * 16777619U;
   }
+  return (hash ^ (hash >> 16)) & (NUM_SLOTS - 1);
+}
 
-  current->cb_ = cb;
+void HeaderMapImpl::StaticLookupTable::add(const LowerCaseString& key, StaticLookupCb cb) {
+  entries_[num_entries_++] = {&key.get(), cb};
 }
 
-HeaderMapImpl::StaticLookupEntry::EntryCb
-HeaderMapImpl::StaticLookupTable::find(const char* key) const {
-  const StaticLookupEntry* current = &root_;
-  while (uint8_t c = *key) {
-    current = current->entries_[c].get();
-    if (current) {
-      key++;
-    } else {
-      return nullptr;
+bool HeaderMapImpl::StaticLookupTable::build(uint32_t seed) {
+  slots_.fill(0);
+  for (size_t i = 0; i < num_entries_; i++) {
+    uint8_t& index = slots_[slot(entries_[i].key_->c_str(), entries_[i].key_->size(), seed)];
+    if (index != 0) {
+      return false;
     }
+    index = i + 1;
   }
 
-  return current->cb_;
+  seed_ = seed;
+  return true;
+}
+
+HeaderMapImpl::StaticLookupCb HeaderMapImpl::StaticLookupTable::find(const char* key,
+                                                                    size_t size) const {
+  const uint8_t index = slots_[slot(key, size, seed_)];
+  if (index == 0) {
+    return nullptr;
+  }
+
+  const Entry& entry = entries_[index - 1];
+  if (entry.key_->size() != size || memcmp(entry.key_->c_str(), key, size) != 0) {
+    return nullptr;
+  }
+
+  return entry.cb_;
 }
 
 HeaderMapImpl::HeaderMapImpl() { memset(&inline_headers_, 0, sizeof(inline_headers_)); }
 
 HeaderMapImpl::HeaderMapImpl(const HeaderMap& rhs) : HeaderMapImpl() {
+  headers_.reserve(rhs.size());
   rhs.iterate(
       [](const HeaderEntry& header, void* context) -> void {
         // TODO(mattklein123) PERF: Avoid copying here is not necessary.
@@ -275,6 +385,7 @@ HeaderMapImpl::HeaderMapImpl(const HeaderMap& rhs) : HeaderMapImpl() {
 HeaderMapImpl::HeaderMapImpl(
     const std::initializer_list<std::pair<LowerCaseString, std::string>>& values)
     : HeaderMapImpl() {
+  headers_.reserve(values.size());
   for (auto& value : values) {
     HeaderString key_string;
     key_string.setCopy(value.first.get().c_str(), value.first.get().size());
@@ -284,12 +395,29 @@ HeaderMapImpl::HeaderMapImpl(
   }
 }
 
+HeaderMapImpl::HeaderMapImpl(HeaderMapImpl&& rhs) noexcept
+    : inline_headers_(rhs.inline_headers_), headers_(std::move(rhs.headers_)) {
+  memset(&rhs.inline_headers_, 0, sizeof(rhs.inline_headers_));
+}
+
+HeaderMapImpl& HeaderMapImpl::operator=(HeaderMapImpl&& rhs) noexcept {
+  if (this != &rhs) {
+    // Entries do not move, so the inline header pointers remain valid.
+    headers_ = std::move(rhs.headers_);
+    inline_headers_ = rhs.inline_headers_;
+    memset(&rhs.inline_headers_, 0, sizeof(rhs.inline_headers_));
+  }
+
+  return *this;
+}
+
 bool HeaderMapImpl::operator==(const HeaderMapImpl& rhs) const {
   if (size() != rhs.size()) {
     return false;
   }
 
-  for (auto i = headers_.begin(), j = rhs.headers_.begin(); i != headers_.end(); ++i, ++j) {
+  for (const HeaderEntryImpl *i = headers_.front(), *j = rhs.headers_.front(); i != nullptr;
+       i = i->next_, j = j->next_) {
     if (i->key() != j->key().c_str() || i->value() != j->value().c_str()) {
       return false;
     }
@@ -299,7 +427,7 @@ bool HeaderMapImpl::operator==(const HeaderMapImpl& rhs) const {
 }
 
 void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.c_str());
+  StaticLookupCb cb = ConstSingleton<StaticLookupTable>::get().find(key.c_str(), key.size());
   if (cb) {
     // TODO(mattklein123): Currently, for all of the inline headers, we don't support appending. The
     // only inline header where we should be converting multiple headers into a comma delimited
@@ -310,9 +438,7 @@ void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
     StaticLookupResponse ref_lookup_response = cb(*this);
     maybeCreateInline(ref_lookup_response.entry_, *ref_lookup_response.key_, std::move(value));
   } else {
-    std::list<HeaderEntryImpl>::iterator i =
-        headers_.emplace(headers_.end(), std::move(key), std::move(value));
-    i->entry_ = i;
+    headers_.emplaceBack(std::move(key), std::move(value));
   }
 }
 
@@ -364,18 +490,20 @@ void HeaderMapImpl::addCopy(const LowerCaseString& key, const std::string& value
 
 uint64_t HeaderMapImpl::byteSize() const {
   uint64_t byte_size = 0;
-  for (const HeaderEntryImpl& header : headers_) {
-    byte_size += header.key().size();
-    byte_size += header.value().size();
+  for (const HeaderEntryImpl* header = headers_.front(); header != nullptr;
+       header = header->next_) {
+    byte_size += header->key().size();
+    byte_size += header->value().size();
   }
 
   return byte_size;
 }
 
 const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    if (header.key() == key.get().c_str()) {
-      return &header;
+  for (const HeaderEntryImpl* header = headers_.front(); header != nullptr;
+       header = header->next_) {
+    if (header->key() == key.get().c_str()) {
+      return header;
     }
   }
 
@@ -383,23 +511,26 @@ const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const {
 }
 
 void HeaderMapImpl::iterate(ConstIterateCb cb, void* context) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    cb(header, context);
+  for (const HeaderEntryImpl* header = headers_.front(); header != nullptr;
+       header = header->next_) {
+    cb(*header, context);
   }
 }
 
 void HeaderMapImpl::remove(const LowerCaseString& key) {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get().c_str());
+  StaticLookupCb cb =
+      ConstSingleton<StaticLookupTable>::get().find(key.get().c_str(), key.get().size());
   if (cb) {
     StaticLookupResponse ref_lookup_response = cb(*this);
     removeInline(ref_lookup_response.entry_);
   } else {
-    for (auto i = headers_.begin(); i != headers_.end();) {
-      if (i->key() == key.get().c_str()) {
-        i = headers_.erase(i);
-      } else {
-        ++i;
+    HeaderEntryImpl* header = headers_.front();
+    while (header != nullptr) {
+      HeaderEntryImpl* next = header->next_;
+      if (header->key() == key.get().c_str()) {
+        headers_.erase(*header);
       }
+      header = next;
     }
   }
 }
@@ -410,9 +541,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.emplace(headers_.end(), key);
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = &headers_.emplaceBack(key);
   return **entry;
 }
 
@@ -424,9 +553,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.emplace(headers_.end(), key, std::move(value));
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = &headers_.emplaceBack(key, std::move(value));
   return **entry;
 }
 
@@ -437,7 +564,7 @@ void HeaderMapImpl::removeInline(HeaderEntryImpl** ptr_to_entry) {
 
   HeaderEntryImpl* entry = *ptr_to_entry;
   *ptr_to_entry = nullptr;
-  headers_.erase(entry->entry_);
+  headers_.erase(*entry);
 }
 
 } // namespace Http
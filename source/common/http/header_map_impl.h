@@ -2,9 +2,11 @@
 
 #include <array>
 #include <cstdint>
-#include <list>
 #include <memory>
+#include <new>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 #include "envoy/http/header_map.h"
 
@@ -33,13 +35,16 @@ public:
  * headers are added to the map, we do a hash lookup to see if it's one of the O(1) headers.
  * If it is, we store a reference to it that can be accessed later directly. Most high performance
  * paths use O(1) direct access. In general, we try to copy as little as possible and allocate as
- * little as possible in any of the paths.
+ * little as possible in any of the paths. Entries are allocated in blocks rather than one at a time,
+ * see HeaderEntryList.
  */
 class HeaderMapImpl : public HeaderMap {
 public:
   HeaderMapImpl();
   HeaderMapImpl(const std::initializer_list<std::pair<LowerCaseString, std::string>>& values);
   HeaderMapImpl(const HeaderMap& rhs);
+  HeaderMapImpl(HeaderMapImpl&& rhs) noexcept;
+  HeaderMapImpl& operator=(HeaderMapImpl&& rhs) noexcept;
 
   /**
    * Add a header via full move. This is the expected high performance paths for codecs populating
@@ -83,7 +88,86 @@ protected:
 
     HeaderString key_;
     HeaderString value_;
-    std::list<HeaderEntryImpl>::iterator entry_;
+    HeaderEntryImpl* prev_{};
+    HeaderEntryImpl* next_{};
+  };
+
+  /**
+   * The entries of a map in insertion order. Entries are constructed in blocks of slots that are
+   * allocated as the map grows, so a map with a typical number of headers makes a few allocations
+   * rather than one per header, and its entries (including the key and value bytes that their
+   * HeaderStrings hold inline) sit close together in memory. Entries never move, so pointers to
+   * them, such as the O(1) inline header pointers, stay valid until they are removed. The slots of
+   * removed entries are reused.
+   */
+  class HeaderEntryList : NonCopyable {
+  public:
+    HeaderEntryList() {}
+    HeaderEntryList(HeaderEntryList&& rhs) noexcept { *this = std::move(rhs); }
+    ~HeaderEntryList() { clear(); }
+
+    HeaderEntryList& operator=(HeaderEntryList&& rhs) noexcept;
+
+    /**
+     * Construct an entry at the end of the list.
+     */
+    template <class... Args> HeaderEntryImpl& emplaceBack(Args&&... args) {
+      HeaderEntryImpl* entry = new (allocateSlot()) HeaderEntryImpl(std::forward<Args>(args)...);
+      entry->prev_ = tail_;
+      if (tail_ != nullptr) {
+        tail_->next_ = entry;
+      } else {
+        head_ = entry;
+      }
+      tail_ = entry;
+      size_++;
+      return *entry;
+    }
+
+    /**
+     * Destroy an entry of the list.
+     */
+    void erase(HeaderEntryImpl& entry);
+
+    /**
+     * Size the first block of slots for a number of entries, e.g. when copying a map. Has no
+     * effect once entries have been added.
+     */
+    void reserve(size_t size);
+
+    HeaderEntryImpl* front() const { return head_; }
+    size_t size() const { return size_; }
+
+  private:
+    typedef std::aligned_storage<sizeof(HeaderEntryImpl), alignof(HeaderEntryImpl)>::type Slot;
+
+    // A block is allocated with its slots following it.
+    struct Block {
+      Slot* slots() { return reinterpret_cast<Slot*>(this + 1); }
+
+      Block* next_;
+      size_t capacity_;
+      size_t used_;
+    };
+
+    static_assert(sizeof(Block) % alignof(Slot) == 0, "slots must be aligned after a block");
+
+    Slot* allocateSlot();
+    void addBlock(size_t capacity);
+    void clear();
+
+    // The minimum number of entries a block holds. Blocks double the capacity of the list, with
+    // 8 + 8 + 16 slots holding a typical request.
+    static const size_t MIN_BLOCK_ENTRIES = 8;
+
+    HeaderEntryImpl* head_{};
+    HeaderEntryImpl* tail_{};
+    size_t size_{};
+    // The most recently allocated block, which is the only one that can have unused slots.
+    Block* blocks_{};
+    size_t capacity_{};
+    // Slots of removed entries, linked through their first bytes.
+    Slot* free_slots_{};
   };
 
   struct StaticLookupResponse {
@@ -91,23 +175,41 @@ protected:
     const LowerCaseString* key_;
   };
 
-  struct StaticLookupEntry {
-    typedef StaticLookupResponse (*EntryCb)(HeaderMapImpl&);
-
-    EntryCb cb_{};
-    std::array<std::unique_ptr<StaticLookupEntry>, 256> entries_;
-  };
+  typedef StaticLookupResponse (*StaticLookupCb)(HeaderMapImpl&);
 
   /**
    * This is the static lookup table that is used to determine whether a header is one of the O(1)
-   * headers. This uses a trie for lookup time at most equal to the size of the incoming string.
+   * headers. It is a perfect hash over the inline header names: the hash seed is chosen when the
+   * table is built so that no two names share a slot, so a lookup hashes the key once and then
+   * compares it against at most one name.
    */
   struct StaticLookupTable {
     StaticLookupTable();
-    void add(const char* key, StaticLookupEntry::EntryCb cb);
-    StaticLookupEntry::EntryCb find(const char* key) const;
-
-    StaticLookupEntry root_;
+    StaticLookupCb find(const char* key, size_t size) const;
+
+  private:
+    struct Entry {
+      const std::string* key_;
+      StaticLookupCb cb_;
+    };
+
+    static size_t slot(const char* key, size_t size, uint32_t seed);
+    void add(const LowerCaseString& key, StaticLookupCb cb);
+    bool build(uint32_t seed);
+
+#define INLINE_HEADER_COUNT(name) +1
+    // All of the inline headers plus the legacy host header.
+    static const size_t NUM_ENTRIES = 1 ALL_INLINE_HEADERS(INLINE_HEADER_COUNT);
+#undef INLINE_HEADER_COUNT
+    // Slots are 1 byte indexes into entries_, with 0 meaning empty. With ~16 slots per name a
+    // collision free seed is found within the first few tries.
+    static const size_t NUM_SLOTS = 1024;
+    static_assert(NUM_ENTRIES < UINT8_MAX, "too many inline headers for 1 byte slots");
+
+    std::array<Entry, NUM_ENTRIES> entries_;
+    size_t num_entries_{};
+    std::array<uint8_t, NUM_SLOTS> slots_;
+    uint32_t seed_{};
   };
 
   struct AllInlineHeaders {
@@ -121,7 +223,7 @@ protected:
   void removeInline(HeaderEntryImpl** entry);
 
   AllInlineHeaders inline_headers_;
-  std::list<HeaderEntryImpl> headers_;
+  HeaderEntryList headers_;
 
   ALL_INLINE_HEADERS(DEFINE_INLINE_HEADER_FUNCS)
 };
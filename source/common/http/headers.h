@@ -15,6 +15,7 @@ namespace Http {
 class HeaderValues {
 public:
   const LowerCaseString Accept{"accept"};
+  const LowerCaseString AcceptEncoding{"accept-encoding"};
   const LowerCaseString AccessControlRequestHeaders{"access-control-request-headers"};
   const LowerCaseString AccessControlRequestMethod{"access-control-request-method"};
   const LowerCaseString AccessControlAllowOrigin{"access-control-allow-origin"};
@@ -23,9 +24,12 @@ public:
   const LowerCaseString AccessControlExposeHeaders{"access-control-expose-headers"};
   const LowerCaseString AccessControlMaxAge{"access-control-max-age"};
   const LowerCaseString AccessControlAllowCredentials{"access-control-allow-credentials"};
+  const LowerCaseString Age{"age"};
   const LowerCaseString Authorization{"authorization"};
+  const LowerCaseString CacheControl{"cache-control"};
   const LowerCaseString ClientTraceId{"x-client-trace-id"};
   const LowerCaseString Connection{"connection"};
+  const LowerCaseString ContentEncoding{"content-encoding"};
   const LowerCaseString ContentLength{"content-length"};
   const LowerCaseString ContentType{"content-type"};
   const LowerCaseString Cookie{"cookie"};
@@ -51,36 +55,56 @@ public:
   const LowerCaseString EnvoyExpectedRequestTimeoutMs{"x-envoy-expected-rq-timeout-ms"};
   const LowerCaseString EnvoyUpstreamServiceTime{"x-envoy-upstream-service-time"};
   const LowerCaseString EnvoyUpstreamHealthCheckedCluster{"x-envoy-upstream-healthchecked-cluster"};
+  const LowerCaseString Etag{"etag"};
   const LowerCaseString Expect{"expect"};
+  const LowerCaseString Expires{"expires"};
   const LowerCaseString ForwardedClientCert{"x-forwarded-client-cert"};
   const LowerCaseString ForwardedFor{"x-forwarded-for"};
   const LowerCaseString ForwardedProto{"x-forwarded-proto"};
   const LowerCaseString GrpcMessage{"grpc-message"};
   const LowerCaseString GrpcStatus{"grpc-status"};
   const LowerCaseString GrpcAcceptEncoding{"grpc-accept-encoding"};
+  const LowerCaseString GrpcEncoding{"grpc-encoding"};
   const LowerCaseString Host{":authority"};
   const LowerCaseString HostLegacy{"host"};
+  const LowerCaseString IfMatch{"if-match"};
+  const LowerCaseString IfModifiedSince{"if-modified-since"};
+  const LowerCaseString IfNoneMatch{"if-none-match"};
+  const LowerCaseString IfUnmodifiedSince{"if-unmodified-since"};
   const LowerCaseString KeepAlive{"keep-alive"};
+  const LowerCaseString LastModified{"last-modified"};
   const LowerCaseString Location{"location"};
   const LowerCaseString Method{":method"};
   const LowerCaseString Origin{"origin"};
   const LowerCaseString OtSpanContext{"x-ot-span-context"};
   const LowerCaseString Path{":path"};
   const LowerCaseString ProxyConnection{"proxy-connection"};
+  const LowerCaseString Range{"range"};
   const LowerCaseString RequestId{"x-request-id"};
   const LowerCaseString Scheme{":scheme"};
   const LowerCaseString Server{"server"};
+  const LowerCaseString SetCookie{"set-cookie"};
   const LowerCaseString Status{":status"};
   const LowerCaseString TransferEncoding{"transfer-encoding"};
   const LowerCaseString TE{"te"};
   const LowerCaseString Upgrade{"upgrade"};
   const LowerCaseString UserAgent{"user-agent"};
+  const LowerCaseString Vary{"vary"};
   const LowerCaseString XB3TraceId{"x-b3-traceid"};
   const LowerCaseString XB3SpanId{"x-b3-spanid"};
   const LowerCaseString XB3ParentSpanId{"x-b3-parentspanid"};
   const LowerCaseString XB3Sampled{"x-b3-sampled"};
   const LowerCaseString XB3Flags{"x-b3-flags"};
 
+  struct {
+    const std::string MaxAge{"max-age"};
+    const std::string NoCache{"no-cache"};
+    const std::string NoStore{"no-store"};
+    const std::string NoTransform{"no-transform"};
+    const std::string Private{"private"};
+    const std::string SMaxAge{"s-maxage"};
+  } CacheControlValues;
+
   struct {
     const std::string Close{"close"};
     const std::string Upgrade{"upgrade"};
@@ -90,6 +114,11 @@ public:
     const std::string WebSocket{"websocket"};
   } UpgradeValues;
 
+  struct {
+    const std::string Gzip{"gzip"};
+    const std::string Deflate{"deflate"};
+  } ContentEncodingValues;
+
   struct {
     const std::string Text{"text/plain"};
     const std::string Grpc{"application/grpc"};
@@ -134,6 +163,9 @@ public:
     const std::string Head{"HEAD"};
     const std::string Post{"POST"};
     const std::string Options{"OPTIONS"};
+    const std::string Put{"PUT"};
+    const std::string Delete{"DELETE"};
+    const std::string Trace{"TRACE"};
   } MethodValues;
 
   struct {
@@ -153,6 +185,12 @@ public:
     const std::string Default{"identity,deflate,gzip"};
   } GrpcAcceptEncodingValues;
 
+  struct {
+    const std::string Identity{"identity"};
+    const std::string Deflate{"deflate"};
+    const std::string Gzip{"gzip"};
+  } GrpcEncodingValues;
+
   struct {
     const std::string Trailers{"trailers"};
   } TEValues;
@@ -160,6 +198,10 @@ public:
   struct {
     const std::string True{"true"};
   } CORSValues;
+
+  struct {
+    const std::string AcceptEncoding{"Accept-Encoding"};
+  } VaryValues;
 };
 
 typedef ConstSingleton<HeaderValues> Headers;
@@ -8,6 +8,7 @@
 #include "envoy/network/connection.h"
 
 #include "common/common/enum_to_int.h"
+#include "common/common/singleton.h"
 #include "common/common/utility.h"
 #include "common/http/exception.h"
 #include "common/http/headers.h"
@@ -22,10 +23,44 @@ namespace Http1 {
 const std::string StreamEncoderImpl::CRLF = "\r\n";
 const std::string StreamEncoderImpl::LAST_CHUNK = "0\r\n\r\n";
 
+/**
+ * Serialized response status lines ("HTTP/1.1 200 OK\r\n") for every 1xx-5xx status code, so that
+ * encoding a response does not format the code and look up the reason phrase each time.
+ */
+class StatusLineValues {
+public:
+  static const uint64_t MIN_CODE = 100;
+  static const uint64_t MAX_CODE = 599;
+
+  StatusLineValues() {
+    for (uint64_t code = MIN_CODE; code <= MAX_CODE; code++) {
+      lines_[code - MIN_CODE] =
+          fmt::format("HTTP/1.1 {} {}\r\n", code, CodeUtility::toString(static_cast<Code>(code)));
+    }
+  }
+
+  /**
+   * @return const std::string* the status line for a code or nullptr if it is not cached.
+   */
+  const std::string* find(uint64_t code) const {
+    return code >= MIN_CODE && code <= MAX_CODE ? &lines_[code - MIN_CODE] : nullptr;
+  }
+
+private:
+  std::array<std::string, MAX_CODE - MIN_CODE + 1> lines_;
+};
+
+typedef ConstSingleton<StatusLineValues> StatusLines;
+
+uint64_t StreamEncoderImpl::encodedHeadersSize(const HeaderMap& headers) {
+  // Each header line adds ": " and CRLF. Pseudo headers are skipped or renamed to the shorter
+  // "host", so this is an upper bound. The largest framing header and the blank line follow.
+  return headers.byteSize() + headers.size() * 4 + Headers::get().TransferEncoding.get().size() +
+         Headers::get().TransferEncodingValues.Chunked.size() + 6;
+}
+
 void StreamEncoderImpl::encodeHeader(const char* key, uint32_t key_size, const char* value,
                                      uint32_t value_size) {
-
-  connection_.reserveBuffer(key_size + value_size + 4);
   ASSERT(key_size > 0);
 
   connection_.copyToBuffer(key, key_size);
@@ -37,6 +72,10 @@ void StreamEncoderImpl::encodeHeader(const char* key, uint32_t key_size, const c
 }
 
 void StreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_stream) {
+  // The whole header block is written into a single reservation. Callers that write a start line
+  // first have already reserved room for both, in which case this is a no-op.
+  connection_.reserveBuffer(encodedHeadersSize(headers));
+
   bool saw_content_length = false;
   headers.iterate(
       [](const HeaderEntry& header, void* context) -> void {
@@ -83,7 +122,6 @@ void StreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_stream)
     }
   }
 
-  connection_.reserveBuffer(2);
   connection_.addCharToBuffer('\r');
   connection_.addCharToBuffer('\n');
 
@@ -99,7 +137,18 @@ void StreamEncoderImpl::encodeData(Buffer::Instance& data, bool end_stream) {
   // atually write the zero length buffer out.
   if (data.length() > 0) {
     if (chunk_encoding_) {
-      connection_.buffer().add(fmt::format("{:x}\r\n", data.length()));
+      // Format the chunk size backwards from the end of a buffer that fits a 64-bit size in hex.
+      static const char HEX_DIGITS[] = "0123456789abcdef";
+      char chunk_header[sizeof(uint64_t) * 2 + 2];
+      char* start = chunk_header + sizeof(chunk_header) - 2;
+      start[0] = '\r';
+      start[1] = '\n';
+      uint64_t length = data.length();
+      do {
+        *--start = HEX_DIGITS[length & 0xf];
+        length >>= 4;
+      } while (length > 0);
+      connection_.buffer().add(start, chunk_header + sizeof(chunk_header) - start);
     }
 
     connection_.buffer().move(data);
@@ -187,23 +236,71 @@ void ResponseStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end
   started_response_ = true;
   uint64_t numeric_status = Utility::getResponseStatus(headers);
 
-  connection_.reserveBuffer(4096);
-  connection_.copyToBuffer(RESPONSE_PREFIX, sizeof(RESPONSE_PREFIX) - 1);
-  connection_.addIntToBuffer(numeric_status);
-  connection_.addCharToBuffer(' ');
-
-  const char* status_string = CodeUtility::toString(static_cast<Code>(numeric_status));
-  uint32_t status_string_len = strlen(status_string);
-  connection_.copyToBuffer(status_string, status_string_len);
+  const uint64_t headers_size = encodedHeadersSize(headers);
+  const std::string* status_line = StatusLines::get().find(numeric_status);
+  if (status_line) {
+    connection_.reserveBuffer(status_line->size() + headers_size);
+    connection_.copyToBuffer(status_line->c_str(), status_line->size());
+  } else {
+    const char* status_string = CodeUtility::toString(static_cast<Code>(numeric_status));
+    uint32_t status_string_len = strlen(status_string);
 
-  connection_.addCharToBuffer('\r');
-  connection_.addCharToBuffer('\n');
+    // Room for the prefix, up to 20 digits, a space, the reason phrase and CRLF.
+    connection_.reserveBuffer(sizeof(RESPONSE_PREFIX) + 23 + status_string_len + headers_size);
+    connection_.copyToBuffer(RESPONSE_PREFIX, sizeof(RESPONSE_PREFIX) - 1);
+    connection_.addIntToBuffer(numeric_status);
+    connection_.addCharToBuffer(' ');
+    connection_.copyToBuffer(status_string, status_string_len);
+    connection_.addCharToBuffer('\r');
+    connection_.addCharToBuffer('\n');
+  }
 
   StreamEncoderImpl::encodeHeaders(headers, end_stream);
 }
 
 static const char REQUEST_POSTFIX[] = " HTTP/1.1\r\n";
 
+void RequestStreamEncoderImpl::runConnectionResetCallbacks() {
+  if (!connection_reset_callbacks_run_) {
+    connection_reset_callbacks_run_ = true;
+    runResetCallbacks(connection_reset_reason_.value());
+  }
+}
+
+void RequestStreamEncoderImpl::resetStream(StreamResetReason reason) {
+  // Once the connection has been reset, resetting a request that is still waiting for its reset
+  // callbacks just runs them now.
+  if (connection_reset_reason_.valid()) {
+    runConnectionResetCallbacks();
+  } else {
+    StreamEncoderImpl::resetStream(reason);
+  }
+}
+
+void RequestStreamEncoderImpl::readDisable(bool disable) {
+  if (read_disable_unwound_) {
+    return;
+  }
+
+  if (disable) {
+    read_disable_calls_++;
+  } else {
+    ASSERT(read_disable_calls_ > 0);
+    read_disable_calls_--;
+  }
+  StreamEncoderImpl::readDisable(disable);
+}
+
+void RequestStreamEncoderImpl::unwindReadDisable() {
+  read_disable_unwound_ = true;
+  // A connection that is closing is not read from again.
+  if (connection_.connection().state() == Network::Connection::State::Open) {
+    for (; read_disable_calls_ > 0; read_disable_calls_--) {
+      StreamEncoderImpl::readDisable(false);
+    }
+  }
+}
+
 void RequestStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_stream) {
   const HeaderEntry* method = headers.Method();
   const HeaderEntry* path = headers.Path();
@@ -214,8 +311,10 @@ void RequestStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_
   if (method->value() == Headers::get().MethodValues.Head.c_str()) {
     head_request_ = true;
   }
+  idempotent_ = Utility::isIdempotentMethod(method->value().c_str());
 
-  connection_.reserveBuffer(std::max(4096U, path->value().size() + 4096));
+  connection_.reserveBuffer(method->value().size() + path->value().size() +
+                            sizeof(REQUEST_POSTFIX) + encodedHeadersSize(headers));
   connection_.copyToBuffer(method->value().c_str(), method->value().size());
   connection_.addCharToBuffer(' ');
   connection_.copyToBuffer(path->value().c_str(), path->value().size());
@@ -262,9 +361,11 @@ const ToLowerTable& ConnectionImpl::toLowerTable() {
   return *table;
 }
 
-ConnectionImpl::ConnectionImpl(Network::Connection& connection, http_parser_type type)
-    : connection_(connection), output_buffer_([&]() -> void { this->onBelowLowWatermark(); },
-                                              [&]() -> void { this->onAboveHighWatermark(); }) {
+ConnectionImpl::ConnectionImpl(Network::Connection& connection, http_parser_type type,
+                               bool fast_parser)
+    : connection_(connection), fast_parser_(fast_parser ? new FastParser(type) : nullptr),
+      output_buffer_([&]() -> void { this->onBelowLowWatermark(); },
+                     [&]() -> void { this->onAboveHighWatermark(); }) {
   output_buffer_.setWatermarks(connection.bufferLimit());
   http_parser_init(&parser_, type);
   parser_.data = this;
@@ -307,7 +408,8 @@ void ConnectionImpl::dispatch(Buffer::Instance& data) {
 }
 
 size_t ConnectionImpl::dispatchSlice(const char* slice, size_t len) {
-  ssize_t rc = http_parser_execute(&parser_, &settings_, slice, len);
+  ssize_t rc = fast_parser_ ? fast_parser_->execute(parser_, settings_, slice, len)
+                            : http_parser_execute(&parser_, &settings_, slice, len);
   if (HTTP_PARSER_ERRNO(&parser_) != HPE_OK && HTTP_PARSER_ERRNO(&parser_) != HPE_PAUSED) {
     sendProtocolError();
     throw CodecProtocolException("http/1.1 protocol error: " +
@@ -371,7 +473,8 @@ void ConnectionImpl::onResetStreamBase(StreamResetReason reason) {
 ServerConnectionImpl::ServerConnectionImpl(Network::Connection& connection,
                                            ServerConnectionCallbacks& callbacks,
                                            Http1Settings settings)
-    : ConnectionImpl(connection, HTTP_REQUEST), callbacks_(callbacks), codec_settings_(settings) {}
+    : ConnectionImpl(connection, HTTP_REQUEST, settings.fast_parser_), callbacks_(callbacks),
+      codec_settings_(settings) {}
 
 void ServerConnectionImpl::onEncodeComplete() {
   ASSERT(active_request_);
@@ -479,7 +582,8 @@ int ServerConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
     if (headers->Expect() &&
         0 == StringUtil::caseInsensitiveCompare(headers->Expect()->value().c_str(),
                                                 Headers::get().ExpectValues._100Continue.c_str())) {
-      Buffer::OwnedImpl continue_response("HTTP/1.1 100 Continue\r\n\r\n");
+      Buffer::OwnedImpl continue_response;
+      continue_response.addBufferFragment(continueResponseFragment());
       connection_.write(continue_response);
       headers->removeExpect();
     }
@@ -558,6 +662,15 @@ void ServerConnectionImpl::onResetStream(StreamResetReason reason) {
   active_request_.reset();
 }
 
+Buffer::BufferFragment& ServerConnectionImpl::continueResponseFragment() {
+  // The response never changes, so it is referenced by the write buffer instead of being copied.
+  // The fragment is intentionally leaked so that it outlives any buffer still referencing it.
+  static const char CONTINUE_RESPONSE[] = "HTTP/1.1 100 Continue\r\n\r\n";
+  static Buffer::BufferFragmentImpl* fragment =
+      new Buffer::BufferFragmentImpl(CONTINUE_RESPONSE, sizeof(CONTINUE_RESPONSE) - 1, nullptr);
+  return *fragment;
+}
+
 void ServerConnectionImpl::sendProtocolError() {
   // We do this here because we may get a protocol error before we have a logical stream. Higher
   // layers can only operate on streams, so there is no coherent way to allow them to send an error
@@ -584,10 +697,10 @@ void ServerConnectionImpl::onBelowLowWatermark() {
 }
 
 ClientConnectionImpl::ClientConnectionImpl(Network::Connection& connection, ConnectionCallbacks&)
-    : ConnectionImpl(connection, HTTP_RESPONSE) {}
+    : ConnectionImpl(connection, HTTP_RESPONSE, false) {}
 
 bool ClientConnectionImpl::cannotHaveBody() {
-  if ((!pending_responses_.empty() && pending_responses_.front().head_request_) ||
+  if ((!pending_responses_.empty() && pending_responses_.front().encoder_.headRequest()) ||
       parser_.status_code == 204 || parser_.status_code == 304) {
     return true;
   } else {
@@ -599,22 +712,11 @@ StreamEncoder& ClientConnectionImpl::newStream(StreamDecoder& response_decoder)
   if (resetStreamCalled()) {
     throw CodecClientException("cannot create new streams after calling reset");
   }
-  // Streams are responsible for unwinding any outstanding readDisable(true)
-  // calls done on the underlying connection as they are destroyed. As this is
-  // the only place a HTTP/1 stream is destroyed where the Network::Connection is
-  // reused, unwind any outstanding readDisable() calls here.
-  while (!connection_.readEnabled()) {
-    connection_.readDisable(false);
-  }
-  request_encoder_.reset(new RequestStreamEncoderImpl(*this));
-  pending_responses_.emplace_back(&response_decoder);
-  return *request_encoder_;
+  pending_responses_.emplace_back(*this, &response_decoder);
+  return pending_responses_.back().encoder_;
 }
 
-void ClientConnectionImpl::onEncodeComplete() {
-  // Transfer head request state into the pending response before we reuse the encoder.
-  pending_responses_.back().head_request_ = request_encoder_->headRequest();
-}
+void ClientConnectionImpl::onEncodeComplete() {}
 
 int ClientConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
   headers->insertStatus().value(parser_.status_code);
@@ -649,8 +751,16 @@ void ClientConnectionImpl::onBody(const char* data, size_t length) {
 void ClientConnectionImpl::onMessageComplete() {
   if (!pending_responses_.empty()) {
     // After calling decodeData() with end stream set to true, we should no longer be able to reset.
-    PendingResponse response = pending_responses_.front();
-    pending_responses_.pop_front();
+    // The request is kept alive until the next response completes, since the caller may still be
+    // encoding it when an early response arrives.
+    completed_response_.clear();
+    completed_response_.splice(completed_response_.begin(), pending_responses_,
+                               pending_responses_.begin());
+    PendingResponse& response = completed_response_.front();
+    // Streams are responsible for unwinding any outstanding readDisable(true) calls done on the
+    // underlying connection, but their owners stop doing so once the response is complete. The
+    // connection may be reused, or already be in use by pipelined requests, so unwind them here.
+    response.encoder_.unwindReadDisable();
 
     if (deferred_end_stream_headers_) {
       response.decoder_->decodeHeaders(std::move(deferred_end_stream_headers_), true);
@@ -663,16 +773,38 @@ void ClientConnectionImpl::onMessageComplete() {
 }
 
 void ClientConnectionImpl::onResetStream(StreamResetReason reason) {
-  // Only raise reset if we did not already dispatch a complete response.
-  if (!pending_responses_.empty()) {
-    pending_responses_.clear();
-    request_encoder_->runResetCallbacks(reason);
+  // Only raise reset if we did not already dispatch a complete response. Every request that is
+  // still waiting for its response is reset. Idempotent requests that were pipelined behind the
+  // first one are reset as connection failures so that they can be retried. Any other pipelined
+  // request may have been processed by the upstream, so it is marked so that it is not retried.
+  ASSERT(reset_responses_.empty());
+  reset_responses_.splice(reset_responses_.end(), pending_responses_);
+  for (PendingResponse& response : reset_responses_) {
+    response.encoder_.unwindReadDisable();
+    if (&response == &reset_responses_.front()) {
+      response.encoder_.setConnectionReset(reason);
+    } else {
+      response.encoder_.setConnectionReset(response.encoder_.idempotent()
+                                               ? StreamResetReason::ConnectionFailure
+                                               : StreamResetReason::PipelinedConnectionTermination);
+    }
+  }
+  for (PendingResponse& response : reset_responses_) {
+    response.encoder_.runConnectionResetCallbacks();
   }
 }
 
-void ClientConnectionImpl::onAboveHighWatermark() { request_encoder_->runHighWatermarkCallbacks(); }
+void ClientConnectionImpl::onAboveHighWatermark() {
+  for (PendingResponse& response : pending_responses_) {
+    response.encoder_.runHighWatermarkCallbacks();
+  }
+}
 
-void ClientConnectionImpl::onBelowLowWatermark() { request_encoder_->runLowWatermarkCallbacks(); }
+void ClientConnectionImpl::onBelowLowWatermark() {
+  for (PendingResponse& response : pending_responses_) {
+    response.encoder_.runLowWatermarkCallbacks();
+  }
+}
 
 } // namespace Http1
 } // namespace Http
@@ -6,6 +6,7 @@
 #include <memory>
 #include <string>
 
+#include "envoy/common/optional.h"
 #include "envoy/http/codec.h"
 #include "envoy/network/connection.h"
 
@@ -15,6 +16,7 @@
 #include "common/http/codec_helper.h"
 #include "common/http/codes.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/http1/fast_parser.h"
 
 #include "http_parser.h"
 
@@ -48,6 +50,12 @@ public:
 protected:
   StreamEncoderImpl(ConnectionImpl& connection) : connection_(connection) {}
 
+  /**
+   * @return uint64_t an upper bound on the size of the encoded header block for headers, including
+   *         the framing header that the codec adds and the terminating blank line.
+   */
+  static uint64_t encodedHeadersSize(const HeaderMap& headers);
+
   static const std::string CRLF;
   static const std::string LAST_CHUNK;
 
@@ -96,11 +104,42 @@ public:
 
   bool headRequest() { return head_request_; }
 
+  /**
+   * @return bool whether the request's method is idempotent, i.e. whether it may be replayed if
+   *         the connection is closed before its response arrives.
+   */
+  bool idempotent() { return idempotent_; }
+
+  /**
+   * Reset the request along with every other request that is waiting on the connection. The
+   * callbacks run at most once, either when the connection gets to this request or when it is
+   * reset again from within another request's reset callbacks, whichever comes first.
+   * @param reason supplies the reset reason.
+   */
+  void setConnectionReset(StreamResetReason reason) { connection_reset_reason_.value(reason); }
+  void runConnectionResetCallbacks();
+
+  /**
+   * Undo the readDisable(true) calls of this request that are still outstanding. Called once its
+   * response is complete or it is reset, since its owner does not unwind them after that, while
+   * the connection may be reused by other requests. Later readDisable() calls are ignored.
+   */
+  void unwindReadDisable();
+
   // Http::StreamEncoder
   void encodeHeaders(const HeaderMap& headers, bool end_stream) override;
 
+  // Http::Stream
+  void resetStream(StreamResetReason reason) override;
+  void readDisable(bool disable) override;
+
 private:
   bool head_request_{};
+  bool idempotent_{};
+  uint32_t read_disable_calls_{};
+  bool read_disable_unwound_{};
+  Optional<StreamResetReason> connection_reset_reason_;
+  bool connection_reset_callbacks_run_{};
 };
 
 /**
@@ -150,12 +189,17 @@ public:
   uint32_t bufferLimit() { return connection_.bufferLimit(); }
 
 protected:
-  ConnectionImpl(Network::Connection& connection, http_parser_type type);
+  /**
+   * @param fast_parser supplies whether to parse with FastParser instead of http_parser.
+   */
+  ConnectionImpl(Network::Connection& connection, http_parser_type type, bool fast_parser);
 
   bool resetStreamCalled() { return reset_stream_called_; }
 
   Network::Connection& connection_;
   http_parser parser_;
+  // When set, parses into parser_ in place of http_parser_execute().
+  std::unique_ptr<FastParser> fast_parser_;
   HeaderMapPtr deferred_end_stream_headers_;
   Http::Code error_code_{Http::Code::BadRequest};
 
@@ -289,6 +333,11 @@ private:
    */
   void handlePath(HeaderMapImpl& headers, unsigned int method);
 
+  /**
+   * @return Buffer::BufferFragment& a process wide fragment referencing the 100-continue response.
+   */
+  static Buffer::BufferFragment& continueResponseFragment();
+
   // ConnectionImpl
   void onEncodeComplete() override;
   void onMessageBegin() override;
@@ -317,11 +366,16 @@ public:
   StreamEncoder& newStream(StreamDecoder& response_decoder) override;
 
 private:
+  /**
+   * A request whose response has not been decoded yet. Requests may be pipelined, in which case
+   * responses arrive in the order of this list.
+   */
   struct PendingResponse {
-    PendingResponse(StreamDecoder* decoder) : decoder_(decoder) {}
+    PendingResponse(ConnectionImpl& connection, StreamDecoder* decoder)
+        : encoder_(connection), decoder_(decoder) {}
 
+    RequestStreamEncoderImpl encoder_;
     StreamDecoder* decoder_;
-    bool head_request_{};
   };
 
   bool cannotHaveBody();
@@ -338,8 +392,12 @@ private:
   void onAboveHighWatermark() override;
   void onBelowLowWatermark() override;
 
-  std::unique_ptr<RequestStreamEncoderImpl> request_encoder_;
   std::list<PendingResponse> pending_responses_;
+  // The most recently completed request, if any.
+  std::list<PendingResponse> completed_response_;
+  // Requests that were reset. Their encoders are kept until the connection is destroyed, since
+  // callers may still hold them.
+  std::list<PendingResponse> reset_responses_;
 };
 
 } // namespace Http1
@@ -1,5 +1,7 @@
 #include "common/http/http1/conn_pool.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <list>
 
@@ -13,6 +15,7 @@
 #include "common/http/codec_client.h"
 #include "common/http/codes.h"
 #include "common/http/headers.h"
+#include "common/http/utility.h"
 #include "common/network/utility.h"
 #include "common/upstream/upstream_impl.h"
 
@@ -40,9 +43,33 @@ void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
 
 void ConnPoolImpl::attachRequestToClient(ActiveClient& client, StreamDecoder& response_decoder,
                                          ConnectionPool::Callbacks& callbacks) {
-  ASSERT(!client.stream_wrapper_);
-  client.stream_wrapper_.reset(new StreamWrapper(response_decoder, client));
-  callbacks.onPoolReady(*client.stream_wrapper_, client.real_host_description_);
+  if (client.preconnected_) {
+    host_->cluster().stats().upstream_cx_preconnect_used_.inc();
+    client.preconnected_ = false;
+  }
+
+  client.stream_wrappers_.emplace_back(new StreamWrapper(response_decoder, client));
+  callbacks.onPoolReady(*client.stream_wrappers_.back(), client.real_host_description_);
+}
+
+bool ConnPoolImpl::canPipeline(const ActiveClient& client) const {
+  // Only pipeline behind requests that are fully sent and can be safely replayed, and never past
+  // the per connection request limit. Requests behind the first one are not retried if the
+  // connection goes away.
+  const uint64_t in_flight = client.stream_wrappers_.size();
+  if (in_flight == 0 || in_flight >= max_pipelined_requests_ ||
+      (client.remaining_requests_ > 0 && in_flight >= client.remaining_requests_) ||
+      client.codec_client_->remoteClosed()) {
+    return false;
+  }
+
+  for (const StreamWrapperPtr& wrapper : client.stream_wrappers_) {
+    if (!wrapper->encode_complete_ || !wrapper->idempotent_ || wrapper->saw_close_header_) {
+      return false;
+    }
+  }
+
+  return true;
 }
 
 void ConnPoolImpl::checkForDrained() {
@@ -57,10 +84,12 @@ void ConnPoolImpl::checkForDrained() {
   }
 }
 
-void ConnPoolImpl::createNewConnection() {
+ConnPoolImpl::ActiveClient& ConnPoolImpl::createNewConnection() {
   ENVOY_LOG(debug, "creating a new connection");
   ActiveClientPtr client(new ActiveClient(*this));
   client->moveIntoList(std::move(client), busy_clients_);
+  connecting_clients_++;
+  return *busy_clients_.front();
 }
 
 ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_decoder,
@@ -69,9 +98,21 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_dec
     ready_clients_.front()->moveBetweenLists(ready_clients_, busy_clients_);
     ENVOY_CONN_LOG(debug, "using existing connection", *busy_clients_.front()->codec_client_);
     attachRequestToClient(*busy_clients_.front(), response_decoder, callbacks);
+    preconnectIfNeeded();
     return nullptr;
   }
 
+  if (max_pipelined_requests_ > 1) {
+    for (const ActiveClientPtr& client : busy_clients_) {
+      if (canPipeline(*client)) {
+        ENVOY_CONN_LOG(debug, "pipelining on existing connection", *client->codec_client_);
+        host_->cluster().stats().upstream_rq_pipelined_.inc();
+        attachRequestToClient(*client, response_decoder, callbacks);
+        return nullptr;
+      }
+    }
+  }
+
   if (host_->cluster().resourceManager(priority_).pendingRequests().canCreate()) {
     bool can_create_connection =
         host_->cluster().resourceManager(priority_).connections().canCreate();
@@ -79,14 +120,20 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_dec
       host_->cluster().stats().upstream_cx_overflow_.inc();
     }
 
-    // If we have no connections at all, make one no matter what so we don't starve.
-    if ((ready_clients_.size() == 0 && busy_clients_.size() == 0) || can_create_connection) {
+    // If we have no connections at all, make one no matter what so we don't starve. A connection
+    // that is already being made and is not bound to a pending request, such as a preconnected
+    // one, will serve this request.
+    if (connecting_clients_ > pending_requests_.size()) {
+      ENVOY_LOG(debug, "waiting for a connection in progress");
+    } else if ((ready_clients_.size() == 0 && busy_clients_.size() == 0) ||
+               can_create_connection) {
       createNewConnection();
     }
 
     ENVOY_LOG(debug, "queueing request due to no available connections");
     PendingRequestPtr pending_request(new PendingRequest(*this, response_decoder, callbacks));
     pending_request->moveIntoList(std::move(pending_request), pending_requests_);
+    preconnectIfNeeded();
     return pending_requests_.front().get();
   } else {
     ENVOY_LOG(debug, "max pending requests overflow");
@@ -103,8 +150,9 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
     ENVOY_CONN_LOG(debug, "client disconnected", *client.codec_client_);
     ActiveClientPtr removed;
     bool check_for_drained = true;
-    if (client.stream_wrapper_) {
-      if (!client.stream_wrapper_->decode_complete_) {
+    if (!client.stream_wrappers_.empty()) {
+      if (client.stream_wrappers_.size() > 1 ||
+          !client.stream_wrappers_.front()->decode_complete_) {
         if (event == Network::ConnectionEvent::LocalClose) {
           host_->cluster().stats().upstream_cx_destroy_local_with_active_rq_.inc();
         }
@@ -114,8 +162,8 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
         host_->cluster().stats().upstream_cx_destroy_with_active_rq_.inc();
       }
 
-      // There is an active request attached to this client. The underlying codec client will
-      // already have "reset" the stream to fire the reset callback. All we do here is just
+      // There are active requests attached to this client. The underlying codec client will
+      // already have "reset" the streams to fire the reset callbacks. All we do here is just
       // destroy the client.
       removed = client.removeFromList(busy_clients_);
     } else if (!client.connect_timer_) {
@@ -160,6 +208,8 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   if (client.connect_timer_) {
     client.connect_timer_->disableTimer();
     client.connect_timer_.reset();
+    ASSERT(connecting_clients_ > 0);
+    connecting_clients_--;
   }
 
   // Note that the order in this function is important. Concretely, we must destroy the connect
@@ -184,12 +234,24 @@ void ConnPoolImpl::onPendingRequestCancel(PendingRequest& request) {
   checkForDrained();
 }
 
+void ConnPoolImpl::onRequestComplete(ActiveClient& client) {
+  if (!pending_requests_.empty() && canPipeline(client)) {
+    ENVOY_CONN_LOG(debug, "pipelining next request", *client.codec_client_);
+    host_->cluster().stats().upstream_rq_pipelined_.inc();
+    attachRequestToClient(client, pending_requests_.back()->decoder_,
+                          pending_requests_.back()->callbacks_);
+    pending_requests_.pop_back();
+  }
+}
+
 void ConnPoolImpl::onResponseComplete(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "response complete", *client.codec_client_);
-  if (!client.stream_wrapper_->encode_complete_) {
+  // Responses arrive in request order, so the response is for the oldest request.
+  const StreamWrapper& stream_wrapper = *client.stream_wrappers_.front();
+  if (!stream_wrapper.encode_complete_) {
     ENVOY_CONN_LOG(debug, "response before request complete", *client.codec_client_);
     onDownstreamReset(client);
-  } else if (client.stream_wrapper_->saw_close_header_ || client.codec_client_->remoteClosed()) {
+  } else if (stream_wrapper.saw_close_header_ || client.codec_client_->remoteClosed()) {
     ENVOY_CONN_LOG(debug, "saw upstream connection: close", *client.codec_client_);
     onDownstreamReset(client);
   } else if (client.remaining_requests_ > 0 && --client.remaining_requests_ == 0) {
@@ -197,12 +259,36 @@ void ConnPoolImpl::onResponseComplete(ActiveClient& client) {
     host_->cluster().stats().upstream_cx_max_requests_.inc();
     onDownstreamReset(client);
   } else {
-    processIdleClient(client);
+    client.stream_wrappers_.pop_front();
+    if (client.stream_wrappers_.empty()) {
+      processIdleClient(client);
+    } else {
+      onRequestComplete(client);
+    }
+  }
+}
+
+void ConnPoolImpl::preconnectIfNeeded() {
+  if (!drained_callbacks_.empty() ||
+      (preconnect_policy_.min_idle_connections_ == 0 && preconnect_policy_.ratio_ <= 1.0)) {
+    return;
+  }
+
+  // Every busy client that has connected carries at least one request, and every pending request
+  // needs a connection.
+  const uint64_t demand = busy_clients_.size() - connecting_clients_ + pending_requests_.size();
+  const uint64_t wanted =
+      std::max(demand + preconnect_policy_.min_idle_connections_,
+               static_cast<uint64_t>(std::ceil(demand * preconnect_policy_.ratio_)));
+  while (ready_clients_.size() + busy_clients_.size() < wanted &&
+         host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    ENVOY_LOG(debug, "preconnecting");
+    createNewConnection().preconnected_ = true;
+    host_->cluster().stats().upstream_cx_preconnect_.inc();
   }
 }
 
 void ConnPoolImpl::processIdleClient(ActiveClient& client) {
-  client.stream_wrapper_.reset();
   if (pending_requests_.empty()) {
     // There is nothing to service so just move the connection into the ready list.
     ENVOY_CONN_LOG(debug, "moving to ready", *client.codec_client_);
@@ -235,7 +321,18 @@ ConnPoolImpl::StreamWrapper::~StreamWrapper() {
   parent_.parent_.host_->stats().rq_active_.dec();
 }
 
-void ConnPoolImpl::StreamWrapper::onEncodeComplete() { encode_complete_ = true; }
+void ConnPoolImpl::StreamWrapper::encodeHeaders(const HeaderMap& headers, bool end_stream) {
+  if (headers.Method()) {
+    idempotent_ = Utility::isIdempotentMethod(headers.Method()->value().c_str());
+  }
+
+  StreamEncoderWrapper::encodeHeaders(headers, end_stream);
+}
+
+void ConnPoolImpl::StreamWrapper::onEncodeComplete() {
+  encode_complete_ = true;
+  parent_.parent_.onRequestComplete(parent_);
+}
 
 void ConnPoolImpl::StreamWrapper::decodeHeaders(HeaderMapPtr&& headers, bool end_stream) {
   if (headers->Connection() &&
@@ -292,10 +389,14 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
        parent_.host_->cluster().stats().upstream_cx_rx_bytes_buffered_,
        parent_.host_->cluster().stats().upstream_cx_tx_bytes_total_,
        parent_.host_->cluster().stats().upstream_cx_tx_bytes_buffered_,
-       &parent_.host_->cluster().stats().bind_errors_});
+       &parent_.host_->cluster().stats().bind_errors_,
+       &parent_.host_->cluster().stats().upstream_cx_rx_syscalls_total_});
 }
 
 ConnPoolImpl::ActiveClient::~ActiveClient() {
+  if (preconnected_) {
+    parent_.host_->cluster().stats().upstream_cx_preconnect_wasted_.inc();
+  }
   parent_.host_->cluster().stats().upstream_cx_active_.dec();
   parent_.host_->stats().cx_active_.dec();
   conn_length_->complete();
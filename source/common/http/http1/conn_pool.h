@@ -21,6 +21,13 @@ namespace Http1 {
 
 /**
  * A connection pool implementation for HTTP/1.1 connections.
+ *
+ * By default a connection carries one request at a time. If max_pipelined_requests is more than
+ * one, a request may instead be sent on a busy connection behind requests that have been fully
+ * encoded and are idempotent, up to max_pipelined_requests requests in flight per connection.
+ * Responses then arrive in request order.
+ *
+ * Connections are also opened ahead of demand as allowed by the preconnect policy.
  * NOTE: The connection pool does NOT do DNS resolution. It assumes it is being given a numeric IP
  *       address. Higher layer code should handle resolving DNS on error and creating a new pool
  *       bound to a different IP address.
@@ -28,8 +35,11 @@ namespace Http1 {
 class ConnPoolImpl : Logger::Loggable<Logger::Id::pool>, public ConnectionPool::Instance {
 public:
   ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
-               Upstream::ResourcePriority priority)
-      : dispatcher_(dispatcher), host_(host), priority_(priority) {}
+               Upstream::ResourcePriority priority, uint64_t max_pipelined_requests = 1,
+               const ConnectionPool::PreconnectPolicy& preconnect_policy =
+                   ConnectionPool::PreconnectPolicy())
+      : dispatcher_(dispatcher), host_(host), priority_(priority),
+        max_pipelined_requests_(max_pipelined_requests), preconnect_policy_(preconnect_policy) {}
 
   ~ConnPoolImpl();
 
@@ -37,6 +47,7 @@ public:
   void addDrainedCallback(DrainedCb cb) override;
   ConnectionPool::Cancellable* newStream(StreamDecoder& response_decoder,
                                          ConnectionPool::Callbacks& callbacks) override;
+  void preconnect() override { preconnectIfNeeded(); }
 
 protected:
   struct ActiveClient;
@@ -48,6 +59,7 @@ protected:
     ~StreamWrapper();
 
     // StreamEncoderWrapper
+    void encodeHeaders(const HeaderMap& headers, bool end_stream) override;
     void onEncodeComplete() override;
 
     // StreamDecoderWrapper
@@ -64,6 +76,7 @@ protected:
     bool encode_complete_{};
     bool saw_close_header_{};
     bool decode_complete_{};
+    bool idempotent_{};
   };
 
   typedef std::unique_ptr<StreamWrapper> StreamWrapperPtr;
@@ -86,10 +99,13 @@ protected:
     ConnPoolImpl& parent_;
     CodecClientPtr codec_client_;
     Upstream::HostDescriptionConstSharedPtr real_host_description_;
-    StreamWrapperPtr stream_wrapper_;
+    // Requests in flight on the connection, oldest first.
+    std::list<StreamWrapperPtr> stream_wrappers_;
     Event::TimerPtr connect_timer_;
     Stats::TimespanPtr conn_length_;
     uint64_t remaining_requests_;
+    // Set while a connection that was opened ahead of demand has not carried a request.
+    bool preconnected_{};
   };
 
   typedef std::unique_ptr<ActiveClient> ActiveClientPtr;
@@ -111,13 +127,19 @@ protected:
 
   void attachRequestToClient(ActiveClient& client, StreamDecoder& response_decoder,
                              ConnectionPool::Callbacks& callbacks);
+  /**
+   * @return whether another request can be pipelined on a busy client.
+   */
+  bool canPipeline(const ActiveClient& client) const;
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   void checkForDrained();
-  void createNewConnection();
+  ActiveClient& createNewConnection();
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onDownstreamReset(ActiveClient& client);
   void onPendingRequestCancel(PendingRequest& request);
+  void onRequestComplete(ActiveClient& client);
   void onResponseComplete(ActiveClient& client);
+  void preconnectIfNeeded();
   void processIdleClient(ActiveClient& client);
 
   Stats::TimespanPtr conn_connect_ms_;
@@ -128,6 +150,10 @@ protected:
   std::list<PendingRequestPtr> pending_requests_;
   std::list<DrainedCb> drained_callbacks_;
   Upstream::ResourcePriority priority_;
+  const uint64_t max_pipelined_requests_;
+  const ConnectionPool::PreconnectPolicy preconnect_policy_;
+  // Clients in busy_clients_ that have not connected yet.
+  uint64_t connecting_clients_{};
 };
 
 /**
@@ -136,8 +162,9 @@ protected:
 class ConnPoolImplProd : public ConnPoolImpl {
 public:
   ConnPoolImplProd(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
-                   Upstream::ResourcePriority priority)
-      : ConnPoolImpl(dispatcher, host, priority) {}
+                   Upstream::ResourcePriority priority, uint64_t max_pipelined_requests,
+                   const ConnectionPool::PreconnectPolicy& preconnect_policy)
+      : ConnPoolImpl(dispatcher, host, priority, max_pipelined_requests, preconnect_policy) {}
 
   // ConnPoolImpl
   CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) override;
@@ -0,0 +1,691 @@
+#include "common/http/http1/fast_parser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "common/common/macros.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+namespace {
+
+struct Method {
+  const char* name_;
+  size_t size_;
+  http_method method_;
+};
+
+#define FAST_PARSER_METHOD(num, name, string) {#string, sizeof(#string) - 1, HTTP_##name},
+const Method METHODS[] = {HTTP_METHOD_MAP(FAST_PARSER_METHOD)};
+#undef FAST_PARSER_METHOD
+
+const char HTTP_VERSION_PREFIX[] = "HTTP/";
+const size_t HTTP_VERSION_PREFIX_SIZE = sizeof(HTTP_VERSION_PREFIX) - 1;
+
+bool isMethodPrefix(const char* data, size_t size) {
+  for (const Method& method : METHODS) {
+    if (size <= method.size_ && memcmp(method.name_, data, size) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const Method* findMethod(const char* data, size_t size) {
+  for (const Method& method : METHODS) {
+    if (size == method.size_ && memcmp(method.name_, data, size) == 0) {
+      return &method;
+    }
+  }
+  return nullptr;
+}
+
+// RFC 7230 tchar, plus the space that http_parser also accepts in header names.
+class TokenTable {
+public:
+  TokenTable() {
+    for (int c = 0; c < 256; c++) {
+      table_[c] = isalnum(c) || (c != 0 && strchr(" !#$%&'*+-.^_`|~", c) != nullptr);
+    }
+  }
+
+  bool isToken(char c) const { return table_[static_cast<uint8_t>(c)]; }
+
+private:
+  bool table_[256];
+};
+
+const TokenTable& tokenTable() {
+  static const TokenTable* table = new TokenTable();
+  return *table;
+}
+
+bool isWhitespace(char c) { return c == ' ' || c == '\t'; }
+
+const char* skipWhitespace(const char* begin, const char* end) {
+  while (begin < end && isWhitespace(*begin)) {
+    begin++;
+  }
+  return begin;
+}
+
+const char* trimWhitespace(const char* begin, const char* end) {
+  while (end > begin && isWhitespace(end[-1])) {
+    end--;
+  }
+  return end;
+}
+
+template <size_t N>
+bool equalsIgnoreCase(const char* data, size_t size, const char (&lower_case)[N]) {
+  if (size != N - 1) {
+    return false;
+  }
+  for (size_t i = 0; i < size; i++) {
+    if (tolower(static_cast<uint8_t>(data[i])) != lower_case[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+const char* FastParser::findLineEnd(const char* begin, const char* end) {
+#ifdef __SSE2__
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i del = _mm_set1_epi8(0x7f);
+  while (end - begin >= 16) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    // Bytes below a space are the ones that max() changes.
+    const __m128i printable = _mm_cmpeq_epi8(_mm_max_epu8(bytes, space), bytes);
+    const __m128i allowed = _mm_andnot_si128(_mm_cmpeq_epi8(bytes, del),
+                                             _mm_or_si128(printable, _mm_cmpeq_epi8(bytes, tab)));
+    const int disallowed = _mm_movemask_epi8(allowed) ^ 0xffff;
+    if (disallowed != 0) {
+      return begin + __builtin_ctz(disallowed);
+    }
+    begin += 16;
+  }
+#endif
+
+  for (; begin < end; begin++) {
+    const uint8_t c = *begin;
+    if ((c < ' ' && c != '\t') || c == 0x7f) {
+      return begin;
+    }
+  }
+  return end;
+}
+
+size_t FastParser::execute(http_parser& parser, const http_parser_settings& settings,
+                           const char* data, size_t len) {
+  parser_ = &parser;
+  settings_ = &settings;
+  if (HTTP_PARSER_ERRNO(parser_) != HPE_OK) {
+    return 0;
+  }
+
+  // Steps left pending by a pause in the headers complete or body callbacks.
+  if (state_ == State::HeadersDone && !onHeadersDone()) {
+    return 0;
+  }
+  if (state_ == State::MessageDone && !onMessageComplete()) {
+    return 0;
+  }
+
+  if (len == 0) {
+    switch (state_) {
+    case State::BodyIdentityEof:
+      onMessageComplete();
+      return 0;
+    case State::Start:
+    case State::Dead:
+      return 0;
+    default:
+      setError(HPE_INVALID_EOF_STATE);
+      return 1;
+    }
+  }
+
+  const char* p = data;
+  const char* end = data + len;
+  while (p < end) {
+    switch (state_) {
+    case State::Start:
+      if (*p == '\r' || *p == '\n') {
+        p++;
+        break;
+      }
+
+      parser_->flags = 0;
+      parser_->content_length = ULLONG_MAX;
+      if (type_ == HTTP_REQUEST ? !isMethodPrefix(p, 1) : *p != HTTP_VERSION_PREFIX[0]) {
+        setError(type_ == HTTP_REQUEST ? HPE_INVALID_METHOD : HPE_INVALID_CONSTANT);
+        return p - data;
+      }
+
+      head_size_ = 0;
+      in_header_value_ = false;
+      state_ = State::StartLine;
+      if (!notify(settings_->on_message_begin, HPE_CB_message_begin)) {
+        return p - data;
+      }
+      break;
+
+    case State::Dead:
+      if (*p != '\r' && *p != '\n') {
+        setError(HPE_CLOSED_CONNECTION);
+        return p - data;
+      }
+      p++;
+      break;
+
+    case State::BodyIdentity:
+    case State::ChunkData: {
+      const size_t size = std::min<uint64_t>(body_remaining_, end - p);
+      const char* body = p;
+      p += size;
+      body_remaining_ -= size;
+      if (body_remaining_ == 0) {
+        state_ = state_ == State::BodyIdentity ? State::MessageDone : State::ChunkDataEnd;
+      }
+      if (!notifyData(settings_->on_body, HPE_CB_body, body, size)) {
+        return p - data;
+      }
+      if (state_ == State::MessageDone && !onMessageComplete()) {
+        return p - data;
+      }
+      break;
+    }
+
+    case State::BodyIdentityEof: {
+      const char* body = p;
+      p = end;
+      if (!notifyData(settings_->on_body, HPE_CB_body, body, end - body)) {
+        return p - data;
+      }
+      break;
+    }
+
+    case State::HeadersDone:
+    case State::MessageDone:
+      // Only entered when a callback paused the parser, which stops the loop.
+      setError(HPE_INVALID_INTERNAL_STATE);
+      return p - data;
+
+    case State::StartLine:
+    case State::Headers:
+    case State::ChunkSize:
+    case State::ChunkDataEnd:
+    case State::Trailers:
+      if (!readLine(p, end)) {
+        return p - data;
+      }
+      break;
+    }
+  }
+
+  return p - data;
+}
+
+bool FastParser::readLine(const char*& p, const char* end) {
+  const bool in_head = state_ == State::StartLine || state_ == State::Headers ||
+                       state_ == State::Trailers;
+  const char* line_begin;
+  const char* line_end;
+
+  if (!partial_line_.empty() && partial_line_.back() == '\r') {
+    // The previous call ended between CR and LF.
+    if (*p != '\n') {
+      return setError(HPE_LF_EXPECTED);
+    }
+    p++;
+    if (in_head && ++head_size_ > HTTP_MAX_HEADER_SIZE) {
+      return setError(HPE_HEADER_OVERFLOW);
+    }
+    partial_line_.pop_back();
+    line_begin = partial_line_.data();
+    line_end = line_begin + partial_line_.size();
+  } else {
+    const char* delimiter = findLineEnd(p, end);
+    const char* next;
+    if (delimiter == end) {
+      next = end;
+    } else if (*delimiter == '\n') {
+      next = delimiter + 1;
+    } else if (*delimiter == '\r') {
+      if (delimiter + 1 == end) {
+        next = end;
+        delimiter = end;
+      } else if (delimiter[1] == '\n') {
+        next = delimiter + 2;
+      } else {
+        return setError(HPE_LF_EXPECTED);
+      }
+    } else {
+      return setError(invalidCharacterError());
+    }
+
+    const uint64_t size = next - p;
+    if (in_head) {
+      head_size_ += size;
+      if (head_size_ > HTTP_MAX_HEADER_SIZE) {
+        return setError(HPE_HEADER_OVERFLOW);
+      }
+    }
+
+    if (delimiter == end) {
+      // Keep the incomplete line, including a trailing CR, until the rest arrives.
+      if (partial_line_.size() + size > HTTP_MAX_HEADER_SIZE) {
+        return setError(HPE_HEADER_OVERFLOW);
+      }
+      partial_line_.append(p, size);
+      p = end;
+      return state_ != State::StartLine || validatePartialStartLine();
+    }
+
+    if (partial_line_.empty()) {
+      line_begin = p;
+      line_end = delimiter;
+    } else {
+      partial_line_.append(p, delimiter - p);
+      line_begin = partial_line_.data();
+      line_end = line_begin + partial_line_.size();
+    }
+    p = next;
+  }
+
+  const bool keep_parsing = onLine(line_begin, line_end);
+  partial_line_.clear();
+  return keep_parsing;
+}
+
+http_errno FastParser::invalidCharacterError() const {
+  switch (state_) {
+  case State::StartLine:
+    return type_ == HTTP_REQUEST ? HPE_INVALID_URL : HPE_INVALID_STATUS;
+  case State::ChunkSize:
+  case State::ChunkDataEnd:
+    return HPE_INVALID_CHUNK_SIZE;
+  default:
+    return HPE_INVALID_HEADER_TOKEN;
+  }
+}
+
+bool FastParser::onLine(const char* begin, const char* end) {
+  switch (state_) {
+  case State::StartLine:
+    state_ = State::Headers;
+    return type_ == HTTP_REQUEST ? onRequestLine(begin, end) : onStatusLine(begin, end);
+
+  case State::Headers:
+    if (begin == end) {
+      return onHeadersComplete();
+    }
+    return onHeaderLine(begin, end);
+
+  case State::ChunkSize:
+    return onChunkSizeLine(begin, end);
+
+  case State::ChunkDataEnd:
+    if (begin != end) {
+      return setError(HPE_STRICT);
+    }
+    state_ = State::ChunkSize;
+    return notify(settings_->on_chunk_complete, HPE_CB_chunk_complete);
+
+  case State::Trailers:
+    if (begin == end) {
+      state_ = State::MessageDone;
+      return notify(settings_->on_chunk_complete, HPE_CB_chunk_complete) && onMessageComplete();
+    }
+    return onHeaderLine(begin, end);
+
+  default:
+    return setError(HPE_INVALID_INTERNAL_STATE);
+  }
+}
+
+bool FastParser::onRequestLine(const char* begin, const char* end) {
+  const char* method_end = static_cast<const char*>(memchr(begin, ' ', end - begin));
+  const Method* method =
+      method_end != nullptr ? findMethod(begin, method_end - begin) : nullptr;
+  if (method == nullptr) {
+    return setError(HPE_INVALID_METHOD);
+  }
+  parser_->method = method->method_;
+
+  const char* url = skipWhitespace(method_end, end);
+  const char* url_end = url;
+  while (url_end < end && *url_end != ' ') {
+    if (*url_end == '\t') {
+      return setError(HPE_INVALID_URL);
+    }
+    url_end++;
+  }
+  if (url == url_end ||
+      (method->method_ != HTTP_CONNECT && *url != '/' && *url != '*' && !isalpha(*url))) {
+    return setError(HPE_INVALID_URL);
+  }
+  if (!notifyData(settings_->on_url, HPE_CB_url, url, url_end - url)) {
+    return false;
+  }
+
+  const char* version = skipWhitespace(url_end, end);
+  if (version == end) {
+    // HTTP/0.9 request line.
+    parser_->http_major = 0;
+    parser_->http_minor = 9;
+    return true;
+  }
+
+  if (parseVersion(version, end) != end) {
+    return setError(HPE_INVALID_VERSION);
+  }
+  return true;
+}
+
+bool FastParser::onStatusLine(const char* begin, const char* end) {
+  const char* status = parseVersion(begin, end);
+  if (status == nullptr) {
+    return setError(HPE_INVALID_VERSION);
+  }
+  if (status == end || *status != ' ') {
+    return setError(HPE_INVALID_STATUS);
+  }
+
+  status++;
+  unsigned int status_code = 0;
+  const char* reason = status;
+  while (reason < end && isdigit(*reason)) {
+    status_code = status_code * 10 + (*reason - '0');
+    if (status_code > 999) {
+      return setError(HPE_INVALID_STATUS);
+    }
+    reason++;
+  }
+  if (reason == status || (reason < end && *reason != ' ')) {
+    return setError(HPE_INVALID_STATUS);
+  }
+  parser_->status_code = status_code;
+
+  reason = skipWhitespace(reason, end);
+  return notifyData(settings_->on_status, HPE_CB_status, reason, end - reason);
+}
+
+const char* FastParser::parseVersion(const char* begin, const char* end) {
+  if (static_cast<size_t>(end - begin) < HTTP_VERSION_PREFIX_SIZE ||
+      memcmp(begin, HTTP_VERSION_PREFIX, HTTP_VERSION_PREFIX_SIZE) != 0) {
+    return nullptr;
+  }
+
+  const char* p = begin + HTTP_VERSION_PREFIX_SIZE;
+  unsigned int version[2];
+  for (size_t i = 0; i < 2; i++) {
+    if (i == 1) {
+      if (p == end || *p != '.') {
+        return nullptr;
+      }
+      p++;
+    }
+
+    const char* digits = p;
+    version[i] = 0;
+    while (p < end && isdigit(*p)) {
+      version[i] = version[i] * 10 + (*p - '0');
+      if (version[i] > 999) {
+        return nullptr;
+      }
+      p++;
+    }
+    if (p == digits) {
+      return nullptr;
+    }
+  }
+
+  parser_->http_major = version[0];
+  parser_->http_minor = version[1];
+  return p;
+}
+
+bool FastParser::onHeaderLine(const char* begin, const char* end) {
+  if (isWhitespace(*begin)) {
+    // An obs-fold continuation of the last value, which is joined to it with a single space.
+    if (!in_header_value_) {
+      return setError(HPE_INVALID_HEADER_TOKEN);
+    }
+    const char* value = skipWhitespace(begin, end);
+    return notifyData(settings_->on_header_value, HPE_CB_header_value, " ", 1) &&
+           notifyData(settings_->on_header_value, HPE_CB_header_value, value, end - value);
+  }
+
+  const TokenTable& tokens = tokenTable();
+  const char* name_end = begin;
+  while (name_end < end && tokens.isToken(*name_end)) {
+    name_end++;
+  }
+  if (name_end == begin || name_end == end || *name_end != ':') {
+    return setError(HPE_INVALID_HEADER_TOKEN);
+  }
+
+  const char* value = skipWhitespace(name_end + 1, end);
+  if (state_ == State::Headers && !onSpecialHeader(begin, name_end - begin, value, end - value)) {
+    return false;
+  }
+
+  in_header_value_ = true;
+  return notifyData(settings_->on_header_field, HPE_CB_header_field, begin, name_end - begin) &&
+         notifyData(settings_->on_header_value, HPE_CB_header_value, value, end - value);
+}
+
+bool FastParser::onSpecialHeader(const char* name, size_t name_size, const char* value,
+                                 size_t value_size) {
+  const char* value_end = trimWhitespace(value, value + value_size);
+
+  if (equalsIgnoreCase(name, name_size, "content-length")) {
+    if (parser_->flags & F_CONTENTLENGTH) {
+      return setError(HPE_UNEXPECTED_CONTENT_LENGTH);
+    }
+    if (value == value_end) {
+      return setError(HPE_INVALID_CONTENT_LENGTH);
+    }
+    uint64_t content_length = 0;
+    for (const char* p = value; p < value_end; p++) {
+      if (!isdigit(*p) || content_length > (ULLONG_MAX - 10) / 10) {
+        return setError(HPE_INVALID_CONTENT_LENGTH);
+      }
+      content_length = content_length * 10 + (*p - '0');
+    }
+    parser_->content_length = content_length;
+    parser_->flags |= F_CONTENTLENGTH;
+  } else if (equalsIgnoreCase(name, name_size, "transfer-encoding")) {
+    if (equalsIgnoreCase(value, value_end - value, "chunked")) {
+      parser_->flags |= F_CHUNKED;
+    }
+  } else if (equalsIgnoreCase(name, name_size, "connection") ||
+             equalsIgnoreCase(name, name_size, "proxy-connection")) {
+    const char* token = value;
+    while (token < value_end) {
+      const char* token_end = static_cast<const char*>(memchr(token, ',', value_end - token));
+      if (token_end == nullptr) {
+        token_end = value_end;
+      }
+      const char* trimmed_end = trimWhitespace(token, token_end);
+      if (equalsIgnoreCase(token, trimmed_end - token, "keep-alive")) {
+        parser_->flags |= F_CONNECTION_KEEP_ALIVE;
+      } else if (equalsIgnoreCase(token, trimmed_end - token, "close")) {
+        parser_->flags |= F_CONNECTION_CLOSE;
+      } else if (equalsIgnoreCase(token, trimmed_end - token, "upgrade")) {
+        parser_->flags |= F_CONNECTION_UPGRADE;
+      }
+      token = token_end < value_end ? skipWhitespace(token_end + 1, value_end) : value_end;
+    }
+  } else if (equalsIgnoreCase(name, name_size, "upgrade")) {
+    parser_->flags |= F_UPGRADE;
+  }
+
+  return true;
+}
+
+bool FastParser::onHeadersComplete() {
+  // Set this before the callback so that it can see it, as http_parser does.
+  parser_->upgrade = (parser_->flags & (F_UPGRADE | F_CONNECTION_UPGRADE)) ==
+                         (F_UPGRADE | F_CONNECTION_UPGRADE) ||
+                     (type_ == HTTP_REQUEST && parser_->method == HTTP_CONNECT);
+
+  state_ = State::HeadersDone;
+  if (settings_->on_headers_complete != nullptr) {
+    switch (settings_->on_headers_complete(parser_)) {
+    case 0:
+      break;
+    case 2:
+      parser_->upgrade = 1;
+      FALLTHRU;
+    case 1:
+      parser_->flags |= F_SKIPBODY;
+      break;
+    default:
+      return setError(HPE_CB_headers_complete);
+    }
+  }
+
+  return HTTP_PARSER_ERRNO(parser_) == HPE_OK && onHeadersDone();
+}
+
+bool FastParser::onHeadersDone() {
+  const bool has_body = (parser_->flags & F_CHUNKED) ||
+                        (parser_->content_length > 0 && parser_->content_length != ULLONG_MAX);
+  if (parser_->upgrade &&
+      (parser_->method == HTTP_CONNECT || (parser_->flags & F_SKIPBODY) || !has_body)) {
+    // The rest of the data belongs to a different protocol, so stop here.
+    onMessageComplete();
+    return false;
+  }
+
+  if (parser_->flags & F_SKIPBODY) {
+    return onMessageComplete();
+  } else if (parser_->flags & F_CHUNKED) {
+    // Chunked encoding takes precedence over Content-Length.
+    state_ = State::ChunkSize;
+  } else if (parser_->content_length == 0) {
+    return onMessageComplete();
+  } else if (parser_->content_length != ULLONG_MAX) {
+    body_remaining_ = parser_->content_length;
+    state_ = State::BodyIdentity;
+  } else if (messageNeedsEof()) {
+    state_ = State::BodyIdentityEof;
+  } else {
+    return onMessageComplete();
+  }
+
+  return true;
+}
+
+bool FastParser::onChunkSizeLine(const char* begin, const char* end) {
+  uint64_t size = 0;
+  const char* p = begin;
+  for (; p < end && isxdigit(*p); p++) {
+    if (size > (ULLONG_MAX - 16) / 16) {
+      return setError(HPE_INVALID_CHUNK_SIZE);
+    }
+    const char c = tolower(*p);
+    size = size * 16 + (isdigit(c) ? c - '0' : c - 'a' + 10);
+  }
+
+  // Chunk extensions are ignored.
+  if (p == begin || (p < end && *p != ';' && !isWhitespace(*p))) {
+    return setError(HPE_INVALID_CHUNK_SIZE);
+  }
+
+  parser_->content_length = size;
+  if (size == 0) {
+    parser_->flags |= F_TRAILING;
+    head_size_ = 0;
+    in_header_value_ = false;
+    state_ = State::Trailers;
+  } else {
+    body_remaining_ = size;
+    state_ = State::ChunkData;
+  }
+
+  return notify(settings_->on_chunk_header, HPE_CB_chunk_header);
+}
+
+bool FastParser::onMessageComplete() {
+  state_ = shouldKeepAlive() ? State::Start : State::Dead;
+  return notify(settings_->on_message_complete, HPE_CB_message_complete);
+}
+
+bool FastParser::validatePartialStartLine() {
+  const size_t size = partial_line_.size();
+  if (type_ == HTTP_REQUEST) {
+    if (memchr(partial_line_.data(), ' ', size) == nullptr &&
+        !isMethodPrefix(partial_line_.data(), size)) {
+      return setError(HPE_INVALID_METHOD);
+    }
+  } else if (memcmp(partial_line_.data(), HTTP_VERSION_PREFIX,
+                    std::min(size, HTTP_VERSION_PREFIX_SIZE)) != 0) {
+    return setError(HPE_INVALID_CONSTANT);
+  }
+
+  return true;
+}
+
+bool FastParser::messageNeedsEof() const {
+  if (type_ == HTTP_REQUEST) {
+    return false;
+  }
+
+  const unsigned int status_code = parser_->status_code;
+  if (status_code / 100 == 1 || status_code == 204 || status_code == 304 ||
+      (parser_->flags & F_SKIPBODY)) {
+    return false;
+  }
+
+  return !(parser_->flags & F_CHUNKED) && parser_->content_length == ULLONG_MAX;
+}
+
+bool FastParser::shouldKeepAlive() const {
+  if (parser_->http_major > 0 && parser_->http_minor > 0) {
+    if (parser_->flags & F_CONNECTION_CLOSE) {
+      return false;
+    }
+  } else if (!(parser_->flags & F_CONNECTION_KEEP_ALIVE)) {
+    return false;
+  }
+
+  return !messageNeedsEof();
+}
+
+bool FastParser::setError(http_errno error) {
+  parser_->http_errno = error;
+  return false;
+}
+
+bool FastParser::notify(http_cb cb, http_errno error) {
+  if (cb != nullptr && cb(parser_) != 0) {
+    return setError(error);
+  }
+  return HTTP_PARSER_ERRNO(parser_) == HPE_OK;
+}
+
+bool FastParser::notifyData(http_data_cb cb, http_errno error, const char* data, size_t len) {
+  if (cb != nullptr && cb(parser_, data, len) != 0) {
+    return setError(error);
+  }
+  return HTTP_PARSER_ERRNO(parser_) == HPE_OK;
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "http_parser.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * An HTTP/1.x parser that is a drop in replacement for http_parser_execute(). It reports through
+ * the same http_parser_settings callbacks and fills in the same public fields of the http_parser
+ * struct (method, version, status code, flags, content length, errno and upgrade), so the codec
+ * can use either engine. http_parser_pause() works the same way.
+ *
+ * Unlike http_parser, which runs a state machine over every byte, messages are parsed a line at a
+ * time. Line ends are found 16 bytes at a time with SSE2 where available (and a scalar loop
+ * otherwise), which also validates that header values contain no control characters. Each header
+ * field and value is reported with a single callback. Only a line that is split across calls to
+ * execute() is copied.
+ */
+class FastParser {
+public:
+  FastParser(http_parser_type type) : type_(type) {}
+
+  /**
+   * Parse data. See http_parser_execute(). A zero length call indicates that the connection has
+   * been closed by the remote.
+   * @param parser supplies the parser struct that receives parsed fields, errors and pauses.
+   * @param settings supplies the callbacks.
+   * @param data supplies the start address.
+   * @param len supplies the length.
+   * @return size_t the number of bytes consumed.
+   */
+  size_t execute(http_parser& parser, const http_parser_settings& settings, const char* data,
+                 size_t len);
+
+  /**
+   * Find the first byte that can't appear in a header value: a control character other than a
+   * horizontal tab, or DEL. A well formed line ends at the first such byte, which is either CR or
+   * LF.
+   * @param begin supplies the start address.
+   * @param end supplies the end address.
+   * @return const char* the first such byte or end if there is none.
+   */
+  static const char* findLineEnd(const char* begin, const char* end);
+
+private:
+  enum class State {
+    Start,
+    StartLine,
+    Headers,
+    BodyIdentity,
+    BodyIdentityEof,
+    ChunkSize,
+    ChunkData,
+    ChunkDataEnd,
+    Trailers,
+    Dead,
+    // Steps that a callback paused before, which run when parsing resumes.
+    HeadersDone,
+    MessageDone
+  };
+
+  /**
+   * Consume the next line. Every step of parsing returns false if parsing must stop because of an
+   * error, a pause or an upgrade.
+   * @param p supplies the start address, which is advanced past the consumed bytes.
+   * @param end supplies the end address.
+   */
+  bool readLine(const char*& p, const char* end);
+
+  /**
+   * Parse a complete line without its line end.
+   */
+  bool onLine(const char* begin, const char* end);
+  bool onRequestLine(const char* begin, const char* end);
+  bool onStatusLine(const char* begin, const char* end);
+  bool onHeaderLine(const char* begin, const char* end);
+  bool onSpecialHeader(const char* name, size_t name_size, const char* value, size_t value_size);
+  bool onHeadersComplete();
+  bool onHeadersDone();
+  bool onChunkSizeLine(const char* begin, const char* end);
+  bool onMessageComplete();
+
+  /**
+   * Check whether an incomplete start line can still become a valid one, so that a bad request is
+   * rejected without waiting for the rest of the line.
+   */
+  bool validatePartialStartLine();
+
+  /**
+   * Parse "HTTP/<major>.<minor>" into the parser struct.
+   * @return const char* the end of the version or nullptr if it is invalid.
+   */
+  const char* parseVersion(const char* begin, const char* end);
+  http_errno invalidCharacterError() const;
+  bool messageNeedsEof() const;
+  bool shouldKeepAlive() const;
+  bool setError(http_errno error);
+
+  /**
+   * Run a notification or data callback.
+   * @return bool false if parsing must stop because the callback failed or paused the parser.
+   */
+  bool notify(http_cb cb, http_errno error);
+  bool notifyData(http_data_cb cb, http_errno error, const char* data, size_t len);
+
+  const http_parser_type type_;
+  http_parser* parser_{};
+  const http_parser_settings* settings_{};
+  State state_{State::Start};
+  // A line that was split across calls to execute().
+  std::string partial_line_;
+  // Bytes of the current message head (start line and headers) seen so far.
+  uint64_t head_size_{};
+  // Bytes left in the current Content-Length body or chunk.
+  uint64_t body_remaining_{};
+  // Whether the last header line had a value, and so can be continued by an obs-fold line.
+  bool in_header_value_{};
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
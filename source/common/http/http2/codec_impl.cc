@@ -62,10 +62,33 @@ ConnectionImpl::StreamImpl::StreamImpl(ConnectionImpl& parent, uint32_t buffer_l
   }
 }
 
+/**
+ * @return bool whether a header name is one whose values are unique to a request, so that indexing
+ *         it would only churn the HPACK dynamic table. These are all inline headers, whose names
+ *         always reference the strings in Headers, so they are recognized by address.
+ */
+static bool neverIndex(const HeaderString& key) {
+  static const char* const NEVER_INDEXED[] = {
+      Headers::get().Date.get().c_str(),          Headers::get().RequestId.get().c_str(),
+      Headers::get().ClientTraceId.get().c_str(), Headers::get().OtSpanContext.get().c_str(),
+      Headers::get().XB3TraceId.get().c_str(),    Headers::get().XB3SpanId.get().c_str(),
+      Headers::get().XB3ParentSpanId.get().c_str()};
+
+  for (const char* name : NEVER_INDEXED) {
+    if (key.c_str() == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
 static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& header) {
   uint8_t flags = 0;
   if (header.key().type() == HeaderString::Type::Reference) {
     flags |= NGHTTP2_NV_FLAG_NO_COPY_NAME;
+    if (neverIndex(header.key())) {
+      flags |= NGHTTP2_NV_FLAG_NO_INDEX;
+    }
   }
   if (header.value().type() == HeaderString::Type::Reference) {
     flags |= NGHTTP2_NV_FLAG_NO_COPY_VALUE;
@@ -79,6 +102,7 @@ void ConnectionImpl::StreamImpl::buildHeaders(std::vector<nghttp2_nv>& final_hea
                                               const HeaderMap& headers) {
   // nghttp2 requires that all ':' headers come before all other headers. To avoid making higher
   // layers understand that we do two passes here to build the final header list to encode.
+  final_headers.clear();
   final_headers.reserve(headers.size());
   headers.iterate(
       [](const HeaderEntry& header, void* context) -> void {
@@ -100,8 +124,10 @@ void ConnectionImpl::StreamImpl::buildHeaders(std::vector<nghttp2_nv>& final_hea
 }
 
 void ConnectionImpl::StreamImpl::encodeHeaders(const HeaderMap& headers, bool end_stream) {
-  std::vector<nghttp2_nv> final_headers;
+  // nghttp2 copies the name/value array on submission, so the connection's array is reused.
+  std::vector<nghttp2_nv>& final_headers = parent_.final_headers_;
   buildHeaders(final_headers, headers);
+  parent_.stats_.tx_headers_bytes_.add(headers.byteSize());
 
   nghttp2_data_provider provider;
   if (!end_stream) {
@@ -183,8 +209,9 @@ void ConnectionImpl::StreamImpl::saveHeader(HeaderString&& name, HeaderString&&
 }
 
 void ConnectionImpl::StreamImpl::submitTrailers(const HeaderMap& trailers) {
-  std::vector<nghttp2_nv> final_headers;
+  std::vector<nghttp2_nv>& final_headers = parent_.final_headers_;
   buildHeaders(final_headers, trailers);
+  parent_.stats_.tx_headers_bytes_.add(trailers.byteSize());
   int rc =
       nghttp2_submit_trailer(parent_.session_, stream_id_, &final_headers[0], final_headers.size());
   ASSERT(rc == 0);
@@ -218,9 +245,8 @@ int ConnectionImpl::StreamImpl::onDataSourceSend(const uint8_t* framehd, size_t
   // https://nghttp2.org/documentation/types.html#c.nghttp2_send_data_callback
   static const uint64_t FRAME_HEADER_SIZE = 9;
 
-  Buffer::OwnedImpl output(framehd, FRAME_HEADER_SIZE);
-  output.move(pending_send_data_, length);
-  parent_.connection_.write(output);
+  parent_.pending_output_.add(framehd, FRAME_HEADER_SIZE);
+  parent_.pending_output_.move(pending_send_data_, length);
   return 0;
 }
 
@@ -290,27 +316,48 @@ ConnectionImpl::~ConnectionImpl() { nghttp2_session_del(session_); }
 
 void ConnectionImpl::dispatch(Buffer::Instance& data) {
   ENVOY_CONN_LOG(trace, "dispatching {} bytes", connection_, data.length());
-  uint64_t num_slices = data.getRawSlices(nullptr, 0);
-  Buffer::RawSlice slices[num_slices];
-  data.getRawSlices(slices, num_slices);
-  for (Buffer::RawSlice& slice : slices) {
+  // Take ownership of the input one slice at a time, so that DATA payloads can reference the slice
+  // they are in. Moving a whole slice does not move the underlying memory, which nghttp2 parses in
+  // place.
+  uint64_t dispatched_bytes = 0;
+  while (data.length() > 0) {
+    Buffer::RawSlice slice;
+    data.getRawSlices(&slice, 1);
+    dispatch_input_ = std::make_shared<ReferencedInput>(connection_.bufferMemoryAccount());
+    dispatch_input_->buffer_.move(data, slice.len_);
+    dispatch_input_->buffer_.getRawSlices(&slice, 1);
     dispatching_ = true;
     ssize_t rc =
         nghttp2_session_mem_recv(session_, static_cast<const uint8_t*>(slice.mem_), slice.len_);
     if (rc != static_cast<ssize_t>(slice.len_)) {
+      dispatch_input_.reset();
       throw CodecProtocolException(fmt::format("{}", nghttp2_strerror(rc)));
     }
 
     dispatching_ = false;
+    dispatched_bytes += slice.len_;
   }
 
-  ENVOY_CONN_LOG(trace, "dispatched {} bytes", connection_, data.length());
-  data.drain(data.length());
+  ENVOY_CONN_LOG(trace, "dispatched {} bytes", connection_, dispatched_bytes);
+  dispatch_input_.reset();
 
   // Decoding incoming frames can generate outbound frames so flush pending.
   sendPendingFrames();
 }
 
+ConnectionImpl::ReferencedInput::~ReferencedInput() {
+  if (charged_bytes_ > 0) {
+    account_->credit(charged_bytes_);
+  }
+}
+
+void ConnectionImpl::ReferencedInput::charge() {
+  if (account_ != nullptr && charged_bytes_ == 0) {
+    charged_bytes_ = buffer_.length();
+    account_->charge(charged_bytes_);
+  }
+}
+
 ConnectionImpl::StreamImpl* ConnectionImpl::getStream(int32_t stream_id) {
   return static_cast<StreamImpl*>(nghttp2_session_get_stream_user_data(session_, stream_id));
 }
@@ -319,7 +366,19 @@ int ConnectionImpl::onData(int32_t stream_id, const uint8_t* data, size_t len) {
   StreamImpl* stream = getStream(stream_id);
   // If this results in buffering too much data, the watermark buffer will call
   // pendingRecvBufferHighWatermark, resulting in ++read_disable_count_
-  stream->pending_recv_data_.add(data, len);
+  if (len >= MIN_REFERENCED_DATA_SIZE &&
+      len * MAX_REFERENCED_INPUT_RATIO >= dispatch_input_->buffer_.length()) {
+    // nghttp2 hands us DATA payloads in place in the input being dispatched, so reference them
+    // rather than copy them.
+    std::shared_ptr<ReferencedInput> input = dispatch_input_;
+    input->charge();
+    stream->pending_recv_data_.addBufferFragment(*new Buffer::BufferFragmentImpl(
+        data, len, [input](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+          delete fragment;
+        }));
+  } else {
+    stream->pending_recv_data_.add(data, len);
+  }
   // Update the window to the peer unless some consumer of this stream's data has hit a flow control
   // limit and disabled reads on this stream
   if (!stream->buffers_overrun()) {
@@ -378,10 +437,10 @@ int ConnectionImpl::onFrameReceived(const nghttp2_frame* frame) {
                                                 Headers::get().ExpectValues._100Continue.c_str())) {
       // Deal with expect: 100-continue here since higher layers are never going to do anything
       // other than say to continue so that we can respond before request complete if necessary.
-      std::vector<nghttp2_nv> final_headers;
-      StreamImpl::buildHeaders(final_headers, *CONTINUE_HEADER);
-      int rc = nghttp2_submit_headers(session_, 0, stream->stream_id_, nullptr, &final_headers[0],
-                                      final_headers.size(), nullptr);
+      StreamImpl::buildHeaders(final_headers_, *CONTINUE_HEADER);
+      stats_.tx_headers_bytes_.add(CONTINUE_HEADER->byteSize());
+      int rc = nghttp2_submit_headers(session_, 0, stream->stream_id_, nullptr, &final_headers_[0],
+                                      final_headers_.size(), nullptr);
       ASSERT(rc == 0);
       UNREFERENCED_PARAMETER(rc);
 
@@ -478,6 +537,9 @@ int ConnectionImpl::onFrameSend(const nghttp2_frame* frame) {
   }
 
   case NGHTTP2_HEADERS:
+    // The length covers the whole HPACK encoded header block, including any CONTINUATION frames.
+    stats_.tx_headers_encoded_bytes_.add(frame->hd.length);
+    FALLTHRU;
   case NGHTTP2_DATA: {
     StreamImpl* stream = getStream(frame->hd.stream_id);
     stream->local_end_stream_sent_ = frame->hd.flags & NGHTTP2_FLAG_END_STREAM;
@@ -503,8 +565,7 @@ int ConnectionImpl::onInvalidFrame(int error_code) {
 
 ssize_t ConnectionImpl::onSend(const uint8_t* data, size_t length) {
   ENVOY_CONN_LOG(trace, "send data: bytes={}", connection_, length);
-  Buffer::OwnedImpl buffer(data, length);
-  connection_.write(buffer);
+  pending_output_.add(data, length);
   return length;
 }
 
@@ -562,6 +623,14 @@ void ConnectionImpl::sendPendingFrames() {
   }
 
   int rc = nghttp2_session_send(session_);
+  // Write everything that was serialized, including a GOAWAY that precedes a failure, at once.
+  // The frames are moved out first since writing can dispatch more frames on this connection.
+  if (pending_output_.length() > 0) {
+    Buffer::OwnedImpl output;
+    output.move(pending_output_);
+    connection_.write(output);
+  }
+
   if (rc != 0) {
     ASSERT(rc == NGHTTP2_ERR_CALLBACK_FAILURE);
     throw CodecProtocolException(fmt::format("{}", nghttp2_strerror(rc)));
@@ -17,6 +17,7 @@
 #include "common/buffer/watermark_buffer.h"
 #include "common/common/linked_object.h"
 #include "common/common/logger.h"
+#include "common/common/non_copyable.h"
 #include "common/http/codec_helper.h"
 #include "common/http/header_map_impl.h"
 
@@ -41,7 +42,9 @@ const std::string CLIENT_MAGIC_PREFIX = "PRI * HTTP/2";
   COUNTER(tx_reset)                                                                                \
   COUNTER(header_overflow)                                                                         \
   COUNTER(trailers)                                                                                \
-  COUNTER(headers_cb_no_stream)
+  COUNTER(headers_cb_no_stream)                                                                    \
+  COUNTER(tx_headers_bytes)                                                                        \
+  COUNTER(tx_headers_encoded_bytes)
 // clang-format on
 
 /**
@@ -241,6 +244,11 @@ protected:
   CodecStats stats_;
   Network::Connection& connection_;
   uint32_t per_stream_buffer_limit_;
+  // Scratch name/value array for the header lists that streams submit.
+  std::vector<nghttp2_nv> final_headers_;
+  // Frames serialized by a single nghttp2_session_send(), which are written to the connection
+  // together once it returns.
+  Buffer::OwnedImpl pending_output_;
 
 private:
   virtual ConnectionCallbacks& callbacks() PURE;
@@ -255,6 +263,36 @@ private:
 
   static const std::unique_ptr<const Http::HeaderMap> CONTINUE_HEADER;
 
+  /**
+   * A slice of dispatched input that referenced DATA payloads share ownership of, so that it is
+   * freed once the last of them has been drained. Once referenced, the whole slice is charged to
+   * the connection's buffer memory account for as long as it is pinned.
+   */
+  class ReferencedInput : NonCopyable {
+  public:
+    ReferencedInput(Buffer::MemoryAccountSharedPtr account) : account_(account) {}
+    ~ReferencedInput();
+
+    /**
+     * Charge the slice to the account, if that has not been done yet.
+     */
+    void charge();
+
+    Buffer::OwnedImpl buffer_;
+
+  private:
+    const Buffer::MemoryAccountSharedPtr account_;
+    uint64_t charged_bytes_{};
+  };
+
+  // DATA payloads of at least this many bytes are handed to streams by reference instead of being
+  // copied, as long as they make up at least 1/MAX_REFERENCED_INPUT_RATIO of the slice they pin.
+  // Smaller ones are copied so that the memory they pin is not much more than flow control sees.
+  static const uint64_t MIN_REFERENCED_DATA_SIZE = 4096;
+  static const uint64_t MAX_REFERENCED_INPUT_RATIO = 2;
+
+  // The slice of input that the current dispatch() is parsing.
+  std::shared_ptr<ReferencedInput> dispatch_input_;
   bool dispatching_ : 1;
   bool raised_goaway_ : 1;
   bool pending_deferred_reset_ : 1;
@@ -1,5 +1,7 @@
 #include "common/http/http2/conn_pool.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 
 #include "envoy/event/dispatcher.h"
@@ -15,16 +17,21 @@ namespace Http {
 namespace Http2 {
 
 ConnPoolImpl::ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
-                           Upstream::ResourcePriority priority)
-    : dispatcher_(dispatcher), host_(host), priority_(priority) {}
+                           Upstream::ResourcePriority priority, uint32_t max_connections,
+                           uint32_t target_streams_per_connection,
+                           const ConnectionPool::PreconnectPolicy& preconnect_policy)
+    : dispatcher_(dispatcher), host_(host), priority_(priority),
+      max_connections_(std::max<uint32_t>(max_connections, 1)),
+      target_streams_per_connection_(std::max<uint32_t>(target_streams_per_connection, 1)),
+      preconnect_policy_(preconnect_policy) {}
 
 ConnPoolImpl::~ConnPoolImpl() {
-  if (primary_client_) {
-    primary_client_->client_->close();
+  while (!primary_clients_.empty()) {
+    primary_clients_.front()->client_->close();
   }
 
-  if (draining_client_) {
-    draining_client_->client_->close();
+  while (!draining_clients_.empty()) {
+    draining_clients_.front()->client_->close();
   }
 
   // Make sure all clients are destroyed before we are destroyed.
@@ -42,18 +49,21 @@ void ConnPoolImpl::checkForDrained() {
   }
 
   bool drained = true;
-  if (primary_client_) {
-    if (primary_client_->client_->numActiveRequests() == 0) {
-      primary_client_->client_->close();
-      ASSERT(!primary_client_);
+  for (auto it = primary_clients_.begin(); it != primary_clients_.end();) {
+    // Closing the client removes it from the list, so move on first.
+    ActiveClient& client = **it++;
+    if (client.client_->numActiveRequests() == 0) {
+      client.client_->close();
     } else {
       drained = false;
     }
   }
 
-  ASSERT(!draining_client_ || (draining_client_->client_->numActiveRequests() > 0));
-  if (draining_client_ && draining_client_->client_->numActiveRequests() > 0) {
-    drained = false;
+  for (const ActiveClientPtr& client : draining_clients_) {
+    ASSERT(client->client_->numActiveRequests() > 0);
+    if (client->client_->numActiveRequests() > 0) {
+      drained = false;
+    }
   }
 
   if (drained) {
@@ -74,12 +84,34 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
     max_streams = maxTotalStreams();
   }
 
-  if (primary_client_ && primary_client_->total_streams_ >= max_streams) {
-    movePrimaryClientToDraining();
+  // Then pick the primary with the fewest active streams, adding a primary if they are all at the
+  // target and there is room for another.
+  ActiveClient* client = nullptr;
+  for (auto it = primary_clients_.begin(); it != primary_clients_.end();) {
+    ActiveClient& candidate = **it++;
+    if (candidate.total_streams_ >= max_streams) {
+      movePrimaryClientToDraining(candidate);
+    } else if (!client ||
+               candidate.client_->numActiveRequests() < client->client_->numActiveRequests()) {
+      client = &candidate;
+    }
   }
 
-  if (!primary_client_) {
-    primary_client_.reset(new ActiveClient(*this));
+  if (!client || (client->client_->numActiveRequests() >= target_streams_per_connection_ &&
+                  primary_clients_.size() < max_connections_)) {
+    bool can_create_connection =
+        host_->cluster().resourceManager(priority_).connections().canCreate();
+    if (!can_create_connection) {
+      host_->cluster().stats().upstream_cx_overflow_.inc();
+    }
+
+    // If we have no primary at all, make one no matter what so we don't starve. Extra primaries
+    // are only added within the cluster's connection limit.
+    if (!client || can_create_connection) {
+      ActiveClientPtr new_client(new ActiveClient(*this));
+      client = new_client.get();
+      new_client->moveIntoListBack(std::move(new_client), primary_clients_);
+    }
   }
 
   if (!host_->cluster().resourceManager(priority_).requests().canCreate()) {
@@ -87,20 +119,58 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
     host_->cluster().stats().upstream_rq_pending_overflow_.inc();
   } else {
-    ENVOY_CONN_LOG(debug, "creating stream", *primary_client_->client_);
-    primary_client_->total_streams_++;
+    ENVOY_CONN_LOG(debug, "creating stream", *client->client_);
+    if (client->preconnected_) {
+      host_->cluster().stats().upstream_cx_preconnect_used_.inc();
+      client->preconnected_ = false;
+    }
+    client->total_streams_++;
     host_->stats().rq_total_.inc();
     host_->stats().rq_active_.inc();
     host_->cluster().stats().upstream_rq_total_.inc();
     host_->cluster().stats().upstream_rq_active_.inc();
     host_->cluster().resourceManager(priority_).requests().inc();
-    callbacks.onPoolReady(primary_client_->client_->newStream(response_decoder),
-                          primary_client_->real_host_description_);
+    callbacks.onPoolReady(client->client_->newStream(response_decoder),
+                          client->real_host_description_);
   }
 
+  preconnect();
   return nullptr;
 }
 
+void ConnPoolImpl::preconnect() {
+  if (!drained_callbacks_.empty()) {
+    return;
+  }
+
+  uint64_t active_streams = 0;
+  for (const ActiveClientPtr& client : primary_clients_) {
+    active_streams += client->client_->numActiveRequests();
+  }
+
+  const uint64_t expected_streams =
+      static_cast<uint64_t>(std::ceil(active_streams * preconnect_policy_.ratio_));
+  while (primary_clients_.size() < max_connections_ &&
+         (primary_clients_.size() < minPrimaryClients() ||
+          (preconnect_policy_.ratio_ > 1.0 &&
+           expected_streams >= primary_clients_.size() * target_streams_per_connection_))) {
+    if (!host_->cluster().resourceManager(priority_).connections().canCreate()) {
+      host_->cluster().stats().upstream_cx_overflow_.inc();
+      break;
+    }
+
+    ENVOY_LOG(debug, "preconnecting");
+    ActiveClientPtr client(new ActiveClient(*this));
+    client->preconnected_ = true;
+    client->moveIntoListBack(std::move(client), primary_clients_);
+    host_->cluster().stats().upstream_cx_preconnect_.inc();
+  }
+}
+
+uint32_t ConnPoolImpl::minPrimaryClients() const {
+  return std::min(max_connections_, preconnect_policy_.min_idle_connections_);
+}
+
 void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
@@ -114,12 +184,12 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       }
     }
 
-    if (&client == primary_client_.get()) {
+    if (!client.draining_) {
       ENVOY_CONN_LOG(debug, "destroying primary client", *client.client_);
-      dispatcher_.deferredDelete(std::move(primary_client_));
+      dispatcher_.deferredDelete(client.removeFromList(primary_clients_));
     } else {
       ENVOY_CONN_LOG(debug, "destroying draining client", *client.client_);
-      dispatcher_.deferredDelete(std::move(draining_client_));
+      dispatcher_.deferredDelete(client.removeFromList(draining_clients_));
     }
 
     if (client.connect_timer_) {
@@ -142,25 +212,16 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   }
 }
 
-void ConnPoolImpl::movePrimaryClientToDraining() {
-  ENVOY_CONN_LOG(debug, "moving primary to draining", *primary_client_->client_);
-  if (draining_client_) {
-    // This should pretty much never happen, but is possible if we start draining and then get
-    // a goaway for example. In this case just kill the current draining connection. It's not
-    // worth keeping a list.
-    draining_client_->client_->close();
-  }
-
-  ASSERT(!draining_client_);
-  if (primary_client_->client_->numActiveRequests() == 0) {
-    // If we are making a new connection and the primary does not have any active requests just
-    // close it now.
-    primary_client_->client_->close();
+void ConnPoolImpl::movePrimaryClientToDraining(ActiveClient& client) {
+  ENVOY_CONN_LOG(debug, "moving primary to draining", *client.client_);
+  ASSERT(!client.draining_);
+  if (client.client_->numActiveRequests() == 0) {
+    // If the primary does not have any active requests just close it now.
+    client.client_->close();
   } else {
-    draining_client_ = std::move(primary_client_);
+    client.draining_ = true;
+    client.moveBetweenLists(primary_clients_, draining_clients_);
   }
-
-  ASSERT(!primary_client_);
 }
 
 void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
@@ -172,8 +233,8 @@ void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
 void ConnPoolImpl::onGoAway(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "remote goaway", *client.client_);
   host_->cluster().stats().upstream_cx_close_notify_.inc();
-  if (&client == primary_client_.get()) {
-    movePrimaryClientToDraining();
+  if (!client.draining_) {
+    movePrimaryClientToDraining(client);
   }
 }
 
@@ -183,9 +244,22 @@ void ConnPoolImpl::onStreamDestroy(ActiveClient& client) {
   host_->stats().rq_active_.dec();
   host_->cluster().stats().upstream_rq_active_.dec();
   host_->cluster().resourceManager(priority_).requests().dec();
-  if (&client == draining_client_.get() && client.client_->numActiveRequests() == 0) {
-    // Close out the draining client if we no long have active requests.
-    client.client_->close();
+  if (client.client_->numActiveRequests() == 0) {
+    if (client.draining_) {
+      // Close out the draining client if we no long have active requests.
+      client.client_->close();
+    } else if (!client.closed_with_active_rq_ &&
+               primary_clients_.size() > std::max<uint32_t>(minPrimaryClients(), 1) &&
+               std::all_of(primary_clients_.begin(), primary_clients_.end(),
+                           [this, &client](const ActiveClientPtr& other) -> bool {
+                             return other.get() == &client ||
+                                    other->client_->numActiveRequests() <
+                                        target_streams_per_connection_;
+                           })) {
+      // The other primaries have room for the load, so close the idle one.
+      ENVOY_CONN_LOG(debug, "closing idle extra primary", *client.client_);
+      client.client_->close();
+    }
   }
 
   // If we are destroying this stream because of a disconnect, do not check for drain here. We will
@@ -227,18 +301,24 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
   parent_.host_->cluster().stats().upstream_cx_total_.inc();
   parent_.host_->cluster().stats().upstream_cx_active_.inc();
   parent_.host_->cluster().stats().upstream_cx_http2_total_.inc();
+  parent_.host_->cluster().resourceManager(parent_.priority_).connections().inc();
   conn_length_ = parent_.host_->cluster().stats().upstream_cx_length_ms_.allocateSpan();
 
   client_->setConnectionStats({parent_.host_->cluster().stats().upstream_cx_rx_bytes_total_,
                                parent_.host_->cluster().stats().upstream_cx_rx_bytes_buffered_,
                                parent_.host_->cluster().stats().upstream_cx_tx_bytes_total_,
                                parent_.host_->cluster().stats().upstream_cx_tx_bytes_buffered_,
-                               &parent_.host_->cluster().stats().bind_errors_});
+                               &parent_.host_->cluster().stats().bind_errors_,
+                               &parent_.host_->cluster().stats().upstream_cx_rx_syscalls_total_});
 }
 
 ConnPoolImpl::ActiveClient::~ActiveClient() {
+  if (preconnected_) {
+    parent_.host_->cluster().stats().upstream_cx_preconnect_wasted_.inc();
+  }
   parent_.host_->stats().cx_active_.dec();
   parent_.host_->cluster().stats().upstream_cx_active_.dec();
+  parent_.host_->cluster().resourceManager(parent_.priority_).connections().dec();
   conn_length_->complete();
 }
 
@@ -9,6 +9,7 @@
 #include "envoy/network/connection.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/common/linked_object.h"
 #include "common/http/codec_client.h"
 
 namespace Envoy {
@@ -17,22 +18,38 @@ namespace Http2 {
 
 /**
  * Implementation of a "connection pool" for HTTP/2. This mainly handles stats as well as
- * shifting to a new connection if we reach max streams on the primary. This is a base class
+ * shifting to a new connection if we reach max streams on a primary. This is a base class
  * used for both the prod implementation as well as the testing one.
+ *
+ * Up to max_connections primary connections may be open at once. A new stream is placed on the
+ * primary with the fewest active streams. Another primary is added when every primary has at least
+ * target_streams_per_connection active streams, and an idle extra primary is closed once all other
+ * primaries are below that target again.
+ *
+ * Primaries are also opened ahead of demand as allowed by the preconnect policy: at least
+ * min_idle_connections of them are kept open, and another is opened once the active streams scaled
+ * by the preconnect ratio would put every primary at the target.
  */
 class ConnPoolImpl : Logger::Loggable<Logger::Id::pool>, public ConnectionPool::Instance {
 public:
+  static const uint32_t DEFAULT_TARGET_STREAMS_PER_CONNECTION = 100;
+
   ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
-               Upstream::ResourcePriority priority);
+               Upstream::ResourcePriority priority, uint32_t max_connections = 1,
+               uint32_t target_streams_per_connection = DEFAULT_TARGET_STREAMS_PER_CONNECTION,
+               const ConnectionPool::PreconnectPolicy& preconnect_policy =
+                   ConnectionPool::PreconnectPolicy());
   ~ConnPoolImpl();
 
   // Http::ConnectionPool::Instance
   void addDrainedCallback(DrainedCb cb) override;
   ConnectionPool::Cancellable* newStream(Http::StreamDecoder& response_decoder,
                                          ConnectionPool::Callbacks& callbacks) override;
+  void preconnect() override;
 
 protected:
-  struct ActiveClient : public Network::ConnectionCallbacks,
+  struct ActiveClient : LinkedObject<ActiveClient>,
+                       public Network::ConnectionCallbacks,
                         public CodecClientCallbacks,
                         public Event::DeferredDeletable,
                         public Http::ConnectionCallbacks {
@@ -64,6 +81,9 @@ protected:
     Event::TimerPtr connect_timer_;
     Stats::TimespanPtr conn_length_;
     bool closed_with_active_rq_{};
+    bool draining_{};
+    // Set while a connection that was opened ahead of demand has not carried a stream.
+    bool preconnected_{};
   };
 
   typedef std::unique_ptr<ActiveClient> ActiveClientPtr;
@@ -71,20 +91,25 @@ protected:
   void checkForDrained();
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   virtual uint32_t maxTotalStreams() PURE;
-  void movePrimaryClientToDraining();
+  void movePrimaryClientToDraining(ActiveClient& client);
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onConnectTimeout(ActiveClient& client);
   void onGoAway(ActiveClient& client);
   void onStreamDestroy(ActiveClient& client);
   void onStreamReset(ActiveClient& client, Http::StreamResetReason reason);
+  uint32_t minPrimaryClients() const;
 
   Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
   Upstream::HostConstSharedPtr host_;
-  ActiveClientPtr primary_client_;
-  ActiveClientPtr draining_client_;
+  // Oldest first.
+  std::list<ActiveClientPtr> primary_clients_;
+  std::list<ActiveClientPtr> draining_clients_;
   std::list<DrainedCb> drained_callbacks_;
   Upstream::ResourcePriority priority_;
+  const uint32_t max_connections_;
+  const uint32_t target_streams_per_connection_;
+  const ConnectionPool::PreconnectPolicy preconnect_policy_;
 };
 
 /**
@@ -151,6 +151,15 @@ bool Utility::isWebSocketUpgradeRequest(const HeaderMap& headers) {
                     Http::Headers::get().UpgradeValues.WebSocket.c_str())));
 }
 
+bool Utility::isIdempotentMethod(const char* method) {
+  return Http::Headers::get().MethodValues.Get == method ||
+         Http::Headers::get().MethodValues.Head == method ||
+         Http::Headers::get().MethodValues.Options == method ||
+         Http::Headers::get().MethodValues.Put == method ||
+         Http::Headers::get().MethodValues.Delete == method ||
+         Http::Headers::get().MethodValues.Trace == method;
+}
+
 Http2Settings Utility::parseHttp2Settings(const envoy::api::v2::Http2ProtocolOptions& config) {
   Http2Settings ret;
   ret.hpack_table_size_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
@@ -81,6 +81,14 @@ public:
    */
   static bool isWebSocketUpgradeRequest(const HeaderMap& headers);
 
+  /**
+   * Determine whether a request method is idempotent as defined by RFC 7231, i.e. whether the
+   * request may be sent again if the connection is closed before its response arrives.
+   * @param method supplies the request method.
+   * @return bool true for GET, HEAD, OPTIONS, PUT, DELETE and TRACE.
+   */
+  static bool isIdempotentMethod(const char* method);
+
   /**
    * @return Http2Settings An Http2Settings populated from the envoy::api::v2::Http2ProtocolOptions
    *         config.
@@ -1030,6 +1030,25 @@ const std::string Json::Schema::IP_TAGGING_HTTP_FILTER_SCHEMA(R"EOF(
   }
   )EOF");
 
+const std::string Json::Schema::GZIP_HTTP_FILTER_SCHEMA(R"EOF(
+  {
+    "$schema": "http://json-schema.org/schema#",
+    "type" : "object",
+    "properties" : {
+      "compression_level" : {"type" : "integer", "minimum" : 1, "maximum" : 9},
+      "window_bits" : {"type" : "integer", "minimum" : 9, "maximum" : 15},
+      "memory_level" : {"type" : "integer", "minimum" : 1, "maximum" : 9},
+      "min_content_length" : {"type" : "integer", "minimum" : 0},
+      "content_types" : {
+        "type" : "array",
+        "uniqueItems" : true,
+        "items" : {"type" : "string"}
+      }
+    },
+    "additionalProperties" : false
+  }
+  )EOF");
+
 const std::string Json::Schema::HEALTH_CHECK_HTTP_FILTER_SCHEMA(R"EOF(
   {
     "$schema": "http://json-schema.org/schema#",
@@ -1070,6 +1089,21 @@ const std::string Json::Schema::RATE_LIMIT_HTTP_FILTER_SCHEMA(R"EOF(
   }
   )EOF");
 
+const std::string Json::Schema::RESPONSE_CACHE_HTTP_FILTER_SCHEMA(R"EOF(
+  {
+    "$schema": "http://json-schema.org/schema#",
+    "type" : "object",
+    "properties" : {
+      "max_size_bytes" : {"type" : "integer", "minimum" : 0},
+      "max_entry_size_bytes" : {"type" : "integer", "minimum" : 0},
+      "shards" : {"type" : "integer", "minimum" : 1, "maximum" : 256},
+      "hit_for_pass_ms" : {"type" : "integer", "minimum" : 0},
+      "max_wait_ms" : {"type" : "integer", "minimum" : 0}
+    },
+    "additionalProperties" : false
+  }
+  )EOF");
+
 const std::string Json::Schema::ROUTER_HTTP_FILTER_SCHEMA(R"EOF(
   {
     "$schema": "http://json-schema.org/schema#",
@@ -0,0 +1,310 @@
+#include "common/network/buffer_memory_tracker.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "common/common/assert.h"
+
+#include "fmt/format.h"
+
+namespace Envoy {
+namespace Network {
+
+const uint64_t ConnectionBufferAccount::PUBLISH_BYTES;
+
+ConnectionBufferAccountSharedPtr ConnectionBufferAccount::create(Connection& connection) {
+  ThreadBufferMemoryTracker* thread_tracker = ThreadBufferMemoryTracker::current();
+  if (thread_tracker == nullptr) {
+    return nullptr;
+  }
+
+  return std::make_shared<ConnectionBufferAccount>(*thread_tracker, connection);
+}
+
+ConnectionBufferAccount::ConnectionBufferAccount(ThreadBufferMemoryTracker& thread_tracker,
+                                                 Connection& connection)
+    : thread_tracker_(&thread_tracker), connection_(connection) {
+  thread_tracker_->add(*this);
+}
+
+ConnectionBufferAccount::~ConnectionBufferAccount() { close(); }
+
+void ConnectionBufferAccount::setOwnerGauge(Stats::Gauge& gauge) {
+  if (thread_tracker_ == nullptr) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(thread_tracker_->lock_);
+  if (owner_gauge_ != nullptr) {
+    owner_gauge_->sub(published_bytes_);
+  }
+  owner_gauge_ = &gauge;
+  owner_gauge_->add(published_bytes_);
+}
+
+void ConnectionBufferAccount::close() {
+  if (thread_tracker_ == nullptr) {
+    return;
+  }
+
+  if (read_disabled_) {
+    // The connection is going away, so it is not read enabled again.
+    read_disabled_ = false;
+    thread_tracker_->read_disabled_--;
+    thread_tracker_->parent_.stats_.read_disabled_active_.dec();
+  }
+
+  ThreadBufferMemoryTracker* thread_tracker = thread_tracker_;
+  thread_tracker->remove(*this);
+  thread_tracker_ = nullptr;
+
+  if (published_bytes_ > 0) {
+    thread_tracker->parent_.stats_.total_bytes_.sub(published_bytes_);
+    if (owner_gauge_ != nullptr) {
+      owner_gauge_->sub(published_bytes_);
+    }
+    published_bytes_ = 0;
+    // The connection may be closing from within a callback of another connection of this thread,
+    // so connections of this thread are read enabled from a posted callback as well.
+    if (thread_tracker->read_disabled_ > 0 && thread_tracker->belowLowThreshold()) {
+      thread_tracker->postReadEnable();
+    }
+    thread_tracker->onDecrease();
+  }
+}
+
+void ConnectionBufferAccount::charge(uint64_t bytes) {
+  const uint64_t new_bytes = bytes_.load(std::memory_order_relaxed) + bytes;
+  bytes_.store(new_bytes, std::memory_order_relaxed);
+  if (new_bytes >= published_bytes_ + PUBLISH_BYTES) {
+    publish();
+  }
+}
+
+void ConnectionBufferAccount::credit(uint64_t bytes) {
+  ASSERT(bytes <= bytes_.load(std::memory_order_relaxed));
+  const uint64_t new_bytes = bytes_.load(std::memory_order_relaxed) - bytes;
+  bytes_.store(new_bytes, std::memory_order_relaxed);
+  // Idle connections usually have empty buffers, so publish that exactly.
+  if (new_bytes + PUBLISH_BYTES <= published_bytes_ || (new_bytes == 0 && published_bytes_ > 0)) {
+    publish();
+  }
+}
+
+void ConnectionBufferAccount::publish() {
+  if (thread_tracker_ == nullptr) {
+    return;
+  }
+
+  BufferMemoryStats& stats = thread_tracker_->parent_.stats_;
+  const uint64_t bytes = bytes_.load(std::memory_order_relaxed);
+  const bool increased = bytes > published_bytes_;
+  if (increased) {
+    stats.total_bytes_.add(bytes - published_bytes_);
+    if (owner_gauge_ != nullptr) {
+      owner_gauge_->add(bytes - published_bytes_);
+    }
+  } else {
+    stats.total_bytes_.sub(published_bytes_ - bytes);
+    if (owner_gauge_ != nullptr) {
+      owner_gauge_->sub(published_bytes_ - bytes);
+    }
+  }
+  published_bytes_ = bytes;
+
+  thread_tracker_->onPublish(increased);
+}
+
+thread_local ThreadBufferMemoryTracker* ThreadBufferMemoryTracker::current_{};
+
+ThreadBufferMemoryTracker::ThreadBufferMemoryTracker(BufferMemoryTracker& parent,
+                                                     Event::Dispatcher& dispatcher)
+    : parent_(parent), dispatcher_(dispatcher) {
+  ASSERT(current_ == nullptr);
+  current_ = this;
+  std::unique_lock<std::mutex> lock(parent_.lock_);
+  parent_.threads_.push_back(this);
+}
+
+ThreadBufferMemoryTracker::~ThreadBufferMemoryTracker() {
+  ASSERT(current_ == this);
+  {
+    std::unique_lock<std::mutex> lock(parent_.lock_);
+    parent_.threads_.remove(this);
+  }
+  // Nothing may be posted to the dispatcher from here on.
+  read_enable_posted_ = true;
+  // Connections that are still open, e.g. upstream connections waiting for deferred deletion, are
+  // no longer tracked.
+  while (!accounts_.empty()) {
+    accounts_.front()->close();
+  }
+  current_ = nullptr;
+}
+
+ThreadBufferMemoryTracker* ThreadBufferMemoryTracker::current() { return current_; }
+
+void ThreadBufferMemoryTracker::add(ConnectionBufferAccount& account) {
+  std::unique_lock<std::mutex> lock(lock_);
+  account.entry_ = accounts_.insert(accounts_.end(), &account);
+}
+
+void ThreadBufferMemoryTracker::remove(ConnectionBufferAccount& account) {
+  std::unique_lock<std::mutex> lock(lock_);
+  accounts_.erase(account.entry_);
+}
+
+void ThreadBufferMemoryTracker::onPublish(bool increased) {
+  const uint64_t max_bytes = parent_.max_bytes_;
+  if (max_bytes == 0) {
+    return;
+  }
+
+  if (increased) {
+    if (parent_.stats_.total_bytes_.value() > max_bytes) {
+      readDisableLargest();
+    }
+    return;
+  }
+
+  if (read_disabled_ > 0 && belowLowThreshold()) {
+    readEnableAll();
+  }
+  onDecrease();
+}
+
+void ThreadBufferMemoryTracker::onDecrease() {
+  // Connections read disabled by other threads only resume once those threads notice the drop,
+  // which idle threads would not do by themselves.
+  if (parent_.max_bytes_ > 0 && parent_.stats_.read_disabled_active_.value() > read_disabled_ &&
+      belowLowThreshold()) {
+    parent_.postReadEnable(*this);
+  }
+}
+
+void ThreadBufferMemoryTracker::postReadEnable() {
+  if (read_disabled_ == 0 || read_enable_posted_.exchange(true)) {
+    return;
+  }
+
+  dispatcher_.post([this]() -> void {
+    read_enable_posted_ = false;
+    if (read_disabled_ > 0 && belowLowThreshold()) {
+      readEnableAll();
+    }
+  });
+}
+
+bool ThreadBufferMemoryTracker::belowLowThreshold() const {
+  const uint64_t max_bytes = parent_.max_bytes_;
+  return parent_.stats_.total_bytes_.value() <= max_bytes - max_bytes / 4;
+}
+
+void ThreadBufferMemoryTracker::readDisableLargest() {
+  ConnectionBufferAccount* largest = nullptr;
+  for (ConnectionBufferAccount* account : accounts_) {
+    if (!account->read_disabled_ && account->connection_.state() == Connection::State::Open &&
+        (largest == nullptr || account->bytes() > largest->bytes())) {
+      largest = account;
+    }
+  }
+
+  if (largest == nullptr || largest->bytes() == 0) {
+    return;
+  }
+
+  ENVOY_CONN_LOG(debug, "buffer memory over limit, disabling reads, holding {} bytes",
+                 largest->connection_, largest->bytes());
+  largest->read_disabled_ = true;
+  read_disabled_++;
+  parent_.stats_.read_disabled_total_.inc();
+  parent_.stats_.read_disabled_active_.inc();
+  largest->connection_.readDisable(true);
+}
+
+void ThreadBufferMemoryTracker::readEnableAll() {
+  ENVOY_LOG(debug, "buffer memory below limit, enabling reads on {} connections",
+            read_disabled_.load());
+  for (ConnectionBufferAccount* account : accounts_) {
+    if (account->read_disabled_) {
+      account->read_disabled_ = false;
+      parent_.stats_.read_disabled_active_.dec();
+      // A connection that started closing since has stopped reading for good.
+      if (account->connection_.state() == Connection::State::Open) {
+        account->connection_.readDisable(false);
+      }
+    }
+  }
+  read_disabled_ = 0;
+}
+
+BufferMemoryTracker::BufferMemoryTracker(Stats::Scope& scope, uint64_t max_bytes)
+    : stats_{ALL_BUFFER_MEMORY_STATS(POOL_COUNTER_PREFIX(scope, "buffer.memory."),
+                                     POOL_GAUGE_PREFIX(scope, "buffer.memory."))},
+      max_bytes_(max_bytes) {
+  stats_.max_bytes_.set(max_bytes_);
+}
+
+void BufferMemoryTracker::postReadEnable(ThreadBufferMemoryTracker& except) {
+  std::unique_lock<std::mutex> lock(lock_);
+  for (ThreadBufferMemoryTracker* thread_tracker : threads_) {
+    if (thread_tracker != &except) {
+      thread_tracker->postReadEnable();
+    }
+  }
+}
+
+std::string BufferMemoryTracker::dump(uint64_t max_connections) {
+  struct ConnectionInfo {
+    uint64_t bytes_;
+    uint64_t id_;
+    std::string remote_address_;
+    std::string owner_;
+  };
+
+  std::vector<ConnectionInfo> connections;
+  std::map<std::string, uint64_t> owners;
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    for (ThreadBufferMemoryTracker* thread_tracker : threads_) {
+      std::unique_lock<std::mutex> thread_lock(thread_tracker->lock_);
+      for (ConnectionBufferAccount* account : thread_tracker->accounts_) {
+        const uint64_t bytes = account->bytes();
+        if (bytes == 0) {
+          continue;
+        }
+
+        const std::string owner =
+            account->owner_gauge_ != nullptr ? account->owner_gauge_->name() : "none";
+        owners[owner] += bytes;
+        connections.push_back({bytes, account->connection_.id(),
+                               account->connection_.remoteAddress().asString(), owner});
+      }
+    }
+  }
+
+  std::string output = fmt::format("total_bytes: {}\nmax_bytes: {}\nread_disabled: {}\n",
+                                   stats_.total_bytes_.value(), max_bytes_,
+                                   stats_.read_disabled_active_.value());
+  output += "owners:\n";
+  for (const auto& owner : owners) {
+    output += fmt::format("  {}: {}\n", owner.first, owner.second);
+  }
+
+  const uint64_t num_connections = std::min<uint64_t>(max_connections, connections.size());
+  std::partial_sort(connections.begin(), connections.begin() + num_connections, connections.end(),
+                    [](const ConnectionInfo& lhs, const ConnectionInfo& rhs) -> bool {
+                      return lhs.bytes_ > rhs.bytes_;
+                    });
+  output += "connections:\n";
+  for (uint64_t i = 0; i < num_connections; i++) {
+    output += fmt::format("  id={} remote={} owner={} bytes={}\n", connections[i].id_,
+                          connections[i].remote_address_, connections[i].owner_,
+                          connections[i].bytes_);
+  }
+  return output;
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/network/connection.h"
+#include "envoy/stats/stats.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/logger.h"
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * All buffer memory stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_BUFFER_MEMORY_STATS(COUNTER, GAUGE)                                                    \
+  COUNTER(read_disabled_total)                                                                     \
+  GAUGE  (read_disabled_active)                                                                    \
+  GAUGE  (total_bytes)                                                                             \
+  GAUGE  (max_bytes)
+// clang-format on
+
+/**
+ * Struct definition for all buffer memory stats. @see stats_macros.h
+ */
+struct BufferMemoryStats {
+  ALL_BUFFER_MEMORY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+class BufferMemoryTracker;
+class ThreadBufferMemoryTracker;
+
+/**
+ * The memory held by the buffers of one connection: its read and write buffers as well as buffers
+ * of other components that hold data for it, such as HTTP stream buffers. The total is published
+ * to the process wide total and to a gauge of the connection's owner (listener or cluster) in
+ * steps of PUBLISH_BYTES, so that buffer churn does not update shared stats on every buffer
+ * operation.
+ */
+class ConnectionBufferAccount : public Buffer::MemoryAccount, NonCopyable {
+public:
+  /**
+   * Create an account for a connection owned by the calling thread.
+   * @param connection supplies the connection.
+   * @return the account, or nullptr if buffer memory is not tracked on the calling thread.
+   */
+  static std::shared_ptr<ConnectionBufferAccount> create(Connection& connection);
+
+  ConnectionBufferAccount(ThreadBufferMemoryTracker& thread_tracker, Connection& connection);
+  ~ConnectionBufferAccount();
+
+  /**
+   * Publish the account to a gauge of the connection's owner.
+   * @param gauge supplies the gauge. It must stay valid until close() is called.
+   */
+  void setOwnerGauge(Stats::Gauge& gauge);
+
+  /**
+   * Stop tracking the account. Published bytes are withdrawn, and further charges are no longer
+   * published. Must be called before the connection closes its socket.
+   */
+  void close();
+
+  /**
+   * @return uint64_t the number of bytes currently charged to the account.
+   */
+  uint64_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+
+  // Buffer::MemoryAccount
+  void charge(uint64_t bytes) override;
+  void credit(uint64_t bytes) override;
+
+  static const uint64_t PUBLISH_BYTES = 16384;
+
+private:
+  friend class BufferMemoryTracker;
+  friend class ThreadBufferMemoryTracker;
+
+  void publish();
+
+  ThreadBufferMemoryTracker* thread_tracker_;
+  Connection& connection_;
+  Stats::Gauge* owner_gauge_{};
+  // Only updated by the thread owning the connection, but also read by the admin thread.
+  std::atomic<uint64_t> bytes_{};
+  uint64_t published_bytes_{};
+  bool read_disabled_{};
+  std::list<ConnectionBufferAccount*>::iterator entry_;
+};
+
+typedef std::shared_ptr<ConnectionBufferAccount> ConnectionBufferAccountSharedPtr;
+
+/**
+ * Tracks the buffer memory accounts of the connections owned by one thread, and applies
+ * backpressure to them while the process is over its buffer memory limit. When a published
+ * increase takes the process total over the limit, reads are disabled on the open connection of
+ * this thread with the largest account that is still reading. All of them are read enabled again
+ * once the total is at or below 3/4 of the limit. This is checked whenever an account of this
+ * thread publishes a decrease or closes. As the total also drops because of connections of other
+ * threads, a thread that sees it drop posts the check to the dispatchers of all threads that have
+ * connections read disabled.
+ *
+ * The tracker is installed for the calling thread for its lifetime. Accounts of connections that
+ * outlive it stop being tracked when it is destroyed. The dispatcher must not run callbacks posted
+ * to it after the tracker is destroyed.
+ */
+class ThreadBufferMemoryTracker : NonCopyable, Logger::Loggable<Logger::Id::connection> {
+public:
+  /**
+   * @param parent supplies the process wide tracker.
+   * @param dispatcher supplies the dispatcher of the calling thread.
+   */
+  ThreadBufferMemoryTracker(BufferMemoryTracker& parent, Event::Dispatcher& dispatcher);
+  ~ThreadBufferMemoryTracker();
+
+  /**
+   * @return ThreadBufferMemoryTracker* the tracker installed for the calling thread, or nullptr.
+   */
+  static ThreadBufferMemoryTracker* current();
+
+private:
+  friend class BufferMemoryTracker;
+  friend class ConnectionBufferAccount;
+
+  void add(ConnectionBufferAccount& account);
+  void remove(ConnectionBufferAccount& account);
+  void onPublish(bool increased);
+  void onDecrease();
+  void postReadEnable();
+  bool belowLowThreshold() const;
+  void readDisableLargest();
+  void readEnableAll();
+
+  static thread_local ThreadBufferMemoryTracker* current_;
+
+  BufferMemoryTracker& parent_;
+  Event::Dispatcher& dispatcher_;
+  // Guards accounts_ and their owner gauges, which are modified by this thread only but also read
+  // by the admin thread.
+  std::mutex lock_;
+  std::list<ConnectionBufferAccount*> accounts_;
+  // Only updated by this thread, but also read by threads that post the read enable check.
+  std::atomic<uint64_t> read_disabled_{};
+  // Whether a read enable check is posted and has not run yet.
+  std::atomic<bool> read_enable_posted_{};
+};
+
+typedef std::unique_ptr<ThreadBufferMemoryTracker> ThreadBufferMemoryTrackerPtr;
+
+/**
+ * Process wide accounting of the memory held in connection and HTTP stream buffers, with an
+ * optional limit. Each thread that owns connections installs a ThreadBufferMemoryTracker.
+ */
+class BufferMemoryTracker : NonCopyable {
+public:
+  /**
+   * @param scope supplies the scope for the buffer memory stats.
+   * @param max_bytes supplies the process wide limit, or 0 for no limit.
+   */
+  BufferMemoryTracker(Stats::Scope& scope, uint64_t max_bytes);
+
+  /**
+   * @return uint64_t the process wide limit, or 0 if there is none.
+   */
+  uint64_t maxBytes() const { return max_bytes_; }
+
+  /**
+   * Describe the current buffer memory usage: the process total, the total per owner and the
+   * connections with the largest accounts across all threads.
+   * @param max_connections supplies the maximum number of connections to list.
+   * @return std::string the description.
+   */
+  std::string dump(uint64_t max_connections);
+
+private:
+  friend class ConnectionBufferAccount;
+  friend class ThreadBufferMemoryTracker;
+
+  /**
+   * Post the read enable check to all threads other than the given one that have connections
+   * read disabled.
+   */
+  void postReadEnable(ThreadBufferMemoryTracker& except);
+
+  BufferMemoryStats stats_;
+  const uint64_t max_bytes_;
+  // Guards threads_.
+  std::mutex lock_;
+  std::list<ThreadBufferMemoryTracker*> threads_;
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -5,6 +5,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 
@@ -52,6 +53,20 @@ void ConnectionImplUtility::updateBufferStats(uint64_t delta, uint64_t new_total
   }
 }
 
+const uint32_t ConnectionImplUtility::MIN_READ_SIZE;
+const uint32_t ConnectionImplUtility::DEFAULT_READ_SIZE;
+const uint32_t ConnectionImplUtility::MAX_READ_SIZE;
+
+uint32_t ConnectionImplUtility::nextReadSize(uint32_t read_size, uint64_t bytes_read,
+                                             uint32_t max_read_size) {
+  if (bytes_read >= read_size) {
+    return std::min(read_size * 2, max_read_size);
+  } else if (bytes_read < read_size / 4) {
+    return std::max(read_size / 2, MIN_READ_SIZE);
+  }
+  return read_size;
+}
+
 std::atomic<uint64_t> ConnectionImpl::next_global_id_;
 
 ConnectionImpl::ConnectionImpl(Event::DispatcherImpl& dispatcher, int fd,
@@ -93,6 +108,12 @@ ConnectionImpl::ConnectionImpl(Event::DispatcherImpl& dispatcher, int fd,
       file_event_->activate(Event::FileReadyType::Write);
     }
   }
+
+  buffer_account_ = ConnectionBufferAccount::create(*this);
+  if (buffer_account_ != nullptr) {
+    read_buffer_.setMemoryAccount(buffer_account_);
+    static_cast<Buffer::WatermarkBuffer*>(write_buffer_.get())->setMemoryAccount(buffer_account_);
+  }
 }
 
 ConnectionImpl::~ConnectionImpl() {
@@ -122,7 +143,7 @@ void ConnectionImpl::close(ConnectionCloseType type) {
     return;
   }
 
-  uint64_t data_to_write = write_buffer_->length();
+  uint64_t data_to_write = writeBufferedLength();
   ENVOY_CONN_LOG(debug, "closing data_to_write={} type={}", *this, data_to_write, enumToInt(type));
   if (data_to_write == 0 || type == ConnectionCloseType::NoFlush) {
     if (data_to_write > 0) {
@@ -162,9 +183,15 @@ void ConnectionImpl::closeSocket(ConnectionEvent close_type) {
   updateReadBufferStats(0, 0);
   updateWriteBufferStats(0, 0);
   connection_stats_.reset();
+  unlinkSplice();
+  if (buffer_account_ != nullptr) {
+    buffer_account_->close();
+  }
 
   file_event_.reset();
-  ::close(fd_);
+  // Zero copy sends may still be reading from memory that the sender holds, so it decides when the
+  // socket is really closed.
+  ZeroCopySender::closeSocket(std::move(zero_copy_sender_), fd_, dispatcher_);
   fd_ = -1;
 
   raiseEvent(close_type);
@@ -312,9 +339,70 @@ void ConnectionImpl::write(Buffer::Instance& data) {
   }
 }
 
+bool ConnectionImpl::enableZeroCopySend(const ZeroCopySendStats& stats) {
+  if (!zero_copy_sender_ && ZeroCopySender::enable(fd_)) {
+    zero_copy_sender_.reset(new ZeroCopySender(stats));
+  }
+  return zero_copy_sender_ != nullptr;
+}
+
+void ConnectionImpl::setBufferMemoryGauge(Stats::Gauge& gauge) {
+  if (buffer_account_ != nullptr) {
+    buffer_account_->setOwnerGauge(gauge);
+  }
+}
+
+bool ConnectionImpl::spliceTo(Connection& connection) {
+  ConnectionImpl* sink = dynamic_cast<ConnectionImpl*>(&connection);
+  if (sink == nullptr || sink == this || fd_ == -1 || sink->fd_ == -1 || splice_out_ ||
+      sink->splice_in_ || (sink->state_ & InternalState::Connecting) || ssl() != nullptr ||
+      sink->ssl() != nullptr || read_buffer_.length() > 0 || filter_manager_.numReadFilters() > 1 ||
+      sink->filter_manager_.numWriteFilters() > 0) {
+    return false;
+  }
+
+  // Size the pipe like the buffers it replaces.
+  splice_out_ = SplicePipe::create(sink->read_buffer_limit_);
+  if (!splice_out_) {
+    return false;
+  }
+
+  ENVOY_CONN_LOG(debug, "splicing reads to connection {}, pipe capacity {}", *this, sink->id(),
+                 splice_out_->capacity());
+  splice_sink_ = sink;
+  sink->splice_in_ = splice_out_;
+  sink->splice_source_ = this;
+  return true;
+}
+
+void ConnectionImpl::unlinkSplice() {
+  // The sink keeps the pipe so that it can still flush the data in it.
+  if (splice_sink_) {
+    splice_sink_->splice_source_ = nullptr;
+    splice_sink_ = nullptr;
+    splice_out_.reset();
+  }
+
+  // Without a sink the source goes back to reading into its read buffer.
+  if (splice_source_) {
+    splice_source_->splice_sink_ = nullptr;
+    splice_source_->splice_out_.reset();
+    splice_source_ = nullptr;
+  }
+  splice_in_.reset();
+}
+
 void ConnectionImpl::setBufferLimits(uint32_t limit) {
   read_buffer_limit_ = limit;
 
+  // There is no point in reading more than the limit in one go, as the read loop yields as soon as
+  // the read buffer reaches the limit.
+  if (limit > 0) {
+    max_read_size_ = std::max(ConnectionImplUtility::MIN_READ_SIZE,
+                              std::min(limit, ConnectionImplUtility::MAX_READ_SIZE));
+    read_size_ = std::min(read_size_, max_read_size_);
+  }
+
   // Due to the fact that writes to the connection and flushing data from the connection are done
   // asynchronously, we have the option of either setting the watermarks aggressively, and regularly
   // enabling/disabling reads from the socket, or allowing more data, but then not triggering
@@ -376,6 +464,12 @@ void ConnectionImpl::onFileEvent(uint32_t events) {
     return;
   }
 
+  // Zero copy completions are signalled as a socket error, which is reported as both read and write
+  // readiness.
+  if (zero_copy_sender_) {
+    zero_copy_sender_->processCompletions(fd_);
+  }
+
   if (events & Event::FileReadyType::Closed) {
     // We never ask for both early close and read at the same time. If we are reading, we want to
     // consume all available data.
@@ -399,15 +493,17 @@ void ConnectionImpl::onFileEvent(uint32_t events) {
 }
 
 ConnectionImpl::IoResult ConnectionImpl::doReadFromSocket() {
+  if (splice_out_) {
+    return doSpliceFromSocket();
+  }
+
   PostIoAction action = PostIoAction::KeepOpen;
   uint64_t bytes_read = 0;
   do {
-    // 16K read is arbitrary. IIRC, libevent will currently clamp this to 4K. libevent will also
-    // use an ioctl() before every read to figure out how much data there is to read.
-    //
-    // TODO(mattklein123) PERF: Tune the read size and figure out a way of getting rid of the
-    // ioctl(). The extra syscall is not worth it.
-    int rc = read_buffer_.read(fd_, 16384);
+    // TODO(mattklein123) PERF: Figure out a way of getting rid of the ioctl() libevent does before
+    // every read when the libevent buffer implementation is in use. The extra syscall is not worth
+    // it.
+    int rc = read_buffer_.read(fd_, readSize());
     ENVOY_CONN_LOG(trace, "read returns: {}", *this, rc);
 
     // Remote close. Might need to raise data before raising close.
@@ -424,6 +520,7 @@ ConnectionImpl::IoResult ConnectionImpl::doReadFromSocket() {
       break;
     } else {
       bytes_read += rc;
+      onReadSyscall(rc);
       if (shouldDrainReadBuffer()) {
         setReadBufferReady();
         break;
@@ -434,6 +531,48 @@ ConnectionImpl::IoResult ConnectionImpl::doReadFromSocket() {
   return {action, bytes_read};
 }
 
+ConnectionImpl::IoResult ConnectionImpl::doSpliceFromSocket() {
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_read = 0;
+  do {
+    int rc = splice_out_->spliceFrom(fd_);
+    ENVOY_CONN_LOG(trace, "splice from socket returns: {}", *this, rc);
+
+    if (rc == 0) {
+      action = PostIoAction::Close;
+      break;
+    } else if (rc == -1) {
+      ENVOY_CONN_LOG(trace, "splice error: {}", *this, errno);
+      if (errno == EAGAIN) {
+        // The pipe may be full, in which case no further read event is raised for the data left in
+        // the socket. The sink raises one once it has drained the pipe.
+        splice_out_->onSourceBlocked();
+      } else {
+        action = PostIoAction::Close;
+      }
+
+      break;
+    } else {
+      bytes_read += rc;
+      onReadSyscall(rc);
+    }
+  } while (true);
+
+  if (bytes_read > 0) {
+    splice_sink_->file_event_->activate(Event::FileReadyType::Write);
+  }
+
+  return {action, bytes_read};
+}
+
+void ConnectionImpl::onReadSyscall(uint64_t bytes_read) {
+  if (connection_stats_ && connection_stats_->read_syscalls_) {
+    connection_stats_->read_syscalls_->inc();
+  }
+
+  read_size_ = ConnectionImplUtility::nextReadSize(read_size_, bytes_read, max_read_size_);
+}
+
 void ConnectionImpl::onReadReady() {
   ASSERT(!(state_ & InternalState::Connecting));
 
@@ -457,7 +596,12 @@ ConnectionImpl::IoResult ConnectionImpl::doWriteToSocket() {
       action = PostIoAction::KeepOpen;
       break;
     }
-    int rc = write_buffer_->write(fd_);
+    int rc;
+    if (zero_copy_sender_ && write_buffer_->length() >= ZeroCopySender::MIN_SEND_SIZE) {
+      rc = zero_copy_sender_->write(fd_, *write_buffer_);
+    } else {
+      rc = write_buffer_->write(fd_);
+    }
     ENVOY_CONN_LOG(trace, "write returns: {}", *this, rc);
     if (rc == -1) {
       ENVOY_CONN_LOG(trace, "write error: {}", *this, errno);
@@ -473,9 +617,40 @@ ConnectionImpl::IoResult ConnectionImpl::doWriteToSocket() {
     }
   } while (true);
 
+  // Spliced data is written after anything that was buffered before splicing started.
+  if (splice_in_ && action == PostIoAction::KeepOpen && write_buffer_->length() == 0) {
+    action = doSpliceToSocket(bytes_written);
+  }
+
   return {action, bytes_written};
 }
 
+ConnectionImpl::PostIoAction ConnectionImpl::doSpliceToSocket(uint64_t& bytes_written) {
+  PostIoAction action = PostIoAction::KeepOpen;
+  while (splice_in_->length() > 0) {
+    int rc = splice_in_->spliceTo(fd_);
+    ENVOY_CONN_LOG(trace, "splice to socket returns: {}", *this, rc);
+    if (rc == -1) {
+      ENVOY_CONN_LOG(trace, "splice error: {}", *this, errno);
+      if (errno != EAGAIN) {
+        action = PostIoAction::Close;
+      }
+
+      break;
+    } else if (rc == 0) {
+      break;
+    }
+
+    bytes_written += rc;
+  }
+
+  if (splice_source_ && splice_in_->shouldResumeSource() && splice_source_->readEnabled()) {
+    splice_source_->file_event_->activate(Event::FileReadyType::Read);
+  }
+
+  return action;
+}
+
 void ConnectionImpl::onConnected() { raiseEvent(ConnectionEvent::Connected); }
 
 void ConnectionImpl::onWriteReady() {
@@ -505,7 +680,7 @@ void ConnectionImpl::onWriteReady() {
   }
 
   IoResult result = doWriteToSocket();
-  uint64_t new_buffer_size = write_buffer_->length();
+  uint64_t new_buffer_size = writeBufferedLength();
   updateWriteBufferStats(result.bytes_processed_, new_buffer_size);
 
   if (result.action_ == PostIoAction::Close) {
@@ -13,7 +13,10 @@
 #include "common/common/logger.h"
 #include "common/event/dispatcher_impl.h"
 #include "common/event/libevent.h"
+#include "common/network/buffer_memory_tracker.h"
 #include "common/network/filter_manager_impl.h"
+#include "common/network/splice_pipe.h"
+#include "common/network/zero_copy_sender.h"
 
 namespace Envoy {
 namespace Network {
@@ -35,6 +38,24 @@ public:
    */
   static void updateBufferStats(uint64_t delta, uint64_t new_total, uint64_t& previous_total,
                                 Stats::Counter& stat_total, Stats::Gauge& stat_current);
+
+  /**
+   * Compute the size of the next socket read. Bulk transfers fill every read and quickly reach
+   * max_read_size, while request/response traffic mostly sees small reads and settles at
+   * MIN_READ_SIZE.
+   * @param read_size supplies the size requested by the previous read.
+   * @param bytes_read supplies the number of bytes returned by the previous read.
+   * @param max_read_size supplies the largest read size to return.
+   * @return the size to request on the next read. A read that filled the requested size doubles
+   *         it, and a read that returned less than a quarter of it halves it.
+   */
+  static uint32_t nextReadSize(uint32_t read_size, uint64_t bytes_read, uint32_t max_read_size);
+
+  // Bounds for the size of socket reads. Connections start at DEFAULT_READ_SIZE and never go above
+  // the smaller of MAX_READ_SIZE and their buffer limit.
+  static const uint32_t MIN_READ_SIZE = 4096;
+  static const uint32_t DEFAULT_READ_SIZE = 16384;
+  static const uint32_t MAX_READ_SIZE = 256 * 1024;
 };
 
 /**
@@ -77,6 +98,10 @@ public:
   void write(Buffer::Instance& data) override;
   void setBufferLimits(uint32_t limit) override;
   uint32_t bufferLimit() const override { return read_buffer_limit_; }
+  bool enableZeroCopySend(const ZeroCopySendStats& stats) override;
+  bool spliceTo(Connection& connection) override;
+  void setBufferMemoryGauge(Stats::Gauge& gauge) override;
+  Buffer::MemoryAccountSharedPtr bufferMemoryAccount() override { return buffer_account_; }
   bool usingOriginalDst() const override { return using_original_dst_; }
   bool aboveHighWatermark() const override { return above_high_watermark_; }
 
@@ -109,10 +134,23 @@ protected:
   void onLowWatermark();
   void onHighWatermark();
 
+  /**
+   * @return the number of bytes to request from the socket on the next read.
+   */
+  uint32_t readSize() const { return read_size_; }
+
+  /**
+   * Adjust the size of subsequent reads after a read that returned data.
+   * @param bytes_read supplies the number of bytes returned by the read.
+   */
+  void onReadSyscall(uint64_t bytes_read);
+
   FilterManagerImpl filter_manager_;
   Address::InstanceConstSharedPtr remote_address_;
   Address::InstanceConstSharedPtr local_address_;
-  Buffer::OwnedImpl read_buffer_;
+  // A WatermarkBuffer only so that it can be charged to buffer_account_. Read limits are applied by
+  // the connection itself, so it has no watermarks.
+  Buffer::WatermarkBuffer read_buffer_{[]() -> void {}, []() -> void {}};
   // This must be a WatermarkBuffer, but as it is created by a factory the ConnectionImpl only has
   // a generic pointer.
   Buffer::InstancePtr write_buffer_;
@@ -136,6 +174,12 @@ private:
   void onRead(uint64_t read_buffer_size);
   void onReadReady();
   void onWriteReady();
+  IoResult doSpliceFromSocket();
+  PostIoAction doSpliceToSocket(uint64_t& bytes_written);
+  void unlinkSplice();
+  uint64_t writeBufferedLength() const {
+    return write_buffer_->length() + (splice_in_ ? splice_in_->length() : 0);
+  }
   void updateReadBufferStats(uint64_t num_read, uint64_t new_size);
   void updateWriteBufferStats(uint64_t num_written, uint64_t new_size);
 
@@ -150,7 +194,20 @@ private:
   Buffer::Instance* current_write_buffer_{};
   uint64_t last_read_buffer_size_{};
   uint64_t last_write_buffer_size_{};
+  uint32_t read_size_{ConnectionImplUtility::DEFAULT_READ_SIZE};
+  uint32_t max_read_size_{ConnectionImplUtility::MAX_READ_SIZE};
+  ZeroCopySenderPtr zero_copy_sender_;
+  // When this connection splices its reads to another connection, the pipe and the connection
+  // writing out of it. The other connection may close first, which unlinks both.
+  SplicePipeSharedPtr splice_out_;
+  ConnectionImpl* splice_sink_{};
+  // When another connection splices its reads to this one, the pipe and the connection filling it.
+  SplicePipeSharedPtr splice_in_;
+  ConnectionImpl* splice_source_{};
   std::unique_ptr<ConnectionStats> connection_stats_;
+  // The account charged for the buffers of this connection, if buffer memory is tracked on the
+  // thread that created it.
+  ConnectionBufferAccountSharedPtr buffer_account_;
   // Tracks the number of times reads have been disabled.  If N different components call
   // readDisabled(true) this allows the connection to only resume reads when readDisabled(false)
   // has been called N times.
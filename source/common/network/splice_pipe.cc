@@ -0,0 +1,101 @@
+#include "common/network/splice_pipe.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+#if defined(__linux__) && defined(SPLICE_F_MOVE) && defined(F_SETPIPE_SZ)
+#define ENVOY_SPLICE
+#endif
+
+namespace Envoy {
+namespace Network {
+
+const uint32_t SplicePipe::MAX_CAPACITY;
+
+SplicePipeSharedPtr SplicePipe::create(uint32_t size) {
+#ifdef ENVOY_SPLICE
+  int fds[2];
+  if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+    return nullptr;
+  }
+
+  // Growing the pipe fails once the user is over its pipe memory quota. The default size still
+  // works, with more syscalls per byte.
+  if (size > 0) {
+    ::fcntl(fds[1], F_SETPIPE_SZ, std::min(size, MAX_CAPACITY));
+  }
+  const int capacity = ::fcntl(fds[1], F_GETPIPE_SZ);
+  if (capacity <= 0) {
+    ::close(fds[0]);
+    ::close(fds[1]);
+    return nullptr;
+  }
+
+  return SplicePipeSharedPtr{new SplicePipe(fds[0], fds[1], capacity)};
+#else
+  UNREFERENCED_PARAMETER(size);
+  return nullptr;
+#endif
+}
+
+SplicePipe::~SplicePipe() {
+  ::close(read_fd_);
+  ::close(write_fd_);
+}
+
+int SplicePipe::spliceFrom(int fd) {
+#ifdef ENVOY_SPLICE
+  // A zero length splice() returns 0, which would read as end of stream.
+  if (length_ >= capacity_) {
+    errno = EAGAIN;
+    return -1;
+  }
+
+  const ssize_t rc = ::splice(fd, nullptr, write_fd_, nullptr, capacity_ - length_,
+                              SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (rc > 0) {
+    length_ += rc;
+  }
+  return rc;
+#else
+  UNREFERENCED_PARAMETER(fd);
+  NOT_IMPLEMENTED;
+#endif
+}
+
+int SplicePipe::spliceTo(int fd) {
+#ifdef ENVOY_SPLICE
+  if (length_ == 0) {
+    return 0;
+  }
+
+  const ssize_t rc =
+      ::splice(read_fd_, nullptr, fd, nullptr, length_, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (rc > 0) {
+    ASSERT(static_cast<uint64_t>(rc) <= length_);
+    length_ -= rc;
+  }
+  return rc;
+#else
+  UNREFERENCED_PARAMETER(fd);
+  NOT_IMPLEMENTED;
+#endif
+}
+
+bool SplicePipe::shouldResumeSource() {
+  if (blocked_length_ == 0 || length_ > blocked_length_ / 2) {
+    return false;
+  }
+
+  blocked_length_ = 0;
+  return true;
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Network {
+
+class SplicePipe;
+typedef std::shared_ptr<SplicePipe> SplicePipeSharedPtr;
+
+/**
+ * A kernel pipe used to move data from one socket to another with splice(2), without copying it
+ * into user space. The pipe is shared by the connection that reads into it and the connection that
+ * writes out of it.
+ *
+ * The pipe is also the flow control point between the two. Once it is full the reading side stops,
+ * and it resumes when the writing side has drained the pipe to half of the occupancy at which the
+ * reading side stopped. splice() reports a full pipe and an empty socket with the same EAGAIN, so
+ * the reading side is treated as blocked whenever it sees EAGAIN with data left in the pipe. The
+ * cost of guessing wrong is one extra splice() call.
+ */
+class SplicePipe : NonCopyable {
+public:
+  /**
+   * Create a pipe.
+   * @param size supplies the requested capacity in bytes, or 0 for the system default. The kernel
+   *        may grant a different capacity.
+   * @return SplicePipeSharedPtr the new pipe, or nullptr if splicing is not supported on this
+   *         platform or the pipe could not be created.
+   */
+  static SplicePipeSharedPtr create(uint32_t size);
+
+  ~SplicePipe();
+
+  /**
+   * Move data from a socket into the pipe.
+   * @param fd supplies the socket to read from.
+   * @return int the number of bytes moved, 0 on end of stream or -1 on error, with errno set. errno
+   *         is EAGAIN if either the socket has no data or the pipe is full.
+   */
+  int spliceFrom(int fd);
+
+  /**
+   * Move data from the pipe to a socket.
+   * @param fd supplies the socket to write to.
+   * @return int the number of bytes moved or -1 on error, with errno set.
+   */
+  int spliceTo(int fd);
+
+  /**
+   * Record that the reading side stopped because spliceFrom() returned EAGAIN.
+   */
+  void onSourceBlocked() { blocked_length_ = length_; }
+
+  /**
+   * @return bool whether the reading side is blocked and the pipe has drained enough for it to
+   *         resume. Returns true only once per onSourceBlocked().
+   */
+  bool shouldResumeSource();
+
+  /**
+   * @return uint64_t the number of bytes in the pipe.
+   */
+  uint64_t length() const { return length_; }
+
+  /**
+   * @return uint64_t the capacity of the pipe in bytes.
+   */
+  uint64_t capacity() const { return capacity_; }
+
+  // The largest capacity requested from the kernel. Unprivileged processes can not go above
+  // /proc/sys/fs/pipe-max-size, which defaults to this.
+  static const uint32_t MAX_CAPACITY = 1024 * 1024;
+
+private:
+  SplicePipe(int read_fd, int write_fd, uint64_t capacity)
+      : read_fd_(read_fd), write_fd_(write_fd), capacity_(capacity) {}
+
+  const int read_fd_;
+  const int write_fd_;
+  const uint64_t capacity_;
+  uint64_t length_{};
+  uint64_t blocked_length_{};
+};
+
+} // namespace Network
+} // namespace Envoy
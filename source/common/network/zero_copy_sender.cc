@@ -0,0 +1,296 @@
+#include "common/network/zero_copy_sender.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
+
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/timer.h"
+
+#include "common/common/assert.h"
+
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define ENVOY_ZERO_COPY_SEND
+#endif
+
+namespace Envoy {
+namespace Network {
+
+namespace {
+
+/**
+ * A reference to the unsent rest of a slice whose start has been sent. It keeps the slice alive.
+ */
+class HeldFragment : public Buffer::BufferFragment {
+public:
+  HeldFragment(const void* data, size_t size, std::shared_ptr<const Buffer::Instance> held)
+      : data_(data), size_(size), held_(std::move(held)) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return data_; }
+  size_t size() const override { return size_; }
+  void done() override { delete this; }
+
+private:
+  const void* const data_;
+  const size_t size_;
+  const std::shared_ptr<const Buffer::Instance> held_;
+};
+
+class SocketDrainer;
+typedef std::unique_ptr<SocketDrainer> SocketDrainerPtr;
+
+/**
+ * The sockets being drained, by the dispatcher that they are drained on. Each dispatcher's
+ * drainers are only created and destroyed on its own thread, but the map is shared by all of them.
+ */
+struct DrainerRegistry {
+  std::mutex lock_;
+  std::unordered_map<Event::Dispatcher*, std::list<SocketDrainerPtr>> drainers_;
+};
+
+DrainerRegistry& drainerRegistry() {
+  static DrainerRegistry* registry = new DrainerRegistry();
+  return *registry;
+}
+
+/**
+ * Owns a socket that its connection has closed until the zero copy sends on it complete. It is
+ * registered for its dispatcher, so that it can be closed when the dispatcher's connections are
+ * shut down before that happens.
+ */
+class SocketDrainer : public Event::DeferredDeletable {
+public:
+  SocketDrainer(ZeroCopySenderPtr&& sender, int fd, Event::Dispatcher& dispatcher)
+      : sender_(std::move(sender)), fd_(fd), dispatcher_(dispatcher),
+        timer_(dispatcher.createTimer([this]() -> void { onTimer(); })),
+        polls_left_(ZeroCopySender::DRAIN_TIMEOUT.count() /
+                    ZeroCopySender::DRAIN_POLL_INTERVAL.count()) {
+    timer_->enableTimer(ZeroCopySender::DRAIN_POLL_INTERVAL);
+  }
+
+  ~SocketDrainer() {
+    if (sender_->pendingBytes() > 0) {
+      // Reset the connection. The kernel drops its send queue when a socket that lingers for no
+      // time is closed, so nothing reads the data after it is released.
+      const linger no_linger{1, 0};
+      setsockopt(fd_, SOL_SOCKET, SO_LINGER, &no_linger, sizeof(no_linger));
+    }
+    ::close(fd_);
+  }
+
+  /**
+   * Start draining a socket.
+   */
+  static void start(ZeroCopySenderPtr&& sender, int fd, Event::Dispatcher& dispatcher) {
+    SocketDrainerPtr drainer(new SocketDrainer(std::move(sender), fd, dispatcher));
+    DrainerRegistry& registry = drainerRegistry();
+    std::lock_guard<std::mutex> lock(registry.lock_);
+    std::list<SocketDrainerPtr>& drainers = registry.drainers_[&dispatcher];
+    drainers.push_front(std::move(drainer));
+    drainers.front()->entry_ = drainers.begin();
+  }
+
+  /**
+   * Close every socket still being drained on a dispatcher.
+   */
+  static void closeAll(Event::Dispatcher& dispatcher) {
+    std::list<SocketDrainerPtr> drainers;
+    {
+      DrainerRegistry& registry = drainerRegistry();
+      std::lock_guard<std::mutex> lock(registry.lock_);
+      auto it = registry.drainers_.find(&dispatcher);
+      if (it == registry.drainers_.end()) {
+        return;
+      }
+      drainers = std::move(it->second);
+      registry.drainers_.erase(it);
+    }
+    // The drainers are destroyed outside of the lock.
+  }
+
+private:
+  void onTimer() {
+    sender_->processCompletions(fd_);
+    if (sender_->pendingBytes() > 0 && polls_left_-- > 0) {
+      timer_->enableTimer(ZeroCopySender::DRAIN_POLL_INTERVAL);
+      return;
+    }
+
+    SocketDrainerPtr self;
+    {
+      DrainerRegistry& registry = drainerRegistry();
+      std::lock_guard<std::mutex> lock(registry.lock_);
+      std::list<SocketDrainerPtr>& drainers = registry.drainers_[&dispatcher_];
+      self = std::move(*entry_);
+      drainers.erase(entry_);
+      if (drainers.empty()) {
+        registry.drainers_.erase(&dispatcher_);
+      }
+    }
+    dispatcher_.deferredDelete(std::move(self));
+  }
+
+  ZeroCopySenderPtr sender_;
+  const int fd_;
+  Event::Dispatcher& dispatcher_;
+  Event::TimerPtr timer_;
+  int64_t polls_left_;
+  std::list<SocketDrainerPtr>::iterator entry_;
+};
+
+} // namespace
+
+const uint64_t ZeroCopySender::MIN_SEND_SIZE;
+const std::chrono::milliseconds ZeroCopySender::DRAIN_POLL_INTERVAL{100};
+const std::chrono::milliseconds ZeroCopySender::DRAIN_TIMEOUT{30000};
+
+bool ZeroCopySender::enable(int fd) {
+#ifdef ENVOY_ZERO_COPY_SEND
+  const int on = 1;
+  return setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) == 0;
+#else
+  UNREFERENCED_PARAMETER(fd);
+  return false;
+#endif
+}
+
+int ZeroCopySender::write(int fd, Buffer::Instance& buffer) {
+#ifdef ENVOY_ZERO_COPY_SEND
+  if (kernel_copies_) {
+    return buffer.write(fd);
+  }
+
+  Buffer::RawSlice slices[IOV_MAX];
+  const uint64_t num_slices = std::min<uint64_t>(buffer.getRawSlices(slices, IOV_MAX), IOV_MAX);
+  msghdr message{};
+  message.msg_iov = reinterpret_cast<iovec*>(slices);
+  message.msg_iovlen = num_slices;
+  const ssize_t rc = ::sendmsg(fd, &message, MSG_ZEROCOPY);
+  if (rc == -1 && errno == ENOBUFS) {
+    // The socket has hit its limit of pinned memory. Copy this write instead.
+    stats_.fallbacks_.inc();
+    return buffer.write(fd);
+  }
+
+  if (rc > 0) {
+    stats_.sends_.inc();
+    // The kernel references every slice up to and including the one holding the last byte sent.
+    // Moving whole slices doesn't copy or reallocate them, so the memory stays where it is.
+    uint64_t held_length = 0;
+    uint64_t slice = 0;
+    while (held_length < static_cast<uint64_t>(rc)) {
+      held_length += slices[slice++].len_;
+    }
+    std::shared_ptr<Buffer::OwnedImpl> held(new Buffer::OwnedImpl());
+    held->move(buffer, held_length);
+
+    const uint64_t unsent_length = held_length - rc;
+    if (unsent_length > 0) {
+      const Buffer::RawSlice& last_slice = slices[slice - 1];
+      Buffer::OwnedImpl unsent;
+      unsent.addBufferFragment(*new HeldFragment(
+          static_cast<const uint8_t*>(last_slice.mem_) + last_slice.len_ - unsent_length,
+          unsent_length, held));
+      buffer.prepend(unsent);
+    }
+
+    pending_sends_.push_back({next_id_++, static_cast<uint64_t>(rc), std::move(held), false});
+    pending_bytes_ += rc;
+  }
+  return rc;
+#else
+  UNREFERENCED_PARAMETER(fd);
+  return buffer.write(fd);
+#endif
+}
+
+void ZeroCopySender::processCompletions(int fd) {
+#ifdef ENVOY_ZERO_COPY_SEND
+  while (!pending_sends_.empty()) {
+    char control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+    msghdr message{};
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    if (::recvmsg(fd, &message, MSG_ERRQUEUE) == -1) {
+      // EAGAIN once the error queue is empty.
+      break;
+    }
+
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&message, cmsg)) {
+      if (!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+            (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))) {
+        continue;
+      }
+      const sock_extended_err* error = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+      if (error->ee_errno != 0 || error->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+      onCompletion(error->ee_info, error->ee_data, error->ee_code & SO_EE_CODE_ZEROCOPY_COPIED);
+    }
+  }
+#else
+  UNREFERENCED_PARAMETER(fd);
+#endif
+}
+
+void ZeroCopySender::onCompletion(uint32_t first_id, uint32_t last_id, bool copied) {
+  ENVOY_LOG(trace, "zero copy sends {}-{} complete, copied: {}", first_id, last_id, copied);
+  const uint32_t range = last_id - first_id;
+  for (PendingSend& send : pending_sends_) {
+    if (send.id_ - first_id <= range) {
+      send.completed_ = true;
+      if (copied) {
+        stats_.fallbacks_.inc();
+      }
+    }
+  }
+
+  if (copied) {
+    // The kernel decided to copy the data after all, e.g. because the route goes over loopback. It
+    // will keep doing so for this socket, so stop paying for pinning and tracking the memory.
+    kernel_copies_ = true;
+  }
+
+  // Completions normally arrive in order. Data can only be released from the front of the pending
+  // buffer, so an out of order completion is held until the sends in front of it complete.
+  while (!pending_sends_.empty() && pending_sends_.front().completed_) {
+    pending_bytes_ -= pending_sends_.front().length_;
+    pending_sends_.pop_front();
+  }
+}
+
+void ZeroCopySender::closeSocket(ZeroCopySenderPtr&& sender, int fd,
+                                 Event::Dispatcher& dispatcher) {
+  if (sender != nullptr) {
+    sender->processCompletions(fd);
+  }
+  if (sender == nullptr || sender->pendingBytes() == 0) {
+    ::close(fd);
+    return;
+  }
+
+  // Send a FIN after the data, as closing the socket would, but keep the socket open.
+  ::shutdown(fd, SHUT_WR);
+  SocketDrainer::start(std::move(sender), fd, dispatcher);
+}
+
+void ZeroCopySender::closeDrainingSockets(Event::Dispatcher& dispatcher) {
+  SocketDrainer::closeAll(dispatcher);
+}
+
+} // namespace Network
+} // namespace Envoy
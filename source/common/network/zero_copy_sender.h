@@ -0,0 +1,107 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/network/connection.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Sends buffer data with MSG_ZEROCOPY. The kernel then transmits straight from the buffer memory
+ * instead of copying it into the socket buffer, so sent data must stay untouched until the kernel
+ * reports on the socket error queue that it is done with it. The slices holding sent data are moved
+ * out of the caller's buffer and held by the sender until their sends complete. When a send ends
+ * part way through a slice, the unsent rest of it goes back to the front of the caller's buffer as
+ * a reference to the held slice rather than a copy, so the slice is freed only once it has been
+ * sent in full and every send of it has completed.
+ */
+class ZeroCopySender : Logger::Loggable<Logger::Id::connection> {
+public:
+  /**
+   * Enable zero copy sends on a socket.
+   * @param fd supplies the socket.
+   * @return bool whether the platform and socket support zero copy sends.
+   */
+  static bool enable(int fd);
+
+  ZeroCopySender(const Connection::ZeroCopySendStats& stats) : stats_(stats) {}
+
+  /**
+   * Send data from the front of a buffer. Data that is sent is drained from the buffer.
+   * @param fd supplies the socket to send on.
+   * @param buffer supplies the data to send.
+   * @return int the number of bytes sent or -1 on error, with errno set.
+   */
+  int write(int fd, Buffer::Instance& buffer);
+
+  /**
+   * Read all available completion notifications from the socket error queue and release the data
+   * of the sends that have completed.
+   * @param fd supplies the socket.
+   */
+  void processCompletions(int fd);
+
+  /**
+   * @return uint64_t the number of bytes sent and not yet released by the kernel.
+   */
+  uint64_t pendingBytes() const { return pending_bytes_; }
+
+  /**
+   * Close a socket that a sender has sent on. The kernel may still read sent data after the socket
+   * is closed, and a closed socket no longer reports completions. So if sends are outstanding, the
+   * socket is shut down for writing and kept open until they complete, and only then closed. If
+   * they haven't completed after DRAIN_TIMEOUT, the connection is reset, which makes the kernel
+   * drop the data it still holds.
+   * @param sender supplies the sender, which is kept until the socket is closed.
+   * @param fd supplies the socket.
+   * @param dispatcher supplies the dispatcher to wait for completions on.
+   */
+  static void closeSocket(std::unique_ptr<ZeroCopySender>&& sender, int fd,
+                          Event::Dispatcher& dispatcher);
+
+  /**
+   * Close the sockets that closeSocket() is still keeping open on a dispatcher, resetting those
+   * with outstanding sends. This must be called on the dispatcher's thread before it shuts down, as
+   * the sockets and the data held for them would otherwise never be released.
+   * @param dispatcher supplies the dispatcher.
+   */
+  static void closeDrainingSockets(Event::Dispatcher& dispatcher);
+
+  // Writes smaller than this are cheaper to copy than to pin and track.
+  static const uint64_t MIN_SEND_SIZE = 16384;
+
+  // How often a closed socket is checked for completions, and how long they are waited for.
+  static const std::chrono::milliseconds DRAIN_POLL_INTERVAL;
+  static const std::chrono::milliseconds DRAIN_TIMEOUT;
+
+private:
+  struct PendingSend {
+    uint32_t id_;
+    uint64_t length_;
+    // The slices that the send was made from.
+    std::shared_ptr<const Buffer::Instance> data_;
+    bool completed_;
+  };
+
+  void onCompletion(uint32_t first_id, uint32_t last_id, bool copied);
+
+  const Connection::ZeroCopySendStats stats_;
+  std::deque<PendingSend> pending_sends_;
+  uint64_t pending_bytes_{};
+  // The kernel numbers successful zero copy sends on each socket sequentially, starting at 0.
+  uint32_t next_id_{};
+  bool kernel_copies_{};
+};
+
+typedef std::unique_ptr<ZeroCopySender> ZeroCopySenderPtr;
+
+} // namespace Network
+} // namespace Envoy
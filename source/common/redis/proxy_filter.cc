@@ -48,7 +48,7 @@ void ProxyFilter::initializeReadFilterCallbacks(Network::ReadFilterCallbacks& ca
                                                config_->stats().downstream_cx_rx_bytes_buffered_,
                                                config_->stats().downstream_cx_tx_bytes_total_,
                                                config_->stats().downstream_cx_tx_bytes_buffered_,
-                                               nullptr});
+                                               nullptr, nullptr});
 }
 
 void ProxyFilter::onRespValue(RespValuePtr&& value) {
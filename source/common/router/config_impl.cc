@@ -1,5 +1,6 @@
 #include "common/router/config_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <map>
@@ -16,6 +17,7 @@
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/hash.h"
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/config/metadata.h"
 #include "common/config/rds_json.h"
@@ -185,8 +187,11 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
     }
   }
 
-  for (const auto& header_map : route.match().headers()) {
-    config_headers_.push_back(header_map);
+  if (route.match().headers_size() > 0) {
+    const uint64_t max_regex_program_size = ConfigUtility::maxRegexProgramSize(loader);
+    for (const auto& header_map : route.match().headers()) {
+      config_headers_.emplace_back(header_map, max_regex_program_size);
+    }
   }
 
   if (!route.route().hash_policy().empty()) {
@@ -464,7 +469,8 @@ RegexRouteEntryImpl::RegexRouteEntryImpl(const VirtualHostImpl& vhost,
                                          const envoy::api::v2::Route& route,
                                          Runtime::Loader& loader)
     : RouteEntryImplBase(vhost, route, loader),
-      regex_(std::regex{route.match().regex().c_str(), std::regex::optimize}) {}
+      regex_(RegexUtil::parseRegex(route.match().regex(),
+                                   ConfigUtility::maxRegexProgramSize(loader))) {}
 
 void RegexRouteEntryImpl::finalizeRequestHeaders(
     Http::HeaderMap& headers, const Http::AccessLog::RequestInfo& request_info) const {
@@ -472,7 +478,8 @@ void RegexRouteEntryImpl::finalizeRequestHeaders(
 
   const Http::HeaderString& path = headers.Path()->value();
   const char* query_string_start = Http::Utility::findQueryStringStart(path);
-  ASSERT(std::regex_match(path.c_str(), query_string_start, regex_));
+  ASSERT(RE2::FullMatch(re2::StringPiece(path.c_str(), query_string_start - path.c_str()),
+                       *regex_));
   std::string matched_path(path.c_str(), query_string_start);
   finalizePathHeader(headers, matched_path);
 }
@@ -482,7 +489,8 @@ RouteConstSharedPtr RegexRouteEntryImpl::matches(const Http::HeaderMap& headers,
   if (RouteEntryImplBase::matchRoute(headers, random_value)) {
     const Http::HeaderString& path = headers.Path()->value();
     const char* query_string_start = Http::Utility::findQueryStringStart(path);
-    if (std::regex_match(path.c_str(), query_string_start, regex_)) {
+    if (RE2::FullMatch(re2::StringPiece(path.c_str(), query_string_start - path.c_str()),
+                       *regex_)) {
       return clusterEntry(headers, random_value);
     }
   }
@@ -514,6 +522,7 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::VirtualHost& virtual_host
                                        header_value_option.header().value()});
   }
 
+  size_t regex_routes = 0;
   for (const auto& route : virtual_host.routes()) {
     const bool has_prefix =
         route.match().path_specifier_case() == envoy::api::v2::RouteMatch::kPrefix;
@@ -528,6 +537,7 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::VirtualHost& virtual_host
       ASSERT(has_regex);
       UNREFERENCED_PARAMETER(has_regex);
       routes_.emplace_back(new RegexRouteEntryImpl(*this, route, runtime));
+      regex_routes++;
     }
 
     if (validate_clusters) {
@@ -541,6 +551,12 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::VirtualHost& virtual_host
     }
   }
 
+  const bool use_trie = routes_.size() >= MIN_ROUTES_FOR_TRIE;
+  const bool use_regex_set = regex_routes >= MIN_ROUTES_FOR_REGEX_SET;
+  if (use_trie || use_regex_set) {
+    buildRouteIndex(virtual_host, runtime, use_trie, use_regex_set);
+  }
+
   for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
     virtual_clusters_.push_back(VirtualClusterEntry(virtual_cluster));
   }
@@ -550,6 +566,35 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::VirtualHost& virtual_host
   }
 }
 
+void VirtualHostImpl::buildRouteIndex(const envoy::api::v2::VirtualHost& virtual_host,
+                                      Runtime::Loader& runtime, bool use_trie,
+                                      bool use_regex_set) {
+  std::unique_ptr<RouteTrie> route_trie(use_trie ? new RouteTrie() : nullptr);
+  std::vector<std::string> regexes;
+  for (int32_t i = 0; i < virtual_host.routes().size(); i++) {
+    const envoy::api::v2::RouteMatch& match = virtual_host.routes(i).match();
+    // The trie compares characters exactly, so case insensitive routes are evaluated one by one.
+    const bool case_sensitive = PROTOBUF_GET_WRAPPED_OR_DEFAULT(match, case_sensitive, true);
+    if (use_trie && case_sensitive &&
+        match.path_specifier_case() == envoy::api::v2::RouteMatch::kPrefix) {
+      route_trie->addPrefix(match.prefix(), i);
+    } else if (use_trie && case_sensitive &&
+               match.path_specifier_case() == envoy::api::v2::RouteMatch::kPath) {
+      route_trie->addPath(match.path(), i);
+    } else if (use_regex_set && match.path_specifier_case() == envoy::api::v2::RouteMatch::kRegex) {
+      regexes.push_back(match.regex());
+      regex_routes_.push_back(i);
+    } else {
+      unindexed_routes_.push_back(i);
+    }
+  }
+  route_trie_ = std::move(route_trie);
+  if (use_regex_set) {
+    regex_set_ =
+        RegexUtil::parseRegexSet(regexes, ConfigUtility::maxRegexProgramSize(runtime));
+  }
+}
+
 bool VirtualHostImpl::usesRuntime() const {
   bool uses = false;
   for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
@@ -571,22 +616,13 @@ VirtualHostImpl::VirtualClusterEntry::VirtualClusterEntry(
   name_ = virtual_cluster.name();
 }
 
-const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(const std::string& host) const {
+const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(const char* host,
+                                                             size_t size) const {
   // We do a longest wildcard suffix match against the host that's passed in.
   // (e.g. foo-bar.baz.com should match *-bar.baz.com before matching *.baz.com)
-  // This is done by scanning the length => wildcards map looking for every
-  // wildcard whose size is < length.
-  for (const auto& iter : wildcard_virtual_host_suffixes_) {
-    const uint32_t wildcard_length = iter.first;
-    const auto& wildcard_map = iter.second;
-    // >= because *.foo.com shouldn't match .foo.com.
-    if (wildcard_length >= host.size()) {
-      continue;
-    }
-    const auto& match = wildcard_map.find(host.substr(host.size() - wildcard_length));
-    if (match != wildcard_map.end()) {
-      return match->second.get();
-    }
+  uint32_t index;
+  if (wildcard_virtual_host_suffixes_.find(host, size, index)) {
+    return wildcard_virtual_hosts_[index].get();
   }
   return nullptr;
 }
@@ -606,7 +642,8 @@ RouteMatcher::RouteMatcher(const envoy::api::v2::RouteConfiguration& route_confi
         }
         default_virtual_host_ = virtual_host;
       } else if (domain.size() > 0 && '*' == domain[0]) {
-        wildcard_virtual_host_suffixes_[domain.size() - 1].emplace(domain.substr(1), virtual_host);
+        wildcard_virtual_host_suffixes_.add(domain.substr(1), wildcard_virtual_hosts_.size());
+        wildcard_virtual_hosts_.push_back(virtual_host);
       } else {
         if (virtual_hosts_.find(domain) != virtual_hosts_.end()) {
           throw EnvoyException(fmt::format(
@@ -629,9 +666,55 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
     return SSL_REDIRECT_ROUTE;
   }
 
-  // Check for a route that matches the request.
-  for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
-    RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+  if ((route_trie_ == nullptr && regex_set_ == nullptr) || headers.Path() == nullptr) {
+    // Check for a route that matches the request.
+    for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
+      RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+      if (nullptr != route_entry) {
+        return route_entry;
+      }
+    }
+
+    return nullptr;
+  }
+
+  // Only the routes whose path specifier matches, and those that aren't indexed, can match the
+  // request. They are checked in their configured order so that the first match still wins.
+  const Http::HeaderString& path = headers.Path()->value();
+  const char* query_string_start = Http::Utility::findQueryStringStart(path);
+  const size_t size_without_query =
+      query_string_start != nullptr ? query_string_start - path.c_str() : path.size();
+  // Scratch space for the indexed routes, reused by every lookup on this thread so that it only
+  // allocates until the vectors have grown to fit.
+  static thread_local std::vector<uint32_t> candidates;
+  static thread_local std::vector<int> matched;
+  candidates.clear();
+  if (route_trie_ != nullptr) {
+    route_trie_->find(path.c_str(), path.size(), size_without_query, candidates);
+  }
+  if (regex_set_ != nullptr) {
+    if (RegexUtil::matchRegexSet(*regex_set_, re2::StringPiece(path.c_str(), size_without_query),
+                                 matched)) {
+      for (int regex : matched) {
+        candidates.push_back(regex_routes_[regex]);
+      }
+    } else {
+      // Any regex route may match, so they are all evaluated one by one.
+      candidates.insert(candidates.end(), regex_routes_.begin(), regex_routes_.end());
+    }
+  }
+  // Few routes match the path, so sorting them is cheap. The unindexed routes are already in order,
+  // and are merged in as they're evaluated.
+  std::sort(candidates.begin(), candidates.end());
+  auto candidate = candidates.begin();
+  auto unindexed = unindexed_routes_.begin();
+  while (candidate != candidates.end() || unindexed != unindexed_routes_.end()) {
+    const uint32_t index =
+        unindexed == unindexed_routes_.end() ||
+                (candidate != candidates.end() && *candidate < *unindexed)
+            ? *candidate++
+            : *unindexed++;
+    RouteConstSharedPtr route_entry = routes_[index]->matches(headers, random_value);
     if (nullptr != route_entry) {
       return route_entry;
     }
@@ -648,13 +731,13 @@ const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::HeaderMap& head
 
   // TODO (@rshriram) Match Origin header in WebSocket
   // request with VHost, using wildcard match
-  const char* host = headers.Host()->value().c_str();
-  const auto& iter = virtual_hosts_.find(host);
+  const Http::HeaderString& host = headers.Host()->value();
+  const auto& iter = virtual_hosts_.find(host.c_str());
   if (iter != virtual_hosts_.end()) {
     return iter->second.get();
   }
   if (!wildcard_virtual_host_suffixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(host);
+    const VirtualHostImpl* vhost = findWildcardVirtualHost(host.c_str(), host.size());
     if (vhost != nullptr) {
       return vhost;
     }
@@ -672,6 +755,8 @@ RouteConstSharedPtr RouteMatcher::route(const Http::HeaderMap& headers,
   }
 }
 
+const size_t VirtualHostImpl::MIN_ROUTES_FOR_TRIE;
+const size_t VirtualHostImpl::MIN_ROUTES_FOR_REGEX_SET;
 const VirtualHostImpl::CatchAllVirtualCluster VirtualHostImpl::VIRTUAL_CLUSTER_CATCH_ALL;
 const SslRedirector SslRedirectRoute::SSL_REDIRECTOR;
 const std::shared_ptr<const SslRedirectRoute> VirtualHostImpl::SSL_REDIRECT_ROUTE{
@@ -15,8 +15,11 @@
 #include "envoy/runtime/runtime.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "common/common/regex.h"
 #include "common/router/config_utility.h"
+#include "common/router/domain_trie.h"
 #include "common/router/req_header_formatter.h"
+#include "common/router/route_trie.h"
 #include "common/router/router_ratelimit.h"
 
 #include "api/rds.pb.h"
@@ -116,9 +119,18 @@ public:
   const std::string& name() const override { return name_; }
   const RateLimitPolicy& rateLimitPolicy() const override { return rate_limit_policy_; }
 
+  // Virtual hosts with at least this many routes index them in a RouteTrie. Below it, evaluating
+  // every route is as fast.
+  static const size_t MIN_ROUTES_FOR_TRIE = 16;
+  // Virtual hosts with at least this many regex routes match them all at once with an RE2::Set.
+  static const size_t MIN_ROUTES_FOR_REGEX_SET = 2;
+
 private:
   enum class SslRequirements { NONE, EXTERNAL_ONLY, ALL };
 
+  void buildRouteIndex(const envoy::api::v2::VirtualHost& virtual_host, Runtime::Loader& runtime,
+                       bool use_trie, bool use_regex_set);
+
   struct VirtualClusterEntry : public VirtualCluster {
     VirtualClusterEntry(const envoy::api::v2::VirtualCluster& virtual_cluster);
 
@@ -142,6 +154,15 @@ private:
 
   const std::string name_;
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  // Null unless the virtual host has MIN_ROUTES_FOR_TRIE routes.
+  std::unique_ptr<const RouteTrie> route_trie_;
+  // Null unless the virtual host has MIN_ROUTES_FOR_REGEX_SET regex routes. Each regex in the set
+  // is for the route at the same position in regex_routes_.
+  std::unique_ptr<const RE2::Set> regex_set_;
+  std::vector<uint32_t> regex_routes_;
+  // Positions of the routes that neither route_trie_ nor regex_set_ index, in order. Only used if
+  // one of them is set.
+  std::vector<uint32_t> unindexed_routes_;
   std::vector<VirtualClusterEntry> virtual_clusters_;
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
@@ -460,7 +481,7 @@ public:
   RouteConstSharedPtr matches(const Http::HeaderMap& headers, uint64_t random_value) const override;
 
 private:
-  const std::regex regex_;
+  const std::unique_ptr<const RE2> regex_;
 };
 
 /**
@@ -478,20 +499,12 @@ public:
 
 private:
   const VirtualHostImpl* findVirtualHost(const Http::HeaderMap& headers) const;
-  const VirtualHostImpl* findWildcardVirtualHost(const std::string& host) const;
+  const VirtualHostImpl* findWildcardVirtualHost(const char* host, size_t size) const;
 
   std::unordered_map<std::string, VirtualHostSharedPtr> virtual_hosts_;
-  // std::greater as a minor optimization to iterate from more to less specific
-  //
-  // A note on using an unordered_map versus a vector of (string, VirtualHostSharedPtr) pairs:
-  //
-  // Based on local benchmarks, each vector entry costs around 20ns for recall and (string)
-  // comparison with a fixed cost of about 25ns. For unordered_map, the empty map costs about 65ns
-  // and climbs to about 110ns once there are any entries.
-  //
-  // The break-even is 4 entries.
-  std::map<int64_t, std::unordered_map<std::string, VirtualHostSharedPtr>, std::greater<int64_t>>
-      wildcard_virtual_host_suffixes_;
+  // The suffixes of wildcard domains, indexing wildcard_virtual_hosts_.
+  DomainTrie wildcard_virtual_host_suffixes_;
+  std::vector<VirtualHostSharedPtr> wildcard_virtual_hosts_;
   VirtualHostSharedPtr default_virtual_host_;
   bool uses_runtime_{};
 };
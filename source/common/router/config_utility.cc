@@ -1,6 +1,5 @@
 #include "common/router/config_utility.h"
 
-#include <regex>
 #include <string>
 #include <vector>
 
@@ -21,6 +20,11 @@ ConfigUtility::parsePriority(const envoy::api::v2::RoutingPriority& priority) {
   }
 }
 
+uint64_t ConfigUtility::maxRegexProgramSize(Runtime::Loader& runtime) {
+  return runtime.snapshot().getInteger("router.regex.max_program_size",
+                                       RegexUtil::DEFAULT_MAX_PROGRAM_SIZE);
+}
+
 bool ConfigUtility::matchHeaders(const Http::HeaderMap& request_headers,
                                  const std::vector<HeaderData>& config_headers) {
   bool matches = true;
@@ -34,7 +38,8 @@ bool ConfigUtility::matchHeaders(const Http::HeaderMap& request_headers,
         matches &= (header != nullptr) && (header->value() == cfg_header_data.value_.c_str());
       } else {
         matches &= (header != nullptr) &&
-                   std::regex_match(header->value().c_str(), cfg_header_data.regex_pattern_);
+                   RE2::FullMatch(re2::StringPiece(header->value().c_str(), header->value().size()),
+                                  *cfg_header_data.regex_pattern_);
       }
       if (!matches) {
         break;
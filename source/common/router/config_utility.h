@@ -1,13 +1,15 @@
 #pragma once
 
-#include <regex>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "envoy/json/json_object.h"
+#include "envoy/runtime/runtime.h"
 #include "envoy/upstream/resource_manager.h"
 
 #include "common/common/empty_string.h"
+#include "common/common/regex.h"
 #include "common/config/rds_json.h"
 #include "common/http/headers.h"
 #include "common/protobuf/utility.h"
@@ -26,10 +28,14 @@ public:
     // An empty header value allows for matching to be only based on header presence.
     // Regex is an opt-in. Unless explicitly mentioned, the header values will be used for
     // exact string matching.
-    HeaderData(const envoy::api::v2::HeaderMatcher& config)
+    HeaderData(const envoy::api::v2::HeaderMatcher& config,
+               uint64_t max_regex_program_size = RegexUtil::DEFAULT_MAX_PROGRAM_SIZE)
         : name_(config.name()), value_(config.value()),
-          regex_pattern_(value_, std::regex::optimize),
-          is_regex_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, regex, false)) {}
+          is_regex_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, regex, false)) {
+      if (is_regex_) {
+        regex_pattern_ = RegexUtil::parseRegex(value_, max_regex_program_size);
+      }
+    }
     HeaderData(const Json::Object& config)
         : HeaderData([&config] {
             envoy::api::v2::HeaderMatcher header_matcher;
@@ -39,8 +45,9 @@ public:
 
     const Http::LowerCaseString name_;
     const std::string value_;
-    const std::regex regex_pattern_;
     const bool is_regex_;
+    // Only set if is_regex_.
+    std::unique_ptr<const RE2> regex_pattern_;
   };
 
   /**
@@ -48,6 +55,13 @@ public:
    */
   static Upstream::ResourcePriority parsePriority(const envoy::api::v2::RoutingPriority& priority);
 
+  /**
+   * @param runtime supplies the runtime loader.
+   * @return uint64_t the largest compiled program that a regex in a route table may have. It is
+   *         read from the router.regex.max_program_size runtime key.
+   */
+  static uint64_t maxRegexProgramSize(Runtime::Loader& runtime);
+
   /**
    * See if the specified headers are present in the request headers.
    * @param headers supplies the list of headers to match
@@ -0,0 +1,87 @@
+#include "common/router/domain_trie.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Envoy {
+namespace Router {
+
+void DomainTrie::add(const std::string& suffix, uint32_t index) {
+  Node& node = insert(suffix);
+  if (!node.has_index_) {
+    node.has_index_ = true;
+    node.index_ = index;
+  }
+}
+
+bool DomainTrie::find(const char* host, size_t size, uint32_t& index) const {
+  const Node* node = &root_;
+  // The host is consumed from its end, so the part left to match is always host[0, remaining).
+  size_t remaining = size;
+  bool found = false;
+  while (remaining > 0) {
+    node = findChild(*node, host[remaining - 1]);
+    if (node == nullptr || node->label_.size() > remaining ||
+        memcmp(node->label_.data(), host + remaining - node->label_.size(),
+               node->label_.size()) != 0) {
+      break;
+    }
+    remaining -= node->label_.size();
+    // A suffix that is the whole host doesn't match, and neither can any longer one.
+    if (node->has_index_ && remaining > 0) {
+      index = node->index_;
+      found = true;
+    }
+  }
+
+  return found;
+}
+
+DomainTrie::Node& DomainTrie::insert(const std::string& suffix) {
+  Node* node = &root_;
+  size_t remaining = suffix.size();
+  while (remaining > 0) {
+    const char c = suffix[remaining - 1];
+    auto child = std::lower_bound(node->children_.begin(), node->children_.end(), c, labelLess);
+    if (child == node->children_.end() || (*child)->label_.back() != c) {
+      // No edge ends like the rest of the suffix, so the rest of the suffix becomes a new leaf.
+      NodePtr leaf(new Node());
+      leaf->label_ = suffix.substr(0, remaining);
+      return **node->children_.insert(child, std::move(leaf));
+    }
+
+    // Follow the edge backwards as far as it agrees with the suffix. If the suffix ends or differs
+    // part way along the edge, split the edge there.
+    const std::string& label = (*child)->label_;
+    size_t common = 1;
+    while (common < label.size() && common < remaining &&
+           label[label.size() - 1 - common] == suffix[remaining - 1 - common]) {
+      common++;
+    }
+    if (common < label.size()) {
+      NodePtr split(new Node());
+      split->label_ = label.substr(label.size() - common);
+      (*child)->label_.erase(label.size() - common);
+      split->children_.push_back(std::move(*child));
+      *child = std::move(split);
+    }
+
+    node = child->get();
+    remaining -= common;
+  }
+
+  return *node;
+}
+
+bool DomainTrie::labelLess(const NodePtr& node, char c) { return node->label_.back() < c; }
+
+const DomainTrie::Node* DomainTrie::findChild(const Node& node, char c) {
+  auto child = std::lower_bound(node.children_.begin(), node.children_.end(), c, labelLess);
+  if (child == node.children_.end() || (*child)->label_.back() != c) {
+    return nullptr;
+  }
+  return child->get();
+}
+
+} // namespace Router
+} // namespace Envoy
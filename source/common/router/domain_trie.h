@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * A radix trie over the suffixes of wildcard domains, keyed from the last character backwards.
+ * Virtual hosts are identified by an index that the caller assigns. A lookup walks the host once,
+ * from its end, and finds the longest suffix that matches it without allocating.
+ */
+class DomainTrie : NonCopyable {
+public:
+  /**
+   * Index the suffix of a wildcard domain. If the suffix is already indexed, the earlier index is
+   * kept.
+   * @param suffix supplies the wildcard domain without its leading '*'. It must not be empty.
+   * @param index supplies the index of the virtual host.
+   */
+  void add(const std::string& suffix, uint32_t index);
+
+  /**
+   * Find the longest suffix that matches a host. A suffix must be shorter than the host, so that
+   * *.foo.com doesn't match .foo.com.
+   * @param host supplies the host.
+   * @param size supplies the length of the host.
+   * @param index receives the index of the virtual host for the suffix, if one is found.
+   * @return bool whether a suffix matches the host.
+   */
+  bool find(const char* host, size_t size, uint32_t& index) const;
+
+  /**
+   * @return bool whether no suffix has been added.
+   */
+  bool empty() const { return root_.children_.empty(); }
+
+private:
+  struct Node;
+  typedef std::unique_ptr<Node> NodePtr;
+
+  struct Node {
+    // The part of the suffix on the edge from the parent to this node, in its original order. It
+    // comes just before the parent's part of the suffix. Siblings never share a last character.
+    std::string label_;
+    bool has_index_{};
+    uint32_t index_{};
+    // Sorted by the last character of their label.
+    std::vector<NodePtr> children_;
+  };
+
+  /**
+   * @return Node& the node for a suffix, created along with any nodes on the way to it.
+   */
+  Node& insert(const std::string& suffix);
+
+  /**
+   * Orders children by the last character of their label, for binary search.
+   */
+  static bool labelLess(const NodePtr& node, char c);
+
+  /**
+   * @return const Node* the child of a node whose label ends with a character, or nullptr.
+   */
+  static const Node* findChild(const Node& node, char c);
+
+  Node root_;
+};
+
+} // namespace Router
+} // namespace Envoy
@@ -177,6 +177,13 @@ bool RetryStateImpl::wouldRetry(const Http::HeaderMap* response_headers,
     return false;
   }
 
+  // We never retry a non-idempotent request that was pipelined behind another one, since the
+  // upstream may have processed it before the connection was terminated.
+  if (reset_reason.valid() &&
+      reset_reason.value() == Http::StreamResetReason::PipelinedConnectionTermination) {
+    return false;
+  }
+
   if (retry_on_ & RetryPolicy::RETRY_ON_5XX) {
     // wouldRetry() is passed null headers when there was an upstream reset. Currently we count an
     // upstream reset as a "5xx" (since it will result in one). We may eventually split this out
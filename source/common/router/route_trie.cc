@@ -0,0 +1,86 @@
+#include "common/router/route_trie.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Envoy {
+namespace Router {
+
+void RouteTrie::addPrefix(const std::string& prefix, uint32_t index) {
+  insert(prefix).prefix_routes_.push_back(index);
+}
+
+void RouteTrie::addPath(const std::string& path, uint32_t index) {
+  insert(path).path_routes_.push_back(index);
+}
+
+void RouteTrie::find(const char* path, size_t size, size_t size_without_query,
+                     std::vector<uint32_t>& indexes) const {
+  const Node* node = &root_;
+  size_t position = 0;
+  while (true) {
+    indexes.insert(indexes.end(), node->prefix_routes_.begin(), node->prefix_routes_.end());
+    if (position == size_without_query) {
+      indexes.insert(indexes.end(), node->path_routes_.begin(), node->path_routes_.end());
+    }
+    if (position == size) {
+      return;
+    }
+
+    node = findChild(*node, path[position]);
+    if (node == nullptr || node->label_.size() > size - position ||
+        memcmp(node->label_.data(), path + position, node->label_.size()) != 0) {
+      return;
+    }
+    position += node->label_.size();
+  }
+}
+
+RouteTrie::Node& RouteTrie::insert(const std::string& key) {
+  Node* node = &root_;
+  size_t position = 0;
+  while (position < key.size()) {
+    auto child = std::lower_bound(node->children_.begin(), node->children_.end(), key[position],
+                                  labelLess);
+    if (child == node->children_.end() || (*child)->label_[0] != key[position]) {
+      // No edge starts like the rest of the key, so the rest of the key becomes a new leaf.
+      NodePtr leaf(new Node());
+      leaf->label_ = key.substr(position);
+      return **node->children_.insert(child, std::move(leaf));
+    }
+
+    // Follow the edge as far as it agrees with the key. If the key ends or differs part way along
+    // the edge, split the edge there.
+    const std::string& label = (*child)->label_;
+    size_t common = 1;
+    while (common < label.size() && position + common < key.size() &&
+           label[common] == key[position + common]) {
+      common++;
+    }
+    if (common < label.size()) {
+      NodePtr split(new Node());
+      split->label_ = label.substr(0, common);
+      (*child)->label_.erase(0, common);
+      split->children_.push_back(std::move(*child));
+      *child = std::move(split);
+    }
+
+    node = child->get();
+    position += common;
+  }
+
+  return *node;
+}
+
+bool RouteTrie::labelLess(const NodePtr& node, char c) { return node->label_[0] < c; }
+
+const RouteTrie::Node* RouteTrie::findChild(const Node& node, char c) {
+  auto child = std::lower_bound(node.children_.begin(), node.children_.end(), c, labelLess);
+  if (child == node.children_.end() || (*child)->label_[0] != c) {
+    return nullptr;
+  }
+  return child->get();
+}
+
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * A radix trie over the prefixes and exact paths of a virtual host's routes. Routes are identified
+ * by their position in the virtual host. A lookup walks the request path once and returns every
+ * route whose path specifier matches it. The caller still evaluates those routes in order, with
+ * their header and runtime constraints, so that the first matching route wins as before.
+ *
+ * Only case sensitive prefix and exact path routes can be indexed.
+ */
+class RouteTrie : NonCopyable {
+public:
+  /**
+   * Index a prefix route.
+   * @param prefix supplies the prefix that the route matches.
+   * @param index supplies the position of the route.
+   */
+  void addPrefix(const std::string& prefix, uint32_t index);
+
+  /**
+   * Index an exact path route.
+   * @param path supplies the path that the route matches, without a query string.
+   * @param index supplies the position of the route.
+   */
+  void addPath(const std::string& path, uint32_t index);
+
+  /**
+   * Find the routes whose path specifier matches a request path.
+   * @param path supplies the request path, including any query string.
+   * @param size supplies the length of the path.
+   * @param size_without_query supplies the length of the path before the query string, which is
+   *        what exact path routes are compared with.
+   * @param indexes receives the positions of the routes, in no particular order.
+   */
+  void find(const char* path, size_t size, size_t size_without_query,
+            std::vector<uint32_t>& indexes) const;
+
+private:
+  struct Node;
+  typedef std::unique_ptr<Node> NodePtr;
+
+  struct Node {
+    // The part of the key on the edge from the parent to this node. Siblings never share a first
+    // character.
+    std::string label_;
+    std::vector<uint32_t> prefix_routes_;
+    std::vector<uint32_t> path_routes_;
+    // Sorted by the first character of their label.
+    std::vector<NodePtr> children_;
+  };
+
+  /**
+   * @return Node& the node for a key, created along with any nodes on the way to it.
+   */
+  Node& insert(const std::string& key);
+
+  /**
+   * Orders children by the first character of their label, for binary search.
+   */
+  static bool labelLess(const NodePtr& node, char c);
+
+  /**
+   * @return const Node* the child of a node whose label starts with a character, or nullptr.
+   */
+  static const Node* findChild(const Node& node, char c);
+
+  Node root_;
+};
+
+} // namespace Router
+} // namespace Envoy
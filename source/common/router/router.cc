@@ -513,6 +513,7 @@ Filter::streamResetReasonToResponseFlag(Http::StreamResetReason reset_reason) {
   case Http::StreamResetReason::ConnectionFailure:
     return Http::AccessLog::ResponseFlag::UpstreamConnectionFailure;
   case Http::StreamResetReason::ConnectionTermination:
+  case Http::StreamResetReason::PipelinedConnectionTermination:
     return Http::AccessLog::ResponseFlag::UpstreamConnectionTermination;
   case Http::StreamResetReason::LocalReset:
   case Http::StreamResetReason::LocalRefusedStreamReset:
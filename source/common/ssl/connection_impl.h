@@ -26,6 +26,8 @@ public:
   std::string nextProtocol() const override;
   Ssl::Connection* ssl() override { return this; }
   const Ssl::Connection* ssl() const override { return this; }
+  // Data is encrypted into OpenSSL's own buffers, so there is nothing to send without copying.
+  bool enableZeroCopySend(const ZeroCopySendStats&) override { return false; }
 
   // Ssl::Connection
   bool peerCertificatePresented() override;
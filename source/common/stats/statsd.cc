@@ -201,11 +201,13 @@ void TcpStatsdSink::TlsSink::write(Buffer::Instance& buffer) {
 
     connection_ = std::move(info.connection_);
     connection_->addConnectionCallbacks(*this);
-    connection_->setConnectionStats({parent_.cluster_info_->stats().upstream_cx_rx_bytes_total_,
-                                     parent_.cluster_info_->stats().upstream_cx_rx_bytes_buffered_,
-                                     parent_.cluster_info_->stats().upstream_cx_tx_bytes_total_,
-                                     parent_.cluster_info_->stats().upstream_cx_tx_bytes_buffered_,
-                                     &parent_.cluster_info_->stats().bind_errors_});
+    connection_->setConnectionStats(
+        {parent_.cluster_info_->stats().upstream_cx_rx_bytes_total_,
+         parent_.cluster_info_->stats().upstream_cx_rx_bytes_buffered_,
+         parent_.cluster_info_->stats().upstream_cx_tx_bytes_total_,
+         parent_.cluster_info_->stats().upstream_cx_tx_bytes_buffered_,
+         &parent_.cluster_info_->stats().bind_errors_,
+         &parent_.cluster_info_->stats().upstream_cx_rx_syscalls_total_});
     connection_->connect();
   }
 
@@ -1,5 +1,6 @@
 #include "common/upstream/cluster_manager_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <functional>
@@ -560,15 +561,33 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
   }
   }
 
-  host_set_.addMemberUpdateCb([this](const std::vector<HostSharedPtr>&,
+  host_set_.addMemberUpdateCb([this](const std::vector<HostSharedPtr>& hosts_added,
                                      const std::vector<HostSharedPtr>& hosts_removed) -> void {
     // We need to go through and purge any connection pools for hosts that got deleted.
     // Even if two hosts actually point to the same address this will be safe, since if a
     // host is readded it will be a different physical HostSharedPtr.
     parent_.drainConnPools(hosts_removed);
+    preconnect(hosts_added);
   });
 }
 
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::preconnect(
+    const std::vector<HostSharedPtr>& hosts) {
+  // Warm up pools for new hosts so that their first requests do not wait for a handshake.
+  if (hosts.empty() ||
+      parent_.parent_.runtime_.snapshot().getInteger(
+          fmt::format("upstream.{}.preconnect_min_idle_connections", cluster_info_->name()), 0) ==
+          0) {
+    return;
+  }
+
+  for (const HostSharedPtr& host : hosts) {
+    if (host->healthy()) {
+      connPool(host, ResourcePriority::Default).preconnect();
+    }
+  }
+}
+
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::~ClusterEntry() {
   // We need to drain all connection pools for the cluster being removed. Then we can remove the
   // cluster.
@@ -588,6 +607,12 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
     return nullptr;
   }
 
+  return &connPool(host, priority);
+}
+
+Http::ConnectionPool::Instance&
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
+    HostConstSharedPtr host, ResourcePriority priority) {
   ConnPoolsContainer& container = parent_.host_http_conn_pool_map_[host];
   ASSERT(enumToInt(priority) < container.pools_.size());
   if (!container.pools_[enumToInt(priority)]) {
@@ -595,7 +620,7 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
         parent_.parent_.factory_.allocateConnPool(parent_.thread_local_dispatcher_, host, priority);
   }
 
-  return container.pools_[enumToInt(priority)].get();
+  return *container.pools_[enumToInt(priority)];
 }
 
 ClusterManagerPtr ProdClusterManagerFactory::clusterManagerFromProto(
@@ -609,13 +634,32 @@ ClusterManagerPtr ProdClusterManagerFactory::clusterManagerFromProto(
 Http::ConnectionPool::InstancePtr
 ProdClusterManagerFactory::allocateConnPool(Event::Dispatcher& dispatcher, HostConstSharedPtr host,
                                             ResourcePriority priority) {
+  const std::string& cluster_name = host->cluster().name();
+  Http::ConnectionPool::PreconnectPolicy preconnect_policy;
+  preconnect_policy.min_idle_connections_ = runtime_.snapshot().getInteger(
+      fmt::format("upstream.{}.preconnect_min_idle_connections", cluster_name), 0);
+  preconnect_policy.ratio_ =
+      runtime_.snapshot().getInteger(
+          fmt::format("upstream.{}.preconnect_ratio_percent", cluster_name), 100) /
+      100.0;
+
   if ((host->cluster().features() & ClusterInfo::Features::HTTP2) &&
       runtime_.snapshot().featureEnabled("upstream.use_http2", 100)) {
+    const uint64_t max_connections = runtime_.snapshot().getInteger(
+        fmt::format("upstream.{}.http2_max_connections", cluster_name), 1);
+    const uint64_t target_streams_per_connection = runtime_.snapshot().getInteger(
+        fmt::format("upstream.{}.http2_target_streams_per_connection", cluster_name),
+        Http::Http2::ConnPoolImpl::DEFAULT_TARGET_STREAMS_PER_CONNECTION);
     return Http::ConnectionPool::InstancePtr{
-        new Http::Http2::ProdConnPoolImpl(dispatcher, host, priority)};
+        new Http::Http2::ProdConnPoolImpl(dispatcher, host, priority, max_connections,
+                                          target_streams_per_connection, preconnect_policy)};
   } else {
+    const uint64_t max_pipelined_requests = runtime_.snapshot().getInteger(
+        fmt::format("upstream.{}.http1_max_pipelined_requests", cluster_name), 1);
     return Http::ConnectionPool::InstancePtr{
-        new Http::Http1::ConnPoolImplProd(dispatcher, host, priority)};
+        new Http::Http1::ConnPoolImplProd(dispatcher, host, priority,
+                                          std::max<uint64_t>(max_pipelined_requests, 1),
+                                          preconnect_policy)};
   }
 }
 
@@ -183,6 +183,8 @@ private:
 
       Http::ConnectionPool::Instance* connPool(ResourcePriority priority,
                                                LoadBalancerContext* context);
+      Http::ConnectionPool::Instance& connPool(HostConstSharedPtr host, ResourcePriority priority);
+      void preconnect(const std::vector<HostSharedPtr>& hosts);
 
       // Upstream::ThreadLocalCluster
       const HostSet& hostSet() override { return host_set_; }
@@ -61,6 +61,7 @@ HostImpl::createConnection(Event::Dispatcher& dispatcher, const ClusterInfo& clu
                                                                   cluster.sourceAddress())
                            : dispatcher.createClientConnection(address, cluster.sourceAddress());
   connection->setBufferLimits(cluster.perConnectionBufferLimitBytes());
+  connection->setBufferMemoryGauge(cluster.stats().upstream_cx_buffer_memory_bytes_);
   return connection;
 }
 
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <memory>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/compiler_requirements.h"
 #include "common/event/libevent.h"
 #include "common/network/utility.h"
@@ -62,6 +63,7 @@ int main_common(OptionsImpl& options) {
 #endif
 
   Event::Libevent::Global::initialize();
+  Buffer::OwnedImpl::useOldImpl(options.libeventBuffersEnabled());
   Server::ProdComponentFactory component_factory;
   auto local_address = Network::Utility::getLocalAddress(options.localAddressIpVersion());
   switch (options.mode()) {
@@ -23,8 +23,7 @@ HttpFilterFactoryCb BufferFilterConfig::createFilterFactory(const Json::Object&
       static_cast<uint64_t>(json_config.getInteger("max_request_bytes")),
       std::chrono::seconds(json_config.getInteger("max_request_time_s"))});
   return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamDecoderFilter(
-        Http::StreamDecoderFilterSharedPtr{new Http::BufferFilter(config)});
+    callbacks.addStreamDecoderFilter(callbacks.arena().makeShared<Http::BufferFilter>(config));
   };
 }
 
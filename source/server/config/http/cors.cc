@@ -12,7 +12,7 @@ HttpFilterFactoryCb CorsFilterConfig::createFilterFactory(const Json::Object&, c
                                                           FactoryContext&) {
 
   return [](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamFilter(Http::StreamFilterSharedPtr{new Http::CorsFilter()});
+    callbacks.addStreamFilter(callbacks.arena().makeShared<Http::CorsFilter>());
   };
 }
 
@@ -14,8 +14,8 @@ HttpFilterFactoryCb DynamoFilterConfig::createFilterFactory(const Json::Object&,
                                                             const std::string& stat_prefix,
                                                             FactoryContext& context) {
   return [&context, stat_prefix](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamFilter(Http::StreamFilterSharedPtr{
-        new Dynamo::DynamoFilter(context.runtime(), stat_prefix, context.scope())});
+    callbacks.addStreamFilter(callbacks.arena().makeShared<Dynamo::DynamoFilter>(
+        context.runtime(), stat_prefix, context.scope()));
   };
 }
 
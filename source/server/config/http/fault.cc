@@ -17,8 +17,7 @@ HttpFilterFactoryCb FaultFilterConfig::createFilterFactory(const Json::Object& j
   Http::FaultFilterConfigSharedPtr config(
       new Http::FaultFilterConfig(json_config, context.runtime(), stats_prefix, context.scope()));
   return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamDecoderFilter(
-        Http::StreamDecoderFilterSharedPtr{new Http::FaultFilter(config)});
+    callbacks.addStreamDecoderFilter(callbacks.arena().makeShared<Http::FaultFilter>(config));
   };
 }
 
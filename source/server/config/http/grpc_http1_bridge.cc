@@ -15,7 +15,7 @@ HttpFilterFactoryCb GrpcHttp1BridgeFilterConfig::createFilterFactory(const Json:
                                                                      FactoryContext& context) {
   return [&context](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamFilter(
-        Http::StreamFilterSharedPtr{new Grpc::Http1BridgeFilter(context.clusterManager())});
+        callbacks.arena().makeShared<Grpc::Http1BridgeFilter>(context.clusterManager()));
   };
 }
 
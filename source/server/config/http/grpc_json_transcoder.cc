@@ -18,7 +18,7 @@ GrpcJsonTranscoderFilterConfig::createFilterFactory(const Json::Object& config_j
       std::make_shared<Grpc::JsonTranscoderConfig>(config_json);
 
   return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamFilter(Http::StreamFilterSharedPtr{new Grpc::JsonTranscoderFilter(*config)});
+    callbacks.addStreamFilter(callbacks.arena().makeShared<Grpc::JsonTranscoderFilter>(*config));
   };
 }
 
@@ -13,7 +13,7 @@ HttpFilterFactoryCb GrpcWebFilterConfig::createFilterFactory(const Json::Object&
                                                              FactoryContext& context) {
   return [&context](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamFilter(
-        Http::StreamFilterSharedPtr{new Grpc::GrpcWebFilter(context.clusterManager())});
+        callbacks.arena().makeShared<Grpc::GrpcWebFilter>(context.clusterManager()));
   };
 }
 
@@ -19,8 +19,8 @@ HttpFilterFactoryCb RateLimitFilterConfig::createFilterFactory(const Json::Objec
   const uint32_t timeout_ms = config.getInteger("timeout_ms", 20);
   return [filter_config, timeout_ms,
           &context](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamDecoderFilter(Http::StreamDecoderFilterSharedPtr{new Http::RateLimit::Filter(
-        filter_config, context.rateLimitClient(std::chrono::milliseconds(timeout_ms)))});
+    callbacks.addStreamDecoderFilter(callbacks.arena().makeShared<Http::RateLimit::Filter>(
+        filter_config, context.rateLimitClient(std::chrono::milliseconds(timeout_ms))));
   };
 }
 
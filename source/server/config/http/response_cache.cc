@@ -0,0 +1,45 @@
+#include "server/config/http/response_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "envoy/registry/registry.h"
+#include "envoy/singleton/manager.h"
+
+#include "common/common/utility.h"
+#include "common/http/filter/response_cache_filter.h"
+
+namespace Envoy {
+namespace Server {
+namespace Configuration {
+
+// Singleton registration via macro defined in envoy/singleton/manager.h
+SINGLETON_MANAGER_REGISTRATION(response_cache_admin);
+
+HttpFilterFactoryCb ResponseCacheFilterConfig::createFilterFactory(const Json::Object& json_config,
+                                                                   const std::string& stats_prefix,
+                                                                   FactoryContext& context) {
+  std::shared_ptr<Http::ResponseCacheAdmin> cache_admin =
+      context.singletonManager().getTyped<Http::ResponseCacheAdmin>(
+          SINGLETON_MANAGER_REGISTERED_NAME(response_cache_admin),
+          [&context] { return std::make_shared<Http::ResponseCacheAdmin>(context.admin()); });
+
+  Http::ResponseCacheFilterConfigSharedPtr config(new Http::ResponseCacheFilterConfig(
+      json_config, stats_prefix, context.scope(), ProdSystemTimeSource::instance_));
+  cache_admin->addCache(stats_prefix, config->cache());
+
+  // The admin endpoint is kept for as long as any filter chain that can fill a cache.
+  return [config, cache_admin](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addStreamFilter(callbacks.arena().makeShared<Http::ResponseCacheFilter>(config));
+  };
+}
+
+/**
+ * Static registration for the response cache filter. @see RegisterFactory.
+ */
+static Registry::RegisterFactory<ResponseCacheFilterConfig, NamedHttpFilterConfigFactory>
+    register_;
+
+} // namespace Configuration
+} // namespace Server
+} // namespace Envoy
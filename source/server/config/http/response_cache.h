@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+#include "envoy/server/filter_config.h"
+
+#include "common/config/well_known_names.h"
+
+namespace Envoy {
+namespace Server {
+namespace Configuration {
+
+/**
+ * Config registration for the response cache filter. @see NamedHttpFilterConfigFactory.
+ */
+class ResponseCacheFilterConfig : public NamedHttpFilterConfigFactory {
+public:
+  HttpFilterFactoryCb createFilterFactory(const Json::Object& json_config,
+                                          const std::string& stats_prefix,
+                                          FactoryContext& context) override;
+  std::string name() override { return Config::HttpFilterNames::get().RESPONSE_CACHE; }
+};
+
+} // namespace Configuration
+} // namespace Server
+} // namespace Envoy
@@ -24,7 +24,7 @@ HttpFilterFactoryCb RouterFilterConfig::createFilterFactory(const Json::Object&
       json_config.getBoolean("dynamic_stats", true)));
 
   return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamDecoderFilter(std::make_shared<Router::ProdFilter>(*config));
+    callbacks.addStreamDecoderFilter(callbacks.arena().makeShared<Router::ProdFilter>(*config));
   };
 }
 
@@ -122,6 +122,7 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
       route_config_provider_manager_(route_config_provider_manager),
       http2_settings_(Http::Utility::parseHttp2Settings(config.http2_protocol_options())),
       http1_settings_(Http::Utility::parseHttp1Settings(config.http_protocol_options())),
+      fast_http1_parser_key_(stats_prefix_ + "fast_http1_parser"),
       drain_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(config, drain_timeout, 5000)),
       generate_request_id_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, generate_request_id, true)),
       date_provider_(date_provider),
@@ -220,6 +221,7 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
   }
 
   const auto& filters = config.http_filters();
+  filter_factories_.reserve(filters.size());
   for (int32_t i = 0; i < filters.size(); i++) {
     const ProtobufTypes::String& string_name = filters[i].name();
     const auto& proto_config = filters[i];
@@ -241,7 +243,7 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
           Config::Utility::translateToFactoryConfig(proto_config, factory);
       callback = factory.createFilterFactoryFromProto(*message, stats_prefix_, context);
     }
-    filter_factories_.push_back(callback);
+    filter_factories_.push_back(std::move(callback));
   }
 }
 
@@ -252,7 +254,7 @@ HttpConnectionManagerConfig::createCodec(Network::Connection& connection,
   switch (codec_type_) {
   case CodecType::HTTP1:
     return Http::ServerConnectionPtr{
-        new Http::Http1::ServerConnectionImpl(connection, callbacks, http1_settings_)};
+        new Http::Http1::ServerConnectionImpl(connection, callbacks, http1Settings())};
   case CodecType::HTTP2:
     return Http::ServerConnectionPtr{new Http::Http2::ServerConnectionImpl(
         connection, callbacks, context_.scope(), http2_settings_)};
@@ -263,13 +265,19 @@ HttpConnectionManagerConfig::createCodec(Network::Connection& connection,
           connection, callbacks, context_.scope(), http2_settings_)};
     } else {
       return Http::ServerConnectionPtr{
-          new Http::Http1::ServerConnectionImpl(connection, callbacks, http1_settings_)};
+          new Http::Http1::ServerConnectionImpl(connection, callbacks, http1Settings())};
     }
   }
 
   NOT_REACHED;
 }
 
+Http::Http1Settings HttpConnectionManagerConfig::http1Settings() {
+  Http::Http1Settings settings = http1_settings_;
+  settings.fast_parser_ = context_.runtime().snapshot().featureEnabled(fast_http1_parser_key_, 0);
+  return settings;
+}
+
 void HttpConnectionManagerConfig::createFilterChain(Http::FilterChainFactoryCallbacks& callbacks) {
   for (const HttpFilterFactoryCb& factory : filter_factories_) {
     factory(callbacks);
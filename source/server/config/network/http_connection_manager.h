@@ -5,6 +5,7 @@
 #include <functional>
 #include <list>
 #include <string>
+#include <vector>
 
 #include "envoy/http/filter.h"
 #include "envoy/router/route_config_provider_manager.h"
@@ -99,8 +100,14 @@ public:
 private:
   enum class CodecType { HTTP1, HTTP2, AUTO };
 
+  /**
+   * @return Http::Http1Settings the settings for a new HTTP/1.1 codec.
+   */
+  Http::Http1Settings http1Settings();
+
   FactoryContext& context_;
-  std::list<HttpFilterFactoryCb> filter_factories_;
+  // The filter chain, in order, created for every stream.
+  std::vector<HttpFilterFactoryCb> filter_factories_;
   std::list<Http::AccessLog::InstanceSharedPtr> access_logs_;
   const std::string stats_prefix_;
   Http::ConnectionManagerStats stats_;
@@ -112,6 +119,7 @@ private:
   CodecType codec_type_;
   const Http::Http2Settings http2_settings_;
   const Http::Http1Settings http1_settings_;
+  const std::string fast_http1_parser_key_;
   std::string server_name_;
   Http::TracingConnectionManagerConfigPtr tracing_config_;
   Optional<std::string> user_agent_;
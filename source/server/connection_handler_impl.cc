@@ -4,12 +4,21 @@
 #include "envoy/event/timer.h"
 #include "envoy/network/filter.h"
 
+#include "common/network/zero_copy_sender.h"
+
 namespace Envoy {
 namespace Server {
 
 ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher)
     : logger_(logger), dispatcher_(dispatcher) {}
 
+ConnectionHandlerImpl::~ConnectionHandlerImpl() {
+  listeners_.clear();
+  // Closed connections may have left sockets open for zero copy sends to complete. They can't
+  // outlive the handler's connections, as nothing would run the dispatcher for them.
+  Network::ZeroCopySender::closeDrainingSockets(dispatcher_);
+}
+
 void ConnectionHandlerImpl::addListener(Network::FilterChainFactory& factory,
                                         Network::ListenSocket& socket, Stats::Scope& scope,
                                         uint64_t listener_tag,
@@ -68,14 +77,15 @@ ConnectionHandlerImpl::ActiveListener::ActiveListener(
     const Network::ListenerOptions& listener_options)
     : ActiveListener(
           parent, parent.dispatcher_.createListener(parent, socket, *this, scope, listener_options),
-          factory, scope, listener_tag) {}
+          factory, scope, listener_tag, listener_options.zero_copy_send_) {}
 
 ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& parent,
                                                       Network::ListenerPtr&& listener,
                                                       Network::FilterChainFactory& factory,
-                                                      Stats::Scope& scope, uint64_t listener_tag)
+                                                      Stats::Scope& scope, uint64_t listener_tag,
+                                                      bool zero_copy_send)
     : parent_(parent), factory_(factory), listener_(std::move(listener)),
-      stats_(generateStats(scope)), listener_tag_(listener_tag) {}
+      stats_(generateStats(scope)), listener_tag_(listener_tag), zero_copy_send_(zero_copy_send) {}
 
 ConnectionHandlerImpl::ActiveListener::~ActiveListener() {
   while (!connections_.empty()) {
@@ -92,7 +102,7 @@ ConnectionHandlerImpl::SslActiveListener::SslActiveListener(
     : ActiveListener(parent,
                      parent.dispatcher_.createSslListener(parent, ssl_ctx, socket, *this, scope,
                                                           listener_options),
-                     factory, scope, listener_tag) {}
+                     factory, scope, listener_tag, listener_options.zero_copy_send_) {}
 
 Network::Listener*
 ConnectionHandlerImpl::findListenerByAddress(const Network::Address::Instance& address) {
@@ -126,6 +136,11 @@ ConnectionHandlerImpl::findListenerByAddress(const Network::Address::Instance& a
 void ConnectionHandlerImpl::ActiveListener::onNewConnection(
     Network::ConnectionPtr&& new_connection) {
   ENVOY_CONN_LOG_TO_LOGGER(parent_.logger_, info, "new connection", *new_connection);
+  new_connection->setBufferMemoryGauge(stats_.downstream_cx_buffer_memory_bytes_);
+  if (zero_copy_send_) {
+    new_connection->enableZeroCopySend(
+        {stats_.downstream_cx_zerocopy_sends_, stats_.downstream_cx_zerocopy_fallbacks_});
+  }
   bool empty_filter_chain = !factory_.createFilterChain(*new_connection);
 
   // If the connection is already closed, we can just let this connection immediately die.
@@ -26,6 +26,9 @@ namespace Server {
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_destroy)                                                                   \
   GAUGE  (downstream_cx_active)                                                                    \
+  GAUGE  (downstream_cx_buffer_memory_bytes)                                                        \
+  COUNTER(downstream_cx_zerocopy_sends)                                                            \
+  COUNTER(downstream_cx_zerocopy_fallbacks)                                                        \
   TIMER  (downstream_cx_length_ms)
 // clang-format on
 
@@ -43,6 +46,7 @@ struct ListenerStats {
 class ConnectionHandlerImpl : public Network::ConnectionHandler, NonCopyable {
 public:
   ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher);
+  ~ConnectionHandlerImpl();
 
   // Network::ConnectionHandler
   uint64_t numConnections() override { return num_connections_; }
@@ -71,7 +75,7 @@ private:
 
     ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerPtr&& listener,
                    Network::FilterChainFactory& factory, Stats::Scope& scope,
-                   uint64_t listener_tag);
+                   uint64_t listener_tag, bool zero_copy_send);
 
     ~ActiveListener();
 
@@ -93,6 +97,7 @@ private:
     ListenerStats stats_;
     std::list<ActiveConnectionPtr> connections_;
     const uint64_t listener_tag_;
+    const bool zero_copy_send_;
   };
 
   struct SslActiveListener : public ActiveListener {
@@ -396,7 +396,7 @@ bool AdminImpl::createFilterChain(Network::Connection& connection) {
 }
 
 void AdminImpl::createFilterChain(Http::FilterChainFactoryCallbacks& callbacks) {
-  callbacks.addStreamDecoderFilter(Http::StreamDecoderFilterSharedPtr{new AdminFilter(*this)});
+  callbacks.addStreamDecoderFilter(callbacks.arena().makeShared<AdminFilter>(*this));
 }
 
 Http::Code AdminImpl::runCallback(const std::string& path, Buffer::Instance& response) {
@@ -47,8 +47,8 @@ HttpFilterFactoryCb HealthCheckFilterConfig::createFilterFactory(const Json::Obj
 
   return [&context, pass_through_mode, cache_manager,
           hc_endpoint](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamFilter(Http::StreamFilterSharedPtr{
-        new HealthCheckFilter(context, pass_through_mode, cache_manager, hc_endpoint)});
+    callbacks.addStreamFilter(callbacks.arena().makeShared<HealthCheckFilter>(
+        context, pass_through_mode, cache_manager, hc_endpoint));
   };
 }
 
@@ -198,6 +198,7 @@ public:
   bool useProxyProto() override { return use_proxy_proto_; }
   bool useOriginalDst() override { return use_original_dst_; }
   uint32_t perConnectionBufferLimitBytes() override { return per_connection_buffer_limit_bytes_; }
+  bool zeroCopySend() override { return zero_copy_send_; }
   Stats::Scope& listenerScope() override { return *listener_scope_; }
   uint64_t listenerTag() override { return listener_tag_; }
   const std::string& name() const override { return name_; }
@@ -241,6 +242,8 @@ private:
   const bool use_proxy_proto_;
   const bool use_original_dst_;
   const uint32_t per_connection_buffer_limit_bytes_;
+  // Read from runtime once, when the listener is created.
+  const bool zero_copy_send_;
   const uint64_t listener_tag_;
   const std::string name_;
   const bool workers_started_;
@@ -64,6 +64,14 @@ OptionsImpl::OptionsImpl(int argc, char** argv, const std::string& hot_restart_v
                                     "One of 'serve' (default; validate configs and then serve "
                                     "traffic normally) or 'validate' (validate configs and exit).",
                                     false, "serve", "string", cmd);
+  TCLAP::ValueArg<uint32_t> max_buffer_memory_mb(
+      "", "max-buffer-memory-mb",
+      "Limit on connection and HTTP stream buffer memory across all workers in MiB (0 for none)",
+      false, 0, "uint32_t", cmd);
+  TCLAP::SwitchArg use_libevent_buffers("", "use-libevent-buffers",
+                                        "Use libevent evbuffers instead of the native buffer "
+                                        "implementation",
+                                        cmd, false);
 
   try {
     cmd.parse(argc, argv);
@@ -116,5 +124,7 @@ OptionsImpl::OptionsImpl(int argc, char** argv, const std::string& hot_restart_v
   file_flush_interval_msec_ = std::chrono::milliseconds(file_flush_interval_msec.getValue());
   drain_time_ = std::chrono::seconds(drain_time_s.getValue());
   parent_shutdown_time_ = std::chrono::seconds(parent_shutdown_time_s.getValue());
+  max_buffer_memory_bytes_ = static_cast<uint64_t>(max_buffer_memory_mb.getValue()) * 1024 * 1024;
+  libevent_buffers_enabled_ = use_libevent_buffers.getValue();
 }
 } // namespace Envoy
@@ -33,6 +33,13 @@ public:
   const std::string& serviceClusterName() override { return service_cluster_; }
   const std::string& serviceNodeName() override { return service_node_; }
   const std::string& serviceZone() override { return service_zone_; }
+  uint64_t maxBufferMemoryBytes() override { return max_buffer_memory_bytes_; }
+
+  /**
+   * @return bool whether buffers should wrap libevent evbuffers instead of using the native
+   *         buffer implementation.
+   */
+  bool libeventBuffersEnabled() const { return libevent_buffers_enabled_; }
 
 private:
   uint64_t base_id_;
@@ -50,5 +57,7 @@ private:
   std::chrono::seconds drain_time_;
   std::chrono::seconds parent_shutdown_time_;
   Server::Mode mode_;
+  uint64_t max_buffer_memory_bytes_;
+  bool libevent_buffers_enabled_;
 };
 } // namespace Envoy
@@ -47,7 +47,8 @@ InstanceImpl::InstanceImpl(Options& options, Network::Address::InstanceConstShar
       thread_local_(tls), api_(new Api::Impl(options.fileFlushIntervalMsec())),
       dispatcher_(api_->allocateDispatcher()), singleton_manager_(new Singleton::ManagerImpl()),
       handler_(new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher_)),
-      listener_component_factory_(*this), worker_factory_(thread_local_, *api_, hooks),
+      listener_component_factory_(*this), worker_factory_(thread_local_, *api_, hooks, store,
+                                                          options.maxBufferMemoryBytes()),
       dns_resolver_(dispatcher_->createDnsResolver({})),
       access_log_manager_(*api_, *dispatcher_, access_log_lock, store) {
 
@@ -191,6 +192,9 @@ void InstanceImpl::initialize(Options& options,
   admin_.reset(new AdminImpl(initial_config.admin().accessLogPath(),
                              initial_config.admin().profilePath(), options.adminAddressPath(),
                              initial_config.admin().address(), *this));
+  admin_->addHandler("/buffer_memory",
+                     "print buffer memory usage and the connections holding the most",
+                     MAKE_ADMIN_HANDLER(handlerBufferMemory), false);
 
   admin_scope_ = stats_store_.createScope("listener.admin.");
   handler_->addListener(*admin_, admin_->mutable_socket(), *admin_scope_, 0,
@@ -280,6 +284,13 @@ void InstanceImpl::loadServerFlags(const Optional<std::string>& flags_path) {
   }
 }
 
+const uint64_t InstanceImpl::BUFFER_MEMORY_MAX_CONNECTIONS;
+
+Http::Code InstanceImpl::handlerBufferMemory(const std::string&, Buffer::Instance& response) {
+  response.add(worker_factory_.bufferMemoryTracker().dump(BUFFER_MEMORY_MAX_CONNECTIONS));
+  return Http::Code::OK;
+}
+
 uint64_t InstanceImpl::numConnections() { return listener_manager_->numConnections(); }
 
 RunHelper::RunHelper(Event::Dispatcher& dispatcher, Upstream::ClusterManager& cm,
@@ -158,6 +158,10 @@ private:
   void loadServerFlags(const Optional<std::string>& flags_path);
   uint64_t numConnections();
   void startWorkers();
+  Http::Code handlerBufferMemory(const std::string& url, Buffer::Instance& response);
+
+  // The number of connections listed by the /buffer_memory admin endpoint.
+  static const uint64_t BUFFER_MEMORY_MAX_CONNECTIONS = 20;
 
   Options& options_;
   HotRestart& restarter_;
@@ -18,12 +18,16 @@ WorkerPtr ProdWorkerFactory::createWorker() {
   Event::DispatcherPtr dispatcher(api_.allocateDispatcher());
   return WorkerPtr{new WorkerImpl(
       tls_, hooks_, std::move(dispatcher),
-      Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher)})};
+      Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher)},
+      slice_pool_stats_, buffer_memory_tracker_)};
 }
 
 WorkerImpl::WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks,
-                       Event::DispatcherPtr&& dispatcher, Network::ConnectionHandlerPtr handler)
-    : tls_(tls), hooks_(hooks), dispatcher_(std::move(dispatcher)), handler_(std::move(handler)) {
+                       Event::DispatcherPtr&& dispatcher, Network::ConnectionHandlerPtr handler,
+                       Buffer::SlicePoolStats& slice_pool_stats,
+                       Network::BufferMemoryTracker& buffer_memory_tracker)
+    : tls_(tls), hooks_(hooks), dispatcher_(std::move(dispatcher)), handler_(std::move(handler)),
+      slice_pool_stats_(slice_pool_stats), buffer_memory_tracker_(buffer_memory_tracker) {
   tls_.registerThread(*dispatcher_, false);
 }
 
@@ -47,7 +51,8 @@ void WorkerImpl::addListenerWorker(Listener& listener) {
                                                      .use_proxy_proto_ = listener.useProxyProto(),
                                                      .use_original_dst_ = listener.useOriginalDst(),
                                                      .per_connection_buffer_limit_bytes_ =
-                                                         listener.perConnectionBufferLimitBytes()};
+                                                         listener.perConnectionBufferLimitBytes(),
+                                                     .zero_copy_send_ = listener.zeroCopySend()};
   if (listener.sslContext()) {
     handler_->addSslListener(listener.filterChainFactory(), *listener.sslContext(),
                              listener.socket(), listener.listenerScope(), listener.listenerTag(),
@@ -104,6 +109,12 @@ void WorkerImpl::stopListeners() {
 }
 
 void WorkerImpl::threadRoutine(GuardDog& guard_dog) {
+  // Buffer memory allocated and released on this thread is recycled through a per worker pool.
+  Buffer::SlicePool slice_pool(slice_pool_stats_, SLICE_POOL_MAX_CACHED_BYTES);
+  Buffer::SlicePool::setThreadLocal(&slice_pool);
+  // Connections created on this thread account for their buffer memory here.
+  Network::ThreadBufferMemoryTracker buffer_memory_tracker(buffer_memory_tracker_, *dispatcher_);
+
   ENVOY_LOG(info, "worker entering dispatch loop");
   auto watchdog = guard_dog.createWatchDog(Thread::Thread::currentThreadId());
   watchdog->startWatchdog(*dispatcher_);
@@ -118,6 +129,7 @@ void WorkerImpl::threadRoutine(GuardDog& guard_dog) {
   handler_.reset();
   tls_.shutdownThread();
   watchdog.reset();
+  Buffer::SlicePool::setThreadLocal(nullptr);
 }
 
 } // namespace Server
@@ -8,10 +8,13 @@
 #include "envoy/server/guarddog.h"
 #include "envoy/server/listener_manager.h"
 #include "envoy/server/worker.h"
+#include "envoy/stats/stats.h"
 #include "envoy/thread_local/thread_local.h"
 
+#include "common/buffer/slice_pool.h"
 #include "common/common/logger.h"
 #include "common/common/thread.h"
+#include "common/network/buffer_memory_tracker.h"
 
 #include "server/test_hooks.h"
 
@@ -20,8 +23,17 @@ namespace Server {
 
 class ProdWorkerFactory : public WorkerFactory, Logger::Loggable<Logger::Id::main> {
 public:
-  ProdWorkerFactory(ThreadLocal::Instance& tls, Api::Api& api, TestHooks& hooks)
-      : tls_(tls), api_(api), hooks_(hooks) {}
+  ProdWorkerFactory(ThreadLocal::Instance& tls, Api::Api& api, TestHooks& hooks,
+                    Stats::Scope& scope, uint64_t max_buffer_memory_bytes)
+      : tls_(tls), api_(api), hooks_(hooks),
+        slice_pool_stats_{ALL_SLICE_POOL_STATS(POOL_COUNTER_PREFIX(scope, "buffer.slice_pool."),
+                                               POOL_GAUGE_PREFIX(scope, "buffer.slice_pool."))},
+        buffer_memory_tracker_(scope, max_buffer_memory_bytes) {}
+
+  /**
+   * @return Network::BufferMemoryTracker& the tracker of the buffer memory of all workers.
+   */
+  Network::BufferMemoryTracker& bufferMemoryTracker() { return buffer_memory_tracker_; }
 
   // Server::WorkerFactory
   WorkerPtr createWorker() override;
@@ -30,6 +42,8 @@ private:
   ThreadLocal::Instance& tls_;
   Api::Api& api_;
   TestHooks& hooks_;
+  Buffer::SlicePoolStats slice_pool_stats_;
+  Network::BufferMemoryTracker buffer_memory_tracker_;
 };
 
 /**
@@ -38,7 +52,11 @@ private:
 class WorkerImpl : public Worker, Logger::Loggable<Logger::Id::main> {
 public:
   WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks, Event::DispatcherPtr&& dispatcher,
-             Network::ConnectionHandlerPtr handler);
+             Network::ConnectionHandlerPtr handler, Buffer::SlicePoolStats& slice_pool_stats,
+             Network::BufferMemoryTracker& buffer_memory_tracker);
+
+  // The maximum number of bytes of free buffer memory each worker keeps cached for reuse.
+  static const uint64_t SLICE_POOL_MAX_CACHED_BYTES = 4 * 1024 * 1024;
 
   // Server::Worker
   void addListener(Listener& listener, AddListenerCompletion completion) override;
@@ -58,6 +76,8 @@ private:
   Event::DispatcherPtr dispatcher_;
   Network::ConnectionHandlerPtr handler_;
   Thread::ThreadPtr thread_;
+  Buffer::SlicePoolStats& slice_pool_stats_;
+  Network::BufferMemoryTracker& buffer_memory_tracker_;
 };
 
 } // namespace Server
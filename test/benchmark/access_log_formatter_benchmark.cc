@@ -0,0 +1,49 @@
+#include <string>
+
+#include "common/http/access_log/access_log_formatter.h"
+#include "common/http/access_log/request_info_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace AccessLog {
+
+// Format a typical request with the given format string.
+static void formatRequest(benchmark::State& state, const std::string& format) {
+  FormatterImpl formatter(format);
+  HeaderMapImpl request_headers{
+      {Headers::get().Method, "GET"},
+      {Headers::get().Path, "/api/v1/users/12345/profile"},
+      {Headers::get().Host, "api.example.com"},
+      {Headers::get().UserAgent, "Mozilla/5.0 (X11; Linux x86_64) Gecko/20100101"},
+      {Headers::get().ForwardedFor, "10.0.0.1"},
+      {Headers::get().RequestId, "6f7dbe80-1b6c-4b4b-9b0a-7f3b1d5c2f44"}};
+  HeaderMapImpl response_headers{{Headers::get().Status, "200"},
+                                 {Headers::get().EnvoyUpstreamServiceTime, "12"}};
+  RequestInfoImpl request_info(Protocol::Http11);
+  request_info.response_code_.value(200);
+  request_info.bytes_received_ = 512;
+  request_info.bytes_sent_ = 4096;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(formatter.format(request_headers, response_headers, request_info));
+  }
+}
+
+static void accessLogFormatDefault(benchmark::State& state) {
+  formatRequest(state, AccessLogFormatUtils::DEFAULT_FORMAT);
+}
+BENCHMARK(accessLogFormatDefault);
+
+// A format made of header values only, without the start time and duration.
+static void accessLogFormatHeaders(benchmark::State& state) {
+  formatRequest(state, "%REQ(:METHOD)% %REQ(:PATH)% %REQ(:AUTHORITY)% %REQ(X-REQUEST-ID)% "
+                       "%RESP(X-ENVOY-UPSTREAM-SERVICE-TIME)%\n");
+}
+BENCHMARK(accessLogFormatHeaders);
+
+} // namespace AccessLog
+} // namespace Http
+} // namespace Envoy
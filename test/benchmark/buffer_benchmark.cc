@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Buffer {
+
+// Each benchmark takes the size of the data as its first argument and whether to use the libevent
+// buffer implementation as its second.
+static void setBufferImpl(benchmark::State& state) {
+  OwnedImpl::useOldImpl(state.range(1) != 0);
+  state.SetLabel(state.range(1) != 0 ? "libevent" : "native");
+}
+
+static void bufferImplArgs(benchmark::internal::Benchmark* benchmark) {
+  for (int64_t use_old_impl : {0, 1}) {
+    for (int64_t size : {64, 4096, 65536}) {
+      benchmark->Args({size, use_old_impl});
+    }
+  }
+}
+
+// Add a chunk of data, draining the buffer once it holds 1MiB.
+static void bufferAdd(benchmark::State& state) {
+  setBufferImpl(state);
+  const std::string data(state.range(0), 'a');
+  OwnedImpl buffer;
+  while (state.KeepRunning()) {
+    buffer.add(data.data(), data.size());
+    if (buffer.length() >= 1024 * 1024) {
+      buffer.drain(buffer.length());
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+  OwnedImpl::useOldImpl(false);
+}
+BENCHMARK(bufferAdd)->Apply(bufferImplArgs);
+
+// Move all data from one buffer to another, as done when passing data through filters.
+static void bufferMove(benchmark::State& state) {
+  setBufferImpl(state);
+  const std::string data(state.range(0), 'a');
+  OwnedImpl buffer1(data);
+  OwnedImpl buffer2;
+  while (state.KeepRunning()) {
+    buffer2.move(buffer1);
+    buffer1.move(buffer2);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size() * 2);
+  OwnedImpl::useOldImpl(false);
+}
+BENCHMARK(bufferMove)->Apply(bufferImplArgs);
+
+// Move part of a buffer to another, as done when framing messages.
+static void bufferMovePartial(benchmark::State& state) {
+  setBufferImpl(state);
+  const std::string data(state.range(0), 'a');
+  OwnedImpl buffer1(data);
+  OwnedImpl buffer2;
+  while (state.KeepRunning()) {
+    buffer2.move(buffer1, data.size() / 2);
+    buffer2.move(buffer1);
+    buffer1.move(buffer2);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size() * 2);
+  OwnedImpl::useOldImpl(false);
+}
+BENCHMARK(bufferMovePartial)->Apply(bufferImplArgs);
+
+// Add data in 4KiB chunks, as a socket read would, and drain it in 1KiB steps.
+static void bufferDrain(benchmark::State& state) {
+  setBufferImpl(state);
+  const std::string data(4096, 'a');
+  const uint64_t size = state.range(0);
+  OwnedImpl buffer;
+  while (state.KeepRunning()) {
+    while (buffer.length() < size) {
+      buffer.add(data.data(), data.size());
+    }
+    while (buffer.length() > 0) {
+      buffer.drain(std::min<uint64_t>(1024, buffer.length()));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+  OwnedImpl::useOldImpl(false);
+}
+BENCHMARK(bufferDrain)->Apply(bufferImplArgs);
+
+// Search for the end of an HTTP/1 header block at the end of the buffer, which is made of 4KiB
+// chunks so that the search crosses slice boundaries.
+static void bufferSearch(benchmark::State& state) {
+  setBufferImpl(state);
+  const std::string data(4096, 'a');
+  OwnedImpl buffer;
+  while (buffer.length() < static_cast<uint64_t>(state.range(0))) {
+    buffer.add(data.data(), data.size());
+  }
+  buffer.add("\r\n\r\n");
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(buffer.search("\r\n\r\n", 4, 0));
+  }
+  state.SetBytesProcessed(state.iterations() * buffer.length());
+  OwnedImpl::useOldImpl(false);
+}
+BENCHMARK(bufferSearch)->Apply(bufferImplArgs);
+
+} // namespace Buffer
+} // namespace Envoy
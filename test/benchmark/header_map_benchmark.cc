@@ -0,0 +1,123 @@
+#include <string>
+#include <vector>
+
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+
+#include "benchmark/benchmark.h"
+#include "fmt/format.h"
+
+namespace Envoy {
+namespace Http {
+
+// Each benchmark takes the number of custom (not inline) headers in the map as its argument, in
+// addition to a typical set of request headers.
+static void headerMapArgs(benchmark::internal::Benchmark* benchmark) {
+  for (int num_custom_headers : {0, 10, 50}) {
+    benchmark->Arg(num_custom_headers);
+  }
+}
+
+static std::vector<LowerCaseString> customHeaderNames(int64_t num_custom_headers) {
+  std::vector<LowerCaseString> names;
+  for (int64_t i = 0; i < num_custom_headers; i++) {
+    names.emplace_back(fmt::format("x-custom-header-{}", i));
+  }
+  return names;
+}
+
+static void addRequestHeaders(HeaderMap& headers, const std::vector<LowerCaseString>& custom) {
+  headers.addCopy(Headers::get().Method, "GET");
+  headers.addCopy(Headers::get().Path, "/api/v1/users/12345/profile?fields=name,email");
+  headers.addCopy(Headers::get().Host, "api.example.com");
+  headers.addCopy(Headers::get().Scheme, "https");
+  headers.addCopy(Headers::get().UserAgent, "Mozilla/5.0 (X11; Linux x86_64) Gecko/20100101");
+  headers.addCopy(Headers::get().Accept, "application/json");
+  headers.addCopy(Headers::get().ForwardedFor, "10.0.0.1, 10.0.0.2");
+  headers.addCopy(Headers::get().RequestId, "6f7dbe80-1b6c-4b4b-9b0a-7f3b1d5c2f44");
+  for (const LowerCaseString& name : custom) {
+    headers.addCopy(name, "some-header-value");
+  }
+}
+
+// Build a header map from scratch, as a codec does for every request.
+static void headerMapInsert(benchmark::State& state) {
+  const std::vector<LowerCaseString> custom = customHeaderNames(state.range(0));
+  while (state.KeepRunning()) {
+    HeaderMapImpl headers;
+    addRequestHeaders(headers, custom);
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(headerMapInsert)->Apply(headerMapArgs);
+
+// Look up headers that have O(1) inline accessors.
+static void headerMapLookupInline(benchmark::State& state) {
+  HeaderMapImpl headers;
+  addRequestHeaders(headers, customHeaderNames(state.range(0)));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(headers.Path());
+    benchmark::DoNotOptimize(headers.Host());
+    benchmark::DoNotOptimize(headers.RequestId());
+  }
+}
+BENCHMARK(headerMapLookupInline)->Apply(headerMapArgs);
+
+// Look up inline headers and a missing custom header by name.
+static void headerMapLookupByName(benchmark::State& state) {
+  HeaderMapImpl headers;
+  addRequestHeaders(headers, customHeaderNames(state.range(0)));
+  const LowerCaseString missing("x-missing-header");
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(headers.get(Headers::get().Path));
+    benchmark::DoNotOptimize(headers.get(Headers::get().Host));
+    benchmark::DoNotOptimize(headers.get(missing));
+  }
+}
+BENCHMARK(headerMapLookupByName)->Apply(headerMapArgs);
+
+// Resolve header names to their inline slots, as done for every header a codec decodes. Removing
+// a header that is not present is little more than that lookup.
+static void headerMapInlineLookup(benchmark::State& state) {
+  std::vector<LowerCaseString> names = customHeaderNames(state.range(0));
+#define ADD_INLINE_HEADER_NAME(name) names.push_back(Headers::get().name);
+  ALL_INLINE_HEADERS(ADD_INLINE_HEADER_NAME)
+#undef ADD_INLINE_HEADER_NAME
+  HeaderMapImpl headers;
+  while (state.KeepRunning()) {
+    for (const LowerCaseString& name : names) {
+      headers.remove(name);
+    }
+  }
+}
+BENCHMARK(headerMapInlineLookup)->Apply(headerMapArgs);
+
+// Iterate over all headers, as done when encoding or logging them.
+static void headerMapIterate(benchmark::State& state) {
+  HeaderMapImpl headers;
+  addRequestHeaders(headers, customHeaderNames(state.range(0)));
+  while (state.KeepRunning()) {
+    uint64_t bytes = 0;
+    headers.iterate(
+        [](const HeaderEntry& header, void* context) -> void {
+          *static_cast<uint64_t*>(context) += header.key().size() + header.value().size();
+        },
+        &bytes);
+    benchmark::DoNotOptimize(bytes);
+  }
+}
+BENCHMARK(headerMapIterate)->Apply(headerMapArgs);
+
+// Copy a header map, as done for retries, shadowing and async requests.
+static void headerMapCopy(benchmark::State& state) {
+  HeaderMapImpl headers;
+  addRequestHeaders(headers, customHeaderNames(state.range(0)));
+  while (state.KeepRunning()) {
+    HeaderMapImpl copy(static_cast<const HeaderMap&>(headers));
+    benchmark::DoNotOptimize(copy.size());
+  }
+}
+BENCHMARK(headerMapCopy)->Apply(headerMapArgs);
+
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,112 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/network/utility.h"
+#include "common/runtime/runtime_impl.h"
+#include "common/stats/stats_impl.h"
+#include "common/upstream/load_balancer_impl.h"
+#include "common/upstream/ring_hash_lb.h"
+#include "common/upstream/upstream_impl.h"
+
+#include "test/mocks/upstream/mocks.h"
+
+#include "benchmark/benchmark.h"
+#include "fmt/format.h"
+#include "gmock/gmock.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * A host set with a given number of healthy hosts, along with what a load balancer needs to be
+ * created for it. The runtime returns defaults without involving mocks, so that only the load
+ * balancer is measured.
+ */
+class BenchmarkHostSet {
+public:
+  BenchmarkHostSet(int64_t num_hosts)
+      : stats_(ClusterInfoImpl::generateStats(stats_store_)), runtime_(random_) {
+    HostVectorSharedPtr hosts(new std::vector<HostSharedPtr>());
+    for (int64_t i = 0; i < num_hosts; i++) {
+      const std::string url = fmt::format("tcp://10.0.{}.{}:80", i / 256, i % 256);
+      hosts->emplace_back(new HostImpl(info_, "", Network::Utility::resolveUrl(url),
+                                       envoy::api::v2::Metadata::default_instance(), 1,
+                                       envoy::api::v2::Locality()));
+    }
+    HostListsSharedPtr hosts_per_locality(new std::vector<std::vector<HostSharedPtr>>());
+    host_set_.updateHosts(hosts, hosts, hosts_per_locality, hosts_per_locality, *hosts, {});
+  }
+
+  std::shared_ptr<NiceMock<MockClusterInfo>> info_{new NiceMock<MockClusterInfo>()};
+  Stats::IsolatedStoreImpl stats_store_;
+  ClusterStats stats_;
+  Runtime::RandomGeneratorImpl random_;
+  Runtime::NullLoaderImpl runtime_;
+  HostSetImpl host_set_;
+};
+
+class HashLoadBalancerContext : public LoadBalancerContext {
+public:
+  // Upstream::LoadBalancerContext
+  Optional<uint64_t> hashKey() const override { return hash_key_; }
+  const Network::Connection* downstreamConnection() const override { return nullptr; }
+
+  Optional<uint64_t> hash_key_;
+};
+
+// Each benchmark takes the number of hosts in the cluster as its argument.
+static void hostSetArgs(benchmark::internal::Benchmark* benchmark) {
+  for (int num_hosts : {10, 100, 1000}) {
+    benchmark->Arg(num_hosts);
+  }
+}
+
+static void roundRobinChooseHost(benchmark::State& state) {
+  BenchmarkHostSet cluster(state.range(0));
+  RoundRobinLoadBalancer lb(cluster.host_set_, nullptr, cluster.stats_, cluster.runtime_,
+                            cluster.random_);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(lb.chooseHost(nullptr));
+  }
+}
+BENCHMARK(roundRobinChooseHost)->Apply(hostSetArgs);
+
+static void leastRequestChooseHost(benchmark::State& state) {
+  BenchmarkHostSet cluster(state.range(0));
+  LeastRequestLoadBalancer lb(cluster.host_set_, nullptr, cluster.stats_, cluster.runtime_,
+                              cluster.random_);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(lb.chooseHost(nullptr));
+  }
+}
+BENCHMARK(leastRequestChooseHost)->Apply(hostSetArgs);
+
+static void randomChooseHost(benchmark::State& state) {
+  BenchmarkHostSet cluster(state.range(0));
+  RandomLoadBalancer lb(cluster.host_set_, nullptr, cluster.stats_, cluster.runtime_,
+                        cluster.random_);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(lb.chooseHost(nullptr));
+  }
+}
+BENCHMARK(randomChooseHost)->Apply(hostSetArgs);
+
+static void ringHashChooseHost(benchmark::State& state) {
+  BenchmarkHostSet cluster(state.range(0));
+  RingHashLoadBalancer lb(cluster.host_set_, cluster.stats_, cluster.runtime_, cluster.random_);
+  HashLoadBalancerContext context;
+  uint64_t hash_key = 0;
+  while (state.KeepRunning()) {
+    // Spread the keys over the ring with an odd multiplier.
+    context.hash_key_ = (hash_key++) * 0x9E3779B97F4A7C15;
+    benchmark::DoNotOptimize(lb.chooseHost(&context));
+  }
+}
+BENCHMARK(ringHashChooseHost)->Apply(hostSetArgs);
+
+} // namespace Upstream
+} // namespace Envoy
@@ -0,0 +1,23 @@
+// NOLINT(namespace-envoy)
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/event/libevent.h"
+
+#include "benchmark/benchmark.h"
+
+// The main entry point (and the rest of this file) should have no logic in it,
+// this allows overriding by site specific versions of main.cc.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  Envoy::Event::Libevent::Global::initialize();
+  // Logging would dominate the timings of code that logs at debug or trace level.
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::critical, lock);
+
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
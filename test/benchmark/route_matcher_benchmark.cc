@@ -0,0 +1,122 @@
+#include <memory>
+#include <string>
+
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+#include "common/router/config_impl.h"
+
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+
+#include "benchmark/benchmark.h"
+#include "fmt/format.h"
+#include "gmock/gmock.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Router {
+
+// The number of prefix routes in each virtual host, ahead of the path, regex and catch all routes.
+static const int NUM_PREFIX_ROUTES = 20;
+
+/**
+ * A route table with a given number of virtual hosts, each with several prefix routes, an exact
+ * path route, a regex route and a catch all route. There is also a wildcard virtual host and a
+ * default virtual host.
+ */
+class RouteTable {
+public:
+  RouteTable(int64_t num_virtual_hosts) {
+    envoy::api::v2::RouteConfiguration route_config;
+    for (int64_t i = 0; i < num_virtual_hosts; i++) {
+      addVirtualHost(route_config, fmt::format("service-{}", i),
+                     fmt::format("service-{}.example.com", i));
+    }
+    addVirtualHost(route_config, "internal", "*.internal.example.com");
+    addVirtualHost(route_config, "default", "*");
+    config_.reset(new ConfigImpl(route_config, runtime_, cm_, false));
+  }
+
+  const Config& config() const { return *config_; }
+
+private:
+  static void addVirtualHost(envoy::api::v2::RouteConfiguration& route_config,
+                             const std::string& name, const std::string& domain) {
+    auto* virtual_host = route_config.mutable_virtual_hosts()->Add();
+    virtual_host->set_name(name);
+    virtual_host->add_domains(domain);
+    for (int i = 0; i < NUM_PREFIX_ROUTES; i++) {
+      addRoute(*virtual_host, name)->mutable_match()->set_prefix(
+          fmt::format("/api/v1/resource-{}/", i));
+    }
+    addRoute(*virtual_host, name)->mutable_match()->set_path("/healthcheck");
+    addRoute(*virtual_host, name)->mutable_match()->set_regex("/users/[0-9]+/profile");
+    addRoute(*virtual_host, name)->mutable_match()->set_prefix("/");
+  }
+
+  static envoy::api::v2::Route* addRoute(envoy::api::v2::VirtualHost& virtual_host,
+                                         const std::string& cluster) {
+    auto* route = virtual_host.mutable_routes()->Add();
+    route->mutable_route()->set_cluster(cluster);
+    return route;
+  }
+
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Upstream::MockClusterManager> cm_;
+  std::unique_ptr<ConfigImpl> config_;
+};
+
+// Each benchmark takes the number of virtual hosts with an exact domain as its argument.
+static void routeTableArgs(benchmark::internal::Benchmark* benchmark) {
+  for (int num_virtual_hosts : {1, 100, 1000}) {
+    benchmark->Arg(num_virtual_hosts);
+  }
+}
+
+// Route a request for the given host and path through a table with state.range(0) exact domain
+// virtual hosts.
+static void routeRequest(benchmark::State& state, const std::string& host,
+                         const std::string& path) {
+  RouteTable table(state.range(0));
+  Http::HeaderMapImpl headers{{Http::Headers::get().Host, host},
+                              {Http::Headers::get().Path, path},
+                              {Http::Headers::get().Method, "GET"}};
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(table.config().route(headers, 0));
+  }
+}
+
+// Match the last prefix route of an exact domain virtual host.
+static void routeMatcherPrefix(benchmark::State& state) {
+  routeRequest(state, "service-0.example.com",
+               fmt::format("/api/v1/resource-{}/items", NUM_PREFIX_ROUTES - 1));
+}
+BENCHMARK(routeMatcherPrefix)->Apply(routeTableArgs);
+
+// Match an exact path route, after all prefix routes have been tried.
+static void routeMatcherPath(benchmark::State& state) {
+  routeRequest(state, "service-0.example.com", "/healthcheck");
+}
+BENCHMARK(routeMatcherPath)->Apply(routeTableArgs);
+
+// Match a regex route, after all prefix and path routes have been tried.
+static void routeMatcherRegex(benchmark::State& state) {
+  routeRequest(state, "service-0.example.com", "/users/12345/profile");
+}
+BENCHMARK(routeMatcherRegex)->Apply(routeTableArgs);
+
+// Match the first route of the wildcard virtual host.
+static void routeMatcherWildcardHost(benchmark::State& state) {
+  routeRequest(state, "frontend.internal.example.com", "/api/v1/resource-0/items");
+}
+BENCHMARK(routeMatcherWildcardHost)->Apply(routeTableArgs);
+
+// Match the catch all route of the default virtual host.
+static void routeMatcherDefaultHost(benchmark::State& state) {
+  routeRequest(state, "unknown.example.org", "/index.html");
+}
+BENCHMARK(routeMatcherDefaultHost)->Apply(routeTableArgs);
+
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,73 @@
+#include <string>
+
+#include "common/stats/stats_impl.h"
+#include "common/stats/thread_local_store.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * A thread local store backed by heap allocated stats, optionally with threading initialized as
+ * it is on workers. The calling thread stands in for a worker.
+ */
+class BenchmarkStore {
+public:
+  BenchmarkStore(bool tls) {
+    if (tls) {
+      store_.initializeThreading(main_thread_dispatcher_, tls_);
+    }
+  }
+
+  ~BenchmarkStore() {
+    store_.shutdownThreading();
+    tls_.shutdownThread();
+  }
+
+  HeapRawStatDataAllocator alloc_;
+  NiceMock<Event::MockDispatcher> main_thread_dispatcher_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  ThreadLocalStoreImpl store_{alloc_};
+};
+
+// Increment a counter through a reference obtained once, as generated stats structs do.
+static void statsCounterInc(benchmark::State& state) {
+  BenchmarkStore store(true);
+  Counter& counter = store.store_.counter("cluster.service.upstream_rq_total");
+  while (state.KeepRunning()) {
+    counter.inc();
+  }
+}
+BENCHMARK(statsCounterInc);
+
+// Look up a counter by name and increment it, as done for dynamically named stats. The argument
+// selects whether threading is initialized, which adds the thread local cache.
+static void statsCounterLookupInc(benchmark::State& state) {
+  BenchmarkStore store(state.range(0) != 0);
+  const std::string name = "cluster.service.upstream_rq_200";
+  while (state.KeepRunning()) {
+    store.store_.counter(name).inc();
+  }
+}
+BENCHMARK(statsCounterLookupInc)->Arg(0)->Arg(1);
+
+// Look up a counter by name in a scope and increment it.
+static void statsScopeCounterLookupInc(benchmark::State& state) {
+  BenchmarkStore store(true);
+  ScopePtr scope = store.store_.createScope("cluster.service.");
+  const std::string name = "upstream_rq_200";
+  while (state.KeepRunning()) {
+    scope->counter(name).inc();
+  }
+}
+BENCHMARK(statsScopeCounterLookupInc);
+
+} // namespace Stats
+} // namespace Envoy
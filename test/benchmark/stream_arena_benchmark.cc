@@ -0,0 +1,217 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/arena_impl.h"
+#include "common/http/conn_manager_impl.h"
+#include "common/http/date_provider_impl.h"
+#include "common/http/filter/buffer_filter.h"
+#include "common/http/filter/cors_filter.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+#include "common/network/address_impl.h"
+#include "common/router/router.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/router/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/tracing/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+
+#include "benchmark/benchmark.h"
+#include "fmt/format.h"
+#include "gmock/gmock.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::_;
+
+// Count every heap allocation made by the process, so that the benchmark can report how many each
+// request costs.
+static uint64_t heap_allocations = 0;
+
+void* operator new(size_t size) {
+  heap_allocations++;
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * A connection manager with a mock codec and upstream, whose streams go through a typical filter
+ * chain: the CORS and buffer filters, then the router.
+ */
+class BenchmarkConnectionManager : public ConnectionManagerConfig {
+public:
+  struct RouteConfigProvider : public Router::RouteConfigProvider {
+    // Router::RouteConfigProvider
+    Router::ConfigConstSharedPtr config() override { return route_config_; }
+    const std::string versionInfo() const override { return ""; }
+
+    std::shared_ptr<Router::MockConfig> route_config_{new NiceMock<Router::MockConfig>()};
+  };
+
+  BenchmarkConnectionManager()
+      : codec_(new NiceMock<MockServerConnection>()),
+        stats_{{ALL_HTTP_CONN_MAN_STATS(POOL_COUNTER(stats_store_), POOL_GAUGE(stats_store_),
+                                        POOL_TIMER(stats_store_))},
+               "",
+               stats_store_},
+        tracing_stats_{CONN_MAN_TRACING_STATS(POOL_COUNTER(stats_store_))},
+        listener_stats_{CONN_MAN_LISTENER_STATS(POOL_COUNTER(stats_store_))},
+        buffer_config_(new BufferFilterConfig{BufferFilter::generateStats("buffer.", stats_store_),
+                                              1024 * 1024, std::chrono::seconds(30)}),
+        router_config_("router.", local_info_, stats_store_, cluster_manager_, runtime_, random_,
+                       Router::ShadowWriterPtr{new NiceMock<Router::MockShadowWriter>()}, true) {
+    ON_CALL(filter_factory_, createFilterChain(_))
+        .WillByDefault(Invoke([this](FilterChainFactoryCallbacks& callbacks) -> void {
+          callbacks.addStreamFilter(callbacks.arena().makeShared<CorsFilter>());
+          callbacks.addStreamDecoderFilter(
+              callbacks.arena().makeShared<BufferFilter>(buffer_config_));
+          callbacks.addStreamDecoderFilter(
+              callbacks.arena().makeShared<Router::ProdFilter>(router_config_));
+          arena_ = dynamic_cast<ArenaImpl*>(&callbacks.arena());
+        }));
+
+    // The codec decodes a header only request from any input.
+    ON_CALL(*codec_, dispatch(_)).WillByDefault(Invoke([this](Buffer::Instance& data) -> void {
+      StreamDecoder& decoder = conn_manager_->newStream(response_encoder_);
+      decoder.decodeHeaders(HeaderMapPtr{new HeaderMapImpl{{Headers::get().Host, "host"},
+                                                           {Headers::get().Method, "GET"},
+                                                           {Headers::get().Path, "/"}}},
+                            true);
+      data.drain(data.length());
+    }));
+
+    // The upstream connection is always ready.
+    ON_CALL(cluster_manager_.conn_pool_, newStream(_, _))
+        .WillByDefault(Invoke([this](StreamDecoder& response_decoder,
+                                     ConnectionPool::Callbacks& callbacks)
+                                  -> ConnectionPool::Cancellable* {
+          response_decoder_ = &response_decoder;
+          callbacks.onPoolReady(request_encoder_, cluster_manager_.conn_pool_.host_);
+          return nullptr;
+        }));
+
+    ON_CALL(filter_callbacks_.connection_, remoteAddress())
+        .WillByDefault(testing::ReturnRef(remote_address_));
+    conn_manager_.reset(new ConnectionManagerImpl(*this, drain_close_, random_, tracer_, runtime_,
+                                                  local_info_, cluster_manager_));
+    conn_manager_->initializeReadFilterCallbacks(filter_callbacks_);
+  }
+
+  ~BenchmarkConnectionManager() {
+    filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
+  }
+
+  /**
+   * Proxy a header only request and response through a new stream, and destroy the stream.
+   * @return uint64_t the number of allocations that the stream made from its arena.
+   */
+  uint64_t request() {
+    Buffer::OwnedImpl input("GET / HTTP/1.1\r\n\r\n");
+    conn_manager_->onData(input);
+    response_decoder_->decodeHeaders(
+        HeaderMapPtr{new HeaderMapImpl{{Headers::get().Status, "200"}}}, true);
+    const uint64_t arena_allocations = arena_->allocations();
+    filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
+    return arena_allocations;
+  }
+
+  // Http::ConnectionManagerConfig
+  const std::list<AccessLog::InstanceSharedPtr>& accessLogs() override { return access_logs_; }
+  ServerConnectionPtr createCodec(Network::Connection&, const Buffer::Instance&,
+                                  ServerConnectionCallbacks&) override {
+    return ServerConnectionPtr{codec_};
+  }
+  DateProvider& dateProvider() override { return date_provider_; }
+  std::chrono::milliseconds drainTimeout() override { return std::chrono::milliseconds(100); }
+  FilterChainFactory& filterFactory() override { return filter_factory_; }
+  bool generateRequestId() override { return true; }
+  const Optional<std::chrono::milliseconds>& idleTimeout() override { return idle_timeout_; }
+  Router::RouteConfigProvider& routeConfigProvider() override { return route_config_provider_; }
+  const std::string& serverName() override { return server_name_; }
+  ConnectionManagerStats& stats() override { return stats_; }
+  ConnectionManagerTracingStats& tracingStats() override { return tracing_stats_; }
+  bool useRemoteAddress() override { return true; }
+  Http::ForwardClientCertType forwardClientCert() override {
+    return Http::ForwardClientCertType::Sanitize;
+  }
+  const std::vector<Http::ClientCertDetailsType>& setCurrentClientCertDetails() const override {
+    return set_current_client_cert_details_;
+  }
+  const Network::Address::Instance& localAddress() override { return local_address_; }
+  const Optional<std::string>& userAgent() override { return user_agent_; }
+  const TracingConnectionManagerConfig* tracingConfig() override { return nullptr; }
+  ConnectionManagerListenerStats& listenerStats() override { return listener_stats_; }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  NiceMock<Tracing::MockHttpTracer> tracer_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Runtime::MockRandomGenerator> random_;
+  NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  NiceMock<Upstream::MockClusterManager> cluster_manager_;
+  NiceMock<Network::MockDrainDecision> drain_close_;
+  NiceMock<Network::MockReadFilterCallbacks> filter_callbacks_;
+  NiceMock<MockFilterChainFactory> filter_factory_;
+  MockServerConnection* codec_;
+  NiceMock<MockStreamEncoder> response_encoder_;
+  NiceMock<MockStreamEncoder> request_encoder_;
+  StreamDecoder* response_decoder_{};
+  ArenaImpl* arena_{};
+  std::list<AccessLog::InstanceSharedPtr> access_logs_;
+  SlowDateProviderImpl date_provider_;
+  ConnectionManagerStats stats_;
+  ConnectionManagerTracingStats tracing_stats_;
+  ConnectionManagerListenerStats listener_stats_;
+  RouteConfigProvider route_config_provider_;
+  std::string server_name_{"envoy"};
+  Network::Address::Ipv4Instance local_address_{"127.0.0.1"};
+  Network::Address::Ipv4Instance remote_address_{"10.0.0.1"};
+  std::vector<Http::ClientCertDetailsType> set_current_client_cert_details_;
+  Optional<std::string> user_agent_;
+  Optional<std::chrono::milliseconds> idle_timeout_;
+  BufferFilterConfigConstSharedPtr buffer_config_;
+  Router::FilterConfig router_config_;
+  std::unique_ptr<ConnectionManagerImpl> conn_manager_;
+};
+
+// Proxy requests through ConnectionManagerImpl. Everything that a stream allocates from its arena
+// was a heap allocation of its own before the arena, so the label reports both: their sum is the
+// number of heap allocations per request without the arena. The mocks allocate as well, e.g. for
+// timers, which is the same with or without the arena.
+static void connectionManagerRequest(benchmark::State& state) {
+  BenchmarkConnectionManager conn_manager;
+  // The first request creates the codec, and grows the date provider's buffers.
+  conn_manager.request();
+
+  uint64_t arena_allocations = 0;
+  const uint64_t start = heap_allocations;
+  while (state.KeepRunning()) {
+    arena_allocations += conn_manager.request();
+  }
+  const uint64_t requests = state.iterations();
+  state.SetLabel(fmt::format("{} heap and {} arena allocations per request",
+                             (heap_allocations - start) / requests,
+                             arena_allocations / requests));
+}
+BENCHMARK(connectionManagerRequest);
+
+} // namespace Http
+} // namespace Envoy
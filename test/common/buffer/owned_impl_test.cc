@@ -0,0 +1,339 @@
+#include <memory>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+class OwnedImplTest : public testing::TestWithParam<bool> {
+public:
+  OwnedImplTest() { OwnedImpl::useOldImpl(GetParam()); }
+  ~OwnedImplTest() { OwnedImpl::useOldImpl(false); }
+
+  static std::string toString(const Instance& buffer) {
+    std::string output;
+    uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
+    RawSlice slices[num_slices];
+    buffer.getRawSlices(slices, num_slices);
+    for (const RawSlice& slice : slices) {
+      output.append(static_cast<const char*>(slice.mem_), slice.len_);
+    }
+    return output;
+  }
+};
+
+INSTANTIATE_TEST_CASE_P(BufferImpl, OwnedImplTest, testing::Bool());
+
+TEST_P(OwnedImplTest, Impl) {
+  OwnedImpl buffer;
+  EXPECT_EQ(GetParam(), buffer.usesOldImpl());
+}
+
+TEST_P(OwnedImplTest, AddAndDrain) {
+  OwnedImpl buffer;
+  EXPECT_EQ(0, buffer.length());
+  buffer.add("hello", 5);
+  buffer.add(std::string(" world"));
+  EXPECT_EQ(11, buffer.length());
+  EXPECT_EQ("hello world", toString(buffer));
+
+  buffer.drain(6);
+  EXPECT_EQ(5, buffer.length());
+  EXPECT_EQ("world", toString(buffer));
+
+  buffer.drain(5);
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_EQ(0, buffer.getRawSlices(nullptr, 0));
+}
+
+TEST_P(OwnedImplTest, AddLarge) {
+  const std::string data(100000, 'a');
+  OwnedImpl buffer;
+  buffer.add("b", 1);
+  buffer.add(data);
+  EXPECT_EQ(100001, buffer.length());
+  EXPECT_EQ("b" + data, toString(buffer));
+
+  OwnedImpl copy;
+  copy.add(buffer);
+  EXPECT_EQ(100001, copy.length());
+  EXPECT_EQ("b" + data, toString(copy));
+}
+
+TEST_P(OwnedImplTest, AddBufferFragmentNoCleanup) {
+  char input[] = "hello world";
+  BufferFragmentImpl frag(input, 11, nullptr);
+  {
+    OwnedImpl buffer;
+    buffer.addBufferFragment(frag);
+    EXPECT_EQ(11, buffer.length());
+
+    // The fragment is referenced, not copied.
+    RawSlice slice;
+    EXPECT_EQ(1, buffer.getRawSlices(&slice, 1));
+    EXPECT_EQ(static_cast<void*>(input), slice.mem_);
+
+    buffer.drain(11);
+    EXPECT_EQ(0, buffer.length());
+  }
+}
+
+TEST_P(OwnedImplTest, AddBufferFragmentWithCleanup) {
+  char input[] = "hello world";
+  bool release_callback_called = false;
+  BufferFragmentImpl frag(input, 11,
+                          [&](const void* data, size_t size, const BufferFragmentImpl* fragment) {
+                            release_callback_called = true;
+                            EXPECT_EQ(input, data);
+                            EXPECT_EQ(11, size);
+                            EXPECT_EQ(&frag, fragment);
+                          });
+  OwnedImpl buffer;
+  buffer.addBufferFragment(frag);
+  buffer.add(" again", 6);
+  EXPECT_EQ(17, buffer.length());
+  EXPECT_EQ("hello world again", toString(buffer));
+
+  buffer.drain(6);
+  EXPECT_EQ(11, buffer.length());
+  EXPECT_FALSE(release_callback_called);
+
+  // Data is never written into the space drained from a fragment.
+  buffer.prepend(std::string("hello "));
+  EXPECT_EQ("hello world again", toString(buffer));
+  EXPECT_EQ(0, memcmp(input, "hello world", 11));
+
+  buffer.drain(17);
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_TRUE(release_callback_called);
+}
+
+TEST_P(OwnedImplTest, AddBufferFragmentMoveAndDestroy) {
+  char input[] = "hello world";
+  uint32_t release_count = 0;
+  BufferFragmentImpl frag(input, 11,
+                          [&](const void*, size_t, const BufferFragmentImpl*) { release_count++; });
+  std::unique_ptr<OwnedImpl> other(new OwnedImpl());
+  {
+    OwnedImpl buffer;
+    buffer.addBufferFragment(frag);
+    other->move(buffer);
+    EXPECT_EQ(0, buffer.length());
+  }
+  EXPECT_EQ(0, release_count);
+  EXPECT_EQ("hello world", toString(*other));
+
+  // Destroying the buffer releases the fragment.
+  other.reset();
+  EXPECT_EQ(1, release_count);
+}
+
+TEST_P(OwnedImplTest, Prepend) {
+  OwnedImpl buffer("world");
+  buffer.prepend(std::string("hello "));
+  EXPECT_EQ(11, buffer.length());
+  EXPECT_EQ("hello world", toString(buffer));
+
+  // Prepend into the space freed up by draining.
+  buffer.drain(6);
+  buffer.prepend(std::string("brave new "));
+  EXPECT_EQ("brave new world", toString(buffer));
+
+  OwnedImpl empty;
+  empty.prepend(std::string("abc"));
+  empty.prepend(std::string("xyz"));
+  empty.add("def", 3);
+  EXPECT_EQ("xyzabcdef", toString(empty));
+}
+
+TEST_P(OwnedImplTest, PrependLarge) {
+  const std::string data(10000, 'a');
+  OwnedImpl buffer("b");
+  buffer.prepend(data);
+  EXPECT_EQ(data + "b", toString(buffer));
+}
+
+TEST_P(OwnedImplTest, PrependBuffer) {
+  OwnedImpl buffer("world");
+  OwnedImpl other("hello ");
+  buffer.prepend(other);
+  EXPECT_EQ(0, other.length());
+  EXPECT_EQ(11, buffer.length());
+  EXPECT_EQ("hello world", toString(buffer));
+}
+
+TEST_P(OwnedImplTest, Move) {
+  OwnedImpl buffer("hello");
+  OwnedImpl other(" world");
+  buffer.move(other);
+  EXPECT_EQ(0, other.length());
+  EXPECT_EQ(11, buffer.length());
+  EXPECT_EQ("hello world", toString(buffer));
+
+  // The source buffer is still usable after the move.
+  other.add("again", 5);
+  EXPECT_EQ("again", toString(other));
+}
+
+TEST_P(OwnedImplTest, MovePartial) {
+  OwnedImpl buffer;
+  OwnedImpl other("hello world");
+  buffer.move(other, 5);
+  EXPECT_EQ("hello", toString(buffer));
+  EXPECT_EQ(" world", toString(other));
+
+  buffer.move(other, 6);
+  EXPECT_EQ("hello world", toString(buffer));
+  EXPECT_EQ(0, other.length());
+}
+
+TEST_P(OwnedImplTest, MovePartialAcrossSlices) {
+  const std::string data(10000, 'a');
+  OwnedImpl other(data);
+  OwnedImpl tmp("bcd");
+  other.move(tmp);
+  OwnedImpl buffer;
+  buffer.move(other, 10001);
+  EXPECT_EQ(data + "b", toString(buffer));
+  EXPECT_EQ("cd", toString(other));
+  EXPECT_EQ(2, other.length());
+}
+
+TEST_P(OwnedImplTest, Linearize) {
+  OwnedImpl buffer("hello");
+  OwnedImpl other(" world");
+  buffer.move(other);
+  EXPECT_EQ(0, memcmp("hello world", buffer.linearize(11), 11));
+  EXPECT_EQ(11, buffer.length());
+
+  RawSlice slice;
+  EXPECT_EQ(1, buffer.getRawSlices(&slice, 1));
+  EXPECT_EQ(slice.mem_, buffer.linearize(11));
+}
+
+TEST_P(OwnedImplTest, ReserveCommit) {
+  OwnedImpl buffer("hello");
+  RawSlice iovecs[1];
+  ASSERT_EQ(1, buffer.reserve(6, iovecs, 1));
+  EXPECT_LE(6, iovecs[0].len_);
+  memcpy(iovecs[0].mem_, " world", 6);
+  iovecs[0].len_ = 6;
+  buffer.commit(iovecs, 1);
+  EXPECT_EQ(11, buffer.length());
+  EXPECT_EQ("hello world", toString(buffer));
+
+  // A reservation that is never committed does not change the buffer.
+  buffer.reserve(100, iovecs, 1);
+  EXPECT_EQ(11, buffer.length());
+  EXPECT_EQ("hello world", toString(buffer));
+}
+
+TEST_P(OwnedImplTest, ReserveCommitSplit) {
+  OwnedImpl buffer;
+  RawSlice iovecs[2];
+  uint64_t num_iovecs = buffer.reserve(16384, iovecs, 2);
+  ASSERT_LE(1, num_iovecs);
+  uint64_t total = 0;
+  for (uint64_t i = 0; i < num_iovecs; i++) {
+    memset(iovecs[i].mem_, 'a', iovecs[i].len_);
+    total += iovecs[i].len_;
+  }
+  EXPECT_LE(16384, total);
+  buffer.commit(iovecs, num_iovecs);
+  EXPECT_EQ(total, buffer.length());
+  EXPECT_EQ(std::string(total, 'a'), toString(buffer));
+}
+
+TEST_P(OwnedImplTest, Search) {
+  OwnedImpl buffer("abcdefgh");
+  OwnedImpl other("ijklmnop");
+  buffer.move(other);
+  const std::string data(10000, 'z');
+  buffer.add(data);
+  buffer.add("needle", 6);
+
+  EXPECT_EQ(0, buffer.search("abc", 3, 0));
+  EXPECT_EQ(3, buffer.search("def", 3, 0));
+  EXPECT_EQ(-1, buffer.search("abc", 3, 1));
+  // Matches that span slices.
+  EXPECT_EQ(6, buffer.search("ghij", 4, 0));
+  EXPECT_EQ(6, buffer.search("ghij", 4, 6));
+  EXPECT_EQ(-1, buffer.search("ghij", 4, 7));
+  EXPECT_EQ(10016, buffer.search("needle", 6, 0));
+  EXPECT_EQ(-1, buffer.search("needles", 7, 0));
+  EXPECT_EQ(-1, buffer.search("x", 1, 0));
+}
+
+TEST_P(OwnedImplTest, ReadWrite) {
+  int pipe_fds[2] = {0, 0};
+  ASSERT_EQ(0, pipe(pipe_fds));
+
+  const std::string data(20000, 'a');
+  OwnedImpl buffer(data);
+  int bytes_written_total = 0;
+  int bytes_read_total = 0;
+  OwnedImpl read_buffer;
+  while (bytes_written_total < 20000) {
+    int bytes_written = buffer.write(pipe_fds[1]);
+    ASSERT_LT(0, bytes_written);
+    bytes_written_total += bytes_written;
+    while (bytes_read_total < bytes_written_total) {
+      int bytes_read = read_buffer.read(pipe_fds[0], 16384);
+      ASSERT_LT(0, bytes_read);
+      bytes_read_total += bytes_read;
+    }
+  }
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_EQ(20000, read_buffer.length());
+  EXPECT_EQ(data, toString(read_buffer));
+
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+}
+
+TEST_P(OwnedImplTest, ReadLarge) {
+  int pipe_fds[2] = {0, 0};
+  ASSERT_EQ(0, pipe(pipe_fds));
+
+  const std::string data(40000, 'a');
+  ASSERT_EQ(40000, ::write(pipe_fds[1], data.data(), data.size()));
+  OwnedImpl buffer("b");
+  uint64_t bytes_read_total = 0;
+  while (bytes_read_total < 40000) {
+    const int bytes_read = buffer.read(pipe_fds[0], 256 * 1024);
+    ASSERT_LT(0, bytes_read);
+    bytes_read_total += bytes_read;
+  }
+  EXPECT_EQ(40001, buffer.length());
+  EXPECT_EQ("b" + data, toString(buffer));
+
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+}
+
+TEST_P(OwnedImplTest, ManySlices) {
+  // Exceed the inline capacity of the slice queue in both directions.
+  OwnedImpl buffer;
+  std::string expected;
+  for (int i = 0; i < 64; i++) {
+    OwnedImpl back(std::to_string(i));
+    buffer.move(back);
+    expected += std::to_string(i);
+    OwnedImpl front(std::string(1, 'a' + (i % 26)));
+    buffer.prepend(front);
+    expected = std::string(1, 'a' + (i % 26)) + expected;
+  }
+  EXPECT_EQ(expected.size(), buffer.length());
+  EXPECT_EQ(expected, toString(buffer));
+
+  buffer.drain(10);
+  EXPECT_EQ(expected.substr(10), toString(buffer));
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
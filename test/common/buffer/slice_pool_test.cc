@@ -0,0 +1,114 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/buffer/slice_pool.h"
+#include "common/stats/stats_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+class SlicePoolTest : public testing::Test {
+public:
+  ~SlicePoolTest() { SlicePool::setThreadLocal(nullptr); }
+
+  // The size to pass to allocate() for a poolable block of the given number of pages.
+  static size_t pages(size_t num_pages) {
+    return num_pages * SlicePool::PAGE_SIZE_BYTES - SlicePool::HEADER_SIZE;
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  SlicePoolStats stats_{ALL_SLICE_POOL_STATS(POOL_COUNTER(store_), POOL_GAUGE(store_))};
+};
+
+TEST_F(SlicePoolTest, NoPool) {
+  void* memory = SlicePool::allocate(pages(1));
+  ASSERT_NE(nullptr, memory);
+  SlicePool::release(memory);
+  SlicePool::release(nullptr);
+}
+
+TEST_F(SlicePoolTest, Reuse) {
+  {
+    SlicePool pool(stats_, 1024 * 1024);
+    SlicePool::setThreadLocal(&pool);
+
+    void* first = SlicePool::allocate(pages(1));
+    SlicePool::release(first);
+    EXPECT_EQ(SlicePool::PAGE_SIZE_BYTES, pool.cachedBytes());
+
+    // The cached block is reused by an allocation of the same size only.
+    void* other_size = SlicePool::allocate(pages(2));
+    EXPECT_NE(first, other_size);
+    void* second = SlicePool::allocate(pages(1));
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(0, pool.cachedBytes());
+
+    SlicePool::release(second);
+    SlicePool::release(other_size);
+    EXPECT_EQ(3 * SlicePool::PAGE_SIZE_BYTES, pool.cachedBytes());
+
+    // Sizes that are not whole pages, or that are too large, are not pooled.
+    SlicePool::release(SlicePool::allocate(100));
+    SlicePool::release(SlicePool::allocate(pages(SlicePool::MAX_POOLED_PAGES + 1)));
+    EXPECT_EQ(3 * SlicePool::PAGE_SIZE_BYTES, pool.cachedBytes());
+    SlicePool::setThreadLocal(nullptr);
+  }
+
+  // Stats are flushed when the pool is destroyed.
+  EXPECT_EQ(1, store_.counter("alloc_hit").value());
+  EXPECT_EQ(2, store_.counter("alloc_miss").value());
+  EXPECT_EQ(3, store_.counter("release_cached").value());
+  EXPECT_EQ(0, store_.counter("release_freed").value());
+  EXPECT_EQ(0, store_.gauge("resident_bytes").value());
+}
+
+TEST_F(SlicePoolTest, MaxCachedBytes) {
+  SlicePool pool(stats_, 2 * SlicePool::PAGE_SIZE_BYTES);
+  SlicePool::setThreadLocal(&pool);
+
+  void* first = SlicePool::allocate(pages(2));
+  void* second = SlicePool::allocate(pages(1));
+  SlicePool::release(first);
+  SlicePool::release(second);
+  EXPECT_EQ(2 * SlicePool::PAGE_SIZE_BYTES, pool.cachedBytes());
+  SlicePool::setThreadLocal(nullptr);
+}
+
+TEST_F(SlicePoolTest, StatsFlushedPeriodically) {
+  SlicePool pool(stats_, 1024 * 1024);
+  SlicePool::setThreadLocal(&pool);
+
+  for (int i = 0; i < 1000; i++) {
+    SlicePool::release(SlicePool::allocate(pages(1)));
+  }
+  EXPECT_LT(0, store_.counter("alloc_hit").value());
+  EXPECT_EQ(SlicePool::PAGE_SIZE_BYTES, store_.gauge("resident_bytes").value());
+  SlicePool::setThreadLocal(nullptr);
+}
+
+TEST_F(SlicePoolTest, BufferSlices) {
+  SlicePool pool(stats_, 1024 * 1024);
+  SlicePool::setThreadLocal(&pool);
+
+  {
+    OwnedImpl buffer("hello");
+    buffer.drain(5);
+    buffer.add(std::string(10000, 'a'));
+  }
+  EXPECT_LT(0, pool.cachedBytes());
+  const uint64_t cached_bytes = pool.cachedBytes();
+
+  // The same buffer usage is served entirely from the pool.
+  {
+    OwnedImpl buffer("hello");
+    buffer.drain(5);
+    buffer.add(std::string(10000, 'a'));
+  }
+  EXPECT_EQ(cached_bytes, pool.cachedBytes());
+  SlicePool::setThreadLocal(nullptr);
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
@@ -9,18 +9,28 @@ namespace {
 
 const char TEN_BYTES[] = "0123456789";
 
-class WatermarkBufferTest : public testing::Test {
+// Selects the buffer implementation before any buffers in the fixture are constructed.
+class BufferImplSelector {
 public:
-  WatermarkBufferTest() { buffer_.setWatermarks(5, 10); }
+  BufferImplSelector(bool use_old_impl) { OwnedImpl::useOldImpl(use_old_impl); }
+  ~BufferImplSelector() { OwnedImpl::useOldImpl(false); }
+};
+
+class WatermarkBufferTest : public testing::TestWithParam<bool>, public BufferImplSelector {
+public:
+  WatermarkBufferTest() : BufferImplSelector(GetParam()) { buffer_.setWatermarks(5, 10); }
 
   Buffer::WatermarkBuffer buffer_{[&]() -> void { ++times_low_watermark_called_; },
                                   [&]() -> void { ++times_high_watermark_called_; }};
   uint32_t times_low_watermark_called_{0};
   uint32_t times_high_watermark_called_{0};
 };
-TEST_F(WatermarkBufferTest, TestWatermark) { ASSERT_EQ(10, buffer_.highWatermark()); }
 
-TEST_F(WatermarkBufferTest, AddChar) {
+INSTANTIATE_TEST_CASE_P(BufferImpl, WatermarkBufferTest, testing::Bool());
+
+TEST_P(WatermarkBufferTest, TestWatermark) { ASSERT_EQ(10, buffer_.highWatermark()); }
+
+TEST_P(WatermarkBufferTest, AddChar) {
   buffer_.add(TEN_BYTES, 10);
   EXPECT_EQ(0, times_high_watermark_called_);
   buffer_.add("a", 1);
@@ -28,7 +38,7 @@ TEST_F(WatermarkBufferTest, AddChar) {
   EXPECT_EQ(11, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, AddString) {
+TEST_P(WatermarkBufferTest, AddString) {
   buffer_.add(std::string(TEN_BYTES));
   EXPECT_EQ(0, times_high_watermark_called_);
   buffer_.add(std::string("a"));
@@ -36,7 +46,7 @@ TEST_F(WatermarkBufferTest, AddString) {
   EXPECT_EQ(11, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, AddBuffer) {
+TEST_P(WatermarkBufferTest, AddBuffer) {
   OwnedImpl first(TEN_BYTES);
   buffer_.add(first);
   EXPECT_EQ(0, times_high_watermark_called_);
@@ -46,7 +56,28 @@ TEST_F(WatermarkBufferTest, AddBuffer) {
   EXPECT_EQ(11, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, Commit) {
+TEST_P(WatermarkBufferTest, AddBufferFragment) {
+  BufferFragmentImpl first(TEN_BYTES, 10, nullptr);
+  buffer_.addBufferFragment(first);
+  EXPECT_EQ(0, times_high_watermark_called_);
+  BufferFragmentImpl second(TEN_BYTES, 1, nullptr);
+  buffer_.addBufferFragment(second);
+  EXPECT_EQ(1, times_high_watermark_called_);
+  EXPECT_EQ(11, buffer_.length());
+  buffer_.drain(11);
+  EXPECT_EQ(1, times_low_watermark_called_);
+}
+
+TEST_P(WatermarkBufferTest, Prepend) {
+  buffer_.prepend(std::string(TEN_BYTES));
+  EXPECT_EQ(0, times_high_watermark_called_);
+  OwnedImpl data("a");
+  buffer_.prepend(data);
+  EXPECT_EQ(1, times_high_watermark_called_);
+  EXPECT_EQ(11, buffer_.length());
+}
+
+TEST_P(WatermarkBufferTest, Commit) {
   buffer_.add(TEN_BYTES, 10);
   EXPECT_EQ(0, times_high_watermark_called_);
   RawSlice out;
@@ -58,7 +89,7 @@ TEST_F(WatermarkBufferTest, Commit) {
   EXPECT_EQ(20, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, Drain) {
+TEST_P(WatermarkBufferTest, Drain) {
   // Draining from above to below the low watermark does nothing if the high
   // watermark never got hit.
   buffer_.add(TEN_BYTES, 10);
@@ -81,7 +112,7 @@ TEST_F(WatermarkBufferTest, Drain) {
   EXPECT_EQ(2, times_high_watermark_called_);
 }
 
-TEST_F(WatermarkBufferTest, MoveFullBuffer) {
+TEST_P(WatermarkBufferTest, MoveFullBuffer) {
   buffer_.add(TEN_BYTES, 10);
   OwnedImpl data("a");
 
@@ -91,7 +122,7 @@ TEST_F(WatermarkBufferTest, MoveFullBuffer) {
   EXPECT_EQ(11, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, MoveOneByte) {
+TEST_P(WatermarkBufferTest, MoveOneByte) {
   buffer_.add(TEN_BYTES, 9);
   OwnedImpl data("ab");
 
@@ -104,7 +135,7 @@ TEST_F(WatermarkBufferTest, MoveOneByte) {
   EXPECT_EQ(11, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, WatermarkFdFunctions) {
+TEST_P(WatermarkBufferTest, WatermarkFdFunctions) {
   int pipe_fds[2] = {0, 0};
   ASSERT_EQ(0, pipe(pipe_fds));
 
@@ -134,7 +165,7 @@ TEST_F(WatermarkBufferTest, WatermarkFdFunctions) {
   EXPECT_EQ(20, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, MoveWatermarks) {
+TEST_P(WatermarkBufferTest, MoveWatermarks) {
   buffer_.add(TEN_BYTES, 9);
   EXPECT_EQ(0, times_high_watermark_called_);
   buffer_.setWatermarks(1, 9);
@@ -158,7 +189,7 @@ TEST_F(WatermarkBufferTest, MoveWatermarks) {
   EXPECT_EQ(2, times_low_watermark_called_);
 }
 
-TEST_F(WatermarkBufferTest, GetRawSlices) {
+TEST_P(WatermarkBufferTest, GetRawSlices) {
   buffer_.add(TEN_BYTES, 10);
 
   RawSlice slices[2];
@@ -170,7 +201,7 @@ TEST_F(WatermarkBufferTest, GetRawSlices) {
   EXPECT_EQ(data_pointer, slices[0].mem_);
 }
 
-TEST_F(WatermarkBufferTest, Search) {
+TEST_P(WatermarkBufferTest, Search) {
   buffer_.add(TEN_BYTES, 10);
 
   EXPECT_EQ(1, buffer_.search(&TEN_BYTES[1], 2, 0));
@@ -178,7 +209,7 @@ TEST_F(WatermarkBufferTest, Search) {
   EXPECT_EQ(-1, buffer_.search(&TEN_BYTES[1], 2, 5));
 }
 
-TEST_F(WatermarkBufferTest, MoveBackWithWatermarks) {
+TEST_P(WatermarkBufferTest, MoveBackWithWatermarks) {
   int high_watermark_buffer1 = 0;
   int low_watermark_buffer1 = 0;
   Buffer::WatermarkBuffer buffer1{[&]() -> void { ++low_watermark_buffer1; },
@@ -206,6 +237,51 @@ TEST_F(WatermarkBufferTest, MoveBackWithWatermarks) {
   EXPECT_EQ(1, low_watermark_buffer1);
 }
 
+class TestMemoryAccount : public MemoryAccount {
+public:
+  void charge(uint64_t bytes) override { bytes_ += bytes; }
+  void credit(uint64_t bytes) override {
+    ASSERT_LE(bytes, bytes_);
+    bytes_ -= bytes;
+  }
+
+  uint64_t bytes_{0};
+};
+
+TEST_P(WatermarkBufferTest, MemoryAccount) {
+  std::shared_ptr<TestMemoryAccount> account(new TestMemoryAccount());
+  buffer_.add(TEN_BYTES, 10);
+  buffer_.setMemoryAccount(account);
+  EXPECT_EQ(10, account->bytes_);
+
+  buffer_.add(TEN_BYTES, 10);
+  EXPECT_EQ(20, account->bytes_);
+  buffer_.drain(15);
+  EXPECT_EQ(5, account->bytes_);
+
+  // Data moved out of the buffer is credited, data moved in is charged.
+  {
+    Buffer::WatermarkBuffer other([]() -> void {}, []() -> void {});
+    other.setMemoryAccount(account);
+    other.move(buffer_);
+    EXPECT_EQ(0, buffer_.length());
+    EXPECT_EQ(5, account->bytes_);
+    other.add(TEN_BYTES, 10);
+    EXPECT_EQ(15, account->bytes_);
+  }
+  // Destroyed buffers credit what they held.
+  EXPECT_EQ(0, account->bytes_);
+
+  // The charge moves with the buffer when the account changes.
+  std::shared_ptr<TestMemoryAccount> other_account(new TestMemoryAccount());
+  buffer_.add(TEN_BYTES, 10);
+  buffer_.setMemoryAccount(other_account);
+  EXPECT_EQ(0, account->bytes_);
+  EXPECT_EQ(10, other_account->bytes_);
+  buffer_.setMemoryAccount(nullptr);
+  EXPECT_EQ(0, other_account->bytes_);
+}
+
 } // namespace
 } // namespace Buffer
 } // namespace Envoy
@@ -0,0 +1,111 @@
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <type_traits>
+
+#include "common/common/arena_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+TEST(ArenaImplTest, Alignment) {
+  ArenaImpl arena;
+  for (size_t alignment : {1, 2, 4, 8, 16, 64}) {
+    arena.allocate(1, 1);
+    void* ptr = arena.allocate(3, alignment);
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(ptr) % alignment);
+  }
+  EXPECT_EQ(12U, arena.allocations());
+  EXPECT_EQ(1U, arena.heapBlocks());
+}
+
+TEST(ArenaImplTest, AllocationsDontOverlap) {
+  ArenaImpl arena;
+  char* first = static_cast<char*>(arena.allocate(10, 1));
+  char* second = static_cast<char*>(arena.allocate(10, 1));
+  EXPECT_LE(first + 10, second);
+}
+
+TEST(ArenaImplTest, BlocksGrow) {
+  ArenaImpl arena(nullptr, 64);
+  EXPECT_EQ(0U, arena.heapBlocks());
+
+  // Each allocation fills what is left of the current block, so every one takes a new block
+  // until the blocks are big enough to hold two.
+  arena.allocate(40, 1);
+  EXPECT_EQ(1U, arena.heapBlocks());
+  arena.allocate(40, 1);
+  EXPECT_EQ(2U, arena.heapBlocks());
+  arena.allocate(40, 1);
+  EXPECT_EQ(2U, arena.heapBlocks());
+  arena.allocate(100, 1);
+  EXPECT_EQ(3U, arena.heapBlocks());
+}
+
+TEST(ArenaImplTest, InitialBlock) {
+  std::aligned_storage<256>::type storage;
+  ArenaImpl arena(&storage, sizeof(storage));
+
+  for (int i = 0; i < 8; i++) {
+    char* ptr = static_cast<char*>(arena.allocate(16, 8));
+    EXPECT_LE(reinterpret_cast<char*>(&storage), ptr);
+    EXPECT_GE(reinterpret_cast<char*>(&storage) + sizeof(storage), ptr + 16);
+  }
+  EXPECT_EQ(0U, arena.heapBlocks());
+
+  // Overflowing the initial block moves on to the heap.
+  arena.allocate(256, 8);
+  EXPECT_EQ(1U, arena.heapBlocks());
+}
+
+TEST(ArenaImplTest, OversizedAllocation) {
+  ArenaImpl arena(nullptr, 64);
+  char* ptr = static_cast<char*>(arena.allocate(ArenaImpl::MAX_BLOCK_SIZE * 2, 16));
+  EXPECT_EQ(1U, arena.heapBlocks());
+  // The whole allocation is usable.
+  ptr[0] = 1;
+  ptr[ArenaImpl::MAX_BLOCK_SIZE * 2 - 1] = 1;
+
+  // Later allocations don't fit what is left of the oversized block, and start small again.
+  arena.allocate(32, 1);
+  EXPECT_EQ(2U, arena.heapBlocks());
+}
+
+TEST(ArenaImplTest, MakeShared) {
+  struct Counted {
+    Counted(int& live) : live_(live) { live_++; }
+    ~Counted() { live_--; }
+    int& live_;
+  };
+
+  int live = 0;
+  std::aligned_storage<256>::type storage;
+  ArenaImpl arena(&storage, sizeof(storage));
+  {
+    std::shared_ptr<Counted> counted = arena.makeShared<Counted>(live);
+    std::shared_ptr<Counted> copy = counted;
+    EXPECT_EQ(1, live);
+    EXPECT_EQ(1U, arena.allocations());
+  }
+  EXPECT_EQ(0, live);
+  EXPECT_EQ(0U, arena.heapBlocks());
+}
+
+TEST(ArenaImplTest, Allocator) {
+  ArenaImpl arena;
+  std::list<int, ArenaAllocator<int>> list{ArenaAllocator<int>(arena)};
+  for (int i = 0; i < 10; i++) {
+    list.push_back(i);
+  }
+  list.pop_front();
+  EXPECT_EQ(9U, list.size());
+  EXPECT_EQ(1, list.front());
+  EXPECT_EQ(10U, arena.allocations());
+
+  ArenaImpl other_arena;
+  EXPECT_TRUE(ArenaAllocator<int>(arena) == ArenaAllocator<char>(arena));
+  EXPECT_TRUE(ArenaAllocator<int>(arena) != ArenaAllocator<int>(other_arena));
+}
+
+} // namespace Envoy
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/regex.h"
+
+#include "test/test_common/utility.h"
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+TEST(RegexUtil, ParseRegex) {
+  std::unique_ptr<RE2> regex = RegexUtil::parseRegex("/b[io]t");
+  EXPECT_TRUE(RE2::FullMatch("/bit", *regex));
+  EXPECT_TRUE(RE2::FullMatch("/bot", *regex));
+  EXPECT_FALSE(RE2::FullMatch("/bite", *regex));
+}
+
+TEST(RegexUtil, InvalidRegex) {
+  EXPECT_THROW_WITH_MESSAGE(RegexUtil::parseRegex("/foo("), EnvoyException,
+                            "invalid regex '/foo(': missing ): /foo(");
+  // Lookahead can't be matched in linear time, so RE2 doesn't support it.
+  EXPECT_THROW(RegexUtil::parseRegex("/users/(?!validate)\\w+"), EnvoyException);
+}
+
+TEST(RegexUtil, ProgramSizeLimit) {
+  EXPECT_NO_THROW(RegexUtil::parseRegex("/users/\\d+/chargeaccounts/\\w+"));
+  // Bounded repetitions of character classes, as in typical id patterns, are accepted.
+  EXPECT_NO_THROW(RegexUtil::parseRegex("/foo/[a-z0-9-]{1,36}"));
+  EXPECT_NO_THROW(RegexUtil::parseRegex("/foo/[a-zA-Z0-9_-]{1,64}/bar"));
+  EXPECT_THROW(RegexUtil::parseRegex("/(a|b|c){500}"), EnvoyException);
+  EXPECT_THROW(RegexUtil::parseRegex(".{1000}"), EnvoyException);
+}
+
+TEST(RegexUtil, ConfiguredProgramSizeLimit) {
+  EXPECT_THROW_WITH_MESSAGE(RegexUtil::parseRegex("/foo/[a-z0-9-]{1,36}", 100), EnvoyException,
+                            "regex '/foo/[a-z0-9-]{1,36}' is too complex: program size 152 "
+                            "exceeds 100");
+  EXPECT_NO_THROW(RegexUtil::parseRegex(".{1000}", 10000));
+  EXPECT_THROW(RegexUtil::parseRegexSet({"/foo", "/foo/[a-z0-9-]{1,36}"}, 100), EnvoyException);
+}
+
+TEST(RegexUtil, ParseRegexSet) {
+  std::unique_ptr<RE2::Set> set = RegexUtil::parseRegexSet({"/b[io]t", "/b.*", "/c[ao]t"});
+
+  std::vector<int> matched;
+  EXPECT_TRUE(RegexUtil::matchRegexSet(*set, "/bit", matched));
+  std::sort(matched.begin(), matched.end());
+  EXPECT_EQ((std::vector<int>{0, 1}), matched);
+
+  // Every regex in the set must match the whole input.
+  EXPECT_TRUE(RegexUtil::matchRegexSet(*set, "/cats", matched));
+  EXPECT_TRUE(matched.empty());
+  EXPECT_TRUE(RegexUtil::matchRegexSet(*set, "x/cat", matched));
+  EXPECT_TRUE(matched.empty());
+  EXPECT_TRUE(RegexUtil::matchRegexSet(*set, "/cot", matched));
+  EXPECT_EQ((std::vector<int>{2}), matched);
+}
+
+TEST(RegexUtil, EmptyRegexSet) {
+  std::unique_ptr<RE2::Set> set = RegexUtil::parseRegexSet({});
+  std::vector<int> matched;
+  EXPECT_TRUE(RegexUtil::matchRegexSet(*set, "/foo", matched));
+  EXPECT_TRUE(matched.empty());
+}
+
+// RE2 failing to match a set is indistinguishable from no regex matching, unless the set comes
+// from parseRegexSet(). A set that doesn't is used to check that the failure is reported.
+TEST(RegexUtil, MatchRegexSetFailure) {
+  RE2::Set set(RE2::Options(), RE2::ANCHOR_BOTH);
+  set.Add("/foo", nullptr);
+  ASSERT_TRUE(set.Compile());
+  std::vector<int> matched;
+  EXPECT_FALSE(RegexUtil::matchRegexSet(set, "/bar", matched));
+}
+
+// Large sets are given enough memory to compile, where RE2's default budget isn't enough.
+TEST(RegexUtil, LargeRegexSet) {
+  std::vector<std::string> regexes;
+  for (int i = 0; i < 1000; i++) {
+    regexes.push_back(fmt::format("/route{}/(a|b|c){{150}}", i));
+  }
+  RE2::Set default_set(RE2::Options(), RE2::ANCHOR_BOTH);
+  for (const std::string& regex : regexes) {
+    default_set.Add(regex, nullptr);
+  }
+  EXPECT_FALSE(default_set.Compile());
+
+  std::unique_ptr<RE2::Set> set = RegexUtil::parseRegexSet(regexes);
+  std::vector<int> matched;
+  EXPECT_TRUE(RegexUtil::matchRegexSet(*set, "/route999/" + std::string(150, 'b'), matched));
+  EXPECT_EQ((std::vector<int>{999}), matched);
+}
+
+TEST(RegexUtil, InvalidRegexSet) {
+  EXPECT_THROW(RegexUtil::parseRegexSet({"/foo", "/bar("}), EnvoyException);
+  EXPECT_THROW(RegexUtil::parseRegexSet({"/foo", ".{1000}"}), EnvoyException);
+}
+
+} // namespace Envoy
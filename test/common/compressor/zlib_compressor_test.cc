@@ -0,0 +1,218 @@
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/compressor/zlib_compressor.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Compressor {
+namespace {
+
+std::string inflateString(const std::string& compressed, int window_bits) {
+  z_stream stream{};
+  EXPECT_EQ(Z_OK, inflateInit2(&stream, window_bits));
+  std::string output(compressed.size() * 1024 + 1024, '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+  stream.avail_in = compressed.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+  stream.avail_out = output.size();
+  EXPECT_EQ(Z_STREAM_END, inflate(&stream, Z_FINISH));
+  output.resize(stream.total_out);
+  inflateEnd(&stream);
+  return output;
+}
+
+// Inflate the start of a stream, which has been flushed but not finished.
+std::string inflatePartial(const std::string& compressed, int window_bits) {
+  z_stream stream{};
+  EXPECT_EQ(Z_OK, inflateInit2(&stream, window_bits));
+  std::string output(compressed.size() * 1024 + 1024, '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+  stream.avail_in = compressed.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+  stream.avail_out = output.size();
+  EXPECT_EQ(Z_OK, inflate(&stream, Z_SYNC_FLUSH));
+  EXPECT_EQ(0U, stream.avail_in);
+  output.resize(stream.total_out);
+  inflateEnd(&stream);
+  return output;
+}
+
+std::string testData() {
+  std::string data;
+  for (uint64_t i = 0; data.size() < 200000; i++) {
+    data += std::to_string(i * 7) + " lorem ipsum ";
+  }
+  return data;
+}
+
+std::string compressInChunks(ZlibCompressor& compressor, const std::string& data,
+                             uint64_t chunk_size) {
+  Buffer::OwnedImpl output;
+  for (uint64_t offset = 0; offset < data.size(); offset += chunk_size) {
+    Buffer::OwnedImpl input(data.substr(offset, chunk_size));
+    compressor.compress(input, output, false);
+    EXPECT_EQ(0U, input.length());
+  }
+  Buffer::OwnedImpl empty;
+  compressor.compress(empty, output, true);
+  return TestUtility::bufferToString(output);
+}
+
+TEST(ZlibCompressorTest, Gzip) {
+  const std::string data = testData();
+  ZlibParams params;
+  ZlibCompressor compressor(params);
+  const std::string compressed = compressInChunks(compressor, data, 4096);
+  EXPECT_LT(compressed.size(), data.size() / 4);
+  EXPECT_EQ(data.size(), compressor.totalIn());
+  EXPECT_EQ(compressed.size(), compressor.totalOut());
+  // 16 selects the gzip wrapper.
+  EXPECT_EQ(data, inflateString(compressed, 15 + 16));
+}
+
+TEST(ZlibCompressorTest, Zlib) {
+  const std::string data = testData();
+  ZlibParams params;
+  params.format_ = ZlibParams::Format::Zlib;
+  params.level_ = 1;
+  params.window_bits_ = 9;
+  params.mem_level_ = 1;
+  ZlibCompressor compressor(params);
+  EXPECT_EQ(data, inflateString(compressInChunks(compressor, data, 100000), 9));
+}
+
+TEST(ZlibCompressorTest, EmptyInput) {
+  ZlibParams params;
+  ZlibCompressor compressor(params);
+  EXPECT_EQ("", inflateString(compressInChunks(compressor, "", 1), 15 + 16));
+}
+
+// Every call flushes, so the output so far decompresses to all the input so far.
+TEST(ZlibCompressorTest, Flush) {
+  ZlibParams params;
+  ZlibCompressor compressor(params);
+  Buffer::OwnedImpl output;
+  Buffer::OwnedImpl input("data: hello\n\n");
+  compressor.compress(input, output, false);
+  EXPECT_EQ("data: hello\n\n", inflatePartial(TestUtility::bufferToString(output), 15 + 16));
+
+  // Nothing more is written without new input.
+  const uint64_t flushed_length = output.length();
+  compressor.compress(input, output, false);
+  EXPECT_EQ(flushed_length, output.length());
+
+  input.add("data: world\n\n");
+  compressor.compress(input, output, false);
+  EXPECT_EQ("data: hello\n\ndata: world\n\n",
+            inflatePartial(TestUtility::bufferToString(output), 15 + 16));
+
+  compressor.compress(input, output, true);
+  EXPECT_EQ("data: hello\n\ndata: world\n\n",
+            inflateString(TestUtility::bufferToString(output), 15 + 16));
+}
+
+// Streams are cached per thread when a compressor is destroyed, reset, and reused by the next
+// compressor with the same parameters.
+TEST(ZlibCompressorTest, StreamCache) {
+  const std::string data = testData();
+  ZlibParams params;
+  params.level_ = 3;
+  const size_t cached_streams = ZlibCompressor::cachedStreams();
+  {
+    ZlibCompressor compressor(params);
+    // Abandon the stream part way through.
+    Buffer::OwnedImpl input(data);
+    Buffer::OwnedImpl output;
+    compressor.compress(input, output, false);
+  }
+  EXPECT_EQ(cached_streams + 1, ZlibCompressor::cachedStreams());
+
+  {
+    ZlibParams other_params;
+    other_params.level_ = 4;
+    ZlibCompressor other_compressor(other_params);
+    EXPECT_EQ(cached_streams + 1, ZlibCompressor::cachedStreams());
+
+    ZlibCompressor compressor(params);
+    EXPECT_EQ(cached_streams, ZlibCompressor::cachedStreams());
+    EXPECT_EQ(0U, compressor.totalIn());
+    EXPECT_EQ(data, inflateString(compressInChunks(compressor, data, 4096), 15 + 16));
+  }
+  EXPECT_EQ(cached_streams + 2, ZlibCompressor::cachedStreams());
+
+  // The cache is bounded.
+  for (size_t i = 0; i < ZlibCompressor::MAX_CACHED_STREAMS + 1; i++) {
+    ZlibParams distinct_params;
+    distinct_params.mem_level_ = 1 + i % 9;
+    distinct_params.window_bits_ = 9 + i / 9;
+    ZlibCompressor compressor(distinct_params);
+  }
+  EXPECT_EQ(ZlibCompressor::MAX_CACHED_STREAMS, ZlibCompressor::cachedStreams());
+}
+
+std::string decompressInChunks(ZlibDecompressor& decompressor, const std::string& compressed,
+                               uint64_t chunk_size) {
+  Buffer::OwnedImpl output;
+  for (uint64_t offset = 0; offset < compressed.size(); offset += chunk_size) {
+    Buffer::OwnedImpl input(compressed.substr(offset, chunk_size));
+    EXPECT_TRUE(decompressor.decompress(input, output, UINT64_MAX));
+    EXPECT_EQ(0U, input.length());
+  }
+  return TestUtility::bufferToString(output);
+}
+
+std::string compressString(const std::string& data, ZlibParams::Format format) {
+  ZlibParams params;
+  params.format_ = format;
+  ZlibCompressor compressor(params);
+  return compressInChunks(compressor, data, data.size() + 1);
+}
+
+TEST(ZlibDecompressorTest, GzipAndZlib) {
+  const std::string data = testData();
+  ZlibDecompressor decompressor;
+  // A single chunk inflates to many times the output chunk size.
+  const std::string gzip = compressString(data, ZlibParams::Format::Gzip);
+  EXPECT_EQ(data, decompressInChunks(decompressor, gzip, gzip.size()));
+  EXPECT_TRUE(decompressor.finished());
+
+  decompressor.reset();
+  EXPECT_FALSE(decompressor.finished());
+  const std::string zlib = compressString(data, ZlibParams::Format::Zlib);
+  EXPECT_EQ(data, decompressInChunks(decompressor, zlib, 7));
+  EXPECT_TRUE(decompressor.finished());
+}
+
+TEST(ZlibDecompressorTest, Invalid) {
+  ZlibDecompressor decompressor;
+  Buffer::OwnedImpl output;
+  Buffer::OwnedImpl garbage("not a compressed stream");
+  EXPECT_FALSE(decompressor.decompress(garbage, output, UINT64_MAX));
+  EXPECT_EQ(0U, garbage.length());
+
+  decompressor.reset();
+  Buffer::OwnedImpl trailing(compressString("hello", ZlibParams::Format::Gzip) + "!");
+  EXPECT_FALSE(decompressor.decompress(trailing, output, UINT64_MAX));
+}
+
+TEST(ZlibDecompressorTest, MaxOutput) {
+  const std::string data = testData();
+  ZlibDecompressor decompressor;
+  Buffer::OwnedImpl input(compressString(data, ZlibParams::Format::Gzip));
+  Buffer::OwnedImpl output;
+  EXPECT_FALSE(decompressor.decompress(input, output, data.size() - 1));
+
+  decompressor.reset();
+  input.add(compressString(data, ZlibParams::Format::Gzip));
+  output.drain(output.length());
+  EXPECT_TRUE(decompressor.decompress(input, output, data.size()));
+  EXPECT_EQ(data, TestUtility::bufferToString(output));
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace Envoy
@@ -122,7 +122,8 @@ TEST_F(SubscriptionFactoryTest, GrpcSubscription) {
       {":path", "/envoy.api.v2.EndpointDiscoveryService/StreamEndpoints"},
       {":authority", "eds_cluster"},
       {"content-type", "application/grpc"},
-      {"te", "trailers"}};
+      {"te", "trailers"},
+      {"grpc-accept-encoding", "identity,deflate,gzip"}};
   EXPECT_CALL(stream, sendHeaders(HeaderMapEqualRef(&headers), _));
   EXPECT_CALL(cm_.async_client_.dispatcher_, deferredDelete_(_));
   subscriptionFromConfigSource(config)->start({"foo"}, callbacks_);
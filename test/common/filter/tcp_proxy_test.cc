@@ -20,6 +20,7 @@
 #include "gtest/gtest.h"
 
 using testing::NiceMock;
+using testing::Ref;
 using testing::Return;
 using testing::ReturnRef;
 using testing::SaveArg;
@@ -463,6 +464,22 @@ TEST_F(TcpProxyTest, DownstreamDisconnectLocal) {
   filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::LocalClose);
 }
 
+TEST_F(TcpProxyTest, SpliceOnConnected) {
+  setup(true);
+
+  EXPECT_CALL(filter_callbacks_.connection_, spliceTo(Ref(*upstream_connection_)))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*upstream_connection_, spliceTo(Ref(filter_callbacks_.connection_)))
+      .WillOnce(Return(false));
+  upstream_connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(1U, config_->stats().downstream_cx_spliced_.value());
+
+  // Data the upstream connection could not splice still goes through the filter.
+  Buffer::OwnedImpl response("world");
+  EXPECT_CALL(filter_callbacks_.connection_, write(BufferEqual(&response)));
+  upstream_read_filter_->onData(response);
+}
+
 TEST_F(TcpProxyTest, UpstreamConnectTimeout) {
   setup(true);
 
@@ -175,7 +175,11 @@ public:
                                     {":path", "/helloworld.Greeter/SayHello"},
                                     {":authority", "test_cluster"},
                                     {"content-type", "application/grpc"},
-                                    {"te", "trailers"}};
+                                    {"te", "trailers"},
+                                    {"grpc-accept-encoding", "identity,deflate,gzip"}};
+    if (!request_encoding_.empty()) {
+      headers.addCopy("grpc-encoding", request_encoding_);
+    }
     for (auto& value : initial_metadata) {
       headers.addReference(value.first, value.second);
     }
@@ -260,6 +264,8 @@ public:
   NiceMock<Http::MockAsyncClient> http_client_;
   NiceMock<Upstream::MockClusterManager> cm_;
   std::unique_ptr<AsyncClientImpl<helloworld::HelloRequest, helloworld::HelloReply>> grpc_client_;
+  // The grpc-encoding expected on requests, if any.
+  std::string request_encoding_;
 };
 
 // Validate that a simple request-reply stream works.
@@ -436,6 +442,74 @@ TEST_F(GrpcAsyncClientImplTest, BadReplyProtobuf) {
   stream->http_callbacks_->onData(reply_buffer, false);
 }
 
+// Validate that a compressed reply is handled as an INTERNAL gRPC error when the server didn't name
+// the algorithm in grpc-encoding.
+TEST_F(GrpcAsyncClientImplTest, CompressedReplyWithoutEncoding) {
+  TestMetadata empty_metadata;
+  auto stream = createStream(empty_metadata);
+  stream->sendRequest();
+  stream->sendServerInitialMetadata(empty_metadata);
+  stream->expectGrpcStatus(Status::GrpcStatus::Internal);
+  helloworld::HelloReply reply;
+  reply.set_message(std::string(1000, 'a'));
+  stream->http_callbacks_->onData(*Common::serializeBody(reply, CompressionAlgorithm::Gzip), false);
+}
+
+// Validate that requests are compressed when configured, and replies decompressed as grpc-encoding
+// says.
+TEST_F(GrpcAsyncClientImplTest, CompressedStream) {
+  request_encoding_ = "deflate";
+  grpc_client_.reset(new AsyncClientImpl<helloworld::HelloRequest, helloworld::HelloReply>(
+      cm_, "test_cluster", CompressionAlgorithm::Deflate));
+  TestMetadata empty_metadata;
+  auto stream = createStream(empty_metadata);
+
+  helloworld::HelloRequest request;
+  request.set_name(std::string(1000, 'a'));
+  EXPECT_CALL(*stream->http_stream_, sendData(_, false))
+      .WillOnce(Invoke([](Buffer::Instance& data, bool) {
+        EXPECT_EQ(GRPC_FH_COMPRESSED, *static_cast<uint8_t*>(data.linearize(1)));
+        EXPECT_GT(1000U, data.length());
+      }));
+  stream->grpc_stream_->sendMessage(request, false);
+
+  TestMetadata reply_metadata{{Http::LowerCaseString("grpc-encoding"), "gzip"}};
+  stream->sendServerInitialMetadata(reply_metadata);
+  helloworld::HelloReply reply;
+  reply.set_message(std::string(1000, 'b'));
+  EXPECT_CALL(*stream, onReceiveMessage_(HelloworldReplyEq(reply.message())));
+  stream->http_callbacks_->onData(*Common::serializeBody(reply, CompressionAlgorithm::Gzip), false);
+
+  stream->sendServerTrailers(Status::GrpcStatus::Ok, "", empty_metadata);
+  stream->closeStream();
+}
+
+// Validate that a reply that decompresses to more than the default limit is handled as an INTERNAL
+// gRPC error, and is accepted by a client configured with a larger limit.
+TEST_F(GrpcAsyncClientImplTest, LargeCompressedReply) {
+  helloworld::HelloReply reply;
+  reply.set_message(std::string(Decoder::DEFAULT_MAX_MESSAGE_LENGTH + 1024, 'c'));
+  TestMetadata empty_metadata;
+  TestMetadata reply_metadata{{Http::LowerCaseString("grpc-encoding"), "gzip"}};
+  {
+    auto stream = createStream(empty_metadata);
+    stream->sendServerInitialMetadata(reply_metadata);
+    stream->expectGrpcStatus(Status::GrpcStatus::Internal);
+    stream->http_callbacks_->onData(*Common::serializeBody(reply, CompressionAlgorithm::Gzip),
+                                    false);
+  }
+
+  grpc_client_.reset(new AsyncClientImpl<helloworld::HelloRequest, helloworld::HelloReply>(
+      cm_, "test_cluster", CompressionAlgorithm::None, UINT64_MAX));
+  auto stream = createStream(empty_metadata);
+  stream->sendServerInitialMetadata(reply_metadata);
+  EXPECT_CALL(*stream, onReceiveMessage_(HelloworldReplyEq(reply.message())));
+  stream->http_callbacks_->onData(*Common::serializeBody(reply, CompressionAlgorithm::Gzip), false);
+
+  stream->sendServerTrailers(Status::GrpcStatus::Ok, "", empty_metadata);
+  stream->closeStream();
+}
+
 // Validate that an out-of-range gRPC status is handled as an INVALID_CODE gRPC
 // error.
 TEST_F(GrpcAsyncClientImplTest, OutOfRangeGrpcStatus) {
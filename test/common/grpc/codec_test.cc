@@ -8,6 +8,7 @@
 
 #include "test/proto/helloworld.pb.h"
 #include "test/test_common/printers.h"
+#include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
 
@@ -164,5 +165,124 @@ TEST(GrpcCodecTest, decodeMultipleFrame) {
   }
 }
 
+TEST(GrpcCodecTest, encodeMessage) {
+  Encoder encoder;
+  const std::string message(Encoder::MIN_COMPRESSION_LENGTH - 1, 'a');
+
+  // Too short to compress.
+  Buffer::OwnedImpl short_message(message);
+  Buffer::OwnedImpl output;
+  encoder.encodeMessage(short_message, CompressionAlgorithm::Gzip, output);
+  EXPECT_EQ(0U, short_message.length());
+  std::array<uint8_t, 5> header;
+  encoder.newFrame(GRPC_FH_DEFAULT, message.size(), header);
+  EXPECT_EQ(std::string(reinterpret_cast<char*>(header.data()), 5) + message,
+            TestUtility::bufferToString(output));
+
+  // Not compressed without an algorithm.
+  Buffer::OwnedImpl long_message(message + "a");
+  output.drain(output.length());
+  encoder.encodeMessage(long_message, CompressionAlgorithm::None, output);
+  EXPECT_EQ(message.size() + 6, output.length());
+  EXPECT_EQ(GRPC_FH_DEFAULT, *static_cast<uint8_t*>(output.linearize(1)));
+}
+
+TEST(GrpcCodecTest, decodeCompressedFrames) {
+  helloworld::HelloRequest request;
+  request.set_name(std::string(100000, 'x'));
+
+  for (CompressionAlgorithm algorithm :
+       {CompressionAlgorithm::Gzip, CompressionAlgorithm::Deflate}) {
+    Buffer::OwnedImpl buffer;
+    Encoder encoder;
+    for (int i = 0; i < 3; i++) {
+      Buffer::OwnedImpl message(request.SerializeAsString());
+      encoder.encodeMessage(message, algorithm, buffer);
+    }
+    EXPECT_EQ(GRPC_FH_COMPRESSED, *static_cast<uint8_t*>(buffer.linearize(1)));
+    EXPECT_LT(buffer.length(), static_cast<uint64_t>(request.ByteSize()));
+
+    std::vector<Frame> frames;
+    Decoder decoder;
+    decoder.setDecompression(algorithm);
+    // Feed the frames a byte at a time.
+    while (buffer.length() != 0) {
+      Buffer::OwnedImpl byte;
+      byte.move(buffer, 1);
+      EXPECT_TRUE(decoder.decode(byte, frames));
+    }
+    EXPECT_EQ(3U, frames.size());
+    for (Frame& frame : frames) {
+      EXPECT_EQ(GRPC_FH_DEFAULT, frame.flags_);
+      EXPECT_EQ(static_cast<uint64_t>(request.ByteSize()), frame.length_);
+      EXPECT_EQ(frame.length_, frame.data_->length());
+
+      helloworld::HelloRequest result;
+      result.ParseFromArray(frame.data_->linearize(frame.data_->length()), frame.data_->length());
+      EXPECT_EQ(request.name(), result.name());
+    }
+  }
+}
+
+TEST(GrpcCodecTest, decodeCompressedFrameWithoutDecompression) {
+  Buffer::OwnedImpl message(std::string(1000, 'a'));
+  Buffer::OwnedImpl buffer;
+  Encoder encoder;
+  encoder.encodeMessage(message, CompressionAlgorithm::Gzip, buffer);
+  const uint64_t compressed_length = buffer.length() - 5;
+
+  std::vector<Frame> frames;
+  Decoder decoder;
+  EXPECT_TRUE(decoder.decode(buffer, frames));
+  EXPECT_EQ(1U, frames.size());
+  EXPECT_EQ(GRPC_FH_COMPRESSED, frames[0].flags_);
+  EXPECT_EQ(compressed_length, frames[0].length_);
+}
+
+TEST(GrpcCodecTest, decodeInvalidCompressedFrame) {
+  Buffer::OwnedImpl buffer;
+  std::array<uint8_t, 5> header;
+  Encoder encoder;
+  encoder.newFrame(GRPC_FH_COMPRESSED, 5, header);
+  buffer.add(header.data(), 5);
+  buffer.add("hello");
+
+  std::vector<Frame> frames;
+  Decoder decoder;
+  decoder.setDecompression(CompressionAlgorithm::Gzip);
+  EXPECT_FALSE(decoder.decode(buffer, frames));
+  EXPECT_EQ(0U, frames.size());
+}
+
+TEST(GrpcCodecTest, decodeDecompressionBomb) {
+  // A small frame that inflates to far more than the default limit.
+  Buffer::OwnedImpl message(std::string(4 * Decoder::DEFAULT_MAX_MESSAGE_LENGTH, '\0'));
+  Buffer::OwnedImpl buffer;
+  Encoder encoder;
+  encoder.encodeMessage(message, CompressionAlgorithm::Gzip, buffer);
+  EXPECT_LT(buffer.length(), 64 * 1024U);
+
+  std::vector<Frame> frames;
+  Decoder decoder;
+  decoder.setDecompression(CompressionAlgorithm::Gzip);
+  EXPECT_FALSE(decoder.decode(buffer, frames));
+  EXPECT_EQ(0U, frames.size());
+}
+
+TEST(GrpcCodecTest, decodeCompressedFrameMaxMessageLength) {
+  for (const uint64_t max_message_length : {999, 1000}) {
+    Buffer::OwnedImpl message(std::string(1000, 'a'));
+    Buffer::OwnedImpl buffer;
+    Encoder encoder;
+    encoder.encodeMessage(message, CompressionAlgorithm::Deflate, buffer);
+
+    std::vector<Frame> frames;
+    Decoder decoder;
+    decoder.setDecompression(CompressionAlgorithm::Deflate, max_message_length);
+    EXPECT_EQ(max_message_length == 1000, decoder.decode(buffer, frames));
+    EXPECT_EQ(max_message_length == 1000 ? 1U : 0U, frames.size());
+  }
+}
+
 } // namespace Grpc
 } // namespace Envoy
@@ -38,6 +38,33 @@ TEST(GrpcCommonTest, GetGrpcMessage) {
   EXPECT_EQ("", Common::getGrpcMessage(empty_error_trailers));
 }
 
+TEST(GrpcCommonTest, GetCompressionAlgorithm) {
+  Http::TestHeaderMapImpl no_encoding_headers{{"foo", "bar"}};
+  EXPECT_EQ(CompressionAlgorithm::None, Common::getCompressionAlgorithm(no_encoding_headers));
+
+  Http::TestHeaderMapImpl identity_headers{{"grpc-encoding", "identity"}};
+  EXPECT_EQ(CompressionAlgorithm::None, Common::getCompressionAlgorithm(identity_headers));
+
+  Http::TestHeaderMapImpl gzip_headers{{"grpc-encoding", "gzip"}};
+  EXPECT_EQ(CompressionAlgorithm::Gzip, Common::getCompressionAlgorithm(gzip_headers));
+
+  Http::TestHeaderMapImpl deflate_headers{{"grpc-encoding", "deflate"}};
+  EXPECT_EQ(CompressionAlgorithm::Deflate, Common::getCompressionAlgorithm(deflate_headers));
+
+  Http::TestHeaderMapImpl snappy_headers{{"grpc-encoding", "snappy"}};
+  EXPECT_EQ(CompressionAlgorithm::None, Common::getCompressionAlgorithm(snappy_headers));
+}
+
+TEST(GrpcCommonTest, IsCompressionAccepted) {
+  EXPECT_TRUE(Common::isCompressionAccepted("", CompressionAlgorithm::None));
+  EXPECT_FALSE(Common::isCompressionAccepted("", CompressionAlgorithm::Gzip));
+  EXPECT_TRUE(Common::isCompressionAccepted("identity, gzip", CompressionAlgorithm::Gzip));
+  EXPECT_FALSE(Common::isCompressionAccepted("identity, gzip", CompressionAlgorithm::Deflate));
+  EXPECT_TRUE(
+      Common::isCompressionAccepted("identity,deflate,gzip", CompressionAlgorithm::Deflate));
+  EXPECT_FALSE(Common::isCompressionAccepted("x-gzip", CompressionAlgorithm::Gzip));
+}
+
 TEST(GrpcCommonTest, ChargeStats) {
   NiceMock<Upstream::MockClusterInfo> cluster;
   Common::chargeStat(cluster, "service", "method", true);
@@ -77,6 +104,30 @@ TEST(GrpcCommonTest, PrepareHeaders) {
   EXPECT_STREQ("application/grpc", message->headers().ContentType()->value().c_str());
 }
 
+TEST(GrpcCommonTest, SerializeBodyCompressed) {
+  helloworld::HelloRequest request;
+  request.set_name(std::string(1000, 'a'));
+
+  Buffer::InstancePtr uncompressed = Common::serializeBody(request, CompressionAlgorithm::None);
+  EXPECT_EQ(request.ByteSize() + 5U, uncompressed->length());
+
+  Buffer::InstancePtr compressed = Common::serializeBody(request, CompressionAlgorithm::Gzip);
+  EXPECT_LT(compressed->length(), uncompressed->length());
+  Decoder decoder;
+  decoder.setDecompression(CompressionAlgorithm::Gzip);
+  std::vector<Frame> frames;
+  EXPECT_TRUE(decoder.decode(*compressed, frames));
+  EXPECT_EQ(1U, frames.size());
+  helloworld::HelloRequest result;
+  EXPECT_TRUE(result.ParseFromString(TestUtility::bufferToString(*frames[0].data_)));
+  EXPECT_EQ(request.name(), result.name());
+
+  // Short messages are sent uncompressed.
+  request.set_name("hello");
+  compressed = Common::serializeBody(request, CompressionAlgorithm::Gzip);
+  EXPECT_EQ(GRPC_FH_DEFAULT, *static_cast<uint8_t*>(compressed->linearize(1)));
+}
+
 TEST(GrpcCommonTest, ResolveServiceAndMethod) {
   std::string service;
   std::string method;
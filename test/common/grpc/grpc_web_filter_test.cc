@@ -147,6 +147,73 @@ TEST_F(GrpcWebFilterTest, InvalidBase64) {
             filter_.decodeData(request_buffer, true));
 }
 
+TEST_F(GrpcWebFilterTest, CompressedResponseNotAccepted) {
+  Http::TestHeaderMapImpl request_headers{
+      {"content-type", Http::Headers::get().ContentTypeValues.GrpcWebProto}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+  // The backend may still compress, since the filter decompresses for the client.
+  EXPECT_EQ(Http::Headers::get().GrpcAcceptEncodingValues.Default,
+            request_headers.GrpcAcceptEncoding()->value().c_str());
+
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"grpc-encoding", "gzip"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.encodeHeaders(response_headers, false));
+  EXPECT_FALSE(response_headers.has("grpc-encoding"));
+
+  const std::string message(1000, 'a');
+  Buffer::OwnedImpl message_buffer(message);
+  Buffer::OwnedImpl data;
+  Encoder().encodeMessage(message_buffer, CompressionAlgorithm::Gzip, data);
+  EXPECT_EQ(GRPC_FH_COMPRESSED, *static_cast<uint8_t*>(data.linearize(1)));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.encodeData(data, false));
+  EXPECT_EQ(std::string("\x00\x00\x00\x03\xe8", 5) + message, TestUtility::bufferToString(data));
+}
+
+TEST_F(GrpcWebFilterTest, CompressedResponseAccepted) {
+  Http::TestHeaderMapImpl request_headers{
+      {"content-type", Http::Headers::get().ContentTypeValues.GrpcWebProto},
+      {"grpc-accept-encoding", "identity, gzip"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"grpc-encoding", "gzip"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.encodeHeaders(response_headers, false));
+  EXPECT_EQ("gzip", response_headers.get_("grpc-encoding"));
+
+  Buffer::OwnedImpl message_buffer(std::string(1000, 'a'));
+  Buffer::OwnedImpl data;
+  Encoder().encodeMessage(message_buffer, CompressionAlgorithm::Gzip, data);
+  const std::string compressed = TestUtility::bufferToString(data);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.encodeData(data, false));
+  EXPECT_EQ(compressed, TestUtility::bufferToString(data));
+}
+
+TEST_F(GrpcWebFilterTest, InvalidCompressedResponse) {
+  Http::TestHeaderMapImpl request_headers{
+      {"content-type", Http::Headers::get().ContentTypeValues.GrpcWebProto}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"grpc-encoding", "deflate"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.encodeHeaders(response_headers, false));
+
+  Buffer::OwnedImpl data("\x01\x00\x00\x00\x05hello", 10);
+  EXPECT_CALL(encoder_callbacks_, resetStream());
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_.encodeData(data, false));
+}
+
+TEST_F(GrpcWebFilterTest, CompressedResponseOverBufferLimit) {
+  Http::TestHeaderMapImpl request_headers{
+      {"content-type", Http::Headers::get().ContentTypeValues.GrpcWebProto}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+  ON_CALL(encoder_callbacks_, encoderBufferLimit()).WillByDefault(Return(1000));
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"grpc-encoding", "gzip"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.encodeHeaders(response_headers, false));
+
+  // A message that decompresses to more than the stream's buffer limit resets the stream.
+  Buffer::OwnedImpl message_buffer(std::string(1001, 'a'));
+  Buffer::OwnedImpl data;
+  Encoder().encodeMessage(message_buffer, CompressionAlgorithm::Gzip, data);
+  EXPECT_CALL(encoder_callbacks_, resetStream());
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_.encodeData(data, false));
+}
+
 TEST_P(GrpcWebFilterTest, StatsNoCluster) {
   Http::TestHeaderMapImpl request_headers{{"content-type", request_content_type()},
                                           {":path", "/lyft.users.BadCompanions/GetBadCompanions"}};
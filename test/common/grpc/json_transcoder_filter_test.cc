@@ -291,6 +291,37 @@ TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryPost) {
   EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_.decodeTrailers(response_trailers));
 }
 
+TEST_F(GrpcJsonTranscoderFilterTest, TranscodingCompressedResponse) {
+  Http::TestHeaderMapImpl request_headers{
+      {"content-type", "application/json"}, {":method", "POST"}, {":path", "/shelf"}};
+
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+  EXPECT_EQ("identity,deflate,gzip", request_headers.get_("grpc-accept-encoding"));
+  Buffer::OwnedImpl request_data{"{\"theme\": \"Children\"}"};
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(request_data, true));
+
+  Http::TestHeaderMapImpl response_headers{
+      {"content-type", "application/grpc"}, {":status", "200"}, {"grpc-encoding", "gzip"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_.encodeHeaders(response_headers, false));
+  EXPECT_FALSE(response_headers.has("grpc-encoding"));
+
+  bookstore::Shelf response;
+  response.set_id(20);
+  response.set_theme(std::string(1000, 'a'));
+  auto response_data = Common::serializeBody(response, CompressionAlgorithm::Gzip);
+  EXPECT_GT(static_cast<uint64_t>(response.ByteSize()), response_data->length());
+
+  // Split the frame to check that the decoder holds on to incomplete frames.
+  Buffer::OwnedImpl first_part;
+  first_part.move(*response_data, 10);
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, filter_.encodeData(first_part, false));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer,
+            filter_.encodeData(*response_data, false));
+  EXPECT_EQ("{\"id\":\"20\",\"theme\":\"" + response.theme() + "\"}",
+            TestUtility::bufferToString(first_part) + TestUtility::bufferToString(*response_data));
+}
+
 TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryError) {
   Http::TestHeaderMapImpl request_headers{
       {"content-type", "application/json"}, {":method", "POST"}, {":path", "/shelf"}};
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/compressor/zlib_compressor.h"
+#include "common/http/filter/gzip_filter.h"
+#include "common/http/header_map_impl.h"
+#include "common/json/json_loader.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/test_common/printers.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::_;
+
+namespace Envoy {
+namespace Http {
+
+class GzipFilterTest : public testing::Test {
+public:
+  GzipFilterTest() { setup("{}"); }
+
+  void setup(const std::string& json) {
+    Json::ObjectSharedPtr config = Json::Factory::loadFromString(json);
+    config_.reset(new GzipFilterConfig(*config, "test.", store_));
+    filter_.reset(new GzipFilter(config_));
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+  }
+
+  void sendRequest(const std::string& accept_encoding) {
+    TestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/"}};
+    if (!accept_encoding.empty()) {
+      request_headers.addCopy("accept-encoding", accept_encoding);
+    }
+    EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+  }
+
+  void expectNotCompressed(TestHeaderMapImpl response_headers) {
+    sendRequest("gzip");
+    EXPECT_EQ(FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+    EXPECT_NE("gzip", response_headers.get_("content-encoding"));
+    EXPECT_FALSE(response_headers.has("vary"));
+
+    Buffer::OwnedImpl data(body_);
+    EXPECT_EQ(FilterDataStatus::Continue, filter_->encodeData(data, true));
+    EXPECT_EQ(body_, TestUtility::bufferToString(data));
+    filter_->onDestroy();
+  }
+
+  // Inflate a gzip or zlib stream, or the start of one that has not been finished.
+  static std::string inflate(const std::string& compressed, bool finished = true) {
+    z_stream stream{};
+    // 32 lets zlib detect the gzip or zlib header.
+    EXPECT_EQ(Z_OK, inflateInit2(&stream, 15 + 32));
+    std::string output(compressed.size() * 64 + 1024, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = compressed.size();
+    stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+    stream.avail_out = output.size();
+    EXPECT_EQ(finished ? Z_STREAM_END : Z_OK,
+              ::inflate(&stream, finished ? Z_FINISH : Z_SYNC_FLUSH));
+    output.resize(stream.total_out);
+    inflateEnd(&stream);
+    return output;
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  GzipFilterConfigSharedPtr config_;
+  std::unique_ptr<GzipFilter> filter_;
+  NiceMock<MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  const std::string body_{std::string(1000, 'a') + std::string(1000, 'b')};
+};
+
+TEST_F(GzipFilterTest, Negotiate) {
+  EXPECT_EQ(GzipFilter::ContentCoding::Gzip, GzipFilter::negotiate("gzip"));
+  EXPECT_EQ(GzipFilter::ContentCoding::Gzip, GzipFilter::negotiate("deflate, gzip;q=0.5"));
+  EXPECT_EQ(GzipFilter::ContentCoding::Gzip, GzipFilter::negotiate("br, X-GZIP"));
+  EXPECT_EQ(GzipFilter::ContentCoding::Gzip, GzipFilter::negotiate("*"));
+  EXPECT_EQ(GzipFilter::ContentCoding::Deflate, GzipFilter::negotiate("deflate"));
+  EXPECT_EQ(GzipFilter::ContentCoding::Deflate, GzipFilter::negotiate("gzip;q=0, *"));
+  EXPECT_EQ(GzipFilter::ContentCoding::Deflate, GzipFilter::negotiate(" gzip ; q=0.000 ,deflate"));
+  EXPECT_EQ(GzipFilter::ContentCoding::Identity, GzipFilter::negotiate(""));
+  EXPECT_EQ(GzipFilter::ContentCoding::Identity, GzipFilter::negotiate("identity, br"));
+  EXPECT_EQ(GzipFilter::ContentCoding::Identity, GzipFilter::negotiate("*;q=0"));
+  EXPECT_EQ(GzipFilter::ContentCoding::Identity, GzipFilter::negotiate("gzip;q=0, deflate;q=0."));
+}
+
+TEST_F(GzipFilterTest, CompressGzip) {
+  sendRequest("gzip, deflate");
+
+  TestHeaderMapImpl response_headers{{":status", "200"},
+                                     {"content-type", "text/html; charset=utf-8"},
+                                     {"content-length", std::to_string(body_.size())},
+                                     {"etag", "\"abc\""}};
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  EXPECT_EQ("gzip", response_headers.get_("content-encoding"));
+  EXPECT_EQ("Accept-Encoding", response_headers.get_("vary"));
+  EXPECT_EQ("W/\"abc\"", response_headers.get_("etag"));
+  EXPECT_FALSE(response_headers.has("content-length"));
+
+  // Feed the body in pieces, as it would arrive from upstream.
+  std::string compressed;
+  for (size_t i = 0; i < body_.size(); i += 500) {
+    Buffer::OwnedImpl data(body_.substr(i, 500));
+    const bool end_stream = i + 500 >= body_.size();
+    EXPECT_EQ(FilterDataStatus::Continue, filter_->encodeData(data, end_stream));
+    compressed += TestUtility::bufferToString(data);
+  }
+  EXPECT_EQ(0x1f, static_cast<uint8_t>(compressed[0]));
+  EXPECT_EQ(0x8b, static_cast<uint8_t>(compressed[1]));
+  EXPECT_EQ(body_, inflate(compressed));
+
+  EXPECT_EQ(1U, store_.counter("test.gzip.compressed").value());
+  EXPECT_EQ(body_.size(), store_.counter("test.gzip.total_uncompressed_bytes").value());
+  EXPECT_EQ(compressed.size(), store_.counter("test.gzip.total_compressed_bytes").value());
+  filter_->onDestroy();
+}
+
+TEST_F(GzipFilterTest, CompressDeflateWithTrailers) {
+  sendRequest("deflate");
+
+  TestHeaderMapImpl response_headers{
+      {":status", "200"}, {"content-type", "application/json"}, {"vary", "Origin"}};
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  EXPECT_EQ("deflate", response_headers.get_("content-encoding"));
+  EXPECT_EQ("Origin, Accept-Encoding", response_headers.get_("vary"));
+
+  Buffer::OwnedImpl data(body_);
+  EXPECT_EQ(FilterDataStatus::Continue, filter_->encodeData(data, false));
+  std::string compressed = TestUtility::bufferToString(data);
+
+  EXPECT_CALL(encoder_callbacks_, addEncodedData(_, true))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void {
+        compressed += TestUtility::bufferToString(data);
+      }));
+  TestHeaderMapImpl response_trailers{{"grpc-status", "0"}};
+  EXPECT_EQ(FilterTrailersStatus::Continue, filter_->encodeTrailers(response_trailers));
+  EXPECT_EQ(0x78, static_cast<uint8_t>(compressed[0]));
+  EXPECT_EQ(body_, inflate(compressed));
+  filter_->onDestroy();
+}
+
+// Data that does not end the stream is flushed, so streamed responses are not held back.
+TEST_F(GzipFilterTest, CompressStreaming) {
+  sendRequest("gzip");
+
+  TestHeaderMapImpl response_headers{{":status", "200"}, {"content-type", "text/html"}};
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  EXPECT_EQ("gzip", response_headers.get_("content-encoding"));
+
+  Buffer::OwnedImpl first("first event");
+  EXPECT_EQ(FilterDataStatus::Continue, filter_->encodeData(first, false));
+  std::string compressed = TestUtility::bufferToString(first);
+  EXPECT_EQ("first event", inflate(compressed, false));
+
+  Buffer::OwnedImpl second("second event");
+  EXPECT_EQ(FilterDataStatus::Continue, filter_->encodeData(second, false));
+  compressed += TestUtility::bufferToString(second);
+  EXPECT_EQ("first eventsecond event", inflate(compressed, false));
+
+  Buffer::OwnedImpl last;
+  EXPECT_EQ(FilterDataStatus::Continue, filter_->encodeData(last, true));
+  compressed += TestUtility::bufferToString(last);
+  EXPECT_EQ("first eventsecond event", inflate(compressed));
+  filter_->onDestroy();
+}
+
+TEST_F(GzipFilterTest, NoAcceptEncoding) {
+  sendRequest("");
+
+  TestHeaderMapImpl response_headers{{":status", "200"}, {"content-type", "text/plain"}};
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  EXPECT_FALSE(response_headers.has("content-encoding"));
+  EXPECT_EQ("Accept-Encoding", response_headers.get_("vary"));
+
+  Buffer::OwnedImpl data(body_);
+  EXPECT_EQ(FilterDataStatus::Continue, filter_->encodeData(data, true));
+  EXPECT_EQ(body_, TestUtility::bufferToString(data));
+  EXPECT_EQ(1U, store_.counter("test.gzip.no_accept_encoding").value());
+}
+
+TEST_F(GzipFilterTest, NotCompressible) {
+  setup(R"EOF({"min_content_length": 100, "content_types": ["application/json"]})EOF");
+
+  expectNotCompressed({{":status", "200"}, {"content-type", "text/html"}});
+  expectNotCompressed(
+      {{":status", "200"}, {"content-type", "application/json"}, {"content-length", "99"}});
+  expectNotCompressed(
+      {{":status", "200"}, {"content-type", "application/json"}, {"content-encoding", "br"}});
+  expectNotCompressed({{":status", "200"},
+                       {"content-type", "application/json"},
+                       {"cache-control", "public, No-Transform"}});
+  expectNotCompressed({{":status", "206"}, {"content-type", "application/json"}});
+  expectNotCompressed({{":status", "200"}});
+  EXPECT_EQ(6U, store_.counter("test.gzip.not_compressed").value());
+}
+
+TEST_F(GzipFilterTest, HeaderOnlyResponse) {
+  sendRequest("gzip");
+
+  TestHeaderMapImpl response_headers{{":status", "200"}, {"content-type", "text/plain"}};
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, true));
+  EXPECT_FALSE(response_headers.has("content-encoding"));
+}
+
+TEST_F(GzipFilterTest, RoutePolicy) {
+  decoder_callbacks_.route_->route_entry_.opaque_config_.insert(
+      {GzipFilter::ROUTE_ENABLED_KEY, "false"});
+  sendRequest("gzip");
+
+  TestHeaderMapImpl response_headers{{":status", "200"}, {"content-type", "text/plain"}};
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  EXPECT_FALSE(response_headers.has("content-encoding"));
+  EXPECT_EQ(1U, store_.counter("test.gzip.not_compressed").value());
+}
+
+TEST_F(GzipFilterTest, RouteCompressionLevel) {
+  decoder_callbacks_.route_->route_entry_.opaque_config_.insert(
+      {GzipFilter::ROUTE_COMPRESSION_LEVEL_KEY, "1"});
+  sendRequest("gzip");
+
+  TestHeaderMapImpl response_headers{{":status", "200"}, {"content-type", "text/plain"}};
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  Buffer::OwnedImpl data(body_);
+  EXPECT_EQ(FilterDataStatus::Continue, filter_->encodeData(data, true));
+  // The gzip header records that the fastest level was used.
+  const std::string compressed = TestUtility::bufferToString(data);
+  EXPECT_EQ(4, compressed[8]);
+  EXPECT_EQ(body_, inflate(compressed));
+}
+
+TEST_F(GzipFilterTest, ResetReturnsCompressorToCache) {
+  sendRequest("gzip");
+
+  TestHeaderMapImpl response_headers{{":status", "200"}, {"content-type", "text/plain"}};
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  Buffer::OwnedImpl data(body_);
+  EXPECT_EQ(FilterDataStatus::Continue, filter_->encodeData(data, false));
+
+  const size_t cached_streams = Compressor::ZlibCompressor::cachedStreams();
+  filter_->onDestroy();
+  EXPECT_EQ(std::min(cached_streams + 1, Compressor::ZlibCompressor::MAX_CACHED_STREAMS),
+            Compressor::ZlibCompressor::cachedStreams());
+}
+
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,579 @@
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/utility.h"
+#include "common/http/filter/response_cache_filter.h"
+#include "common/http/header_map_impl.h"
+#include "common/json/json_loader.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/printers.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::SaveArg;
+using testing::_;
+
+namespace Envoy {
+namespace Http {
+
+class ResponseCacheFilterTest : public testing::Test {
+public:
+  /**
+   * A filter and the callbacks of the stream that it is on.
+   */
+  struct Stream {
+    Stream(ResponseCacheFilterConfigSharedPtr config) : filter_(new ResponseCacheFilter(config)) {
+      filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+      filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+      ON_CALL(decoder_callbacks_.dispatcher_, post(_))
+          .WillByDefault(
+              Invoke([this](std::function<void()> cb) -> void { posted_.push_back(cb); }));
+    }
+
+    // Expect the stream to wait on a leader.
+    void expectWait() {
+      wait_timer_ = new NiceMock<Event::MockTimer>(&decoder_callbacks_.dispatcher_);
+      EXPECT_CALL(*wait_timer_, enableTimer(std::chrono::milliseconds(5000)));
+    }
+
+    void runPosted() {
+      std::vector<std::function<void()>> posted = std::move(posted_);
+      for (const std::function<void()>& cb : posted) {
+        cb();
+      }
+    }
+
+    std::unique_ptr<ResponseCacheFilter> filter_;
+    NiceMock<MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+    NiceMock<MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+    std::vector<std::function<void()>> posted_;
+    Event::MockTimer* wait_timer_{};
+  };
+  typedef std::unique_ptr<Stream> StreamPtr;
+
+  ResponseCacheFilterTest() {
+    ON_CALL(time_source_, currentTime()).WillByDefault(Invoke([this]() { return now_; }));
+    setup("{}");
+  }
+
+  void setup(const std::string& json) {
+    Json::ObjectSharedPtr config = Json::Factory::loadFromString(json);
+    config_.reset(new ResponseCacheFilterConfig(*config, "test.", store_, time_source_));
+  }
+
+  StreamPtr newStream() { return StreamPtr{new Stream(config_)}; }
+
+  // A request for the same response as request_headers_, that further headers can be added to.
+  std::unique_ptr<TestHeaderMapImpl> newRequest() {
+    const HeaderMap& request_headers = request_headers_;
+    return std::unique_ptr<TestHeaderMapImpl>{new TestHeaderMapImpl(request_headers)};
+  }
+
+  FilterHeadersStatus sendRequest(Stream& stream, TestHeaderMapImpl& request_headers) {
+    return stream.filter_->decodeHeaders(request_headers, true);
+  }
+
+  void sendResponse(Stream& stream, TestHeaderMapImpl&& response_headers) {
+    stream.filter_->encodeHeaders(response_headers, body_.empty());
+    if (!body_.empty()) {
+      Buffer::OwnedImpl data(body_);
+      stream.filter_->encodeData(data, true);
+    }
+    stream.filter_->onDestroy();
+  }
+
+  // Fetch a response through a new leader stream, so that it is cached.
+  void fill(TestHeaderMapImpl&& response_headers) {
+    StreamPtr stream = newStream();
+    EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*stream, request_headers_));
+    sendResponse(*stream, std::move(response_headers));
+  }
+
+  // Expect a stream to be answered from the cache with a full response.
+  void expectServed(Stream& stream, const std::string& age) {
+    EXPECT_CALL(stream.decoder_callbacks_, encodeHeaders_(_, false))
+        .WillOnce(Invoke([&](HeaderMap& headers, bool) -> void {
+          EXPECT_STREQ("200", headers.Status()->value().c_str());
+          EXPECT_STREQ(age.c_str(), headers.get(Headers::get().Age)->value().c_str());
+          EXPECT_STREQ(std::to_string(body_.size()).c_str(),
+                       headers.ContentLength()->value().c_str());
+        }));
+    EXPECT_CALL(stream.decoder_callbacks_, encodeData(_, true))
+        .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void {
+          EXPECT_EQ(body_, TestUtility::bufferToString(data));
+        }));
+  }
+
+  void advance(uint64_t seconds) { now_ += std::chrono::seconds(seconds); }
+
+  NiceMock<MockSystemTimeSource> time_source_;
+  SystemTime now_{std::chrono::hours(24 * 365 * 47)};
+  Stats::IsolatedStoreImpl store_;
+  ResponseCacheFilterConfigSharedPtr config_;
+  TestHeaderMapImpl request_headers_{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/a"}, {"accept-encoding", "gzip"}};
+  std::string body_{"hello world"};
+};
+
+TEST_F(ResponseCacheFilterTest, ParseHttpDate) {
+  SystemTime time;
+  EXPECT_TRUE(ResponseCacheFilter::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", time));
+  EXPECT_EQ(784111777, std::chrono::system_clock::to_time_t(time));
+  EXPECT_FALSE(ResponseCacheFilter::parseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT", time));
+  EXPECT_FALSE(ResponseCacheFilter::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT junk", time));
+  EXPECT_FALSE(ResponseCacheFilter::parseHttpDate("", time));
+}
+
+TEST_F(ResponseCacheFilterTest, IsCacheable) {
+  SystemTime now;
+  ResponseCacheFilter::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", now);
+  std::chrono::seconds lifetime;
+  std::chrono::seconds age;
+
+  EXPECT_TRUE(ResponseCacheFilter::isCacheable(
+      TestHeaderMapImpl{{":status", "200"}, {"cache-control", "public, max-age=60"}}, now,
+      lifetime, age));
+  EXPECT_EQ(60, lifetime.count());
+  EXPECT_EQ(0, age.count());
+
+  EXPECT_TRUE(ResponseCacheFilter::isCacheable(
+      TestHeaderMapImpl{
+          {":status", "404"}, {"cache-control", "max-age=60, S-MaxAge=\"30\""}, {"age", "10"}},
+      now, lifetime, age));
+  EXPECT_EQ(30, lifetime.count());
+  EXPECT_EQ(10, age.count());
+
+  // The age is at least how long ago the response was generated.
+  EXPECT_TRUE(ResponseCacheFilter::isCacheable(
+      TestHeaderMapImpl{{":status", "200"},
+                        {"date", "Sun, 06 Nov 1994 08:49:32 GMT"},
+                        {"expires", "Sun, 06 Nov 1994 08:50:32 GMT"}},
+      now, lifetime, age));
+  EXPECT_EQ(60, lifetime.count());
+  EXPECT_EQ(5, age.count());
+
+  EXPECT_FALSE(ResponseCacheFilter::isCacheable(
+      TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60"}, {"age", "60"}}, now,
+      lifetime, age));
+  EXPECT_FALSE(ResponseCacheFilter::isCacheable(TestHeaderMapImpl{{":status", "200"}}, now,
+                                                lifetime, age));
+  EXPECT_FALSE(ResponseCacheFilter::isCacheable(
+      TestHeaderMapImpl{{":status", "200"}, {"expires", "0"}}, now, lifetime, age));
+  EXPECT_FALSE(ResponseCacheFilter::isCacheable(
+      TestHeaderMapImpl{{":status", "500"}, {"cache-control", "max-age=60"}}, now, lifetime, age));
+  EXPECT_FALSE(ResponseCacheFilter::isCacheable(
+      TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60, private"}}, now,
+      lifetime, age));
+  EXPECT_FALSE(ResponseCacheFilter::isCacheable(
+      TestHeaderMapImpl{{":status", "200"}, {"cache-control", "no-store"}}, now, lifetime, age));
+  EXPECT_FALSE(ResponseCacheFilter::isCacheable(
+      TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60, no-cache"}}, now,
+      lifetime, age));
+  EXPECT_FALSE(ResponseCacheFilter::isCacheable(
+      TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=abc"}}, now, lifetime,
+      age));
+  EXPECT_FALSE(ResponseCacheFilter::isCacheable(
+      TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60"}, {"vary", "*"}}, now,
+      lifetime, age));
+  EXPECT_FALSE(ResponseCacheFilter::isCacheable(
+      TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60"}, {"set-cookie", "a"}},
+      now, lifetime, age));
+}
+
+TEST_F(ResponseCacheFilterTest, MissThenHit) {
+  fill({{":status", "200"},
+        {"cache-control", "max-age=60"},
+        {"transfer-encoding", "chunked"},
+        {"age", "3"}});
+  EXPECT_EQ(1U, store_.counter("test.response_cache.miss").value());
+  EXPECT_EQ(1U, store_.counter("test.response_cache.insert").value());
+  EXPECT_EQ(1U, store_.gauge("test.response_cache.entries").value());
+
+  advance(5);
+  StreamPtr stream = newStream();
+  expectServed(*stream, "8");
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*stream, request_headers_));
+  EXPECT_EQ(1U, store_.counter("test.response_cache.hit").value());
+  stream->filter_->onDestroy();
+
+  // The entry expires once the upstream age and the time in the cache add up to max-age.
+  advance(52);
+  stream = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*stream, request_headers_));
+  EXPECT_EQ(2U, store_.counter("test.response_cache.miss").value());
+  EXPECT_EQ(0U, store_.gauge("test.response_cache.entries").value());
+  stream->filter_->onDestroy();
+}
+
+TEST_F(ResponseCacheFilterTest, HeaderOnlyResponse) {
+  body_ = "";
+  fill({{":status", "301"}, {"cache-control", "max-age=60"}, {"location", "/b"}});
+
+  StreamPtr stream = newStream();
+  EXPECT_CALL(stream->decoder_callbacks_, encodeHeaders_(_, true))
+      .WillOnce(Invoke([](HeaderMap& headers, bool) -> void {
+        EXPECT_STREQ("301", headers.Status()->value().c_str());
+        EXPECT_STREQ("/b", headers.get(LowerCaseString("location"))->value().c_str());
+      }));
+  EXPECT_CALL(stream->decoder_callbacks_, encodeData(_, _)).Times(0);
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*stream, request_headers_));
+}
+
+TEST_F(ResponseCacheFilterTest, ConditionalRequests) {
+  fill({{":status", "200"},
+        {"cache-control", "max-age=60"},
+        {"etag", "\"v1\""},
+        {"last-modified", "Sun, 06 Nov 1994 08:49:37 GMT"},
+        {"content-type", "text/plain"}});
+
+  auto expectNotModified = [this](TestHeaderMapImpl& request_headers) -> void {
+    StreamPtr stream = newStream();
+    EXPECT_CALL(stream->decoder_callbacks_, encodeHeaders_(_, true))
+        .WillOnce(Invoke([](HeaderMap& headers, bool) -> void {
+          EXPECT_STREQ("304", headers.Status()->value().c_str());
+          EXPECT_STREQ("\"v1\"", headers.get(Headers::get().Etag)->value().c_str());
+          EXPECT_EQ(nullptr, headers.ContentType());
+        }));
+    EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*stream, request_headers));
+  };
+
+  std::unique_ptr<TestHeaderMapImpl> request_headers = newRequest();
+  request_headers->addCopy("if-none-match", "\"v0\", W/\"v1\"");
+  expectNotModified(*request_headers);
+
+  request_headers = newRequest();
+  request_headers->addCopy("if-none-match", "*");
+  expectNotModified(*request_headers);
+
+  request_headers = newRequest();
+  request_headers->addCopy("if-modified-since", "Sun, 06 Nov 1994 08:49:37 GMT");
+  expectNotModified(*request_headers);
+  EXPECT_EQ(3U, store_.counter("test.response_cache.validated").value());
+
+  // Validators that don't match get the full response.
+  request_headers = newRequest();
+  request_headers->addCopy("if-none-match", "\"v0\"");
+  request_headers->addCopy("if-modified-since", "Sun, 06 Nov 1994 08:49:37 GMT");
+  StreamPtr stream = newStream();
+  expectServed(*stream, "0");
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*stream, *request_headers));
+
+  request_headers = newRequest();
+  request_headers->addCopy("if-modified-since", "Sun, 06 Nov 1994 08:49:36 GMT");
+  stream = newStream();
+  expectServed(*stream, "0");
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*stream, *request_headers));
+}
+
+TEST_F(ResponseCacheFilterTest, ConditionalRequestMiss) {
+  // A conditional request that misses goes upstream without leading, so the 304 that it gets does
+  // not stop the key from being cached.
+  std::unique_ptr<TestHeaderMapImpl> request_headers = newRequest();
+  request_headers->addCopy("if-none-match", "\"v1\"");
+  StreamPtr stream = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*stream, *request_headers));
+  body_ = "";
+  sendResponse(*stream, {{":status", "304"}, {"cache-control", "max-age=60"}, {"etag", "\"v1\""}});
+  EXPECT_EQ(1U, store_.counter("test.response_cache.miss").value());
+  EXPECT_EQ(0U, store_.counter("test.response_cache.not_cacheable").value());
+
+  // Nor does the 206 of a range request.
+  request_headers = newRequest();
+  request_headers->addCopy("range", "bytes=0-1");
+  stream = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*stream, *request_headers));
+  body_ = "he";
+  sendResponse(*stream, {{":status", "206"}, {"cache-control", "max-age=60"}});
+
+  // The next unconditional request leads, and a conditional request waits on it and is answered
+  // with a 304 from its response.
+  body_ = "hello world";
+  StreamPtr leader = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*leader, request_headers_));
+  request_headers = newRequest();
+  request_headers->addCopy("if-none-match", "\"v1\"");
+  StreamPtr follower = newStream();
+  follower->expectWait();
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*follower, *request_headers));
+
+  sendResponse(*leader, {{":status", "200"}, {"cache-control", "max-age=60"}, {"etag", "\"v1\""}});
+  EXPECT_CALL(follower->decoder_callbacks_, encodeHeaders_(_, true))
+      .WillOnce(Invoke([](HeaderMap& headers, bool) -> void {
+        EXPECT_STREQ("304", headers.Status()->value().c_str());
+      }));
+  follower->runPosted();
+  EXPECT_EQ(0U, store_.counter("test.response_cache.pass").value());
+  EXPECT_EQ(1U, store_.counter("test.response_cache.insert").value());
+  EXPECT_EQ(1U, store_.counter("test.response_cache.validated").value());
+}
+
+TEST_F(ResponseCacheFilterTest, Vary) {
+  fill({{":status", "200"}, {"cache-control", "max-age=60"}, {"vary", "Accept-Encoding"}});
+
+  StreamPtr stream = newStream();
+  expectServed(*stream, "0");
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*stream, request_headers_));
+
+  TestHeaderMapImpl request_headers{
+      {":method", "GET"}, {":authority", "host"}, {":path", "/a"}, {"accept-encoding", "br"}};
+  stream = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*stream, request_headers));
+  stream->filter_->onDestroy();
+}
+
+TEST_F(ResponseCacheFilterTest, VaryVariants) {
+  body_ = "gzip body";
+  fill({{":status", "200"}, {"cache-control", "max-age=60"}, {"vary", "Accept-Encoding"}});
+
+  // A request with another accept-encoding misses, and its response is stored as a second variant
+  // of the key rather than in place of the first.
+  TestHeaderMapImpl identity_request{{":method", "GET"},
+                                     {":authority", "host"},
+                                     {":path", "/a"},
+                                     {"accept-encoding", "identity"}};
+  StreamPtr stream = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*stream, identity_request));
+  body_ = "identity body";
+  sendResponse(*stream,
+               {{":status", "200"}, {"cache-control", "max-age=60"}, {"vary", "Accept-Encoding"}});
+  EXPECT_EQ(2U, store_.counter("test.response_cache.insert").value());
+  EXPECT_EQ(2U, store_.gauge("test.response_cache.entries").value());
+  EXPECT_EQ(0U, store_.counter("test.response_cache.eviction").value());
+
+  // Each variant is served to its own requests.
+  stream = newStream();
+  expectServed(*stream, "0");
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*stream, identity_request));
+  body_ = "gzip body";
+  stream = newStream();
+  expectServed(*stream, "0");
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*stream, request_headers_));
+  EXPECT_EQ(2U, store_.counter("test.response_cache.hit").value());
+
+  // A response for a variant that is stored already replaces it.
+  auto variant = [this](const std::string& accept_encoding) -> CachedResponseConstSharedPtr {
+    std::shared_ptr<CachedResponse> response = std::make_shared<CachedResponse>();
+    response->headers_.reset(new TestHeaderMapImpl{{":status", "200"}});
+    response->vary_.emplace_back(LowerCaseString("accept-encoding"), accept_encoding);
+    response->response_time_ = now_;
+    response->expires_ = now_ + std::chrono::seconds(60);
+    return response;
+  };
+  config_->cache()->complete("host/a", variant("gzip"));
+  EXPECT_EQ(3U, store_.counter("test.response_cache.insert").value());
+  EXPECT_EQ(2U, store_.gauge("test.response_cache.entries").value());
+
+  // A key keeps a bounded number of variants, evicting its least recently used one.
+  for (size_t i = 0; i < 7; i++) {
+    config_->cache()->complete("host/a", variant(std::to_string(i)));
+  }
+  EXPECT_EQ(8U, store_.gauge("test.response_cache.entries").value());
+  EXPECT_EQ(1U, store_.counter("test.response_cache.eviction").value());
+  stream = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*stream, identity_request));
+  stream->filter_->onDestroy();
+
+  // Purging the key removes all of its variants.
+  EXPECT_TRUE(config_->cache()->remove("host/a"));
+  EXPECT_EQ(0U, store_.gauge("test.response_cache.entries").value());
+}
+
+TEST_F(ResponseCacheFilterTest, Bypass) {
+  std::unique_ptr<TestHeaderMapImpl> request_headers = newRequest();
+  request_headers->addCopy("cache-control", "no-cache");
+  StreamPtr stream = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*stream, *request_headers));
+  sendResponse(*stream, {{":status", "200"}, {"cache-control", "max-age=60"}});
+  EXPECT_EQ(1U, store_.counter("test.response_cache.bypass").value());
+
+  request_headers = newRequest();
+  request_headers->addCopy("authorization", "secret");
+  stream = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*stream, *request_headers));
+  sendResponse(*stream, {{":status", "200"}, {"cache-control", "max-age=60"}});
+
+  request_headers = newRequest();
+  request_headers->insertMethod().value(std::string("POST"));
+  stream = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*stream, *request_headers));
+  sendResponse(*stream, {{":status", "200"}, {"cache-control", "max-age=60"}});
+
+  EXPECT_EQ(0U, store_.counter("test.response_cache.miss").value());
+  EXPECT_EQ(0U, store_.counter("test.response_cache.insert").value());
+}
+
+TEST_F(ResponseCacheFilterTest, NotCacheable) {
+  // Without hit for pass, each request leads and finds that its response can't be cached.
+  setup(R"EOF({"hit_for_pass_ms": 0})EOF");
+  fill({{":status", "200"}});
+  fill({{":status", "200"}, {"cache-control", "max-age=60"}, {"content-length", "2000000"}});
+  body_ = std::string(2000000, 'a');
+  fill({{":status", "200"}, {"cache-control", "max-age=60"}});
+
+  StreamPtr stream = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*stream, request_headers_));
+  TestHeaderMapImpl response_headers{{":status", "200"}, {"cache-control", "max-age=60"}};
+  stream->filter_->encodeHeaders(response_headers, false);
+  TestHeaderMapImpl response_trailers{{"grpc-status", "0"}};
+  stream->filter_->encodeTrailers(response_trailers);
+  stream->filter_->onDestroy();
+
+  EXPECT_EQ(4U, store_.counter("test.response_cache.not_cacheable").value());
+  EXPECT_EQ(0U, store_.counter("test.response_cache.insert").value());
+}
+
+TEST_F(ResponseCacheFilterTest, Eviction) {
+  setup(R"EOF({"max_size_bytes": 250, "shards": 1})EOF");
+  body_ = std::string(100, 'a');
+  fill({{":status", "200"}, {"cache-control", "max-age=60"}});
+  request_headers_.insertPath().value(std::string("/b"));
+  fill({{":status", "200"}, {"cache-control", "max-age=60"}});
+  EXPECT_EQ(1U, store_.counter("test.response_cache.eviction").value());
+  EXPECT_EQ(1U, store_.gauge("test.response_cache.entries").value());
+
+  // The most recent response is kept.
+  StreamPtr stream = newStream();
+  expectServed(*stream, "0");
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*stream, request_headers_));
+}
+
+TEST_F(ResponseCacheFilterTest, CoalesceMisses) {
+  StreamPtr leader = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*leader, request_headers_));
+
+  StreamPtr follower = newStream();
+  follower->expectWait();
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*follower, request_headers_));
+  EXPECT_EQ(1U, store_.counter("test.response_cache.coalesced").value());
+
+  // A follower that goes away before the leader is done is skipped.
+  StreamPtr reset_follower = newStream();
+  reset_follower->expectWait();
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*reset_follower, request_headers_));
+  reset_follower->filter_->onDestroy();
+
+  advance(2);
+  sendResponse(*leader, {{":status", "200"}, {"cache-control", "max-age=60"}});
+
+  expectServed(*follower, "0");
+  follower->runPosted();
+  EXPECT_CALL(reset_follower->decoder_callbacks_, encodeHeaders_(_, _)).Times(0);
+  reset_follower->runPosted();
+}
+
+TEST_F(ResponseCacheFilterTest, CoalescedMissNotCacheable) {
+  StreamPtr leader = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*leader, request_headers_));
+  StreamPtr follower = newStream();
+  follower->expectWait();
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*follower, request_headers_));
+
+  // The leader's response can't be cached, so the follower goes upstream itself.
+  sendResponse(*leader, {{":status", "200"}});
+  EXPECT_CALL(follower->decoder_callbacks_, continueDecoding());
+  follower->runPosted();
+
+  // Until the hit for pass TTL is up, requests for the key go upstream without waiting on each
+  // other, and their responses are not cached.
+  advance(9);
+  StreamPtr first = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*first, request_headers_));
+  StreamPtr second = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*second, request_headers_));
+  sendResponse(*first, {{":status", "200"}, {"cache-control", "max-age=60"}});
+  second->filter_->onDestroy();
+  EXPECT_EQ(2U, store_.counter("test.response_cache.pass").value());
+  EXPECT_EQ(1U, store_.counter("test.response_cache.coalesced").value());
+  EXPECT_EQ(0U, store_.counter("test.response_cache.insert").value());
+
+  // Then the next request is a leader again.
+  advance(1);
+  fill({{":status", "200"}, {"cache-control", "max-age=60"}});
+  EXPECT_EQ(2U, store_.counter("test.response_cache.miss").value());
+  EXPECT_EQ(1U, store_.counter("test.response_cache.insert").value());
+}
+
+TEST_F(ResponseCacheFilterTest, CoalescedMissLeaderReset) {
+  StreamPtr leader = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*leader, request_headers_));
+  StreamPtr follower = newStream();
+  follower->expectWait();
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*follower, request_headers_));
+
+  // The leader goes away without a response, so the follower goes upstream itself.
+  leader->filter_->onDestroy();
+  EXPECT_CALL(follower->decoder_callbacks_, continueDecoding());
+  follower->runPosted();
+
+  // That says nothing about whether the key can be cached, so the next request is a new leader.
+  StreamPtr stream = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*stream, request_headers_));
+  EXPECT_EQ(2U, store_.counter("test.response_cache.miss").value());
+  EXPECT_EQ(0U, store_.counter("test.response_cache.pass").value());
+  stream->filter_->onDestroy();
+}
+
+TEST_F(ResponseCacheFilterTest, CoalesceTimeout) {
+  StreamPtr leader = newStream();
+  EXPECT_EQ(FilterHeadersStatus::Continue, sendRequest(*leader, request_headers_));
+  StreamPtr follower = newStream();
+  follower->expectWait();
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, sendRequest(*follower, request_headers_));
+
+  // The follower gives up on a slow leader and goes upstream itself.
+  EXPECT_CALL(follower->decoder_callbacks_, continueDecoding());
+  follower->wait_timer_->callback_();
+  EXPECT_EQ(1U, store_.counter("test.response_cache.coalesce_timeout").value());
+
+  // The leader's response is cached when it comes, but the follower is not answered twice.
+  sendResponse(*leader, {{":status", "200"}, {"cache-control", "max-age=60"}});
+  EXPECT_CALL(follower->decoder_callbacks_, encodeHeaders_(_, _)).Times(0);
+  EXPECT_CALL(follower->decoder_callbacks_, continueDecoding()).Times(0);
+  follower->runPosted();
+  EXPECT_EQ(1U, store_.counter("test.response_cache.insert").value());
+  follower->filter_->onDestroy();
+}
+
+TEST_F(ResponseCacheFilterTest, Admin) {
+  NiceMock<Server::MockAdmin> admin;
+  Server::Admin::HandlerCb handler;
+  EXPECT_CALL(admin, addHandler("/cache", _, _, true)).WillOnce(SaveArg<2>(&handler));
+  ResponseCacheAdmin cache_admin(admin);
+  cache_admin.addCache("test.", config_->cache());
+
+  now_ = ProdSystemTimeSource::instance_.currentTime();
+  fill({{":status", "200"}, {"cache-control", "max-age=60"}});
+
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(Code::OK, handler("/cache", response));
+  EXPECT_NE(std::string::npos, TestUtility::bufferToString(response).find("test.: 1 entries"));
+  EXPECT_NE(std::string::npos, TestUtility::bufferToString(response).find("  host/a: "));
+
+  response.drain(response.length());
+  EXPECT_EQ(Code::OK, handler("/cache?purge=host/b", response));
+  EXPECT_EQ(1U, store_.gauge("test.response_cache.entries").value());
+  EXPECT_EQ(Code::OK, handler("/cache?purge=host/a", response));
+  EXPECT_EQ(0U, store_.gauge("test.response_cache.entries").value());
+
+  fill({{":status", "200"}, {"cache-control", "max-age=60"}});
+  EXPECT_EQ(Code::OK, handler("/cache?purge", response));
+  EXPECT_EQ(0U, store_.gauge("test.response_cache.entries").value());
+
+  EXPECT_CALL(admin, removeHandler("/cache"));
+}
+
+} // namespace Http
+} // namespace Envoy
@@ -1,10 +1,12 @@
 #include <string>
+#include <vector>
 
 #include "common/http/header_map_impl.h"
 
 #include "test/test_common/printers.h"
 #include "test/test_common/utility.h"
 
+#include "fmt/format.h"
 #include "gtest/gtest.h"
 
 namespace Envoy {
@@ -280,6 +282,30 @@ TEST(HeaderMapImplTest, MoveIntoInline) {
   EXPECT_STREQ("hello", headers.Host()->value().c_str());
 }
 
+TEST(HeaderMapImplTest, InlineLookup) {
+#define CHECK_INLINE_LOOKUP(name)                                                                  \
+  {                                                                                                \
+    const std::string& key = Headers::get().name.get();                                            \
+    HeaderMapImpl headers;                                                                         \
+    headers.addCopy(LowerCaseString(key + "x"), "suffix");                                         \
+    headers.addCopy(LowerCaseString(key.substr(0, key.size() - 1)), "prefix");                     \
+    EXPECT_EQ(nullptr, headers.name());                                                            \
+    headers.addCopy(LowerCaseString(key), "value");                                                \
+    ASSERT_NE(nullptr, headers.name());                                                            \
+    EXPECT_STREQ("value", headers.name()->value().c_str());                                        \
+    EXPECT_EQ(3UL, headers.size());                                                                \
+  }
+
+  ALL_INLINE_HEADERS(CHECK_INLINE_LOOKUP)
+#undef CHECK_INLINE_LOOKUP
+
+  HeaderMapImpl headers;
+  headers.addCopy(Headers::get().HostLegacy, "host");
+  EXPECT_STREQ("host", headers.Host()->value().c_str());
+  headers.addCopy(LowerCaseString(""), "empty");
+  EXPECT_EQ(2UL, headers.size());
+}
+
 TEST(HeaderMapImplTest, Remove) {
   HeaderMapImpl headers;
 
@@ -402,5 +428,76 @@ TEST(HeaderMapImplTest, LargeCharInHeader) {
   EXPECT_STREQ("value", headers.get(static_key)->value().c_str());
 }
 
+TEST(HeaderMapImplTest, ManyHeaders) {
+  HeaderMapImpl headers;
+  headers.insertHost().value(std::string("host"));
+  const HeaderEntry* host = headers.Host();
+  std::vector<LowerCaseString> keys;
+  for (int i = 0; i < 100; i++) {
+    keys.emplace_back(fmt::format("key-{}", i));
+    headers.addCopy(keys.back(), i);
+  }
+  EXPECT_EQ(101UL, headers.size());
+
+  // Entries do not move as the map grows.
+  EXPECT_EQ(host, headers.Host());
+  EXPECT_STREQ("host", headers.Host()->value().c_str());
+  const HeaderEntry* last = headers.get(keys[99]);
+  EXPECT_STREQ("99", last->value().c_str());
+
+  // Removing entries keeps the order of the rest, and their slots are reused.
+  for (int i = 0; i < 100; i += 2) {
+    headers.remove(keys[i]);
+  }
+  headers.removeHost();
+  EXPECT_EQ(50UL, headers.size());
+  headers.addCopy(LowerCaseString("new"), "value");
+  headers.insertHost().value(std::string("new_host"));
+  EXPECT_EQ(last, headers.get(keys[99]));
+
+  std::vector<std::string> header_keys;
+  headers.iterate(
+      [](const HeaderEntry& header, void* context) -> void {
+        static_cast<std::vector<std::string>*>(context)->push_back(header.key().c_str());
+      },
+      &header_keys);
+  ASSERT_EQ(52UL, header_keys.size());
+  EXPECT_EQ("key-1", header_keys[0]);
+  EXPECT_EQ("key-99", header_keys[49]);
+  EXPECT_EQ("new", header_keys[50]);
+  EXPECT_EQ(":authority", header_keys[51]);
+}
+
+TEST(HeaderMapImplTest, Copy) {
+  TestHeaderMapImpl headers{{":authority", "host"}, {"hello", "world"}, {"foo", "bar"}};
+  HeaderMapImpl copy(static_cast<const HeaderMap&>(headers));
+  EXPECT_EQ(headers, copy);
+  EXPECT_STREQ("host", copy.Host()->value().c_str());
+  EXPECT_NE(headers.Host(), copy.Host());
+}
+
+TEST(HeaderMapImplTest, Move) {
+  HeaderMapImpl headers{{Headers::get().Host, "host"}, {LowerCaseString("hello"), "world"}};
+  const HeaderEntry* host = headers.Host();
+
+  // Entries move with the map, along with the inline headers.
+  HeaderMapImpl moved(std::move(headers));
+  EXPECT_EQ(2UL, moved.size());
+  EXPECT_EQ(host, moved.Host());
+  EXPECT_STREQ("world", moved.get(LowerCaseString("hello"))->value().c_str());
+  EXPECT_EQ(0UL, headers.size());
+  EXPECT_EQ(nullptr, headers.Host());
+
+  // The moved from map can be used again.
+  headers.insertHost().value(std::string("other"));
+  EXPECT_STREQ("other", headers.Host()->value().c_str());
+
+  headers = std::move(moved);
+  EXPECT_EQ(2UL, headers.size());
+  EXPECT_EQ(host, headers.Host());
+  EXPECT_EQ(0UL, moved.size());
+  EXPECT_EQ(nullptr, moved.Host());
+}
+
 } // namespace Http
 } // namespace Envoy
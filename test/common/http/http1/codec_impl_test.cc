@@ -27,9 +27,10 @@ namespace Envoy {
 namespace Http {
 namespace Http1 {
 
-class Http1ServerConnectionImplTest : public ::testing::Test {
+class Http1ServerConnectionImplTest : public ::testing::TestWithParam<bool> {
 public:
   void initialize() {
+    codec_settings_.fast_parser_ = GetParam();
     codec_.reset(new ServerConnectionImpl(connection_, callbacks_, codec_settings_));
   }
 
@@ -83,7 +84,10 @@ void Http1ServerConnectionImplTest::expectHeadersTest(Protocol p, bool allow_abs
   EXPECT_EQ(p, codec_->protocol());
 }
 
-TEST_F(Http1ServerConnectionImplTest, EmptyHeader) {
+// Run each test with both http_parser and FastParser.
+INSTANTIATE_TEST_CASE_P(Parsers, Http1ServerConnectionImplTest, testing::Bool());
+
+TEST_P(Http1ServerConnectionImplTest, EmptyHeader) {
   initialize();
 
   InSequence sequence;
@@ -104,7 +108,7 @@ TEST_F(Http1ServerConnectionImplTest, EmptyHeader) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http10) {
+TEST_P(Http1ServerConnectionImplTest, Http10) {
   initialize();
 
   InSequence sequence;
@@ -121,7 +125,7 @@ TEST_F(Http1ServerConnectionImplTest, Http10) {
   EXPECT_EQ(Protocol::Http10, codec_->protocol());
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http10AbsoluteNoOp) {
+TEST_P(Http1ServerConnectionImplTest, Http10AbsoluteNoOp) {
   initialize();
 
   TestHeaderMapImpl expected_headers{{":path", "/"}, {":method", "GET"}};
@@ -129,7 +133,7 @@ TEST_F(Http1ServerConnectionImplTest, Http10AbsoluteNoOp) {
   expectHeadersTest(Protocol::Http10, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http10Absolute) {
+TEST_P(Http1ServerConnectionImplTest, Http10Absolute) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -138,7 +142,7 @@ TEST_F(Http1ServerConnectionImplTest, Http10Absolute) {
   expectHeadersTest(Protocol::Http10, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePath1) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePath1) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -147,7 +151,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePath1) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePath2) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePath2) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -156,7 +160,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePath2) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathWithPort) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePathWithPort) {
   TestHeaderMapImpl expected_headers{
       {":authority", "www.somewhere.com:4532"}, {":path", "/foo/bar"}, {":method", "GET"}};
   Buffer::OwnedImpl buffer(
@@ -164,7 +168,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathWithPort) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsoluteEnabledNoOp) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsoluteEnabledNoOp) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -173,7 +177,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsoluteEnabledNoOp) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11InvalidRequest) {
+TEST_P(Http1ServerConnectionImplTest, Http11InvalidRequest) {
   initialize();
 
   // Invalid because www.somewhere.com is not an absolute path nor an absolute url
@@ -181,7 +185,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11InvalidRequest) {
   expect400(Protocol::Http11, true, buffer);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathNoSlash) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePathNoSlash) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -190,21 +194,21 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathNoSlash) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathBad) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePathBad) {
   initialize();
 
   Buffer::OwnedImpl buffer("GET * HTTP/1.1\r\nHost: bah\r\n\r\n");
   expect400(Protocol::Http11, true, buffer);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePortTooLarge) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePortTooLarge) {
   initialize();
 
   Buffer::OwnedImpl buffer("GET http://foobar.com:1000000 HTTP/1.1\r\nHost: bah\r\n\r\n");
   expect400(Protocol::Http11, true, buffer);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11RelativeOnly) {
+TEST_P(Http1ServerConnectionImplTest, Http11RelativeOnly) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -213,7 +217,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11RelativeOnly) {
   expectHeadersTest(Protocol::Http11, false, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11Options) {
+TEST_P(Http1ServerConnectionImplTest, Http11Options) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -222,7 +226,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11Options) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, SimpleGet) {
+TEST_P(Http1ServerConnectionImplTest, SimpleGet) {
   initialize();
 
   InSequence sequence;
@@ -238,7 +242,7 @@ TEST_F(Http1ServerConnectionImplTest, SimpleGet) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, BadRequestNoStream) {
+TEST_P(Http1ServerConnectionImplTest, BadRequestNoStream) {
   initialize();
 
   std::string output;
@@ -249,7 +253,7 @@ TEST_F(Http1ServerConnectionImplTest, BadRequestNoStream) {
   EXPECT_EQ("HTTP/1.1 400 Bad Request\r\ncontent-length: 0\r\nconnection: close\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, BadRequestStartedStream) {
+TEST_P(Http1ServerConnectionImplTest, BadRequestStartedStream) {
   initialize();
 
   std::string output;
@@ -266,7 +270,7 @@ TEST_F(Http1ServerConnectionImplTest, BadRequestStartedStream) {
   EXPECT_EQ("HTTP/1.1 400 Bad Request\r\ncontent-length: 0\r\nconnection: close\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, HostHeaderTranslation) {
+TEST_P(Http1ServerConnectionImplTest, HostHeaderTranslation) {
   initialize();
 
   InSequence sequence;
@@ -282,7 +286,7 @@ TEST_F(Http1ServerConnectionImplTest, HostHeaderTranslation) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, CloseDuringHeadersComplete) {
+TEST_P(Http1ServerConnectionImplTest, CloseDuringHeadersComplete) {
   initialize();
 
   InSequence sequence;
@@ -302,7 +306,7 @@ TEST_F(Http1ServerConnectionImplTest, CloseDuringHeadersComplete) {
   EXPECT_NE(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, PostWithContentLength) {
+TEST_P(Http1ServerConnectionImplTest, PostWithContentLength) {
   initialize();
 
   InSequence sequence;
@@ -324,7 +328,7 @@ TEST_F(Http1ServerConnectionImplTest, PostWithContentLength) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, HeaderOnlyResponse) {
+TEST_P(Http1ServerConnectionImplTest, HeaderOnlyResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -347,7 +351,7 @@ TEST_F(Http1ServerConnectionImplTest, HeaderOnlyResponse) {
   EXPECT_EQ("HTTP/1.1 200 OK\r\ncontent-length: 0\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, ChunkedResponse) {
+TEST_P(Http1ServerConnectionImplTest, ChunkedResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -374,7 +378,7 @@ TEST_F(Http1ServerConnectionImplTest, ChunkedResponse) {
             output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, ContentLengthResponse) {
+TEST_P(Http1ServerConnectionImplTest, ContentLengthResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -400,7 +404,61 @@ TEST_F(Http1ServerConnectionImplTest, ContentLengthResponse) {
   EXPECT_EQ("HTTP/1.1 200 OK\r\ncontent-length: 11\r\n\r\nHello World", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, HeadRequestResponse) {
+TEST_P(Http1ServerConnectionImplTest, UncachedStatusResponse) {
+  initialize();
+
+  NiceMock<Http::MockStreamDecoder> decoder;
+  Http::StreamEncoder* response_encoder = nullptr;
+  EXPECT_CALL(callbacks_, newStream(_))
+      .WillOnce(Invoke([&](Http::StreamEncoder& encoder) -> Http::StreamDecoder& {
+        response_encoder = &encoder;
+        return decoder;
+      }));
+
+  Buffer::OwnedImpl buffer("GET / HTTP/1.1\r\n\r\n");
+  codec_->dispatch(buffer);
+  EXPECT_EQ(0U, buffer.length());
+
+  std::string output;
+  ON_CALL(connection_, write(_)).WillByDefault(AddBufferToString(&output));
+
+  TestHeaderMapImpl headers{{":status", "999"}};
+  response_encoder->encodeHeaders(headers, true);
+  EXPECT_EQ("HTTP/1.1 999 Unknown\r\ncontent-length: 0\r\n\r\n", output);
+}
+
+TEST_P(Http1ServerConnectionImplTest, LargeChunkedResponse) {
+  initialize();
+
+  NiceMock<Http::MockStreamDecoder> decoder;
+  Http::StreamEncoder* response_encoder = nullptr;
+  EXPECT_CALL(callbacks_, newStream(_))
+      .WillOnce(Invoke([&](Http::StreamEncoder& encoder) -> Http::StreamDecoder& {
+        response_encoder = &encoder;
+        return decoder;
+      }));
+
+  Buffer::OwnedImpl buffer("GET / HTTP/1.1\r\n\r\n");
+  codec_->dispatch(buffer);
+  EXPECT_EQ(0U, buffer.length());
+
+  std::string output;
+  ON_CALL(connection_, write(_)).WillByDefault(AddBufferToString(&output));
+
+  // The header block is larger than the default 4096 byte reservation.
+  const std::string long_value(5000, 'a');
+  TestHeaderMapImpl headers{{":status", "200"}, {"foo", long_value}, {"bar", "baz"}};
+  response_encoder->encodeHeaders(headers, false);
+
+  Buffer::OwnedImpl data(std::string(4096, 'b'));
+  response_encoder->encodeData(data, true);
+  EXPECT_EQ("HTTP/1.1 200 OK\r\nfoo: " + long_value +
+                "\r\nbar: baz\r\ntransfer-encoding: chunked\r\n\r\n1000\r\n" +
+                std::string(4096, 'b') + "\r\n0\r\n\r\n",
+            output);
+}
+
+TEST_P(Http1ServerConnectionImplTest, HeadRequestResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -423,7 +481,7 @@ TEST_F(Http1ServerConnectionImplTest, HeadRequestResponse) {
   EXPECT_EQ("HTTP/1.1 200 OK\r\ncontent-length: 5\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, ExpectContinueResponse) {
+TEST_P(Http1ServerConnectionImplTest, ExpectContinueResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -448,7 +506,7 @@ TEST_F(Http1ServerConnectionImplTest, ExpectContinueResponse) {
   EXPECT_EQ("HTTP/1.1 100 Continue\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, DoubleRequest) {
+TEST_P(Http1ServerConnectionImplTest, DoubleRequest) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -473,7 +531,7 @@ TEST_F(Http1ServerConnectionImplTest, DoubleRequest) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, RequestWithTrailers) {
+TEST_P(Http1ServerConnectionImplTest, RequestWithTrailers) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -490,7 +548,7 @@ TEST_F(Http1ServerConnectionImplTest, RequestWithTrailers) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, WatermarkTest) {
+TEST_P(Http1ServerConnectionImplTest, WatermarkTest) {
   EXPECT_CALL(connection_, bufferLimit()).Times(1).WillOnce(Return(10));
   initialize();
 
@@ -588,13 +646,17 @@ TEST_F(Http1ClientConnectionImplTest, MultipleHeaderOnlyThenNoContentLength) {
   EXPECT_EQ("GET / HTTP/1.1\r\nhost: host\r\ncontent-length: 0\r\n\r\n", output);
   output.clear();
 
-  // Simulate the underlying connection being backed up.  Ensure that it is
-  // read-enabled as the new stream is created.
-  EXPECT_CALL(connection_, readEnabled())
-      .Times(2)
-      .WillOnce(Return(false))
-      .WillRepeatedly(Return(true));
-  EXPECT_CALL(connection_, readDisable(false));
+  // Simulate the stream being backed up. Ensure that the connection is read-enabled once the
+  // response is complete, and that the stream does not touch it afterwards.
+  EXPECT_CALL(connection_, readDisable(true)).Times(2);
+  request_encoder->getStream().readDisable(true);
+  request_encoder->getStream().readDisable(true);
+  EXPECT_CALL(response_decoder, decodeHeaders_(_, true));
+  EXPECT_CALL(connection_, readDisable(false)).Times(2);
+  Buffer::OwnedImpl response("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+  codec_->dispatch(response);
+  request_encoder->getStream().readDisable(false);
+
   request_encoder = &codec_->newStream(response_decoder);
   request_encoder->encodeHeaders(headers, false);
 
@@ -604,6 +666,128 @@ TEST_F(Http1ClientConnectionImplTest, MultipleHeaderOnlyThenNoContentLength) {
   EXPECT_EQ("GET / HTTP/1.1\r\nhost: host\r\ntransfer-encoding: chunked\r\n\r\n0\r\n\r\n", output);
 }
 
+TEST_F(Http1ClientConnectionImplTest, PipelinedRequests) {
+  initialize();
+
+  std::string output;
+  ON_CALL(connection_, write(_)).WillByDefault(AddBufferToString(&output));
+
+  Http::MockStreamDecoder response_decoder1;
+  Http::StreamEncoder& request_encoder1 = codec_->newStream(response_decoder1);
+  Http::MockStreamDecoder response_decoder2;
+  Http::StreamEncoder& request_encoder2 = codec_->newStream(response_decoder2);
+
+  TestHeaderMapImpl headers1{{":method", "HEAD"}, {":path", "/1"}, {":authority", "host"}};
+  request_encoder1.encodeHeaders(headers1, true);
+  TestHeaderMapImpl headers2{{":method", "GET"}, {":path", "/2"}, {":authority", "host"}};
+  request_encoder2.encodeHeaders(headers2, true);
+  EXPECT_EQ("HEAD /1 HTTP/1.1\r\nhost: host\r\ncontent-length: 0\r\n\r\n"
+            "GET /2 HTTP/1.1\r\nhost: host\r\ncontent-length: 0\r\n\r\n",
+            output);
+
+  // Responses are matched to requests in order, including the HEAD response without a body.
+  InSequence s;
+  EXPECT_CALL(response_decoder1, decodeHeaders_(_, true));
+  EXPECT_CALL(response_decoder2, decodeHeaders_(_, false));
+  EXPECT_CALL(response_decoder2, decodeData(BufferStringEqual("hello"), false));
+  EXPECT_CALL(response_decoder2, decodeData(_, true));
+  Buffer::OwnedImpl response("HTTP/1.1 200 OK\r\nContent-Length: 20\r\n\r\n"
+                             "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello");
+  codec_->dispatch(response);
+}
+
+TEST_F(Http1ClientConnectionImplTest, PipelinedRequestsReset) {
+  initialize();
+
+  NiceMock<Http::MockStreamDecoder> response_decoder;
+  Http::StreamEncoder& request_encoder1 = codec_->newStream(response_decoder);
+  Http::StreamEncoder& request_encoder2 = codec_->newStream(response_decoder);
+  Http::StreamEncoder& request_encoder3 = codec_->newStream(response_decoder);
+  TestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  request_encoder1.encodeHeaders(headers, true);
+  request_encoder2.encodeHeaders(headers, true);
+  request_encoder3.encodeHeaders(headers, true);
+  Http::MockStreamCallbacks callbacks1;
+  request_encoder1.getStream().addCallbacks(callbacks1);
+  Http::MockStreamCallbacks callbacks2;
+  request_encoder2.getStream().addCallbacks(callbacks2);
+  Http::MockStreamCallbacks callbacks3;
+  request_encoder3.getStream().addCallbacks(callbacks3);
+
+  // Idempotent requests behind the first one are reset as connection failures.
+  // Resetting a request that is waiting for its reset callbacks from within another request's
+  // callbacks runs them once, right away.
+  InSequence s;
+  EXPECT_CALL(callbacks1, onResetStream(StreamResetReason::ConnectionTermination))
+      .WillOnce(Invoke([&](StreamResetReason) -> void {
+        request_encoder3.getStream().resetStream(StreamResetReason::ConnectionTermination);
+      }));
+  EXPECT_CALL(callbacks3, onResetStream(StreamResetReason::ConnectionFailure));
+  EXPECT_CALL(callbacks2, onResetStream(StreamResetReason::ConnectionFailure));
+  request_encoder1.getStream().resetStream(StreamResetReason::ConnectionTermination);
+}
+
+TEST_F(Http1ClientConnectionImplTest, PipelinedNonIdempotentRequestReset) {
+  initialize();
+
+  NiceMock<Http::MockStreamDecoder> response_decoder;
+  Http::StreamEncoder& request_encoder1 = codec_->newStream(response_decoder);
+  Http::StreamEncoder& request_encoder2 = codec_->newStream(response_decoder);
+  Http::StreamEncoder& request_encoder3 = codec_->newStream(response_decoder);
+  TestHeaderMapImpl get_headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  TestHeaderMapImpl post_headers{{":method", "POST"}, {":path", "/"}, {":authority", "host"}};
+  request_encoder1.encodeHeaders(get_headers, true);
+  request_encoder2.encodeHeaders(post_headers, true);
+  request_encoder3.encodeHeaders(get_headers, true);
+  Http::MockStreamCallbacks callbacks1;
+  request_encoder1.getStream().addCallbacks(callbacks1);
+  Http::MockStreamCallbacks callbacks2;
+  request_encoder2.getStream().addCallbacks(callbacks2);
+  Http::MockStreamCallbacks callbacks3;
+  request_encoder3.getStream().addCallbacks(callbacks3);
+
+  // The POST pipelined behind the first request may have been processed by the upstream, so it
+  // gets a reason that is never retried.
+  InSequence s;
+  EXPECT_CALL(callbacks1, onResetStream(StreamResetReason::ConnectionTermination));
+  EXPECT_CALL(callbacks2, onResetStream(StreamResetReason::PipelinedConnectionTermination));
+  EXPECT_CALL(callbacks3, onResetStream(StreamResetReason::ConnectionFailure));
+  request_encoder1.getStream().resetStream(StreamResetReason::ConnectionTermination);
+}
+
+TEST_F(Http1ClientConnectionImplTest, PipelinedRequestsReadDisable) {
+  initialize();
+
+  NiceMock<Http::MockStreamDecoder> response_decoder;
+  Http::StreamEncoder& request_encoder1 = codec_->newStream(response_decoder);
+  Http::StreamEncoder& request_encoder2 = codec_->newStream(response_decoder);
+  Http::StreamEncoder& request_encoder3 = codec_->newStream(response_decoder);
+  TestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  request_encoder1.encodeHeaders(headers, true);
+  request_encoder2.encodeHeaders(headers, true);
+  request_encoder3.encodeHeaders(headers, true);
+
+  EXPECT_CALL(connection_, readDisable(true)).Times(3);
+  request_encoder1.getStream().readDisable(true);
+  request_encoder2.getStream().readDisable(true);
+  request_encoder2.getStream().readDisable(true);
+
+  // A response that completes while its stream is read disabled unwinds only that stream's calls,
+  // even though the connection stays in use by the pipelined requests.
+  EXPECT_CALL(connection_, readDisable(false));
+  Buffer::OwnedImpl response1("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+  codec_->dispatch(response1);
+  testing::Mock::VerifyAndClearExpectations(&connection_);
+
+  // The calls of requests that are reset are unwound too.
+  EXPECT_CALL(connection_, readDisable(false)).Times(2);
+  request_encoder2.getStream().resetStream(StreamResetReason::LocalReset);
+  testing::Mock::VerifyAndClearExpectations(&connection_);
+
+  EXPECT_CALL(connection_, readDisable(_)).Times(0);
+  request_encoder2.getStream().readDisable(false);
+}
+
 TEST_F(Http1ClientConnectionImplTest, PrematureResponse) {
   initialize();
 
@@ -729,7 +913,7 @@ TEST_F(Http1ClientConnectionImplTest, WatermarkTest) {
 }
 
 // For issue #1421 regression test that Envoy's HTTP parser applies header limits early.
-TEST_F(Http1ServerConnectionImplTest, TestCodecHeaderLimits) {
+TEST_P(Http1ServerConnectionImplTest, TestCodecHeaderLimits) {
   initialize();
 
   std::string exception_reason;
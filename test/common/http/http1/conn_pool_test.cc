@@ -40,9 +40,13 @@ namespace Http1 {
 class ConnPoolImplForTest : public ConnPoolImpl {
 public:
   ConnPoolImplForTest(Event::MockDispatcher& dispatcher,
-                      Upstream::ClusterInfoConstSharedPtr cluster)
+                      Upstream::ClusterInfoConstSharedPtr cluster,
+                      uint64_t max_pipelined_requests = 1,
+                      const ConnectionPool::PreconnectPolicy& preconnect_policy =
+                          ConnectionPool::PreconnectPolicy())
       : ConnPoolImpl(dispatcher, Upstream::makeTestHost(cluster, "tcp://127.0.0.1:9000"),
-                     Upstream::ResourcePriority::Default),
+                     Upstream::ResourcePriority::Default, max_pipelined_requests,
+                     preconnect_policy),
         mock_dispatcher_(dispatcher) {}
 
   ~ConnPoolImplForTest() {
@@ -104,7 +108,10 @@ public:
  */
 class Http1ConnPoolImplTest : public testing::Test {
 public:
-  Http1ConnPoolImplTest() : conn_pool_(dispatcher_, cluster_) {}
+  Http1ConnPoolImplTest(uint64_t max_pipelined_requests = 1,
+                        const ConnectionPool::PreconnectPolicy& preconnect_policy =
+                            ConnectionPool::PreconnectPolicy())
+      : conn_pool_(dispatcher_, cluster_, max_pipelined_requests, preconnect_policy) {}
 
   ~Http1ConnPoolImplTest() {
     // Make sure all gauges are 0.
@@ -119,6 +126,28 @@ public:
   NiceMock<Runtime::MockLoader> runtime_;
 };
 
+/**
+ * Test fixture for a connection pool that pipelines up to two requests per connection.
+ */
+class Http1ConnPoolImplPipelineTest : public Http1ConnPoolImplTest {
+public:
+  Http1ConnPoolImplPipelineTest() : Http1ConnPoolImplTest(2) {}
+};
+
+/**
+ * Test fixture for a connection pool that keeps an idle connection open ahead of demand.
+ */
+class Http1ConnPoolImplPreconnectTest : public Http1ConnPoolImplTest {
+public:
+  Http1ConnPoolImplPreconnectTest() : Http1ConnPoolImplTest(1, preconnectPolicy()) {}
+
+  static ConnectionPool::PreconnectPolicy preconnectPolicy() {
+    ConnectionPool::PreconnectPolicy policy;
+    policy.min_idle_connections_ = 1;
+    return policy;
+  }
+};
+
 /**
  * Helper for dealing with an active test request.
  */
@@ -172,6 +201,10 @@ struct ActiveTestRequest {
 
   void startRequest() { callbacks_.outer_encoder_->encodeHeaders(TestHeaderMapImpl{}, true); }
 
+  void startRequest(const std::string& method) {
+    callbacks_.outer_encoder_->encodeHeaders(TestHeaderMapImpl{{":method", method}}, true);
+  }
+
   Http1ConnPoolImplTest& parent_;
   size_t client_index_;
   NiceMock<Http::MockStreamDecoder> outer_decoder_;
@@ -599,6 +632,112 @@ TEST_F(Http1ConnPoolImplTest, RemoteCloseToCompleteResponse) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that requests are pipelined behind complete idempotent requests, up to the limit.
+ */
+TEST_F(Http1ConnPoolImplPipelineTest, PipelineIdempotentRequests) {
+  InSequence s;
+
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1024, 1024, 1));
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest("GET");
+
+  // Request 2 is sent on the busy connection.
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Immediate);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pipelined_.value());
+
+  // Request 3 waits since two requests are in flight.
+  ActiveTestRequest r3(*this, 0, ActiveTestRequest::Type::Pending);
+  r2.startRequest("HEAD");
+
+  // Finish r1, which pipelines r3 behind r2.
+  r3.expectNewStream();
+  r1.completeResponse(false);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_rq_pipelined_.value());
+  r3.startRequest("GET");
+
+  r2.completeResponse(false);
+  r3.completeResponse(false);
+
+  // The connection is idle and is reused without pipelining.
+  ActiveTestRequest r4(*this, 0, ActiveTestRequest::Type::Immediate);
+  r4.startRequest("POST");
+  r4.completeResponse(false);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_rq_pipelined_.value());
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that requests are not pipelined behind incomplete or non idempotent requests.
+ */
+TEST_F(Http1ConnPoolImplPipelineTest, NoPipelineBehindUnsafeRequests) {
+  InSequence s;
+
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1024, 1024, 1));
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Pending);
+  r1.startRequest("POST");
+
+  r2.expectNewStream();
+  r1.completeResponse(false);
+  r2.startRequest("GET");
+  r2.completeResponse(false);
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_pipelined_.value());
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that an idle connection is kept open ahead of demand and that preconnect stats are tracked.
+ */
+TEST_F(Http1ConnPoolImplPreconnectTest, MinIdleConnections) {
+  // Warming up the pool opens a connection before any request.
+  conn_pool_.expectClientCreate();
+  conn_pool_.preconnect();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_.value());
+
+  // A request that arrives while the connection is still being made waits for it, and another
+  // connection is preconnected to stay ahead of demand.
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::Pending);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_preconnect_.value());
+
+  r1.expectNewStream();
+  EXPECT_CALL(*conn_pool_.test_clients_[0].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_used_.value());
+  EXPECT_CALL(*conn_pool_.test_clients_[1].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // A second request uses the idle connection without waiting, and a third connection is made.
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::Immediate);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_preconnect_used_.value());
+  EXPECT_EQ(3U, cluster_->stats_.upstream_cx_preconnect_.value());
+
+  r1.startRequest();
+  r1.completeResponse(false);
+  r2.startRequest();
+  r2.completeResponse(false);
+
+  // The third connection never carried a request.
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(3);
+  conn_pool_.test_clients_[2].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_wasted_.value());
+}
+
 } // namespace Http1
 } // namespace Http
 } // namespace Envoy
@@ -0,0 +1,365 @@
+#include <climits>
+#include <memory>
+#include <string>
+
+#include "common/http/http1/fast_parser.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Records parser callbacks as a string, joining consecutive data callbacks of the same type so
+ * that the result does not depend on how the input was split.
+ */
+class FastParserTest : public testing::Test {
+public:
+  void init(http_parser_type type) {
+    type_ = type;
+    parser_.reset(new FastParser(type));
+    http_parser_init(&http_parser_, type);
+    http_parser_.data = this;
+    log_.clear();
+    last_event_.clear();
+  }
+
+  // Parse input in one call, then in every split into two calls, then a byte at a time, and
+  // check that each way parses all of the input with the same callbacks.
+  std::string parse(http_parser_type type, const std::string& input) {
+    init(type);
+    EXPECT_EQ(input.size(), execute(input));
+    EXPECT_EQ(HPE_OK, HTTP_PARSER_ERRNO(&http_parser_));
+    const std::string expected = log_;
+
+    for (size_t split = 1; split < input.size(); split++) {
+      init(type);
+      size_t parsed = execute(input.substr(0, split));
+      parsed += execute(input.substr(split));
+      EXPECT_EQ(input.size(), parsed) << "split at " << split;
+      EXPECT_EQ(expected, log_) << "split at " << split;
+    }
+
+    init(type);
+    for (char c : input) {
+      execute(std::string(1, c));
+    }
+    EXPECT_EQ(expected, log_);
+    return expected;
+  }
+
+  http_errno parseError(http_parser_type type, const std::string& input) {
+    init(type);
+    execute(input);
+    return HTTP_PARSER_ERRNO(&http_parser_);
+  }
+
+  size_t execute(const std::string& data) {
+    return parser_->execute(http_parser_, settings_, data.data(), data.size());
+  }
+
+  void onEvent(const std::string& event) {
+    log_ += event + "|";
+    last_event_.clear();
+  }
+
+  void onData(const std::string& event, const char* data, size_t length) {
+    if (event != last_event_) {
+      log_ += event + ":";
+    } else {
+      log_.pop_back();
+    }
+    log_.append(data, length);
+    log_ += "|";
+    last_event_ = event;
+  }
+
+  static FastParserTest& test(http_parser* parser) {
+    return *static_cast<FastParserTest*>(parser->data);
+  }
+
+  http_parser_settings settings_{
+      [](http_parser* parser) -> int {
+        test(parser).onEvent("begin");
+        return 0;
+      },
+      [](http_parser* parser, const char* at, size_t length) -> int {
+        test(parser).onData("url", at, length);
+        return 0;
+      },
+      [](http_parser* parser, const char* at, size_t length) -> int {
+        test(parser).onData("status", at, length);
+        return 0;
+      },
+      [](http_parser* parser, const char* at, size_t length) -> int {
+        test(parser).onData("field", at, length);
+        return 0;
+      },
+      [](http_parser* parser, const char* at, size_t length) -> int {
+        test(parser).onData("value", at, length);
+        return 0;
+      },
+      [](http_parser* parser) -> int {
+        FastParserTest& self = test(parser);
+        self.onEvent(fmtHeadersComplete(*parser));
+        return self.headers_complete_rc_;
+      },
+      [](http_parser* parser, const char* at, size_t length) -> int {
+        test(parser).onData("body", at, length);
+        return 0;
+      },
+      [](http_parser* parser) -> int {
+        FastParserTest& self = test(parser);
+        self.onEvent("complete");
+        if (self.pause_on_complete_) {
+          http_parser_pause(parser, 1);
+        }
+        return 0;
+      },
+      nullptr, // on_chunk_header
+      nullptr  // on_chunk_complete
+  };
+
+  static std::string fmtHeadersComplete(const http_parser& parser) {
+    std::string event = "headers " + std::to_string(parser.http_major) + "." +
+                        std::to_string(parser.http_minor);
+    if (parser.type == HTTP_REQUEST) {
+      event += std::string(" ") + http_method_str(static_cast<http_method>(parser.method));
+    } else {
+      event += " " + std::to_string(parser.status_code);
+    }
+    if (parser.flags & F_CHUNKED) {
+      event += " chunked";
+    }
+    if (parser.content_length != ULLONG_MAX) {
+      event += " length=" + std::to_string(parser.content_length);
+    }
+    if (parser.upgrade) {
+      event += " upgrade";
+    }
+    return event;
+  }
+
+  http_parser_type type_;
+  std::unique_ptr<FastParser> parser_;
+  http_parser http_parser_;
+  std::string log_;
+  std::string last_event_;
+  int headers_complete_rc_{};
+  bool pause_on_complete_{};
+};
+
+TEST_F(FastParserTest, SimpleRequest) {
+  EXPECT_EQ("begin|url:/foo?bar=baz|field:Host|value:example.com|field:Accept|value:*/*|"
+            "headers 1.1 GET|complete|",
+            parse(HTTP_REQUEST,
+                  "GET /foo?bar=baz HTTP/1.1\r\nHost: example.com\r\nAccept:  */*\r\n\r\n"));
+}
+
+TEST_F(FastParserTest, EmptyValueAndBareLineFeeds) {
+  EXPECT_EQ("begin|url:/|field:Test|value:|field:Hello|value:World|headers 1.0 GET|complete|",
+            parse(HTTP_REQUEST, "\r\nGET / HTTP/1.0\nTest:\nHello: World\n\n"));
+}
+
+TEST_F(FastParserTest, ValueKeepsTrailingWhitespace) {
+  EXPECT_EQ("begin|url:/|field:a|value:b \t|headers 1.1 GET|complete|",
+            parse(HTTP_REQUEST, "GET / HTTP/1.1\r\na: b \t\r\n\r\n"));
+}
+
+TEST_F(FastParserTest, ObsFold) {
+  EXPECT_EQ("begin|url:/|field:a|value:b c|headers 1.1 GET|complete|",
+            parse(HTTP_REQUEST, "GET / HTTP/1.1\r\na: b\r\n \t c\r\n\r\n"));
+}
+
+TEST_F(FastParserTest, LongHeaders) {
+  const std::string value(1000, 'v');
+  EXPECT_EQ("begin|url:/" + value + "|field:x-long|value:" + value + "|headers 1.1 GET|complete|",
+            parse(HTTP_REQUEST, "GET /" + value + " HTTP/1.1\r\nx-long: " + value + "\r\n\r\n"));
+}
+
+TEST_F(FastParserTest, ContentLength) {
+  EXPECT_EQ("begin|url:/|field:Content-Length|value:5|headers 1.1 POST length=5|body:hello|"
+            "complete|begin|url:/|headers 1.1 GET|complete|",
+            parse(HTTP_REQUEST,
+                  "POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\nhelloGET / HTTP/1.1\r\n\r\n"));
+}
+
+TEST_F(FastParserTest, Chunked) {
+  EXPECT_EQ("begin|url:/|field:Transfer-Encoding|value:chunked|headers 1.1 POST chunked|"
+            "body:hello world|field:x-trailer|value:1|complete|",
+            parse(HTTP_REQUEST, "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                                "5;ext=1\r\nhello\r\n6\r\n world\r\n0\r\nx-trailer: 1\r\n\r\n"));
+}
+
+TEST_F(FastParserTest, ChunkedOverridesContentLength) {
+  EXPECT_EQ("begin|url:/|field:transfer-encoding|value:CHUNKED|field:content-length|value:3|"
+            "headers 1.1 POST chunked length=3|body:abc|complete|",
+            parse(HTTP_REQUEST, "POST / HTTP/1.1\r\ntransfer-encoding: CHUNKED\r\n"
+                                "content-length: 3\r\n\r\n3\r\nabc\r\n0\r\n\r\n"));
+}
+
+TEST_F(FastParserTest, ResponseUntilEof) {
+  init(HTTP_RESPONSE);
+  const std::string response = "HTTP/1.1 200 OK\r\nServer: test\r\n\r\nhello";
+  EXPECT_EQ(response.size(), execute(response));
+  EXPECT_EQ(0U, execute(""));
+  EXPECT_EQ(HPE_OK, HTTP_PARSER_ERRNO(&http_parser_));
+  EXPECT_EQ("begin|status:OK|field:Server|value:test|headers 1.1 200|body:hello|complete|", log_);
+
+  // No more messages are parsed after the connection is closed.
+  execute("HTTP/1.1 200 OK\r\n\r\n");
+  EXPECT_EQ(HPE_CLOSED_CONNECTION, HTTP_PARSER_ERRNO(&http_parser_));
+}
+
+TEST_F(FastParserTest, ResponsesWithoutBody) {
+  EXPECT_EQ("begin|status:No Content|headers 1.1 204|complete|"
+            "begin|status:|headers 1.1 304|complete|"
+            "begin|status:Continue|headers 1.1 100|complete|"
+            "begin|status:OK|field:content-length|value:0|headers 1.1 200 length=0|complete|",
+            parse(HTTP_RESPONSE, "HTTP/1.1 204 No Content\r\n\r\nHTTP/1.1 304\r\n\r\n"
+                                 "HTTP/1.1 100 Continue\r\n\r\n"
+                                 "HTTP/1.1 200 OK\r\ncontent-length: 0\r\n\r\n"));
+}
+
+TEST_F(FastParserTest, SkipBody) {
+  headers_complete_rc_ = 1;
+  EXPECT_EQ("begin|status:OK|field:Content-Length|value:20|headers 1.1 200 length=20|complete|"
+            "begin|status:OK|headers 1.1 200|complete|",
+            parse(HTTP_RESPONSE, "HTTP/1.1 200 OK\r\nContent-Length: 20\r\n\r\n"
+                                 "HTTP/1.1 200 OK\r\n\r\n"));
+}
+
+TEST_F(FastParserTest, PauseOnMessageComplete) {
+  init(HTTP_REQUEST);
+  pause_on_complete_ = true;
+  const std::string request = "POST / HTTP/1.1\r\ncontent-length: 1\r\n\r\nx";
+  const std::string input = request + request;
+
+  EXPECT_EQ(request.size(), execute(input));
+  EXPECT_EQ(HPE_PAUSED, HTTP_PARSER_ERRNO(&http_parser_));
+  EXPECT_EQ(0U, execute(input.substr(request.size())));
+
+  http_parser_pause(&http_parser_, 0);
+  EXPECT_EQ(request.size(), execute(input.substr(request.size())));
+  EXPECT_EQ("begin|url:/|field:content-length|value:1|headers 1.1 POST length=1|body:x|complete|"
+            "begin|url:/|field:content-length|value:1|headers 1.1 POST length=1|body:x|complete|",
+            log_);
+}
+
+TEST_F(FastParserTest, Upgrade) {
+  init(HTTP_REQUEST);
+  const std::string request =
+      "GET / HTTP/1.1\r\nConnection: keep-alive, Upgrade\r\nUpgrade: websocket\r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request + "websocket data"));
+  EXPECT_EQ(HPE_OK, HTTP_PARSER_ERRNO(&http_parser_));
+  EXPECT_EQ("begin|url:/|field:Connection|value:keep-alive, Upgrade|field:Upgrade|value:websocket|"
+            "headers 1.1 GET upgrade|complete|",
+            log_);
+}
+
+TEST_F(FastParserTest, ConnectionClose) {
+  init(HTTP_REQUEST);
+  const std::string request = "GET / HTTP/1.1\r\nConnection: close\r\n\r\n";
+  EXPECT_EQ(request.size() + 2, execute(request + "\r\n"));
+  execute("GET / HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(HPE_CLOSED_CONNECTION, HTTP_PARSER_ERRNO(&http_parser_));
+
+  // HTTP/1.0 connections close unless asked to stay open.
+  init(HTTP_REQUEST);
+  execute("GET / HTTP/1.0\r\n\r\nGET / HTTP/1.0\r\n\r\n");
+  EXPECT_EQ(HPE_CLOSED_CONNECTION, HTTP_PARSER_ERRNO(&http_parser_));
+  EXPECT_EQ("begin|url:/|headers 1.0 GET|complete|", log_);
+  EXPECT_EQ("begin|url:/|field:Connection|value:keep-alive|headers 1.0 GET|complete|"
+            "begin|url:/|headers 1.0 GET|complete|",
+            parse(HTTP_REQUEST,
+                  "GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\nGET / HTTP/1.0\r\n\r\n"));
+}
+
+TEST_F(FastParserTest, Eof) {
+  init(HTTP_REQUEST);
+  EXPECT_EQ(0U, execute(""));
+  EXPECT_EQ(HPE_OK, HTTP_PARSER_ERRNO(&http_parser_));
+  execute("GET / HTTP/1.1\r\n");
+  execute("");
+  EXPECT_EQ(HPE_INVALID_EOF_STATE, HTTP_PARSER_ERRNO(&http_parser_));
+}
+
+TEST_F(FastParserTest, BadMethodIsRejectedEarly) {
+  init(HTTP_REQUEST);
+  EXPECT_EQ(1U, execute("G"));
+  EXPECT_EQ("begin|", log_);
+  execute("g");
+  EXPECT_EQ(HPE_INVALID_METHOD, HTTP_PARSER_ERRNO(&http_parser_));
+
+  EXPECT_EQ(HPE_INVALID_METHOD, parseError(HTTP_REQUEST, "bad"));
+  EXPECT_EQ("", log_);
+  EXPECT_EQ(HPE_INVALID_METHOD, parseError(HTTP_REQUEST, "GETS / HTTP/1.1\r\n"));
+}
+
+TEST_F(FastParserTest, Errors) {
+  EXPECT_EQ(HPE_INVALID_CONSTANT, parseError(HTTP_RESPONSE, "HTTQ"));
+  EXPECT_EQ(HPE_INVALID_VERSION, parseError(HTTP_REQUEST, "GET / HTTP/1\r\n"));
+  EXPECT_EQ(HPE_INVALID_VERSION, parseError(HTTP_REQUEST, "GET / HTTP/1.1 \r\n"));
+  EXPECT_EQ(HPE_INVALID_URL, parseError(HTTP_REQUEST, "GET \x01 HTTP/1.1\r\n"));
+  EXPECT_EQ(HPE_INVALID_URL, parseError(HTTP_REQUEST, "GET %2F HTTP/1.1\r\n"));
+  EXPECT_EQ(HPE_INVALID_STATUS, parseError(HTTP_RESPONSE, "HTTP/1.1 2000 OK\r\n"));
+  EXPECT_EQ(HPE_INVALID_STATUS, parseError(HTTP_RESPONSE, "HTTP/1.1 OK\r\n"));
+  EXPECT_EQ(HPE_LF_EXPECTED, parseError(HTTP_REQUEST, "GET / HTTP/1.1\rx"));
+  EXPECT_EQ(HPE_INVALID_HEADER_TOKEN, parseError(HTTP_REQUEST, "GET / HTTP/1.1\r\nfoo\r\n"));
+  EXPECT_EQ(HPE_INVALID_HEADER_TOKEN, parseError(HTTP_REQUEST, "GET / HTTP/1.1\r\n: x\r\n"));
+  EXPECT_EQ(HPE_INVALID_HEADER_TOKEN, parseError(HTTP_REQUEST, "GET / HTTP/1.1\r\na\"b: x\r\n"));
+  EXPECT_EQ(HPE_INVALID_HEADER_TOKEN, parseError(HTTP_REQUEST, "GET / HTTP/1.1\r\n x\r\n"));
+  EXPECT_EQ(HPE_INVALID_HEADER_TOKEN,
+            parseError(HTTP_REQUEST, "GET / HTTP/1.1\r\nfoo: a\x7f"
+                                     "b\r\n"));
+  EXPECT_EQ(HPE_INVALID_CONTENT_LENGTH,
+            parseError(HTTP_REQUEST, "GET / HTTP/1.1\r\ncontent-length: 1x\r\n"));
+  EXPECT_EQ(HPE_INVALID_CONTENT_LENGTH,
+            parseError(HTTP_REQUEST, "GET / HTTP/1.1\r\ncontent-length: 99999999999999999999\r\n"));
+  EXPECT_EQ(HPE_UNEXPECTED_CONTENT_LENGTH,
+            parseError(HTTP_REQUEST,
+                       "GET / HTTP/1.1\r\ncontent-length: 1\r\ncontent-length: 1\r\n"));
+  EXPECT_EQ(HPE_INVALID_CHUNK_SIZE,
+            parseError(HTTP_REQUEST,
+                       "POST / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\nzz\r\n"));
+  EXPECT_EQ(HPE_STRICT, parseError(HTTP_REQUEST, "POST / HTTP/1.1\r\ntransfer-encoding: "
+                                                 "chunked\r\n\r\n1\r\nab\r\n"));
+}
+
+TEST_F(FastParserTest, HeaderOverflow) {
+  init(HTTP_REQUEST);
+  execute("GET / HTTP/1.1\r\n");
+  const std::string line = "foo: " + std::string(1024, 'q') + "\r\n";
+  for (int i = 0; i < 79; i++) {
+    execute(line);
+  }
+  EXPECT_EQ(HPE_OK, HTTP_PARSER_ERRNO(&http_parser_));
+  execute(line);
+  EXPECT_EQ(HPE_HEADER_OVERFLOW, HTTP_PARSER_ERRNO(&http_parser_));
+
+  // A single line that never ends.
+  init(HTTP_REQUEST);
+  execute("GET / HTTP/1.1\r\nfoo: ");
+  for (int i = 0; i < 80; i++) {
+    execute(std::string(1024, 'q'));
+  }
+  EXPECT_EQ(HPE_HEADER_OVERFLOW, HTTP_PARSER_ERRNO(&http_parser_));
+}
+
+TEST_F(FastParserTest, FindLineEnd) {
+  for (int c = 0; c < 256; c++) {
+    const bool line_end = (c < ' ' && c != '\t') || c == 0x7f;
+    for (size_t position = 0; position < 40; position++) {
+      std::string data(40, 'a');
+      data[position] = c;
+      const char* found = FastParser::findLineEnd(data.data(), data.data() + data.size());
+      EXPECT_EQ(line_end ? position : data.size(), static_cast<size_t>(found - data.data()))
+          << "char " << c << " at " << position;
+    }
+  }
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -44,6 +44,15 @@ Http2Settings Http2SettingsFromTuple(const Http2SettingsTuple& tp) {
 }
 } // namespace
 
+class TestMemoryAccount : public Buffer::MemoryAccount {
+public:
+  // Buffer::MemoryAccount
+  void charge(uint64_t bytes) override { bytes_ += bytes; }
+  void credit(uint64_t bytes) override { bytes_ -= bytes; }
+
+  uint64_t bytes_{};
+};
+
 class TestServerConnectionImpl : public ServerConnectionImpl {
 public:
   TestServerConnectionImpl(Network::Connection& connection, ServerConnectionCallbacks& callbacks,
@@ -190,6 +199,34 @@ TEST_P(Http2CodecImplTest, ShutdownNotice) {
   response_encoder_->encodeHeaders(response_headers, true);
 }
 
+TEST_P(Http2CodecImplTest, VolatileHeadersAreNeverIndexed) {
+  initialize();
+
+  const std::string request_id = "6f7dbe80-1b6c-4b4b-9b0a-7f3b1d5c2f44";
+  TestHeaderMapImpl request_headers{{"x-request-id", request_id}};
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true));
+  request_encoder_->encodeHeaders(request_headers, true);
+
+  const uint64_t raw_bytes = stats_store_.counter("http2.tx_headers_bytes").value();
+  const uint64_t encoded_bytes = stats_store_.counter("http2.tx_headers_encoded_bytes").value();
+  EXPECT_EQ(request_headers.byteSize(), raw_bytes);
+  EXPECT_LT(0U, encoded_bytes);
+
+  // Sending the same headers again encodes the request ID literally rather than from the dynamic
+  // table.
+  MockStreamDecoder response_decoder;
+  StreamEncoder* request_encoder = &client_.newStream(response_decoder);
+  NiceMock<MockStreamDecoder> request_decoder;
+  EXPECT_CALL(server_callbacks_, newStream(_))
+      .WillOnce(Invoke([&](StreamEncoder&) -> StreamDecoder& { return request_decoder; }));
+  request_encoder->encodeHeaders(request_headers, true);
+
+  EXPECT_EQ(2 * raw_bytes, stats_store_.counter("http2.tx_headers_bytes").value());
+  EXPECT_LT(request_id.size(),
+            stats_store_.counter("http2.tx_headers_encoded_bytes").value() - encoded_bytes);
+}
+
 TEST_P(Http2CodecImplTest, RefusedStreamReset) {
   initialize();
 
@@ -270,6 +307,84 @@ TEST_P(Http2CodecImplTest, TrailingHeadersLargeBody) {
   response_encoder_->encodeTrailers(TestHeaderMapImpl{{"trailing", "header"}});
 }
 
+TEST_P(Http2CodecImplTest, LargeBodyOutlivesDispatch) {
+  initialize();
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  request_encoder_->encodeHeaders(request_headers, false);
+
+  // Large DATA payloads reference the dispatched input, so keep them past the end of dispatch.
+  std::string body;
+  for (uint32_t i = 0; i < 100 * 1024; i++) {
+    body.push_back('a' + i % 26);
+  }
+  Buffer::OwnedImpl received;
+  EXPECT_CALL(request_decoder_, decodeData(_, _))
+      .Times(AtLeast(1))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) -> void { received.move(data); }));
+  Buffer::OwnedImpl request_body(body);
+  request_encoder_->encodeData(request_body, false);
+  Buffer::OwnedImpl small_body("hello");
+  request_encoder_->encodeData(small_body, true);
+  EXPECT_EQ(body + "hello", TestUtility::bufferToString(received));
+}
+
+TEST_P(Http2CodecImplTest, ReferencedDataChargedToAccount) {
+  initialize();
+  std::shared_ptr<TestMemoryAccount> account = std::make_shared<TestMemoryAccount>();
+  ON_CALL(server_connection_, bufferMemoryAccount()).WillByDefault(Return(account));
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  request_encoder_->encodeHeaders(request_headers, false);
+
+  // The input slices that DATA payloads reference are charged for as long as they are pinned.
+  Buffer::OwnedImpl received;
+  EXPECT_CALL(request_decoder_, decodeData(_, _))
+      .Times(AtLeast(1))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) -> void { received.move(data); }));
+  Buffer::OwnedImpl request_body(std::string(32 * 1024, 'a'));
+  request_encoder_->encodeData(request_body, true);
+  EXPECT_EQ(32 * 1024U, received.length());
+  EXPECT_GT(account->bytes_, 0U);
+
+  received.drain(received.length());
+  EXPECT_EQ(0U, account->bytes_);
+}
+
+TEST_P(Http2CodecImplTest, SmallDataInLargeInputCopied) {
+  initialize();
+  std::shared_ptr<TestMemoryAccount> account = std::make_shared<TestMemoryAccount>();
+  ON_CALL(server_connection_, bufferMemoryAccount()).WillByDefault(Return(account));
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  request_encoder_->encodeHeaders(request_headers, false);
+
+  // Deliver several DATA frames in a single input slice. Each of them is a small part of the slice,
+  // so they are copied rather than pin it.
+  std::string client_output;
+  ON_CALL(client_connection_, write(_)).WillByDefault(Invoke([&](Buffer::Instance& data) -> void {
+    client_output += TestUtility::bufferToString(data);
+  }));
+  const std::string body(48 * 1024, 'a');
+  Buffer::OwnedImpl request_body(body);
+  request_encoder_->encodeData(request_body, true);
+
+  Buffer::OwnedImpl received;
+  EXPECT_CALL(request_decoder_, decodeData(_, _))
+      .Times(AtLeast(1))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) -> void { received.move(data); }));
+  Buffer::OwnedImpl server_input(client_output);
+  server_wrapper_.dispatch(server_input, server_);
+  EXPECT_EQ(body, TestUtility::bufferToString(received));
+  EXPECT_EQ(0U, account->bytes_);
+}
+
 class Http2CodecImplDeferredResetTest : public Http2CodecImplTest {};
 
 TEST_P(Http2CodecImplDeferredResetTest, DeferredResetClient) {
@@ -58,7 +58,13 @@ public:
     Event::MockTimer* connect_timer_;
   };
 
-  Http2ConnPoolImplTest() : pool_(dispatcher_, host_, Upstream::ResourcePriority::Default) {}
+  Http2ConnPoolImplTest(uint32_t max_connections = 1,
+                        uint32_t target_streams_per_connection =
+                            ConnPoolImpl::DEFAULT_TARGET_STREAMS_PER_CONNECTION,
+                        const ConnectionPool::PreconnectPolicy& preconnect_policy =
+                            ConnectionPool::PreconnectPolicy())
+      : pool_(dispatcher_, host_, Upstream::ResourcePriority::Default, max_connections,
+              target_streams_per_connection, preconnect_policy) {}
 
   ~Http2ConnPoolImplTest() {
     // Make sure all gauges are 0.
@@ -103,6 +109,36 @@ public:
   NiceMock<Runtime::MockLoader> runtime_;
 };
 
+/**
+ * Test fixture for a pool that may open a second connection once a connection has an active stream.
+ */
+class Http2ConnPoolImplMultipleConnectionsTest : public Http2ConnPoolImplTest {
+public:
+  Http2ConnPoolImplMultipleConnectionsTest() : Http2ConnPoolImplTest(2, 1) {
+    cluster_->resource_manager_.reset(
+        new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1));
+  }
+};
+
+/**
+ * Test fixture for a pool that keeps a connection open ahead of demand and adds another once the
+ * active streams doubled would reach the target.
+ */
+class Http2ConnPoolImplPreconnectTest : public Http2ConnPoolImplTest {
+public:
+  Http2ConnPoolImplPreconnectTest() : Http2ConnPoolImplTest(2, 2, preconnectPolicy()) {
+    cluster_->resource_manager_.reset(
+        new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1));
+  }
+
+  static ConnectionPool::PreconnectPolicy preconnectPolicy() {
+    ConnectionPool::PreconnectPolicy policy;
+    policy.min_idle_connections_ = 1;
+    policy.ratio_ = 2.0;
+    return policy;
+  }
+};
+
 class ActiveTestRequest {
 public:
   ActiveTestRequest(Http2ConnPoolImplTest& test, size_t client_index) {
@@ -406,6 +442,135 @@ TEST_F(Http2ConnPoolImplTest, GoAway) {
   EXPECT_EQ(1U, cluster_->stats_.upstream_cx_close_notify_.value());
 }
 
+TEST_F(Http2ConnPoolImplMultipleConnectionsTest, SpreadStreams) {
+  InSequence s;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(0);
+
+  // The first connection is at the target, so a second one is added.
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+  EXPECT_CALL(r2.inner_encoder_, encodeHeaders(_, true));
+  r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(1);
+
+  // Both connections are at the target and there is no room for a third, so the oldest of the
+  // least loaded connections is used.
+  ActiveTestRequest r3(*this, 0);
+  EXPECT_CALL(r3.inner_encoder_, encodeHeaders(_, true));
+  r3.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+
+  // The second connection goes idle but the first one is still above the target.
+  EXPECT_CALL(r2.decoder_, decodeHeaders_(_, true));
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  // A new stream goes to the least loaded connection.
+  ActiveTestRequest r4(*this, 1);
+  EXPECT_CALL(r4.inner_encoder_, encodeHeaders(_, true));
+  r4.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  EXPECT_CALL(r4.decoder_, decodeHeaders_(_, true));
+  r4.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  // Once the first connection goes idle it is closed, since the second one has room.
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(r3.decoder_, decodeHeaders_(_, true));
+  r3.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_active_.value());
+
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_total_.value());
+}
+
+TEST_F(Http2ConnPoolImplPreconnectTest, Preconnect) {
+  // Warming up the pool opens a connection before any request.
+  expectClientCreate();
+  pool_.preconnect();
+  expectClientConnect(0);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_.value());
+
+  // The first stream uses it, and with the expected streams at the target a second connection is
+  // opened ahead of demand.
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_used_.value());
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_preconnect_.value());
+
+  // Once the stream completes the first connection is closed, since the second one has room.
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  // The second connection never carried a stream.
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_wasted_.value());
+}
+
+TEST_F(Http2ConnPoolImplMultipleConnectionsTest, ConnectionOverflow) {
+  InSequence s;
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1024, 1024, 1));
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(0);
+
+  // The first connection is at the target, but the cluster's connection limit leaves no room for
+  // a second one.
+  ActiveTestRequest r2(*this, 0);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_overflow_.value());
+  EXPECT_CALL(r2.inner_encoder_, encodeHeaders(_, true));
+  r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(r2.decoder_, decodeHeaders_(_, true));
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_total_.value());
+}
+
+TEST_F(Http2ConnPoolImplPreconnectTest, PreconnectConnectionOverflow) {
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1024, 1024, 1));
+
+  expectClientCreate();
+  pool_.preconnect();
+  expectClientConnect(0);
+
+  // The expected streams would warrant a second connection, but the cluster's connection limit
+  // leaves no room for it.
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_overflow_.value());
+
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+}
+
 } // namespace Http2
 } // namespace Http
 } // namespace Envoy
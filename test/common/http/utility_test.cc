@@ -77,6 +77,19 @@ TEST(HttpUtility, isWebSocketUpgradeRequest) {
       TestHeaderMapImpl{{"connection", "Upgrade"}, {"upgrade", "WebSocket"}}));
 }
 
+TEST(HttpUtility, isIdempotentMethod) {
+  EXPECT_TRUE(Utility::isIdempotentMethod("GET"));
+  EXPECT_TRUE(Utility::isIdempotentMethod("HEAD"));
+  EXPECT_TRUE(Utility::isIdempotentMethod("OPTIONS"));
+  EXPECT_TRUE(Utility::isIdempotentMethod("PUT"));
+  EXPECT_TRUE(Utility::isIdempotentMethod("DELETE"));
+  EXPECT_TRUE(Utility::isIdempotentMethod("TRACE"));
+  EXPECT_FALSE(Utility::isIdempotentMethod("POST"));
+  EXPECT_FALSE(Utility::isIdempotentMethod("PATCH"));
+  EXPECT_FALSE(Utility::isIdempotentMethod("CONNECT"));
+  EXPECT_FALSE(Utility::isIdempotentMethod("get"));
+}
+
 TEST(HttpUtility, appendXff) {
   {
     TestHeaderMapImpl headers;
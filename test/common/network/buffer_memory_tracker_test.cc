@@ -0,0 +1,198 @@
+#include <future>
+#include <string>
+#include <thread>
+
+#include "common/event/dispatcher_impl.h"
+#include "common/network/buffer_memory_tracker.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/mocks/network/mocks.h"
+
+#include "fmt/format.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::HasSubstr;
+using testing::NiceMock;
+using testing::Not;
+using testing::Return;
+
+namespace Envoy {
+namespace Network {
+
+class BufferMemoryTrackerTest : public testing::Test {
+public:
+  void initialize(uint64_t max_bytes) {
+    tracker_.reset(new BufferMemoryTracker(stats_store_, max_bytes));
+    thread_tracker_.reset(new ThreadBufferMemoryTracker(*tracker_, dispatcher_));
+  }
+
+  uint64_t totalBytes() { return stats_store_.gauge("buffer.memory.total_bytes").value(); }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  Event::DispatcherImpl dispatcher_;
+  std::unique_ptr<BufferMemoryTracker> tracker_;
+  ThreadBufferMemoryTrackerPtr thread_tracker_;
+  NiceMock<MockConnection> connection1_;
+  NiceMock<MockConnection> connection2_;
+  const uint64_t publish_bytes_{ConnectionBufferAccount::PUBLISH_BYTES};
+};
+
+TEST_F(BufferMemoryTrackerTest, NotTracked) {
+  EXPECT_EQ(nullptr, ThreadBufferMemoryTracker::current());
+  EXPECT_EQ(nullptr, ConnectionBufferAccount::create(connection1_));
+}
+
+TEST_F(BufferMemoryTrackerTest, PublishInSteps) {
+  initialize(0);
+  EXPECT_EQ(thread_tracker_.get(), ThreadBufferMemoryTracker::current());
+  ConnectionBufferAccountSharedPtr account = ConnectionBufferAccount::create(connection1_);
+  ASSERT_NE(nullptr, account);
+  Stats::Gauge& owner_gauge = stats_store_.gauge("owner");
+  account->setOwnerGauge(owner_gauge);
+
+  // Small changes are not published.
+  account->charge(publish_bytes_ - 1);
+  EXPECT_EQ(publish_bytes_ - 1, account->bytes());
+  EXPECT_EQ(0U, totalBytes());
+  EXPECT_EQ(0U, owner_gauge.value());
+
+  account->charge(1);
+  EXPECT_EQ(publish_bytes_, totalBytes());
+  EXPECT_EQ(publish_bytes_, owner_gauge.value());
+
+  account->charge(publish_bytes_);
+  account->credit(publish_bytes_ / 2);
+  EXPECT_EQ(2 * publish_bytes_, totalBytes());
+  account->credit(publish_bytes_);
+  EXPECT_EQ(publish_bytes_ / 2, totalBytes());
+  EXPECT_EQ(publish_bytes_ / 2, owner_gauge.value());
+
+  // Empty accounts are published exactly.
+  account->credit(publish_bytes_ / 2);
+  EXPECT_EQ(0U, totalBytes());
+  EXPECT_EQ(0U, owner_gauge.value());
+
+  // Closing withdraws what has been published, and stops publishing.
+  account->charge(publish_bytes_);
+  EXPECT_EQ(publish_bytes_, totalBytes());
+  account->close();
+  EXPECT_EQ(0U, totalBytes());
+  EXPECT_EQ(0U, owner_gauge.value());
+  account->charge(publish_bytes_);
+  EXPECT_EQ(0U, totalBytes());
+}
+
+TEST_F(BufferMemoryTrackerTest, ReadDisableOverLimit) {
+  initialize(2 * publish_bytes_);
+  EXPECT_EQ(2 * publish_bytes_, stats_store_.gauge("buffer.memory.max_bytes").value());
+  ConnectionBufferAccountSharedPtr account1 = ConnectionBufferAccount::create(connection1_);
+  ConnectionBufferAccountSharedPtr account2 = ConnectionBufferAccount::create(connection2_);
+
+  account1->charge(publish_bytes_);
+  account2->charge(publish_bytes_);
+  EXPECT_EQ(2 * publish_bytes_, totalBytes());
+
+  // The connection holding the most stops reading once the limit is exceeded.
+  EXPECT_CALL(connection2_, readDisable(true));
+  account2->charge(publish_bytes_);
+  EXPECT_EQ(1U, stats_store_.counter("buffer.memory.read_disabled_total").value());
+  EXPECT_EQ(1U, stats_store_.gauge("buffer.memory.read_disabled_active").value());
+
+  // Further increases disable the next largest connection still reading.
+  EXPECT_CALL(connection1_, readDisable(true));
+  account1->charge(publish_bytes_);
+  EXPECT_EQ(2U, stats_store_.gauge("buffer.memory.read_disabled_active").value());
+
+  // Reads resume once usage has dropped to 3/4 of the limit.
+  account2->credit(2 * publish_bytes_);
+  EXPECT_EQ(2 * publish_bytes_, totalBytes());
+  EXPECT_CALL(connection1_, readDisable(false));
+  EXPECT_CALL(connection2_, readDisable(false));
+  account1->credit(publish_bytes_);
+  EXPECT_EQ(0U, stats_store_.gauge("buffer.memory.read_disabled_active").value());
+  EXPECT_EQ(2U, stats_store_.counter("buffer.memory.read_disabled_total").value());
+
+  account1->close();
+  account2->close();
+}
+
+TEST_F(BufferMemoryTrackerTest, ClosedConnectionsNotReadDisabled) {
+  initialize(publish_bytes_);
+  ConnectionBufferAccountSharedPtr account1 = ConnectionBufferAccount::create(connection1_);
+  ConnectionBufferAccountSharedPtr account2 = ConnectionBufferAccount::create(connection2_);
+
+  ON_CALL(connection2_, state()).WillByDefault(Return(Connection::State::Closing));
+  account2->charge(2 * publish_bytes_);
+  EXPECT_CALL(connection1_, readDisable(true));
+  account1->charge(publish_bytes_);
+
+  // A read disabled account that closes no longer counts as read disabled.
+  account1->close();
+  EXPECT_EQ(0U, stats_store_.gauge("buffer.memory.read_disabled_active").value());
+  EXPECT_EQ(2 * publish_bytes_, totalBytes());
+  account2->close();
+}
+
+TEST_F(BufferMemoryTrackerTest, ReadEnableOtherThreads) {
+  initialize(2 * publish_bytes_);
+  ConnectionBufferAccountSharedPtr account1 = ConnectionBufferAccount::create(connection1_);
+  account1->charge(2 * publish_bytes_);
+
+  // connection2_ is owned by another thread, which goes idle after it has been read disabled.
+  std::promise<void> read_disabled;
+  std::promise<void> below_limit;
+  std::thread thread([&]() -> void {
+    Event::DispatcherImpl dispatcher;
+    ThreadBufferMemoryTracker thread_tracker(*tracker_, dispatcher);
+    ConnectionBufferAccountSharedPtr account2 = ConnectionBufferAccount::create(connection2_);
+    EXPECT_CALL(connection2_, readDisable(true));
+    account2->charge(publish_bytes_);
+    read_disabled.set_value();
+
+    below_limit.get_future().wait();
+    EXPECT_CALL(connection2_, readDisable(false));
+    dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+    EXPECT_EQ(0U, stats_store_.gauge("buffer.memory.read_disabled_active").value());
+    account2->close();
+  });
+
+  read_disabled.get_future().wait();
+  EXPECT_EQ(1U, stats_store_.gauge("buffer.memory.read_disabled_active").value());
+
+  // The drop is caused by this thread, but the other thread resumes reading.
+  account1->credit(2 * publish_bytes_);
+  below_limit.set_value();
+  thread.join();
+  account1->close();
+}
+
+TEST_F(BufferMemoryTrackerTest, Dump) {
+  initialize(0);
+  ConnectionBufferAccountSharedPtr account1 = ConnectionBufferAccount::create(connection1_);
+  ConnectionBufferAccountSharedPtr account2 = ConnectionBufferAccount::create(connection2_);
+  account1->setOwnerGauge(stats_store_.gauge("listener.downstream_cx_buffer_memory_bytes"));
+  account1->charge(publish_bytes_);
+  account2->charge(100);
+  ON_CALL(connection1_, id()).WillByDefault(Return(1));
+  ON_CALL(connection2_, id()).WillByDefault(Return(2));
+
+  const std::string output = tracker_->dump(1);
+  EXPECT_THAT(output, HasSubstr(fmt::format("total_bytes: {}\n", publish_bytes_)));
+  EXPECT_THAT(output, HasSubstr(fmt::format("listener.downstream_cx_buffer_memory_bytes: {}\n",
+                                            publish_bytes_)));
+  EXPECT_THAT(output, HasSubstr("none: 100\n"));
+  EXPECT_THAT(output, HasSubstr(fmt::format("id=1 remote=10.0.0.1:443 "
+                                            "owner=listener.downstream_cx_buffer_memory_bytes "
+                                            "bytes={}\n",
+                                            publish_bytes_)));
+  EXPECT_THAT(output, Not(HasSubstr("id=2")));
+
+  // Accounts still open when the thread stops tracking are closed.
+  thread_tracker_.reset();
+  EXPECT_EQ(0U, totalBytes());
+  EXPECT_THAT(tracker_->dump(1), Not(HasSubstr("id=")));
+}
+
+} // namespace Network
+} // namespace Envoy
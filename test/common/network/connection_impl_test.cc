@@ -62,6 +62,24 @@ TEST(ConnectionImplUtility, updateBufferStats) {
   ConnectionImplUtility::updateBufferStats(3, 3, previous_total, counter, gauge);
 }
 
+TEST(ConnectionImplUtility, nextReadSize) {
+  const uint32_t max_read_size = 64 * 1024;
+
+  // Full reads grow the read size up to the maximum.
+  EXPECT_EQ(32768U, ConnectionImplUtility::nextReadSize(16384, 16384, max_read_size));
+  EXPECT_EQ(65536U, ConnectionImplUtility::nextReadSize(32768, 32768, max_read_size));
+  EXPECT_EQ(65536U, ConnectionImplUtility::nextReadSize(65536, 65536, max_read_size));
+
+  // Reads that return a reasonable fraction of the requested size keep it.
+  EXPECT_EQ(16384U, ConnectionImplUtility::nextReadSize(16384, 16383, max_read_size));
+  EXPECT_EQ(16384U, ConnectionImplUtility::nextReadSize(16384, 4096, max_read_size));
+
+  // Small reads shrink the read size down to the minimum.
+  EXPECT_EQ(8192U, ConnectionImplUtility::nextReadSize(16384, 100, max_read_size));
+  EXPECT_EQ(4096U, ConnectionImplUtility::nextReadSize(8192, 100, max_read_size));
+  EXPECT_EQ(4096U, ConnectionImplUtility::nextReadSize(4096, 100, max_read_size));
+}
+
 class ConnectionImplDeathTest : public testing::TestWithParam<Address::IpVersion> {};
 INSTANTIATE_TEST_CASE_P(IpVersions, ConnectionImplDeathTest,
                         testing::ValuesIn(TestEnvironment::getIpVersionsForTest()));
@@ -201,7 +219,7 @@ TEST_P(ConnectionImplTest, CloseDuringConnectCallback) {
 
 struct MockConnectionStats {
   Connection::ConnectionStats toBufferStats() {
-    return {rx_total_, rx_current_, tx_total_, tx_current_, &bind_errors_};
+    return {rx_total_, rx_current_, tx_total_, tx_current_, &bind_errors_, &rx_syscalls_};
   }
 
   StrictMock<Stats::MockCounter> rx_total_;
@@ -209,6 +227,7 @@ struct MockConnectionStats {
   StrictMock<Stats::MockCounter> tx_total_;
   StrictMock<Stats::MockGauge> tx_current_;
   StrictMock<Stats::MockCounter> bind_errors_;
+  NiceMock<Stats::MockCounter> rx_syscalls_;
 };
 
 TEST_P(ConnectionImplTest, ConnectionStats) {
@@ -402,6 +421,71 @@ TEST_P(ConnectionImplTest, BasicWrite) {
   disconnect(true);
 }
 
+TEST_P(ConnectionImplTest, SpliceToOtherConnection) {
+  setUpBasicConnection();
+  connect();
+
+  // Open a second connection. Data the first server connection reads is spliced to the second
+  // client connection, and arrives at the second server connection.
+  int expected_callbacks = 2;
+  ClientConnectionPtr client_connection2 =
+      dispatcher_->createClientConnection(socket_.localAddress(), source_address_);
+  NiceMock<MockConnectionCallbacks> client_callbacks2;
+  client_connection2->addConnectionCallbacks(client_callbacks2);
+  ConnectionPtr server_connection2;
+  std::shared_ptr<MockReadFilter> read_filter2(new NiceMock<MockReadFilter>());
+  EXPECT_CALL(listener_callbacks_, onNewConnection_(_))
+      .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+        server_connection2 = std::move(conn);
+        server_connection2->addReadFilter(read_filter2);
+        if (--expected_callbacks == 0) {
+          dispatcher_->exit();
+        }
+      }));
+  EXPECT_CALL(client_callbacks2, onEvent(ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+        if (--expected_callbacks == 0) {
+          dispatcher_->exit();
+        }
+      }));
+  client_connection2->connect();
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  NiceMock<MockConnection> mock_connection;
+  EXPECT_FALSE(server_connection_->spliceTo(mock_connection));
+  EXPECT_FALSE(server_connection_->spliceTo(*server_connection_));
+  if (!server_connection_->spliceTo(*client_connection2)) {
+    // splice() is not supported on this platform.
+    client_connection2->close(ConnectionCloseType::NoFlush);
+    server_connection2->close(ConnectionCloseType::NoFlush);
+    disconnect(true);
+    return;
+  }
+  EXPECT_FALSE(server_connection_->spliceTo(*client_connection_));
+
+  // The spliced data bypasses the read filter of the first server connection.
+  const std::string data(256 * 1024, 'a');
+  std::string data_received;
+  EXPECT_CALL(*read_filter_, onData(_)).Times(0);
+  EXPECT_CALL(*read_filter2, onData(_))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& buffer) -> FilterStatus {
+        data_received.append(TestUtility::bufferToString(buffer));
+        buffer.drain(buffer.length());
+        if (data_received.size() == data.size()) {
+          dispatcher_->exit();
+        }
+        return FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl buffer(data);
+  client_connection_->write(buffer);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(data, data_received);
+
+  client_connection2->close(ConnectionCloseType::NoFlush);
+  server_connection2->close(ConnectionCloseType::NoFlush);
+  disconnect(true);
+}
+
 // Similar to BasicWrite, only with watermarks set.
 TEST_P(ConnectionImplTest, WriteWithWatermarks) {
   useMockBuffer();
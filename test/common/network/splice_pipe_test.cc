@@ -0,0 +1,99 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "common/network/splice_pipe.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class SplicePipeTest : public testing::Test {
+public:
+  SplicePipeTest() {
+    EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, source_fds_));
+    EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sink_fds_));
+  }
+
+  ~SplicePipeTest() {
+    for (int fd : {source_fds_[0], source_fds_[1], sink_fds_[0], sink_fds_[1]}) {
+      close(fd);
+    }
+  }
+
+  // Data written to source_fds_[0] is spliced from source_fds_[1] to sink_fds_[0], and read from
+  // sink_fds_[1].
+  int source_fds_[2];
+  int sink_fds_[2];
+};
+
+TEST_F(SplicePipeTest, SpliceData) {
+  SplicePipeSharedPtr pipe = SplicePipe::create(0);
+  if (pipe == nullptr) {
+    // splice() is not supported on this platform.
+    return;
+  }
+  EXPECT_LT(0, pipe->capacity());
+
+  // Nothing to read yet.
+  EXPECT_EQ(-1, pipe->spliceFrom(source_fds_[1]));
+  EXPECT_EQ(EAGAIN, errno);
+  EXPECT_EQ(0, pipe->spliceTo(sink_fds_[0]));
+
+  EXPECT_EQ(5, write(source_fds_[0], "hello", 5));
+  EXPECT_EQ(5, pipe->spliceFrom(source_fds_[1]));
+  EXPECT_EQ(5, pipe->length());
+  EXPECT_EQ(5, pipe->spliceTo(sink_fds_[0]));
+  EXPECT_EQ(0, pipe->length());
+
+  char data[5];
+  EXPECT_EQ(5, read(sink_fds_[1], data, sizeof(data)));
+  EXPECT_EQ("hello", std::string(data, sizeof(data)));
+
+  // End of stream.
+  shutdown(source_fds_[0], SHUT_WR);
+  EXPECT_EQ(0, pipe->spliceFrom(source_fds_[1]));
+}
+
+TEST_F(SplicePipeTest, FlowControl) {
+  SplicePipeSharedPtr pipe = SplicePipe::create(0);
+  if (pipe == nullptr) {
+    return;
+  }
+
+  // Fill the pipe.
+  const std::string data(pipe->capacity(), 'a');
+  uint64_t written = 0;
+  while (written < data.size()) {
+    const ssize_t rc = write(source_fds_[0], data.data() + written, data.size() - written);
+    ASSERT_LT(0, rc);
+    written += rc;
+    while (pipe->spliceFrom(source_fds_[1]) > 0) {
+    }
+  }
+  EXPECT_EQ(-1, pipe->spliceFrom(source_fds_[1]));
+  EXPECT_EQ(EAGAIN, errno);
+  pipe->onSourceBlocked();
+  EXPECT_FALSE(pipe->shouldResumeSource());
+
+  // The source resumes once the pipe has drained to half the occupancy at which it blocked.
+  const uint64_t blocked_length = pipe->length();
+  EXPECT_LT(0, blocked_length);
+  char buffer[4096];
+  while (pipe->length() > blocked_length / 2) {
+    EXPECT_FALSE(pipe->shouldResumeSource());
+    ASSERT_LT(0, pipe->spliceTo(sink_fds_[0]));
+    while (read(sink_fds_[1], buffer, sizeof(buffer)) > 0) {
+    }
+  }
+  EXPECT_TRUE(pipe->shouldResumeSource());
+  EXPECT_FALSE(pipe->shouldResumeSource());
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
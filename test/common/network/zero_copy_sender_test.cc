@@ -0,0 +1,252 @@
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/network/zero_copy_sender.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class ZeroCopySenderTest : public testing::Test {
+public:
+  ZeroCopySenderTest() {
+    // Connect a pair of TCP sockets over loopback. Zero copy sends are not supported on unix
+    // domain sockets. The socket buffers are kept small so that large sends are partial.
+    const int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    const int buffer_size = 4096;
+    EXPECT_EQ(0, setsockopt(listen_fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size)));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_length = sizeof(address);
+    EXPECT_EQ(0, bind(listen_fd, reinterpret_cast<sockaddr*>(&address), address_length));
+    EXPECT_EQ(0, listen(listen_fd, 1));
+    EXPECT_EQ(0, getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_length));
+    client_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT_EQ(0, setsockopt(client_fd_, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size)));
+    EXPECT_EQ(0, connect(client_fd_, reinterpret_cast<sockaddr*>(&address), address_length));
+    EXPECT_NE(-1, fcntl(client_fd_, F_SETFL, O_NONBLOCK));
+    server_fd_ = accept(listen_fd, nullptr, nullptr);
+    EXPECT_NE(-1, server_fd_);
+    close(listen_fd);
+  }
+
+  ~ZeroCopySenderTest() {
+    if (client_fd_ != -1) {
+      close(client_fd_);
+    }
+    close(server_fd_);
+  }
+
+  // Read exactly length bytes from the server side of the connection.
+  std::string readServer(uint64_t length) {
+    std::string data;
+    char chunk[16384];
+    while (data.size() < length) {
+      const ssize_t rc =
+          ::read(server_fd_, chunk, std::min<uint64_t>(sizeof(chunk), length - data.size()));
+      EXPECT_LT(0, rc);
+      if (rc <= 0) {
+        break;
+      }
+      data.append(chunk, rc);
+    }
+    return data;
+  }
+
+  // Wait for the kernel to report completion of all zero copy sends.
+  void waitForCompletions(ZeroCopySender& sender) {
+    for (int i = 0; i < 1000 && sender.pendingBytes() > 0; i++) {
+      sender.processCompletions(client_fd_);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  // Build a buffer out of whole slices, each filled with its own character.
+  static std::string addSlices(Buffer::OwnedImpl& buffer, uint64_t num_slices) {
+    std::string data;
+    for (uint64_t i = 0; i < num_slices; i++) {
+      const std::string slice_data(16384, 'a' + i);
+      Buffer::OwnedImpl slice(slice_data);
+      buffer.move(slice);
+      data += slice_data;
+    }
+    return data;
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  Connection::ZeroCopySendStats stats_{stats_store_.counter("zerocopy_sends"),
+                                       stats_store_.counter("zerocopy_fallbacks")};
+  int client_fd_{-1};
+  int server_fd_{-1};
+};
+
+TEST_F(ZeroCopySenderTest, WriteAndComplete) {
+  if (!ZeroCopySender::enable(client_fd_)) {
+    // The kernel does not support zero copy sends, writes are plain copies.
+    ZeroCopySender sender(stats_);
+    Buffer::OwnedImpl buffer(std::string(100, 'a'));
+    EXPECT_EQ(100, sender.write(client_fd_, buffer));
+    EXPECT_EQ(0, sender.pendingBytes());
+    EXPECT_EQ(std::string(100, 'a'), readServer(100));
+    return;
+  }
+
+  ZeroCopySender sender(stats_);
+  const std::string data(65536, 'a');
+  Buffer::OwnedImpl buffer(data);
+  const int rc = sender.write(client_fd_, buffer);
+  ASSERT_LT(0, rc);
+  EXPECT_EQ(data.size() - rc, buffer.length());
+  EXPECT_EQ(1, stats_store_.counter("zerocopy_sends").value());
+
+  // Sent data is held until the kernel is done with it.
+  EXPECT_EQ(static_cast<uint64_t>(rc), sender.pendingBytes());
+  EXPECT_EQ(data.substr(0, rc), readServer(rc));
+  waitForCompletions(sender);
+  EXPECT_EQ(0, sender.pendingBytes());
+
+  // Loopback traffic is copied by the kernel. After that, the sender copies writes itself.
+  if (stats_store_.counter("zerocopy_fallbacks").value() > 0) {
+    Buffer::OwnedImpl more_data(std::string(100, 'b'));
+    EXPECT_EQ(100, sender.write(client_fd_, more_data));
+    EXPECT_EQ(0, sender.pendingBytes());
+    EXPECT_EQ(1, stats_store_.counter("zerocopy_sends").value());
+  }
+}
+
+// A send that ends part way through a slice leaves the rest of the slice in the buffer. The slice
+// must stay intact while the kernel may read it, however the buffer is changed in the meantime.
+TEST_F(ZeroCopySenderTest, PartialSend) {
+  if (!ZeroCopySender::enable(client_fd_)) {
+    return;
+  }
+
+  ZeroCopySender sender(stats_);
+  Buffer::OwnedImpl buffer;
+  const std::string data = addSlices(buffer, 4);
+  Buffer::RawSlice slices[4];
+  ASSERT_EQ(4, buffer.getRawSlices(slices, 4));
+
+  const int rc = sender.write(client_fd_, buffer);
+  ASSERT_LT(0, rc);
+  ASSERT_GT(data.size(), static_cast<uint64_t>(rc));
+  EXPECT_EQ(data.size() - rc, buffer.length());
+  EXPECT_EQ(static_cast<uint64_t>(rc), sender.pendingBytes());
+  const uint64_t partial_slice = rc / 16384;
+  const uint64_t sent_in_partial_slice = rc % 16384;
+  if (sent_in_partial_slice > 0) {
+    // The unsent rest of the slice is referenced, not copied.
+    Buffer::RawSlice unsent_slice;
+    buffer.getRawSlices(&unsent_slice, 1);
+    EXPECT_EQ(static_cast<uint8_t*>(slices[partial_slice].mem_) + sent_in_partial_slice,
+              unsent_slice.mem_);
+  }
+
+  // Release everything the buffer holds and fill a new buffer, which reuses freed slice memory.
+  // The memory that data was sent from must be unaffected.
+  const std::string unsent_data = TestUtility::bufferToString(buffer);
+  buffer.drain(buffer.length());
+  Buffer::OwnedImpl other;
+  addSlices(other, 8);
+  for (uint64_t i = 0; i <= partial_slice && i < 4; i++) {
+    const uint64_t sent = i < partial_slice ? 16384 : sent_in_partial_slice;
+    EXPECT_EQ(std::string(sent, 'a' + i), std::string(static_cast<char*>(slices[i].mem_), sent));
+  }
+  EXPECT_EQ(data.substr(0, rc), readServer(rc));
+  EXPECT_EQ(data.substr(rc), unsent_data);
+  waitForCompletions(sender);
+  EXPECT_EQ(0, sender.pendingBytes());
+}
+
+// Sending the rest of a partly sent slice holds it again, until that send completes too.
+TEST_F(ZeroCopySenderTest, SendRestOfSlice) {
+  if (!ZeroCopySender::enable(client_fd_)) {
+    return;
+  }
+
+  ZeroCopySender sender(stats_);
+  Buffer::OwnedImpl buffer;
+  const std::string data = addSlices(buffer, 4);
+  std::string received;
+  while (buffer.length() > 0) {
+    const int rc = sender.write(client_fd_, buffer);
+    if (rc > 0) {
+      received += readServer(rc);
+    } else {
+      ASSERT_EQ(EAGAIN, errno);
+    }
+    sender.processCompletions(client_fd_);
+  }
+  EXPECT_EQ(data, received);
+  waitForCompletions(sender);
+  EXPECT_EQ(0, sender.pendingBytes());
+}
+
+// Closing a socket with outstanding sends keeps it open until they complete.
+TEST_F(ZeroCopySenderTest, CloseSocketWithPendingSends) {
+  Event::DispatcherImpl dispatcher;
+  if (!ZeroCopySender::enable(client_fd_)) {
+    ZeroCopySender::closeSocket(nullptr, client_fd_, dispatcher);
+    client_fd_ = -1;
+    char byte;
+    EXPECT_EQ(0, ::read(server_fd_, &byte, 1));
+    return;
+  }
+
+  ZeroCopySenderPtr sender(new ZeroCopySender(stats_));
+  Buffer::OwnedImpl buffer;
+  const std::string data = addSlices(buffer, 4);
+  const int rc = sender->write(client_fd_, buffer);
+  ASSERT_LT(0, rc);
+  buffer.drain(buffer.length());
+
+  ZeroCopySender::closeSocket(std::move(sender), client_fd_, dispatcher);
+  client_fd_ = -1;
+  EXPECT_EQ(data.substr(0, rc), readServer(rc));
+  // The socket was shut down for writing, so the server sees the end of the stream.
+  char byte;
+  EXPECT_EQ(0, ::read(server_fd_, &byte, 1));
+  // The dispatcher runs until the sends have completed and the socket is closed.
+  dispatcher.run(Event::Dispatcher::RunType::Block);
+}
+
+// Sockets that are still draining when the dispatcher's connections shut down are closed then.
+TEST_F(ZeroCopySenderTest, CloseDrainingSockets) {
+  if (!ZeroCopySender::enable(client_fd_)) {
+    return;
+  }
+
+  Event::DispatcherImpl dispatcher;
+  ZeroCopySenderPtr sender(new ZeroCopySender(stats_));
+  Buffer::OwnedImpl buffer;
+  addSlices(buffer, 4);
+  ASSERT_LT(0, sender->write(client_fd_, buffer));
+  buffer.drain(buffer.length());
+
+  const int fd = client_fd_;
+  client_fd_ = -1;
+  ZeroCopySender::closeSocket(std::move(sender), fd, dispatcher);
+  EXPECT_NE(-1, fcntl(fd, F_GETFD));
+  ZeroCopySender::closeDrainingSockets(dispatcher);
+  EXPECT_EQ(-1, fcntl(fd, F_GETFD));
+  // Nothing is left for the dispatcher to do.
+  dispatcher.run(Event::Dispatcher::RunType::Block);
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
@@ -4,6 +4,7 @@
 #include <memory>
 #include <string>
 
+#include "common/common/regex.h"
 #include "common/config/rds_json.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
@@ -804,6 +805,269 @@ TEST(RouteMatcherTest, HeaderMatchedRouting) {
   }
 }
 
+// Virtual hosts with many routes find them through a trie, which must still let the first matching
+// route win.
+TEST(RouteMatcherTest, RouteTrie) {
+  // Routes that never match, ahead of the interesting ones, so that the trie is used.
+  std::string filler_routes;
+  for (size_t i = 0; i < VirtualHostImpl::MIN_ROUTES_FOR_TRIE; i++) {
+    filler_routes += R"EOF({"prefix": "/filler/)EOF" + std::to_string(i) +
+                     R"EOF(/", "cluster": "filler"},)EOF";
+  }
+
+  std::string json = R"EOF(
+{
+  "virtual_hosts": [
+    {
+      "name": "local_service",
+      "domains": ["*"],
+      "routes": [
+  )EOF" + filler_routes + R"EOF(
+        {
+          "prefix": "/api/v2",
+          "cluster": "v2_with_headers",
+          "headers" : [
+            {"name": "x-version", "value": "2"}
+          ]
+        },
+        {
+          "path": "/api/v2/users",
+          "cluster": "users"
+        },
+        {
+          "prefix": "/api/v2",
+          "cluster": "v2"
+        },
+        {
+          "regex": "/api/v3/[0-9]+",
+          "cluster": "v3_regex"
+        },
+        {
+          "prefix": "/API/V4",
+          "case_sensitive": false,
+          "cluster": "v4_case_insensitive"
+        },
+        {
+          "prefix": "/api/v3",
+          "cluster": "v3"
+        },
+        {
+          "prefix": "/api",
+          "cluster": "api"
+        },
+        {
+          "prefix": "/",
+          "cluster": "default"
+        }
+      ]
+    }
+  ]
+}
+  )EOF";
+
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+
+  EXPECT_EQ("filler",
+            config.route(genHeaders("www.lyft.com", "/filler/3/foo", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+  EXPECT_EQ("users", config.route(genHeaders("www.lyft.com", "/api/v2/users", "GET"), 0)
+                         ->routeEntry()
+                         ->clusterName());
+  EXPECT_EQ("users", config.route(genHeaders("www.lyft.com", "/api/v2/users?id=1", "GET"), 0)
+                         ->routeEntry()
+                         ->clusterName());
+  EXPECT_EQ("v2", config.route(genHeaders("www.lyft.com", "/api/v2/users/1", "GET"), 0)
+                      ->routeEntry()
+                      ->clusterName());
+  EXPECT_EQ("v3_regex", config.route(genHeaders("www.lyft.com", "/api/v3/12", "GET"), 0)
+                            ->routeEntry()
+                            ->clusterName());
+  EXPECT_EQ("v3", config.route(genHeaders("www.lyft.com", "/api/v3/abc", "GET"), 0)
+                      ->routeEntry()
+                      ->clusterName());
+  EXPECT_EQ("v4_case_insensitive",
+            config.route(genHeaders("www.lyft.com", "/Api/v4/abc", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+  EXPECT_EQ("api", config.route(genHeaders("www.lyft.com", "/apiary", "GET"), 0)
+                       ->routeEntry()
+                       ->clusterName());
+  EXPECT_EQ("default", config.route(genHeaders("www.lyft.com", "/API/V2", "GET"), 0)
+                           ->routeEntry()
+                           ->clusterName());
+
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/api/v2/users", "GET");
+    headers.addCopy("x-version", "2");
+    EXPECT_EQ("v2_with_headers", config.route(headers, 0)->routeEntry()->clusterName());
+  }
+}
+
+TEST(RouteMatcherTest, RegexSet) {
+  std::string json = R"EOF(
+{
+  "virtual_hosts": [
+    {
+      "name": "local_service",
+      "domains": ["*"],
+      "routes": [
+        {
+          "regex": "/users/[0-9]+",
+          "cluster": "users_with_headers",
+          "headers" : [
+            {"name": "x-version", "value": "2"}
+          ]
+        },
+        {
+          "regex": "/users/[0-9]+",
+          "cluster": "users"
+        },
+        {
+          "prefix": "/users/1",
+          "cluster": "user_prefix"
+        },
+        {
+          "regex": "/users/.*",
+          "cluster": "users_catch_all"
+        },
+        {
+          "prefix": "/",
+          "cluster": "default"
+        }
+      ]
+    }
+  ]
+}
+  )EOF";
+
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+
+  EXPECT_EQ("users", config.route(genHeaders("www.lyft.com", "/users/123", "GET"), 0)
+                         ->routeEntry()
+                         ->clusterName());
+  EXPECT_EQ("users", config.route(genHeaders("www.lyft.com", "/users/123?a=b", "GET"), 0)
+                         ->routeEntry()
+                         ->clusterName());
+  EXPECT_EQ("user_prefix", config.route(genHeaders("www.lyft.com", "/users/1a", "GET"), 0)
+                               ->routeEntry()
+                               ->clusterName());
+  EXPECT_EQ("users_catch_all", config.route(genHeaders("www.lyft.com", "/users/abc", "GET"), 0)
+                                   ->routeEntry()
+                                   ->clusterName());
+  EXPECT_EQ("default", config.route(genHeaders("www.lyft.com", "/users", "GET"), 0)
+                           ->routeEntry()
+                           ->clusterName());
+
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/users/123", "GET");
+    headers.addCopy("x-version", "2");
+    EXPECT_EQ("users_with_headers", config.route(headers, 0)->routeEntry()->clusterName());
+  }
+}
+
+TEST(RouteMatcherTest, InvalidRegex) {
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+
+  std::string unsupported_route = R"EOF(
+{
+  "virtual_hosts": [
+    {
+      "name": "local_service",
+      "domains": ["*"],
+      "routes": [
+        {
+          "regex": "/users/(?!validate)[a-z]+",
+          "cluster": "users"
+        }
+      ]
+    }
+  ]
+}
+  )EOF";
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(unsupported_route), runtime, cm, true),
+               EnvoyException);
+
+  std::string expensive_route = R"EOF(
+{
+  "virtual_hosts": [
+    {
+      "name": "local_service",
+      "domains": ["*"],
+      "routes": [
+        {
+          "regex": "/users/[a-z]{1000}",
+          "cluster": "users"
+        }
+      ]
+    }
+  ]
+}
+  )EOF";
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(expensive_route), runtime, cm, true),
+               EnvoyException);
+
+  std::string expensive_header = R"EOF(
+{
+  "virtual_hosts": [
+    {
+      "name": "local_service",
+      "domains": ["*"],
+      "routes": [
+        {
+          "prefix": "/",
+          "cluster": "users",
+          "headers" : [
+            {"name": "x-user", "value": "(a|b|c){400}", "regex": true}
+          ]
+        }
+      ]
+    }
+  ]
+}
+  )EOF";
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(expensive_header), runtime, cm, true),
+               EnvoyException);
+}
+
+TEST(RouteMatcherTest, RegexProgramSizeRuntime) {
+  std::string json = R"EOF(
+{
+  "virtual_hosts": [
+    {
+      "name": "local_service",
+      "domains": ["*"],
+      "routes": [
+        {
+          "regex": "/foo/[a-z0-9-]{1,36}",
+          "cluster": "foo"
+        }
+      ]
+    }
+  ]
+}
+  )EOF";
+
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  EXPECT_EQ("foo", config.route(genHeaders("www.lyft.com", "/foo/abc-123", "GET"), 0)
+                       ->routeEntry()
+                       ->clusterName());
+
+  EXPECT_CALL(runtime.snapshot_,
+              getInteger("router.regex.max_program_size", RegexUtil::DEFAULT_MAX_PROGRAM_SIZE))
+      .WillRepeatedly(Return(100));
+  EXPECT_THROW_WITH_MESSAGE(
+      ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true), EnvoyException,
+      "regex '/foo/[a-z0-9-]{1,36}' is too complex: program size 152 exceeds 100");
+}
+
 class RouterMatcherHashPolicyTest : public testing::Test {
 public:
   RouterMatcherHashPolicyTest() {
@@ -0,0 +1,83 @@
+#include <cstdint>
+#include <string>
+
+#include "common/router/domain_trie.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+
+class DomainTrieTest : public testing::Test {
+public:
+  // @return int64_t the index found for a host, or -1.
+  int64_t find(const std::string& host) {
+    uint32_t index;
+    if (!trie_.find(host.c_str(), host.size(), index)) {
+      return -1;
+    }
+    return index;
+  }
+
+  DomainTrie trie_;
+};
+
+TEST_F(DomainTrieTest, Empty) {
+  EXPECT_TRUE(trie_.empty());
+  EXPECT_EQ(-1, find(""));
+  EXPECT_EQ(-1, find("foo.com"));
+}
+
+TEST_F(DomainTrieTest, LongestSuffix) {
+  trie_.add(".foo.com", 0);
+  trie_.add("-bar.baz.com", 1);
+  trie_.add(".baz.com", 2);
+  trie_.add("z.com", 3);
+  EXPECT_FALSE(trie_.empty());
+
+  EXPECT_EQ(0, find("www.foo.com"));
+  EXPECT_EQ(0, find("a.b.foo.com"));
+  EXPECT_EQ(1, find("foo-bar.baz.com"));
+  EXPECT_EQ(2, find("bar.baz.com"));
+  EXPECT_EQ(2, find("foo.bar.baz.com"));
+  EXPECT_EQ(3, find("-baz.com"));
+  EXPECT_EQ(3, find("biz.com"));
+  EXPECT_EQ(-1, find("foo.net"));
+  EXPECT_EQ(-1, find("com"));
+  // Hosts are compared exactly.
+  EXPECT_EQ(-1, find("www.FOO.com"));
+}
+
+TEST_F(DomainTrieTest, SuffixMustBeShorterThanHost) {
+  trie_.add(".foo.com", 0);
+  trie_.add("o.com", 1);
+
+  EXPECT_EQ(1, find(".foo.com"));
+  EXPECT_EQ(-1, find("o.com"));
+  EXPECT_EQ(-1, find(".com"));
+}
+
+TEST_F(DomainTrieTest, SplitEdges) {
+  // Each suffix shares part of an existing edge, so that the edge is split.
+  trie_.add("abc.example.com", 0);
+  trie_.add(".example.com", 1);
+  trie_.add("xbc.example.com", 2);
+  trie_.add("le.com", 3);
+
+  EXPECT_EQ(0, find("wwwabc.example.com"));
+  EXPECT_EQ(1, find("www.example.com"));
+  EXPECT_EQ(1, find("bc.example.com"));
+  EXPECT_EQ(2, find("1xbc.example.com"));
+  EXPECT_EQ(3, find("ample.com"));
+  EXPECT_EQ(-1, find("www.example.org"));
+}
+
+TEST_F(DomainTrieTest, FirstIndexWins) {
+  trie_.add(".foo.com", 0);
+  trie_.add(".foo.com", 1);
+
+  EXPECT_EQ(0, find("www.foo.com"));
+}
+
+} // namespace Router
+} // namespace Envoy
@@ -52,6 +52,8 @@ public:
   const Optional<Http::StreamResetReason> remote_refused_stream_reset_{
       Http::StreamResetReason::RemoteRefusedStreamReset};
   const Optional<Http::StreamResetReason> overflow_reset_{Http::StreamResetReason::Overflow};
+  const Optional<Http::StreamResetReason> pipelined_connection_termination_{
+      Http::StreamResetReason::PipelinedConnectionTermination};
   const Optional<Http::StreamResetReason> connect_failure_{
       Http::StreamResetReason::ConnectionFailure};
 };
@@ -83,6 +85,14 @@ TEST_F(RouterRetryStateImplTest, Policy5xxResetOverflow) {
   EXPECT_EQ(RetryStatus::No, state_->shouldRetry(nullptr, overflow_reset_, callback_));
 }
 
+TEST_F(RouterRetryStateImplTest, PolicyPipelinedConnectionTermination) {
+  Http::TestHeaderMapImpl request_headers{{"x-envoy-retry-on", "5xx,connect-failure"}};
+  setup(request_headers);
+  EXPECT_TRUE(state_->enabled());
+  EXPECT_EQ(RetryStatus::No,
+            state_->shouldRetry(nullptr, pipelined_connection_termination_, callback_));
+}
+
 TEST_F(RouterRetryStateImplTest, Policy5xxRemoteReset) {
   Http::TestHeaderMapImpl request_headers{{"x-envoy-retry-on", "5xx"}};
   setup(request_headers);
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/router/route_trie.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace Envoy {
+namespace Router {
+
+class RouteTrieTest : public testing::Test {
+public:
+  std::vector<uint32_t> find(const std::string& path) {
+    std::vector<uint32_t> indexes;
+    const size_t query = path.find('?');
+    trie_.find(path.c_str(), path.size(), query == std::string::npos ? path.size() : query,
+               indexes);
+    std::sort(indexes.begin(), indexes.end());
+    return indexes;
+  }
+
+  RouteTrie trie_;
+};
+
+TEST_F(RouteTrieTest, Empty) {
+  EXPECT_THAT(find(""), IsEmpty());
+  EXPECT_THAT(find("/foo"), IsEmpty());
+}
+
+TEST_F(RouteTrieTest, Prefixes) {
+  trie_.addPrefix("/", 0);
+  trie_.addPrefix("/foo", 1);
+  trie_.addPrefix("/foobar", 2);
+  trie_.addPrefix("/fox", 3);
+  trie_.addPrefix("/foo", 4);
+
+  EXPECT_THAT(find("/"), ElementsAre(0));
+  EXPECT_THAT(find("/fo"), ElementsAre(0));
+  EXPECT_THAT(find("/foo"), ElementsAre(0, 1, 4));
+  EXPECT_THAT(find("/foob"), ElementsAre(0, 1, 4));
+  EXPECT_THAT(find("/foobar/baz"), ElementsAre(0, 1, 2, 4));
+  EXPECT_THAT(find("/fox"), ElementsAre(0, 3));
+  EXPECT_THAT(find("/bar"), ElementsAre(0));
+  EXPECT_THAT(find("bar"), IsEmpty());
+  // Prefixes are matched against the whole path, query string included.
+  EXPECT_THAT(find("/fo?obar"), ElementsAre(0));
+}
+
+TEST_F(RouteTrieTest, Paths) {
+  trie_.addPath("/foo", 0);
+  trie_.addPath("/foo/bar", 1);
+  trie_.addPath("/fo", 2);
+
+  EXPECT_THAT(find("/fo"), ElementsAre(2));
+  EXPECT_THAT(find("/foo"), ElementsAre(0));
+  EXPECT_THAT(find("/foo/"), IsEmpty());
+  EXPECT_THAT(find("/foo/bar"), ElementsAre(1));
+  EXPECT_THAT(find("/foo?bar"), ElementsAre(0));
+  EXPECT_THAT(find("/foo/bar?baz=1"), ElementsAre(1));
+  EXPECT_THAT(find("/f"), IsEmpty());
+}
+
+TEST_F(RouteTrieTest, PrefixesAndPaths) {
+  trie_.addPath("/api/users", 0);
+  trie_.addPrefix("/api/user", 1);
+  trie_.addPrefix("/api", 2);
+  trie_.addPath("/api", 3);
+
+  EXPECT_THAT(find("/api"), ElementsAre(2, 3));
+  EXPECT_THAT(find("/api/users"), ElementsAre(0, 1, 2));
+  EXPECT_THAT(find("/api/users/1"), ElementsAre(1, 2));
+  EXPECT_THAT(find("/api/use"), ElementsAre(2));
+}
+
+TEST_F(RouteTrieTest, EmptyKeys) {
+  trie_.addPrefix("", 0);
+  trie_.addPath("", 1);
+
+  EXPECT_THAT(find(""), ElementsAre(0, 1));
+  EXPECT_THAT(find("?foo"), ElementsAre(0, 1));
+  EXPECT_THAT(find("/"), ElementsAre(0));
+}
+
+} // namespace Router
+} // namespace Envoy
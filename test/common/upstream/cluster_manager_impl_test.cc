@@ -760,6 +760,65 @@ TEST_F(ClusterManagerImplTest, DynamicHostRemove) {
   factory_.tls_.shutdownThread();
 }
 
+TEST_F(ClusterManagerImplTest, DynamicHostPreconnect) {
+  const std::string json = R"EOF(
+  {
+    "clusters": [
+    {
+      "name": "cluster_1",
+      "connect_timeout_ms": 250,
+      "type": "strict_dns",
+      "dns_resolvers": [ "1.2.3.4:80" ],
+      "lb_type": "round_robin",
+      "hosts": [{"url": "tcp://localhost:11001"}]
+    }]
+  }
+  )EOF";
+
+  ON_CALL(factory_.runtime_.snapshot_,
+          getInteger("upstream.cluster_1.preconnect_min_idle_connections", _))
+      .WillByDefault(Return(1));
+
+  std::shared_ptr<Network::MockDnsResolver> dns_resolver(new Network::MockDnsResolver());
+  EXPECT_CALL(factory_.dispatcher_, createDnsResolver(_)).WillOnce(Return(dns_resolver));
+
+  Network::DnsResolver::ResolveCb dns_callback;
+  Event::MockTimer* dns_timer_ = new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  Network::MockActiveDnsQuery active_dns_query;
+  EXPECT_CALL(*dns_resolver, resolve(_, _, _))
+      .WillRepeatedly(DoAll(SaveArg<2>(&dns_callback), Return(&active_dns_query)));
+  create(parseBootstrapFromJson(json));
+
+  // Pools are created and warmed up for each new host, before any request.
+  std::vector<Http::ConnectionPool::MockInstance*> pools;
+  EXPECT_CALL(factory_, allocateConnPool_(_))
+      .Times(3)
+      .WillRepeatedly(Invoke([&pools](HostConstSharedPtr) -> Http::ConnectionPool::Instance* {
+        Http::ConnectionPool::MockInstance* pool = new Http::ConnectionPool::MockInstance();
+        EXPECT_CALL(*pool, preconnect());
+        pools.push_back(pool);
+        return pool;
+      }));
+  dns_callback(TestUtility::makeDnsResponse({"127.0.0.1", "127.0.0.2"}));
+  EXPECT_EQ(2U, pools.size());
+
+  // Requests use the warmed up pools.
+  Http::ConnectionPool::Instance* cp1 =
+      cluster_manager_->httpConnPoolForCluster("cluster_1", ResourcePriority::Default, nullptr);
+  Http::ConnectionPool::Instance* cp2 =
+      cluster_manager_->httpConnPoolForCluster("cluster_1", ResourcePriority::Default, nullptr);
+  EXPECT_NE(cp1, cp2);
+  EXPECT_TRUE(cp1 == pools[0] || cp1 == pools[1]);
+  EXPECT_TRUE(cp2 == pools[0] || cp2 == pools[1]);
+
+  // Only the added host is warmed up.
+  dns_timer_->callback_();
+  dns_callback(TestUtility::makeDnsResponse({"127.0.0.1", "127.0.0.2", "127.0.0.3"}));
+  EXPECT_EQ(3U, pools.size());
+
+  factory_.tls_.shutdownThread();
+}
+
 // This is a regression test for a use-after-free in
 // ClusterManagerImpl::ThreadLocalClusterManagerImpl::drainConnPools(), where a removal at one
 // priority from the ConnPoolsContainer would delete the ConnPoolsContainer mid-iteration over the
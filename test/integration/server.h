@@ -50,6 +50,7 @@ public:
   const std::string& serviceClusterName() override { return service_cluster_name_; }
   const std::string& serviceNodeName() override { return service_node_name_; }
   const std::string& serviceZone() override { return service_zone_; }
+  uint64_t maxBufferMemoryBytes() override { return 0; }
 
 private:
   const std::string config_path_;
@@ -14,6 +14,7 @@
 #include "envoy/http/filter.h"
 #include "envoy/ssl/connection.h"
 
+#include "common/common/arena_impl.h"
 #include "common/http/conn_manager_impl.h"
 
 #include "test/mocks/common.h"
@@ -455,6 +456,9 @@ public:
   MOCK_METHOD1(addStreamEncoderFilter, void(Http::StreamEncoderFilterSharedPtr filter));
   MOCK_METHOD1(addStreamFilter, void(Http::StreamFilterSharedPtr filter));
   MOCK_METHOD1(addAccessLogHandler, void(Http::AccessLog::InstanceSharedPtr handler));
+  MOCK_METHOD0(arena, Arena&());
+
+  ArenaImpl arena_;
 };
 
 class MockDownstreamWatermarkCallbacks : public DownstreamWatermarkCallbacks {
@@ -486,6 +490,7 @@ public:
   MOCK_METHOD1(addDrainedCallback, void(DrainedCb cb));
   MOCK_METHOD2(newStream, Cancellable*(Http::StreamDecoder& response_decoder,
                                        Http::ConnectionPool::Callbacks& callbacks));
+  MOCK_METHOD0(preconnect, void());
 
   std::shared_ptr<testing::NiceMock<Upstream::MockHostDescription>> host_{
       new testing::NiceMock<Upstream::MockHostDescription>()};
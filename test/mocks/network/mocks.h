@@ -71,6 +71,10 @@ public:
   MOCK_METHOD1(write, void(Buffer::Instance& data));
   MOCK_METHOD1(setBufferLimits, void(uint32_t limit));
   MOCK_CONST_METHOD0(bufferLimit, uint32_t());
+  MOCK_METHOD1(enableZeroCopySend, bool(const ZeroCopySendStats& stats));
+  MOCK_METHOD1(spliceTo, bool(Connection& connection));
+  MOCK_METHOD1(setBufferMemoryGauge, void(Stats::Gauge& gauge));
+  MOCK_METHOD0(bufferMemoryAccount, Buffer::MemoryAccountSharedPtr());
   MOCK_CONST_METHOD0(usingOriginalDst, bool());
   MOCK_CONST_METHOD0(aboveHighWatermark, bool());
 };
@@ -107,6 +111,10 @@ public:
   MOCK_METHOD1(write, void(Buffer::Instance& data));
   MOCK_METHOD1(setBufferLimits, void(uint32_t limit));
   MOCK_CONST_METHOD0(bufferLimit, uint32_t());
+  MOCK_METHOD1(enableZeroCopySend, bool(const ZeroCopySendStats& stats));
+  MOCK_METHOD1(spliceTo, bool(Connection& connection));
+  MOCK_METHOD1(setBufferMemoryGauge, void(Stats::Gauge& gauge));
+  MOCK_METHOD0(bufferMemoryAccount, Buffer::MemoryAccountSharedPtr());
   MOCK_CONST_METHOD0(usingOriginalDst, bool());
   MOCK_CONST_METHOD0(aboveHighWatermark, bool());
 
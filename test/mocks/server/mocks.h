@@ -58,6 +58,7 @@ public:
   MOCK_METHOD0(serviceClusterName, const std::string&());
   MOCK_METHOD0(serviceNodeName, const std::string&());
   MOCK_METHOD0(serviceZone, const std::string&());
+  MOCK_METHOD0(maxBufferMemoryBytes, uint64_t());
 
   std::string config_path_;
   std::string admin_address_path_;
@@ -178,6 +179,7 @@ public:
   MOCK_METHOD0(bindToPort, bool());
   MOCK_METHOD0(useOriginalDst, bool());
   MOCK_METHOD0(perConnectionBufferLimitBytes, uint32_t());
+  MOCK_METHOD0(zeroCopySend, bool());
   MOCK_METHOD0(listenerScope, Stats::Scope&());
   MOCK_METHOD0(listenerTag, uint64_t());
   MOCK_CONST_METHOD0(name, const std::string&());
@@ -13,8 +13,10 @@
 #include "server/config/http/file_access_log.h"
 #include "server/config/http/grpc_http1_bridge.h"
 #include "server/config/http/grpc_web.h"
+#include "server/config/http/gzip.h"
 #include "server/config/http/ip_tagging.h"
 #include "server/config/http/ratelimit.h"
+#include "server/config/http/response_cache.h"
 #include "server/config/http/router.h"
 #include "server/config/http/zipkin_http_tracer.h"
 #include "server/config/network/http_connection_manager.h"
@@ -65,6 +67,74 @@ TEST(HttpFilterConfigTest, BadBufferFilterConfig) {
   EXPECT_THROW(factory.createFilterFactory(*json_config, "stats", context), Json::Exception);
 }
 
+TEST(HttpFilterConfigTest, GzipFilter) {
+  std::string json_string = R"EOF(
+  {
+    "compression_level" : 5,
+    "window_bits" : 12,
+    "memory_level" : 9,
+    "min_content_length" : 100,
+    "content_types" : ["text/html", "application/json"]
+  }
+  )EOF";
+
+  Json::ObjectSharedPtr json_config = Json::Factory::loadFromString(json_string);
+  NiceMock<MockFactoryContext> context;
+  GzipFilterConfig factory;
+  HttpFilterFactoryCb cb = factory.createFilterFactory(*json_config, "stats", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamFilter(_));
+  cb(filter_callback);
+}
+
+TEST(HttpFilterConfigTest, BadGzipFilterConfig) {
+  std::string json_string = R"EOF(
+  {
+    "window_bits" : 16
+  }
+  )EOF";
+
+  Json::ObjectSharedPtr json_config = Json::Factory::loadFromString(json_string);
+  NiceMock<MockFactoryContext> context;
+  GzipFilterConfig factory;
+  EXPECT_THROW(factory.createFilterFactory(*json_config, "stats", context), Json::Exception);
+}
+
+TEST(HttpFilterConfigTest, ResponseCacheFilter) {
+  std::string json_string = R"EOF(
+  {
+    "max_size_bytes" : 1048576,
+    "max_entry_size_bytes" : 65536,
+    "shards" : 4
+  }
+  )EOF";
+
+  Json::ObjectSharedPtr json_config = Json::Factory::loadFromString(json_string);
+  NiceMock<MockFactoryContext> context;
+  EXPECT_CALL(context.admin_, addHandler("/cache", _, _, true));
+  EXPECT_CALL(context.admin_, removeHandler("/cache"));
+  ResponseCacheFilterConfig factory;
+  HttpFilterFactoryCb cb = factory.createFilterFactory(*json_config, "stats", context);
+  // A second filter shares the admin endpoint.
+  HttpFilterFactoryCb cb2 = factory.createFilterFactory(*json_config, "stats2", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamFilter(_));
+  cb(filter_callback);
+}
+
+TEST(HttpFilterConfigTest, BadResponseCacheFilterConfig) {
+  std::string json_string = R"EOF(
+  {
+    "shards" : 0
+  }
+  )EOF";
+
+  Json::ObjectSharedPtr json_config = Json::Factory::loadFromString(json_string);
+  NiceMock<MockFactoryContext> context;
+  ResponseCacheFilterConfig factory;
+  EXPECT_THROW(factory.createFilterFactory(*json_config, "stats", context), Json::Exception);
+}
+
 TEST(HttpFilterConfigTest, RateLimitFilter) {
   std::string json_string = R"EOF(
   {
@@ -96,6 +96,35 @@ TEST_F(ConnectionHandlerTest, DestroyCloseConnections) {
   handler_.reset();
 }
 
+TEST_F(ConnectionHandlerTest, ZeroCopySend) {
+  InSequence s;
+
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _, _))
+      .WillOnce(Invoke([&](Network::ConnectionHandler&, Network::ListenSocket&,
+                           Network::ListenerCallbacks& cb, Stats::Scope&,
+                           const Network::ListenerOptions&) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+
+      }));
+  Network::ListenerOptions options = Network::ListenerOptions::listenerOptionsWithBindToPort();
+  options.zero_copy_send_ = true;
+  handler_->addListener(factory_, socket_, stats_store_, 1, options);
+
+  Network::MockConnection* connection = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(*connection, enableZeroCopySend(_)).WillOnce(Return(true));
+  EXPECT_CALL(factory_, createFilterChain(_)).WillOnce(Return(true));
+  listener_callbacks->onNewConnection(Network::ConnectionPtr{connection});
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  EXPECT_CALL(*connection, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(dispatcher_, clearDeferredDeleteList());
+  EXPECT_CALL(*listener, onDestroy());
+  handler_.reset();
+}
+
 TEST_F(ConnectionHandlerTest, CloseDuringFilterChainCreate) {
   InSequence s;
 
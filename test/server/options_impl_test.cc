@@ -40,7 +40,8 @@ TEST(OptionsImplTest, All) {
       "envoy --mode validate --concurrency 2 -c hello --admin-address-path path --restart-epoch 1 "
       "--local-address-ip-version v6 -l info --service-cluster cluster --service-node node "
       "--service-zone zone --file-flush-interval-msec 9000 --drain-time-s 60 "
-      "--parent-shutdown-time-s 90 --log-path /foo/bar");
+      "--parent-shutdown-time-s 90 --log-path /foo/bar --max-buffer-memory-mb 64 "
+      "--use-libevent-buffers");
   EXPECT_EQ(Server::Mode::Validate, options->mode());
   EXPECT_EQ(2U, options->concurrency());
   EXPECT_EQ("hello", options->configPath());
@@ -55,6 +56,8 @@ TEST(OptionsImplTest, All) {
   EXPECT_EQ(std::chrono::milliseconds(9000), options->fileFlushIntervalMsec());
   EXPECT_EQ(std::chrono::seconds(60), options->drainTime());
   EXPECT_EQ(std::chrono::seconds(90), options->parentShutdownTime());
+  EXPECT_EQ(64U * 1024 * 1024, options->maxBufferMemoryBytes());
+  EXPECT_TRUE(options->libeventBuffersEnabled());
 }
 
 TEST(OptionsImplTest, DefaultParams) {
@@ -64,6 +67,8 @@ TEST(OptionsImplTest, DefaultParams) {
   EXPECT_EQ("", options->adminAddressPath());
   EXPECT_EQ(Network::Address::IpVersion::v4, options->localAddressIpVersion());
   EXPECT_EQ(Server::Mode::Serve, options->mode());
+  EXPECT_EQ(0U, options->maxBufferMemoryBytes());
+  EXPECT_FALSE(options->libeventBuffersEnabled());
 }
 
 TEST(OptionsImplTest, BadCliOption) {
@@ -1,4 +1,5 @@
 #include "common/event/dispatcher_impl.h"
+#include "common/stats/stats_impl.h"
 
 #include "server/worker_impl.h"
 
@@ -32,8 +33,16 @@ public:
   Network::MockConnectionHandler* handler_ = new Network::MockConnectionHandler();
   NiceMock<MockGuardDog> guard_dog_;
   DefaultTestHooks hooks_;
-  WorkerImpl worker_{tls_, hooks_, Event::DispatcherPtr{dispatcher_},
-                     Network::ConnectionHandlerPtr{handler_}};
+  Stats::IsolatedStoreImpl stats_store_;
+  Buffer::SlicePoolStats slice_pool_stats_{ALL_SLICE_POOL_STATS(POOL_COUNTER(stats_store_),
+                                                                POOL_GAUGE(stats_store_))};
+  Network::BufferMemoryTracker buffer_memory_tracker_{stats_store_, 0};
+  WorkerImpl worker_{tls_,
+                     hooks_,
+                     Event::DispatcherPtr{dispatcher_},
+                     Network::ConnectionHandlerPtr{handler_},
+                     slice_pool_stats_,
+                     buffer_memory_tracker_};
   Event::TimerPtr no_exit_timer_ = dispatcher_->createTimer([]() -> void {});
 };
 
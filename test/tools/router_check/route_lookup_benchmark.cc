@@ -0,0 +1,161 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+#include "common/router/config_impl.h"
+
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+
+#include "benchmark/benchmark.h"
+#include "fmt/format.h"
+#include "gmock/gmock.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * A single virtual host with a given number of routes, as generated from a service catalog: an
+ * exact path route and a prefix route for each service, followed by a catch all route.
+ */
+class ServiceRouteTable {
+public:
+  ServiceRouteTable(int64_t num_services, bool case_sensitive) {
+    envoy::api::v2::RouteConfiguration route_config;
+    auto* virtual_host = route_config.mutable_virtual_hosts()->Add();
+    virtual_host->set_name("services");
+    virtual_host->add_domains("*");
+    for (int64_t i = 0; i < num_services; i++) {
+      const std::string service = fmt::format("service-{}", i);
+      addRoute(*virtual_host, service, case_sensitive)
+          ->mutable_match()
+          ->set_path(fmt::format("/{}/healthcheck", service));
+      addRoute(*virtual_host, service, case_sensitive)
+          ->mutable_match()
+          ->set_prefix(fmt::format("/{}/", service));
+    }
+    addRoute(*virtual_host, "default", case_sensitive)->mutable_match()->set_prefix("/");
+    config_.reset(new ConfigImpl(route_config, runtime_, cm_, false));
+  }
+
+  const Config& config() const { return *config_; }
+
+private:
+  static envoy::api::v2::Route* addRoute(envoy::api::v2::VirtualHost& virtual_host,
+                                         const std::string& cluster, bool case_sensitive) {
+    auto* route = virtual_host.mutable_routes()->Add();
+    route->mutable_match()->mutable_case_sensitive()->set_value(case_sensitive);
+    route->mutable_route()->set_cluster(cluster);
+    return route;
+  }
+
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Upstream::MockClusterManager> cm_;
+  std::unique_ptr<ConfigImpl> config_;
+};
+
+/**
+ * A route configuration with a given number of tenants, each with an exact domain and a wildcard
+ * domain of its own, followed by a default virtual host.
+ */
+class TenantVirtualHostTable {
+public:
+  TenantVirtualHostTable(int64_t num_tenants) {
+    envoy::api::v2::RouteConfiguration route_config;
+    for (int64_t i = 0; i < num_tenants; i++) {
+      auto* virtual_host = addVirtualHost(route_config, fmt::format("tenant-{}", i));
+      virtual_host->add_domains(tenantDomain(i));
+      virtual_host->add_domains("*." + tenantDomain(i));
+    }
+    addVirtualHost(route_config, "default")->add_domains("*");
+    config_.reset(new ConfigImpl(route_config, runtime_, cm_, false));
+  }
+
+  const Config& config() const { return *config_; }
+
+  // Tenant names vary in length, as real ones do, so wildcard domains have many lengths.
+  static std::string tenantDomain(int64_t tenant) {
+    const std::string name(1 + tenant % 24, static_cast<char>('a' + tenant % 26));
+    return fmt::format("{}-{}.edge.example.com", name, tenant);
+  }
+
+private:
+  static envoy::api::v2::VirtualHost* addVirtualHost(envoy::api::v2::RouteConfiguration& config,
+                                                     const std::string& cluster) {
+    auto* virtual_host = config.mutable_virtual_hosts()->Add();
+    virtual_host->set_name(cluster);
+    auto* route = virtual_host->mutable_routes()->Add();
+    route->mutable_match()->set_prefix("/");
+    route->mutable_route()->set_cluster(cluster);
+    return virtual_host;
+  }
+
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Upstream::MockClusterManager> cm_;
+  std::unique_ptr<ConfigImpl> config_;
+};
+
+// Each benchmark takes the number of services as its argument. There are two routes per service.
+static void routeCountArgs(benchmark::internal::Benchmark* benchmark) {
+  for (int num_services : {4, 16, 64, 256, 1024, 4096}) {
+    benchmark->Arg(num_services);
+  }
+}
+
+// Look up a path of the last service, which is the worst case for evaluating routes in order.
+static void lookupLastService(benchmark::State& state, bool case_sensitive) {
+  ServiceRouteTable table(state.range(0), case_sensitive);
+  Http::HeaderMapImpl headers{
+      {Http::Headers::get().Host, "www.example.com"},
+      {Http::Headers::get().Path, fmt::format("/service-{}/items/1", state.range(0) - 1)},
+      {Http::Headers::get().Method, "GET"}};
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(table.config().route(headers, 0));
+  }
+  state.SetLabel(fmt::format("{} routes", 2 * state.range(0) + 1));
+}
+
+// Case sensitive prefix and path routes are found through the route trie once a virtual host has
+// enough of them.
+static void routeLookupIndexed(benchmark::State& state) { lookupLastService(state, true); }
+BENCHMARK(routeLookupIndexed)->Apply(routeCountArgs);
+
+// Case insensitive routes can't be indexed, so every route ahead of the match is evaluated.
+static void routeLookupUnindexed(benchmark::State& state) { lookupLastService(state, false); }
+BENCHMARK(routeLookupUnindexed)->Apply(routeCountArgs);
+
+// Each benchmark takes the number of tenants as its argument.
+static void tenantCountArgs(benchmark::internal::Benchmark* benchmark) {
+  for (int num_tenants : {16, 256, 4096, 40000}) {
+    benchmark->Arg(num_tenants);
+  }
+}
+
+static void lookupVirtualHost(benchmark::State& state, const std::string& host) {
+  TenantVirtualHostTable table(state.range(0));
+  Http::HeaderMapImpl headers{{Http::Headers::get().Host, host},
+                              {Http::Headers::get().Path, "/"},
+                              {Http::Headers::get().Method, "GET"}};
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(table.config().route(headers, 0));
+  }
+}
+
+// The host matches the wildcard domain of a tenant, found through the trie of wildcard suffixes.
+static void virtualHostLookupWildcard(benchmark::State& state) {
+  lookupVirtualHost(state, "api." + TenantVirtualHostTable::tenantDomain(state.range(0) - 1));
+}
+BENCHMARK(virtualHostLookupWildcard)->Apply(tenantCountArgs);
+
+// No wildcard domain matches the host, so the default virtual host is used.
+static void virtualHostLookupDefault(benchmark::State& state) {
+  lookupVirtualHost(state, "api.tenant.edge.example.org");
+}
+BENCHMARK(virtualHostLookupDefault)->Apply(tenantCountArgs);
+
+} // namespace Router
+} // namespace Envoy
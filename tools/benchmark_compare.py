@@ -0,0 +1,54 @@
+#!/usr/bin/env python
+
+# This tool compares two runs of an Envoy benchmark binary, e.g. from before and after a change.
+# Each run is the JSON output of the binary, as written with:
+#
+#   bazel run -c opt //test/benchmark:buffer_benchmark -- --benchmark_out=/tmp/before.json \
+#     --benchmark_out_format=json
+#
+# and it prints the CPU time per iteration of each benchmark in both runs along with the change.
+
+from __future__ import print_function
+
+import json
+import sys
+
+
+def LoadBenchmarks(path):
+  with open(path) as f:
+    results = json.load(f)
+  benchmarks = {}
+  for benchmark in results['benchmarks']:
+    benchmarks[benchmark['name']] = benchmark
+  return results['context'], benchmarks
+
+
+def CompareBenchmarks(before_path, after_path):
+  before_context, before = LoadBenchmarks(before_path)
+  after_context, after = LoadBenchmarks(after_path)
+  for key in ('num_cpus', 'mhz_per_cpu', 'library_build_type'):
+    if before_context.get(key) != after_context.get(key):
+      print('warning: runs differ in %s: %s vs. %s' % (key, before_context.get(key),
+                                                       after_context.get(key)))
+
+  name_width = max([len(name) for name in before] + [len('benchmark')])
+  print('%-*s %14s %14s %8s' % (name_width, 'benchmark', 'before', 'after', 'change'))
+  for name in sorted(before):
+    if name not in after:
+      continue
+    before_time = before[name]['cpu_time']
+    after_time = after[name]['cpu_time']
+    unit = before[name].get('time_unit', 'ns')
+    change = (after_time - before_time) * 100.0 / before_time if before_time else 0.0
+    print('%-*s %11.1f %2s %11.1f %2s %+7.1f%%' % (name_width, name, before_time, unit,
+                                                    after_time, unit, change))
+
+  for name in sorted(set(before) ^ set(after)):
+    print('%s: only in %s' % (name, before_path if name in before else after_path))
+
+
+if __name__ == '__main__':
+  if len(sys.argv) != 3:
+    print('Usage: %s <before.json> <after.json>' % sys.argv[0])
+    sys.exit(1)
+  CompareBenchmarks(sys.argv[1], sys.argv[2])